@@ -41,6 +41,14 @@ endif()
 # Rest is patch (may include -commits-ghash)
 set (Found_PATCH ${GIT_VERS_STRIPPED})
 
+# Shows keep their background images and media in a resource pool as of 3.9, which earlier versions can't
+# read.  Until v3.9.0 is tagged, builds call themselves 3.9 so the shows they write say so.
+if (Found_MAJOR LESS 3 OR (Found_MAJOR EQUAL 3 AND Found_MINOR LESS 9))
+  set(Found_MAJOR 3)
+  set(Found_MINOR 9)
+  set(Found_PATCH 0)
+endif()
+
 set (CalChart_VERSION_MAJOR ${Found_MAJOR})
 set (CalChart_VERSION_MINOR ${Found_MINOR})
 set (CalChart_VERSION_PATCH ${Found_PATCH})
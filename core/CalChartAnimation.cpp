@@ -24,31 +24,131 @@
 #include "CalChartAnimationCompile.h"
 #include "CalChartAnimationSheet.h"
 #include "CalChartConfiguration.h"
+#include "CalChartDisplayList.h"
 #include "CalChartMeasure.h"
 #include "CalChartRanges.h"
 #include "CalChartSheet.h"
 #include "CalChartShow.h"
+#include <future>
 #include <optional>
 #include <ranges>
+#include <thread>
+#include <unordered_map>
 
 auto gAnimateMeasure = CalChart::MeasureDuration<1024>{ "AnimateShow" };
 
 namespace CalChart::Animate {
 
-auto AnimateShow(const Show& show) -> Sheets
+namespace {
+    auto CompileMarcher(CalChart::Sheet const& currSheet, CalChart::Sheet const* nextAnimationSheet, MarcherIndex whichMarcher, Variables& variablesStates) -> Animate::CompileResult
+    {
+        auto current_symbol = currSheet.GetSymbol(whichMarcher);
+        auto endPosition = [whichMarcher](auto&& nextAnimationSheet) -> std::optional<Coord> {
+            if (nextAnimationSheet) {
+                return nextAnimationSheet->GetMarcherPosition(whichMarcher);
+            }
+            return std::nullopt;
+        }(nextAnimationSheet);
+        auto cont = currSheet.GetContinuityBySymbol(current_symbol);
+        return CalChart::Animate::CreateCompileResult(
+            AnimationData{
+                whichMarcher,
+                currSheet.GetMarcher(whichMarcher),
+                endPosition,
+                currSheet.GetBeats(),
+                nextAnimationSheet == nullptr },
+            currSheet.ContinuityInUse(current_symbol) ? &cont : nullptr,
+            variablesStates);
+    }
+
+    auto CompileMarchers(CalChart::Sheet const& currSheet, CalChart::Sheet const* nextAnimationSheet, MarcherIndex first, MarcherIndex last, Variables& variablesStates)
+    {
+        return CalChart::Ranges::ToVector<Animate::CompileResult>(
+            std::views::iota(first, last) | std::views::transform([&variablesStates, &currSheet, nextAnimationSheet](auto whichMarcher) {
+                return CompileMarcher(currSheet, nextAnimationSheet, whichMarcher, variablesStates);
+            }));
+    }
+
+    // Variables are keyed by marcher, so a range of marchers only ever reads and writes its own part of them.
+    auto ExtractVariables(Variables const& variablesStates, MarcherIndex first, MarcherIndex last)
+    {
+        auto result = Variables{};
+        for (auto whichVariable : std::views::iota(0UL, result.size())) {
+            auto const& values = variablesStates.at(whichVariable);
+            result.at(whichVariable).insert(values.lower_bound(first), values.lower_bound(last));
+        }
+        return result;
+    }
+
+    void ReplaceVariables(Variables& variablesStates, Variables const& replacement, MarcherIndex first, MarcherIndex last)
+    {
+        for (auto whichVariable : std::views::iota(0UL, variablesStates.size())) {
+            auto& values = variablesStates.at(whichVariable);
+            values.erase(values.lower_bound(first), values.lower_bound(last));
+            values.insert(replacement.at(whichVariable).begin(), replacement.at(whichVariable).end());
+        }
+    }
+
+    auto CompileSheet(CalChart::Sheet const& currSheet, CalChart::Sheet const* nextAnimationSheet, size_t numPoints, Variables& variablesStates, unsigned numberThreads) -> Animate::Sheet
+    {
+        auto const numMarchers = static_cast<MarcherIndex>(numPoints);
+        if (numberThreads == 0) {
+            numberThreads = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+        numberThreads = std::min(numberThreads, numMarchers);
+        if (numberThreads <= 1) {
+            return Animate::Sheet{
+                currSheet.GetName(), currSheet.GetBeats(), CompileMarchers(currSheet, nextAnimationSheet, 0, numMarchers, variablesStates)
+            };
+        }
+
+        // Split the marchers into contiguous ranges, each compiled against its own copy of its variables.
+        // The first range is done on this thread while the others run.
+        auto const marchersPerThread = (numMarchers + numberThreads - 1) / numberThreads;
+        auto ranges = CalChart::Ranges::ToVector<std::pair<MarcherIndex, MarcherIndex>>(
+            std::views::iota(0U, numberThreads) | std::views::transform([numMarchers, marchersPerThread](auto whichThread) {
+                return std::pair{ std::min(whichThread * marchersPerThread, numMarchers), std::min((whichThread + 1) * marchersPerThread, numMarchers) };
+            }));
+        auto rangeVariables = CalChart::Ranges::ToVector<Variables>(ranges | std::views::transform([&variablesStates](auto&& range) {
+            return ExtractVariables(variablesStates, range.first, range.second);
+        }));
+        auto futures = std::vector<std::future<std::vector<Animate::CompileResult>>>{};
+        for (auto whichRange : std::views::iota(1UL, ranges.size())) {
+            futures.push_back(std::async(std::launch::async, [&currSheet, nextAnimationSheet, range = ranges.at(whichRange), &variables = rangeVariables.at(whichRange)] {
+                return CompileMarchers(currSheet, nextAnimationSheet, range.first, range.second, variables);
+            }));
+        }
+        auto theCommands = CompileMarchers(currSheet, nextAnimationSheet, ranges.front().first, ranges.front().second, rangeVariables.front());
+        for (auto&& future : futures) {
+            std::ranges::move(future.get(), std::back_inserter(theCommands));
+        }
+        for (auto whichRange : std::views::iota(0UL, ranges.size())) {
+            ReplaceVariables(variablesStates, rangeVariables.at(whichRange), ranges.at(whichRange).first, ranges.at(whichRange).second);
+        }
+
+        return Animate::Sheet{
+            currSheet.GetName(), currSheet.GetBeats(), theCommands
+        };
+    }
+
+    auto ShowSheetToAnimationSheet(Show const& show)
+    {
+        auto runningIndex = CalChart::Ranges::ToVector<unsigned>(show.AreSheetsInAnimation());
+        std::exclusive_scan(runningIndex.begin(), runningIndex.end(), runningIndex.begin(), 0);
+        return runningIndex;
+    }
+}
+
+auto AnimateShow(const Show& show, unsigned numberThreads) -> Sheets
 {
     auto snapshot = gAnimateMeasure.doMeasurement();
 
     // the variables are persistant through the entire compile process.
     Variables variablesStates;
 
-    auto runningIndex = CalChart::Ranges::ToVector<unsigned>(show.AreSheetsInAnimation());
-    std::exclusive_scan(runningIndex.begin(), runningIndex.end(), runningIndex.begin(), 0);
-
-    // First, construct pairs of sheets, the animation start and end.  We use optional here as a
-    // sentinel -- meaning if it is null we know we have the last sheet, which we treat specially.
-    // Then, from the pairs construct AnimationData, which has all the information needed for the compile step.
-    // Then CreateCompileResult with the AnimationData and Variables.  Collect the whole thing into commands,
+    // Construct pairs of sheets, the animation start and end.  We use optional here as a sentinel --
+    // meaning if it is null we know we have the last sheet, which we treat specially.
+    // Then compile each of the pairs with the Variables.  Collect the whole thing into commands,
     // and, viola, we have the compiled show.
 
     return Animate::Sheets{
@@ -60,66 +160,135 @@ auto AnimateShow(const Show& show) -> Sheets
                 return animationSheetsWithSentinel;
             }(show))
             | std::views::transform([&](auto&& curr_next) {
-                  auto [curr_sheet, nextAnimationSheet] = curr_next;
-                  // Create local copies to avoid capturing structured bindings directly (C++ limitation)
-                  // This prevents MSVC from silently failing in Release builds
-                  auto curr_sheet_copy = curr_sheet;
-                  auto nextAnimationSheet_copy = nextAnimationSheet;
-                  auto numBeats = curr_sheet->GetBeats();
-                  auto isLastSheet = !nextAnimationSheet.has_value();
-                  auto theCommands = CalChart::Ranges::ToVector<Animate::CompileResult>(
-                      std::ranges::iota_view(0UL, show.GetNumPoints()) | std::views::transform([&variablesStates, numBeats, isLastSheet, curr_sheet_copy, nextAnimationSheet_copy](auto whichMarcher) {
-                          auto current_symbol = curr_sheet_copy->GetSymbol(whichMarcher);
-                          auto endPosition = [whichMarcher](auto&& nextAnimationSheet) -> std::optional<Coord> {
-                              if (nextAnimationSheet) {
-                                  return nextAnimationSheet->GetMarcherPosition(whichMarcher);
-                              }
-                              return std::nullopt;
-                          }(nextAnimationSheet_copy);
-                          auto cont = curr_sheet_copy->GetContinuityBySymbol(current_symbol);
-                          return CalChart::Animate::CreateCompileResult(
-                              AnimationData{
-                                  static_cast<unsigned>(whichMarcher),
-                                  curr_sheet_copy->GetMarcher(whichMarcher),
-                                  endPosition,
-                                  numBeats,
-                                  isLastSheet },
-                              curr_sheet_copy->ContinuityInUse(current_symbol) ? &cont : nullptr,
-                              variablesStates);
-                      }));
-
-                  return Animate::Sheet{
-                      curr_sheet_copy->GetName(), numBeats, theCommands
-                  };
+                  auto const& [curr_sheet, nextAnimationSheet] = curr_next;
+                  return CompileSheet(*curr_sheet, nextAnimationSheet ? &*nextAnimationSheet : nullptr, show.GetNumPoints(), variablesStates, numberThreads);
               })),
-        runningIndex
+        ShowSheetToAnimationSheet(show)
     };
 }
-}
+
+// Everything that goes into compiling an animation sheet, and what came out.  The sheets are copies of the
+// show's sheets, which share their contents with them, so keeping them is cheap and lets an unchanged sheet be
+// found by its ContentsIdentity without comparing every marcher and continuity.
+struct CompileCache::Entry {
+    [[nodiscard]] auto CompilesTheSame(CalChart::Sheet const& sheet, CalChart::Sheet const* nextSheet, Variables const& variablesIn) const -> bool;
+
+    CalChart::Sheet mShowSheet;
+    std::optional<CalChart::Sheet> mNextShowSheet;
+    Variables mVariablesIn;
+    Variables mVariablesOut;
+    // shared with every Animate::Sheets made from the cache, so reusing a sheet doesn't copy it.
+    std::shared_ptr<Animate::Sheet const> mSheet;
+};
 
 namespace {
+    // Entries left over from earlier shows are kept around so an undo can find the sheets it puts back.
+    constexpr auto kMaxSpareEntries = 16UL;
+}
 
-template <std::ranges::input_range Range>
-    requires(std::is_convertible_v<std::ranges::range_value_t<Range>, CalChart::Animate::Info>)
-auto GeneratePointDrawCommand(Range&& infos) -> std::vector<CalChart::Draw::DrawCommand>
+auto CompileCache::Entry::CompilesTheSame(CalChart::Sheet const& sheet, CalChart::Sheet const* nextSheet, Variables const& variablesIn) const -> bool
 {
-    return CalChart::Ranges::ToVector<CalChart::Draw::DrawCommand>(infos | std::views::transform([](auto&& info) {
-        auto size = CalChart::Coord{ CalChart::Int2CoordUnits(1), CalChart::Int2CoordUnits(1) };
-        return CalChart::Draw::Rectangle{
-            info.mMarcherInfo.mPosition - size / 2, { CalChart::Int2CoordUnits(1), CalChart::Int2CoordUnits(1) }
+    if (mShowSheet.GetBeats() != sheet.GetBeats() || mShowSheet.GetName() != sheet.GetName() || mNextShowSheet.has_value() != (nextSheet != nullptr)) {
+        return false;
+    }
+    if (nextSheet && mNextShowSheet->ContentsIdentity() != nextSheet->ContentsIdentity() && mNextShowSheet->GetAllMarcherPositions() != nextSheet->GetAllMarcherPositions()) {
+        return false;
+    }
+    return mVariablesIn == variablesIn && mShowSheet.ContentsIdentity() == sheet.ContentsIdentity();
+}
+
+CompileCache::CompileCache() = default;
+CompileCache::~CompileCache() = default;
+CompileCache::CompileCache(CompileCache&&) noexcept = default;
+auto CompileCache::operator=(CompileCache&&) noexcept -> CompileCache& = default;
+
+void CompileCache::Clear()
+{
+    mEntries.clear();
+    mNumberSheetsCompiled = 0;
+}
+
+auto AnimateShow(const Show& show, CompileCache& cache, unsigned numberThreads) -> Sheets
+{
+    auto snapshot = gAnimateMeasure.doMeasurement();
+
+    Variables variablesStates;
+
+    auto animationSheets = CalChart::Ranges::ToVector<CalChart::Sheet const*>(show.SheetsInAnimation() | std::views::transform([](auto&& sheet) { return &sheet; }));
+
+    // Unchanged sheets are found by identity.  A sheet that was changed has a new identity and is compiled again.
+    auto byIdentity = std::unordered_multimap<void const*, size_t>{};
+    for (auto whichEntry : std::views::iota(0UL, cache.mEntries.size())) {
+        byIdentity.emplace(cache.mEntries.at(whichEntry).mShowSheet.ContentsIdentity(), whichEntry);
+    }
+    auto used = std::vector<bool>(cache.mEntries.size());
+    auto findEntry = [&](CalChart::Sheet const& sheet, CalChart::Sheet const* nextSheet) -> std::optional<size_t> {
+        auto matches = [&](size_t whichEntry) {
+            return !used.at(whichEntry) && cache.mEntries.at(whichEntry).CompilesTheSame(sheet, nextSheet, variablesStates);
         };
-    }));
+        auto [begin, end] = byIdentity.equal_range(sheet.ContentsIdentity());
+        for (auto&& [identity, whichEntry] : std::ranges::subrange(begin, end)) {
+            if (matches(whichEntry)) {
+                return whichEntry;
+            }
+        }
+        return std::nullopt;
+    };
+
+    auto entries = std::vector<CompileCache::Entry>{};
+    entries.reserve(animationSheets.size() + kMaxSpareEntries);
+    cache.mNumberSheetsCompiled = 0;
+    for (auto whichSheet : std::views::iota(0UL, animationSheets.size())) {
+        auto const& currSheet = *animationSheets.at(whichSheet);
+        auto const* nextAnimationSheet = (whichSheet + 1 < animationSheets.size()) ? animationSheets.at(whichSheet + 1) : nullptr;
+
+        if (auto found = findEntry(currSheet, nextAnimationSheet); found) {
+            used.at(*found) = true;
+            variablesStates = cache.mEntries.at(*found).mVariablesOut;
+            entries.push_back(std::move(cache.mEntries.at(*found)));
+            continue;
+        }
+
+        ++cache.mNumberSheetsCompiled;
+        auto variablesIn = variablesStates;
+        auto sheet = CompileSheet(currSheet, nextAnimationSheet, show.GetNumPoints(), variablesStates, numberThreads);
+        entries.push_back(CompileCache::Entry{
+            currSheet,
+            nextAnimationSheet ? std::optional{ *nextAnimationSheet } : std::nullopt,
+            std::move(variablesIn),
+            variablesStates,
+            std::make_shared<Animate::Sheet const>(std::move(sheet)),
+        });
+    }
+    auto result = CalChart::Ranges::ToVector<std::shared_ptr<Animate::Sheet const>>(entries | std::views::transform([](auto&& entry) { return entry.mSheet; }));
+
+    // the most recently used of the entries that weren't used this time are kept as spares.
+    auto spares = std::views::iota(0UL, cache.mEntries.size()) | std::views::filter([&used](auto whichEntry) { return !used.at(whichEntry); });
+    for (auto whichEntry : spares | std::views::take(kMaxSpareEntries)) {
+        entries.push_back(std::move(cache.mEntries.at(whichEntry)));
+    }
+    cache.mEntries = std::move(entries);
+
+    return Animate::Sheets{ std::move(result), ShowSheetToAnimationSheet(show) };
 }
+}
+
+namespace {
 
 template <std::ranges::input_range Range, typename Function>
     requires(std::is_convertible_v<std::ranges::range_value_t<Range>, CalChart::Animate::Info>)
-auto GeneratePointDrawCommand(Range&& range, Function predicate, CalChart::BrushAndPen brushAndPen) -> CalChart::Draw::DrawCommand
+void AddPointDrawCommands(CalChart::Draw::DisplayList& result, Range&& range, Function predicate, CalChart::BrushAndPen brushAndPen)
 {
     auto filteredRange = range | std::views::filter(predicate);
-    if (!filteredRange.empty()) {
-        return CalChart::Draw::withBrushAndPen(brushAndPen, GeneratePointDrawCommand(filteredRange));
+    if (filteredRange.empty()) {
+        return;
     }
-    return CalChart::Draw::Ignore{};
+    auto size = CalChart::Coord{ CalChart::Int2CoordUnits(1), CalChart::Int2CoordUnits(1) };
+    result.Push(brushAndPen);
+    for (auto&& info : filteredRange) {
+        result.Add(CalChart::Draw::Rectangle{ info.mMarcherInfo.mPosition - size / 2, size });
+    }
+    result.Pop();
 }
 
 template <std::ranges::input_range Range>
@@ -146,8 +315,13 @@ auto SortForSprites(Range input)
 }
 
 namespace CalChart {
-Animation::Animation(const Show& show)
-    : mSheets{ Animate::AnimateShow(show) }
+Animation::Animation(const Show& show, unsigned numberThreads)
+    : mSheets{ Animate::AnimateShow(show, numberThreads) }
+{
+}
+
+Animation::Animation(const Show& show, Animate::CompileCache& cache, unsigned numberThreads)
+    : mSheets{ Animate::AnimateShow(show, cache, numberThreads) }
 {
 }
 
@@ -186,7 +360,7 @@ auto Animation::GetAnimateInfoWithDistanceFromPoint(Beats whichBeat, SelectionLi
     });
 }
 
-auto Animation::GenerateDotsDrawCommands(Beats whichBeat, SelectionList const& selectionList, bool drawCollisionWarning, CalChart::Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>
+void Animation::AddDotsDrawCommands(CalChart::Draw::DisplayList& result, Beats whichBeat, SelectionList const& selectionList, bool drawCollisionWarning, CalChart::Configuration const& config) const
 {
     auto allInfo = GetAllAnimateInfo(whichBeat);
     auto allSelected = allInfo
@@ -194,90 +368,66 @@ auto Animation::GenerateDotsDrawCommands(Beats whichBeat, SelectionList const& s
     auto allNotSelected = allInfo
         | std::views::filter([&selectionList](auto&& info) { return !selectionList.contains(info.mIndex); });
 
-    auto drawCmds = std::vector<CalChart::Draw::DrawCommand>{};
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allNotSelected, [](auto&& info) { return FacingBack(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_BACK)));
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allNotSelected, [](auto&& info) { return FacingFront(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_FRONT)));
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allNotSelected, [](auto&& info) { return FacingSide(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_SIDE)));
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allSelected, [](auto&& info) { return FacingBack(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_BACK)));
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allSelected, [](auto&& info) { return FacingFront(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_FRONT)));
-    CalChart::append(drawCmds,
-        GeneratePointDrawCommand(
-            allSelected, [](auto&& info) { return FacingSide(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_SIDE)));
+    AddPointDrawCommands(
+        result, allNotSelected, [](auto&& info) { return FacingBack(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_BACK));
+    AddPointDrawCommands(
+        result, allNotSelected, [](auto&& info) { return FacingFront(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_FRONT));
+    AddPointDrawCommands(
+        result, allNotSelected, [](auto&& info) { return FacingSide(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_SIDE));
+    AddPointDrawCommands(
+        result, allSelected, [](auto&& info) { return FacingBack(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_BACK));
+    AddPointDrawCommands(
+        result, allSelected, [](auto&& info) { return FacingFront(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_FRONT));
+    AddPointDrawCommands(
+        result, allSelected, [](auto&& info) { return FacingSide(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_HILIT_SIDE));
 
     if (drawCollisionWarning) {
-        CalChart::append(drawCmds,
-            GeneratePointDrawCommand(
-                allInfo, [](auto&& info) { return CollisionWarning(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_COLLISION_WARNING)));
-        CalChart::append(drawCmds,
-            GeneratePointDrawCommand(
-                allInfo, [](auto&& info) { return CollisionIntersect(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_COLLISION)));
+        AddPointDrawCommands(
+            result, allInfo, [](auto&& info) { return CollisionWarning(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_COLLISION_WARNING));
+        AddPointDrawCommands(
+            result, allInfo, [](auto&& info) { return CollisionIntersect(info); }, config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_COLLISION));
     }
-    return drawCmds;
 }
 
-auto Animation::GenerateSpritesDrawCommands(Beats whichBeat, SelectionList const& selectionList, AngleStepToImageFunction imageFunction, std::optional<bool> onBeat, Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>
+void Animation::AddSpritesDrawCommands(CalChart::Draw::DisplayList& result, Beats whichBeat, SelectionList const& selectionList, AngleStepToImageFunction const& imageFunction, std::optional<bool> onBeat, Configuration const& config) const
 {
     constexpr auto comp_X = 0.5;
     auto comp_Y = config.Get_SpriteBitmapOffsetY();
 
-    auto drawCmds = CalChart::Ranges::ToVector<CalChart::Draw::DrawCommand>(
-        SortForSprites(GetAllAnimateInfo(whichBeat)) | std::views::transform([comp_Y, &selectionList, onBeat, imageFunction](auto&& info) {
-            auto image_offset = [&]() -> ImageBeat {
-                if (info.mMarcherInfo.mStepStyle == CalChart::MarchingStyle::Close) {
-                    return ImageBeat::Standing;
-                }
-                if (!onBeat.has_value()) {
-                    return ImageBeat::Standing;
-                }
-                return *onBeat ? ImageBeat::Left : ImageBeat::Right;
-            }();
-            auto [image, size] = imageFunction(info.mMarcherInfo.mFacingDirection, image_offset, selectionList.contains(info.mIndex));
-            auto position = info.mMarcherInfo.mPosition;
-            auto offset = CalChart::Coord{ static_cast<int>(size.x * comp_X), static_cast<int>(size.y * comp_Y) };
-
-            return CalChart::Draw::Image{ position, image } - offset;
-        }));
-    return drawCmds;
+    for (auto&& info : SortForSprites(CalChart::Ranges::ToVector<Animate::Info>(GetAllAnimateInfo(whichBeat)))) {
+        auto image_offset = [&]() -> ImageBeat {
+            if (info.mMarcherInfo.mStepStyle == CalChart::MarchingStyle::Close) {
+                return ImageBeat::Standing;
+            }
+            if (!onBeat.has_value()) {
+                return ImageBeat::Standing;
+            }
+            return *onBeat ? ImageBeat::Left : ImageBeat::Right;
+        }();
+        auto [image, size] = imageFunction(info.mMarcherInfo.mFacingDirection, image_offset, selectionList.contains(info.mIndex));
+        auto position = info.mMarcherInfo.mPosition;
+        auto offset = CalChart::Coord{ static_cast<int>(size.x * comp_X), static_cast<int>(size.y * comp_Y) };
+
+        result.Add(CalChart::Draw::Image{ position - offset, image });
+    }
 }
 
-auto Animation::GenerateDrawCommands(
+void Animation::GenerateDrawCommands(
+    CalChart::Draw::DisplayList& result,
     Beats whichBeat,
     SelectionList const& selectionList,
     ShowMode const& showMode,
     Configuration const& config,
     bool drawCollisionWarning,
     std::optional<bool> onBeat,
-    AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>
+    AngleStepToImageFunction const& imageFunction) const
 {
-    auto drawCmds = CalChart::CreateModeDrawCommandsWithBorderOffset(config, showMode, CalChart::HowToDraw::Animation);
-    auto useSprites = config.Get_UseSprites();
-    if (useSprites) {
-        CalChart::append(drawCmds,
-            GenerateSpritesDrawCommands(
-                whichBeat,
-                selectionList,
-                imageFunction,
-                onBeat,
-                config));
+    result.Add(CalChart::CreateModeDrawCommandsWithBorderOffset(config, showMode, CalChart::HowToDraw::Animation));
+    if (config.Get_UseSprites()) {
+        AddSpritesDrawCommands(result, whichBeat, selectionList, imageFunction, onBeat, config);
     } else {
-        CalChart::append(drawCmds,
-            GenerateDotsDrawCommands(
-                whichBeat,
-                selectionList,
-                drawCollisionWarning,
-                config));
+        AddDotsDrawCommands(result, whichBeat, selectionList, drawCollisionWarning, config);
     }
-    return drawCmds + showMode.Offset();
 }
 
 }
@@ -29,6 +29,7 @@
 #include "CalChartDrawCommand.h"
 
 #include <map>
+#include <span>
 #include <vector>
 
 namespace CalChart {
@@ -36,6 +37,9 @@ namespace CalChart {
 class Configuration;
 class Show;
 class ShowMode;
+namespace Draw {
+    class DisplayList;
+}
 
 namespace Animate {
     inline auto FacingBack(Info const& info)
@@ -69,14 +73,47 @@ namespace Animate {
         return info.mCollision == CalChart::Coord::CollisionType::intersect;
     }
 
+    // Compiling a sheet only depends on that sheet's marchers and continuities, where the marchers need to be
+    // on the next sheet, and the variable state handed over from the previous sheet.  The CompileCache remembers
+    // those inputs for every animation sheet along with the compiled result, so after an edit only the sheets
+    // whose inputs changed (and any following sheets whose incoming variables changed) are recompiled.
+    // Besides the entries for the last show it keeps a few spares, so an undo finds the sheets it puts back.
+    class CompileCache {
+    public:
+        CompileCache();
+        ~CompileCache();
+        CompileCache(CompileCache const&) = delete;
+        auto operator=(CompileCache const&) -> CompileCache& = delete;
+        CompileCache(CompileCache&&) noexcept;
+        auto operator=(CompileCache&&) noexcept -> CompileCache&;
+
+        // number of sheets that needed to be compiled (rather than reused) on the last AnimateShow.
+        [[nodiscard]] auto GetNumberSheetsCompiled() const { return mNumberSheetsCompiled; }
+        void Clear();
+
+    private:
+        friend auto AnimateShow(Show const& show, CompileCache& cache, unsigned numberThreads) -> Sheets;
+        struct Entry;
+        std::vector<Entry> mEntries;
+        size_t mNumberSheetsCompiled{};
+    };
+
+    // Marchers compile independently of each other (their variables are kept per marcher), so each sheet's
+    // marchers can be split across numberThreads threads.  Sheets are still compiled in order so variables
+    // carry over from one sheet to the next.  0 means use all available cores.
+    auto AnimateShow(Show const& show, unsigned numberThreads = 1) -> Sheets;
+    auto AnimateShow(Show const& show, CompileCache& cache, unsigned numberThreads = 1) -> Sheets;
 }
 
 class Animation {
 public:
-    explicit Animation(const Show& show);
+    explicit Animation(const Show& show, unsigned numberThreads = 1);
+    // reuses (and updates) the compiled sheets in cache, recompiling only what changed.
+    Animation(const Show& show, Animate::CompileCache& cache, unsigned numberThreads = 1);
 
     [[nodiscard]] auto GetAnimateInfo(MarcherIndex whichMarcher, Beats whichBeat) const -> Animate::Info { return mSheets.AnimateInfoAtBeat(whichMarcher, whichBeat); }
-    [[nodiscard]] auto GetAllAnimateInfo(Beats whichBeat) const -> std::vector<Animate::Info> { return mSheets.AllAnimateInfoAtBeat(whichBeat); }
+    // Does not allocate; the view is valid as long as this Animation is.
+    [[nodiscard]] auto GetAllAnimateInfo(Beats whichBeat) const { return mSheets.AllAnimateInfoAtBeat(whichBeat); }
     [[nodiscard]] auto GetAllAnimateInfo(Beats whichBeat, SelectionList const& selectionList) const -> std::vector<Animate::Info>;
 
     [[nodiscard]] auto GetAnimateInfoWithDistanceFromPoint(Beats whichBeat, CalChart::Coord origin) const -> std::multimap<double, Animate::Info>;
@@ -121,18 +158,21 @@ public:
     using AngleStepToImageFunction = std::function<std::tuple<std::shared_ptr<Draw::OpaqueImageData>, CalChart::Coord>(Radian, ImageBeat, bool)>;
 
     // Drawing commands
-    [[nodiscard]] auto GenerateDotsDrawCommands(Beats whichBeat, SelectionList const& selectionList, bool drawCollisionWarning, Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>;
-    [[nodiscard]] auto GenerateSpritesDrawCommands(Beats whichBeat, SelectionList const& selectionList, AngleStepToImageFunction imageFunction, std::optional<bool> onBeat, Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>;
-    [[nodiscard]] auto GenerateDrawCommands(
+    // the animation at whichBeat, not moved to showMode.Offset(); that's left for when result is drawn.
+    void GenerateDrawCommands(
+        Draw::DisplayList& result,
         Beats whichBeat,
         SelectionList const& selectionList,
         ShowMode const& showMode,
         Configuration const& config,
         bool drawCollisionWarning,
         std::optional<bool> onBeat,
-        AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>;
+        AngleStepToImageFunction const& imageFunction) const;
 
 private:
+    void AddDotsDrawCommands(Draw::DisplayList& result, Beats whichBeat, SelectionList const& selectionList, bool drawCollisionWarning, Configuration const& config) const;
+    void AddSpritesDrawCommands(Draw::DisplayList& result, Beats whichBeat, SelectionList const& selectionList, AngleStepToImageFunction const& imageFunction, std::optional<bool> onBeat, Configuration const& config) const;
+
     // There are two types of data, the ones that are set when we are created, and the ones that modify over time.
     Animate::Sheets mSheets;
 };
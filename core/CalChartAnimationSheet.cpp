@@ -62,38 +62,55 @@ Sheet::Sheet(std::string name, unsigned numBeats, std::vector<CompileResult> con
         });
     }(commands) }
 {
-    mCollisions = FindAllCollisions();
+    mMarcherInfos.reserve(mNumBeats * mCommands.size());
+    for (auto beat : std::views::iota(0U, mNumBeats)) {
+        for (auto whichMarcher : std::views::iota(0U, mCommands.size())) {
+            mMarcherInfos.push_back(mCommands.at(whichMarcher).MarcherInfoAtBeat(beat));
+        }
+    }
+    mCollisions.assign(mMarcherInfos.size(), Coord::CollisionType::none);
+    MarkAllCollisions();
 }
 
 auto Sheet::MarcherInfoAtBeat(MarcherIndex whichMarcher, Beats beat) const -> MarcherInfo
 {
+    if (whichMarcher < mCommands.size() && beat < mNumBeats) {
+        return mMarcherInfos[beat * mCommands.size() + whichMarcher];
+    }
     return mCommands.at(whichMarcher).MarcherInfoAtBeat(beat);
 }
 
 auto Sheet::CollisionAtBeat(MarcherIndex whichMarcher, Beats beat) const -> CalChart::Coord::CollisionType
 {
-    if (auto where = mCollisions.find({ whichMarcher, beat }); where != mCollisions.end()) {
-        return where->second;
+    if (whichMarcher < mCommands.size() && beat < mNumBeats) {
+        return mCollisions[beat * mCommands.size() + whichMarcher];
     }
     return Coord::CollisionType::none;
 }
 
 auto Sheet::GetAllBeatsWithCollisions() const -> std::set<Beats>
 {
-    return std::accumulate(mCollisions.begin(), mCollisions.end(), std::set<Beats>{}, [](auto acc, auto item) {
-        acc.insert(std::get<1>(std::get<0>(item)));
-        return acc;
-    });
+    auto result = std::set<Beats>{};
+    for (auto beat : std::views::iota(0U, mNumBeats)) {
+        if (HasCollisionAtBeat(beat)) {
+            result.insert(beat);
+        }
+    }
+    return result;
 }
 
 auto Sheet::GetAllMarchersWithCollisionAtBeat(Beats beat) const -> CalChart::SelectionList
 {
-    return std::accumulate(mCollisions.begin(), mCollisions.end(), CalChart::SelectionList{}, [beat](auto acc, auto item) {
-        if (std::get<1>(std::get<0>(item)) == beat) {
-            acc.insert(std::get<0>(std::get<0>(item)));
+    if (!HasCollisionAtBeat(beat)) {
+        return {};
+    }
+    auto result = CalChart::SelectionList{};
+    for (auto&& info : AllAnimateInfoAtBeat(beat)) {
+        if (info.mCollision != Coord::CollisionType::none) {
+            result.insert(info.mIndex);
         }
-        return acc;
-    });
+    }
+    return result;
 }
 
 auto Sheet::toOnlineViewerJSON() const -> std::vector<std::vector<nlohmann::json>>
@@ -105,42 +122,107 @@ auto Sheet::toOnlineViewerJSON() const -> std::vector<std::vector<nlohmann::json
 }
 
 namespace {
+    void RecordCollision(std::map<MarcherIndex, Coord::CollisionType>& results, MarcherIndex which, Coord::CollisionType collision)
+    {
+        if (auto where = results.find(which); where == results.end() || where->second < collision) {
+            results[which] = collision;
+        }
+    }
 
-    template <std::ranges::input_range Range>
-        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, CalChart::Coord>)
-    auto FindAllCollisions(Range range) -> std::map<MarcherIndex, Coord::CollisionType>
+    void DetectCollision(std::vector<Coord> const& points, MarcherIndex i, MarcherIndex j, std::map<MarcherIndex, Coord::CollisionType>& results)
+    {
+        auto collisionResult = points.at(i).DetectCollision(points.at(j));
+        if (collisionResult != Coord::CollisionType::none) {
+            RecordCollision(results, i, collisionResult);
+            RecordCollision(results, j, collisionResult);
+        }
+    }
+
+    auto FindAllCollisionsBruteForce(std::vector<Coord> const& points) -> std::map<MarcherIndex, Coord::CollisionType>
     {
-        auto points = CalChart::Ranges::ToVector<CalChart::Coord>(range);
         auto results = std::map<MarcherIndex, Coord::CollisionType>{};
-        for (auto i : std::views::iota(0UL, points.size() - 1)) {
+        for (auto i : std::views::iota(0UL, points.size())) {
             for (auto j : std::views::iota(i + 1, points.size())) {
-                auto collisionResult = points.at(i).DetectCollision(points.at(j));
-                if (collisionResult != Coord::CollisionType::none) {
-                    if (!results.contains(i) || results[i] < collisionResult) {
-                        results[i] = collisionResult;
-                    }
-                    if (!results.contains(j) || results[j] < collisionResult) {
-                        results[j] = collisionResult;
+                DetectCollision(points, i, j, results);
+            }
+        }
+        return results;
+    }
+
+    // floor division, so cells don't double up around the origin.
+    constexpr auto CollisionCell(Coord::units value)
+    {
+        constexpr auto kCellSize = Int2CoordUnits(1);
+        return (value >= 0) ? (value / kCellSize) : -((-value + kCellSize - 1) / kCellSize);
+    }
+
+    auto FindAllCollisionsSpatialHash(std::vector<Coord> const& points) -> std::map<MarcherIndex, Coord::CollisionType>
+    {
+        // sort the marchers by their cell, so each cell's marchers are next to each other and can be found with a binary search.
+        using CellAndMarcher = std::tuple<Coord::units, Coord::units, MarcherIndex>;
+        auto cells = std::vector<CellAndMarcher>{};
+        cells.reserve(points.size());
+        for (auto i : std::views::iota(0UL, points.size())) {
+            cells.emplace_back(CollisionCell(points[i].x), CollisionCell(points[i].y), i);
+        }
+        std::ranges::sort(cells);
+
+        auto marchersInCell = [&cells](Coord::units cellX, Coord::units cellY) {
+            auto lower = std::ranges::lower_bound(cells, CellAndMarcher{ cellX, cellY, 0 });
+            auto upper = std::ranges::lower_bound(lower, cells.end(), CellAndMarcher{ cellX, cellY + 1, 0 });
+            return std::ranges::subrange(lower, upper);
+        };
+
+        auto results = std::map<MarcherIndex, Coord::CollisionType>{};
+        for (auto begin = cells.begin(); begin != cells.end();) {
+            auto cellX = std::get<0>(*begin);
+            auto cellY = std::get<1>(*begin);
+            auto end = std::find_if(begin, cells.end(), [cellX, cellY](auto&& cell) {
+                return std::get<0>(cell) != cellX || std::get<1>(cell) != cellY;
+            });
+            auto thisCell = std::ranges::subrange(begin, end);
+            for (auto i = thisCell.begin(); i != thisCell.end(); ++i) {
+                for (auto j = std::next(i); j != thisCell.end(); ++j) {
+                    DetectCollision(points, std::get<2>(*i), std::get<2>(*j), results);
+                }
+            }
+            // Only look at the neighboring cells that sort after this one; the ones before have already looked at us.
+            for (auto [neighborX, neighborY] : { std::pair{ cellX, cellY + 1 }, std::pair{ cellX + 1, cellY - 1 }, std::pair{ cellX + 1, cellY }, std::pair{ cellX + 1, cellY + 1 } }) {
+                for (auto&& neighbor : marchersInCell(neighborX, neighborY)) {
+                    for (auto&& marcher : thisCell) {
+                        DetectCollision(points, std::get<2>(marcher), std::get<2>(neighbor), results);
                     }
                 }
             }
+            begin = end;
         }
         return results;
     }
 }
 
-auto Sheet::FindAllCollisions() const -> std::map<std::tuple<MarcherIndex, Beats>, Coord::CollisionType>
+auto FindAllCollisions(std::vector<Coord> const& positions, CollisionDetection method) -> std::map<MarcherIndex, Coord::CollisionType>
 {
-    auto results = std::map<std::tuple<MarcherIndex, Beats>, Coord::CollisionType>{};
-    for (auto beat : std::views::iota(0U, GetNumBeats())) {
-        auto allCollisions = Animate::FindAllCollisions(AllMarcherInfoAtBeat(beat) | std::views::transform([](auto info) { return info.mPosition; }));
-        results = std::accumulate(allCollisions.begin(), allCollisions.end(), results, [beat](auto acc, auto item) {
-            auto [where, collision] = item;
-            acc[{ where, beat }] = collision;
-            return acc;
-        });
+    switch (method) {
+    case CollisionDetection::BruteForce:
+        return FindAllCollisionsBruteForce(positions);
+    case CollisionDetection::SpatialHash:
+        return FindAllCollisionsSpatialHash(positions);
+    }
+    return {};
+}
+
+void Sheet::MarkAllCollisions()
+{
+    mBeatHasCollision.assign(mNumBeats, false);
+    for (auto beat : std::views::iota(0U, mNumBeats)) {
+        auto marcherInfos = std::span{ mMarcherInfos }.subspan(FirstInfoAtBeat(beat), mCommands.size());
+        auto allCollisions = Animate::FindAllCollisions(CalChart::Ranges::ToVector<CalChart::Coord>(marcherInfos | std::views::transform([](auto&& info) { return info.mPosition; })));
+        for (auto&& [whichMarcher, collision] : allCollisions) {
+            mCollisions.at(beat * mCommands.size() + whichMarcher) = collision;
+            mMarchersWithCollisions.insert(whichMarcher);
+        }
+        mBeatHasCollision.at(beat) = !allCollisions.empty();
     }
-    return results;
 }
 
 auto Sheet::DebugAnimateInfoAtBeat(Beats beat, bool ignoreCollision) const -> std::vector<std::string>
@@ -160,42 +242,24 @@ auto Sheet::DebugAnimateInfoAtBeat(Beats beat, bool ignoreCollision) const -> st
         }));
 }
 
-namespace {
-    // Because we need to draw sprites and other animations without overlap, sort them so the "closer" ones are first
-    template <std::ranges::input_range Range>
-        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, Info>)
-    auto SortForSprites(Range input)
-    {
-        std::ranges::sort(input, [](auto&& a, auto&& b) {
-            return a.mMarcherInfo.mPosition < b.mMarcherInfo.mPosition;
-        });
-        return input;
-    }
-
-}
-
-auto Sheet::AllAnimateInfoAtBeat(Beats beat) const -> std::vector<Info>
+auto Sheet::FirstInfoAtBeat(Beats beat) const -> size_t
 {
-    auto animates = CalChart::Ranges::ToVector<Info>(std::views::iota(0U, mCommands.size()) | std::views::transform([this, beat](auto whichMarcher) -> Info {
-        return {
-            whichMarcher,
-            CollisionAtBeat(whichMarcher, beat),
-            MarcherInfoAtBeat(whichMarcher, beat)
-        };
-    }));
-    return animates;
+    if (beat >= mNumBeats) {
+        throw std::out_of_range(std::format("beat {} is past the end of sheet {}", beat, mName));
+    }
+    return beat * mCommands.size();
 }
 
 namespace {
     template <std::ranges::input_range Range>
-        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, Sheet>)
+        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, std::shared_ptr<Sheet const>>)
     auto GetBeatsPerSheet(Range&& range)
     {
-        return range | std::views::transform([](auto sheet) { return sheet.GetNumBeats(); });
+        return range | std::views::transform([](auto&& sheet) { return sheet->GetNumBeats(); });
     }
 
     template <std::ranges::input_range Range>
-        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, Sheet>)
+        requires(std::is_convertible_v<std::ranges::range_value_t<Range>, std::shared_ptr<Sheet const>>)
     auto GetRunningBeats(Range&& range)
     {
         auto allBeats = CalChart::Ranges::ToVector<Beats>(GetBeatsPerSheet(range));
@@ -205,10 +269,15 @@ namespace {
     }
 }
 
-Sheets::Sheets(std::vector<Sheet> const& sheets, std::vector<unsigned> const& showSheetToAnimationSheet)
-    : mSheets(sheets)
-    , mRunningBeatCount{ GetRunningBeats(sheets) }
-    , mShowSheetToAnimationSheet{ showSheetToAnimationSheet }
+Sheets::Sheets(std::vector<Sheet> sheets, std::vector<unsigned> showSheetToAnimationSheet)
+    : Sheets(CalChart::Ranges::ToVector<std::shared_ptr<Sheet const>>(sheets | std::views::transform([](auto&& sheet) { return std::make_shared<Sheet const>(std::move(sheet)); })), std::move(showSheetToAnimationSheet))
+{
+}
+
+Sheets::Sheets(std::vector<std::shared_ptr<Sheet const>> sheets, std::vector<unsigned> showSheetToAnimationSheet)
+    : mSheets(std::move(sheets))
+    , mRunningBeatCount{ GetRunningBeats(mSheets) }
+    , mShowSheetToAnimationSheet{ std::move(showSheetToAnimationSheet) }
 {
 }
 
@@ -222,12 +291,13 @@ auto Sheets::TotalBeats() const -> Beats
 
 auto Sheets::BeatToSheetOffsetAndBeat(Beats beat) const -> std::tuple<size_t, Beats>
 {
-    auto where = std::ranges::find_if(mRunningBeatCount, [beat](auto thisBeat) { return beat < thisBeat; });
+    // the first sheet that ends after this beat.
+    auto where = std::ranges::upper_bound(mRunningBeatCount, beat);
     if (where == mRunningBeatCount.end()) {
         return { mRunningBeatCount.size(), beat - TotalBeats() };
     }
     auto index = std::distance(mRunningBeatCount.begin(), where);
-    return { index, beat - (*where - mSheets.at(index).GetNumBeats()) };
+    return { index, beat - (*where - mSheets.at(index)->GetNumBeats()) };
 }
 
 auto Sheets::MarcherInfoAtBeat(MarcherIndex whichMarcher, Beats beat) const -> MarcherInfo
@@ -236,7 +306,7 @@ auto Sheets::MarcherInfoAtBeat(MarcherIndex whichMarcher, Beats beat) const -> M
     if (which >= mSheets.size()) {
         return {};
     }
-    return mSheets.at(which).MarcherInfoAtBeat(whichMarcher, newBeat);
+    return mSheets.at(which)->MarcherInfoAtBeat(whichMarcher, newBeat);
 }
 
 auto Sheets::CollisionAtBeat(MarcherIndex whichMarcher, Beats beat) const -> Coord::CollisionType
@@ -249,7 +319,7 @@ auto Sheets::CollisionAtBeat(MarcherIndex whichMarcher, Beats beat) const -> Coo
     if (which >= mSheets.size()) {
         return {};
     }
-    return mSheets.at(which).CollisionAtBeat(whichMarcher, newBeat);
+    return mSheets.at(which)->CollisionAtBeat(whichMarcher, newBeat);
 }
 
 auto Sheets::BeatHasCollision(Beats beat) const -> bool
@@ -258,7 +328,7 @@ auto Sheets::BeatHasCollision(Beats beat) const -> bool
     if (which >= mSheets.size()) {
         return false;
     }
-    return mSheets.at(which).GetAllBeatsWithCollisions().contains(beat);
+    return mSheets.at(which)->HasCollisionAtBeat(newBeat);
 }
 
 auto Sheets::DebugAnimateInfoAtBeat(Beats beat) const -> std::pair<std::string, std::vector<std::string>>
@@ -267,21 +337,15 @@ auto Sheets::DebugAnimateInfoAtBeat(Beats beat) const -> std::pair<std::string,
     std::ostringstream output;
     output << GetSheetName(whichSheet) << " (" << whichSheet << " of " << mSheets.size() << ")\n";
     output << "beat " << newBeat << " of " << BeatsForSheet(whichSheet) << "\n";
-    auto each = mSheets.at(whichSheet).DebugAnimateInfoAtBeat(newBeat, beat == 0);
+    auto each = mSheets.at(whichSheet)->DebugAnimateInfoAtBeat(newBeat, beat == 0);
     return { output.str(), each };
 }
 
-auto Sheets::AllAnimateInfoAtBeat(Beats whichBeat) const -> std::vector<Info>
-{
-    auto [whichSheet, newBeat] = BeatToSheetOffsetAndBeat(whichBeat);
-    return mSheets.at(whichSheet).AllAnimateInfoAtBeat(newBeat);
-}
-
 auto Sheets::toOnlineViewerJSON() const -> std::vector<std::vector<std::vector<nlohmann::json>>>
 {
     return CalChart::Ranges::ToVector<std::vector<std::vector<nlohmann::json>>>(
         mSheets | std::views::transform([](auto&& sheet) {
-            return sheet.toOnlineViewerJSON();
+            return sheet->toOnlineViewerJSON();
         }));
 }
 
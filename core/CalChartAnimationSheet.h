@@ -28,9 +28,12 @@
 #include "CalChartPoint.h"
 #include "CalChartRanges.h"
 
+#include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <ranges>
 #include <set>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -38,6 +41,16 @@ namespace CalChart::Animate {
 
 using CompileResult = std::pair<std::vector<Command>, ErrorsEncountered>;
 
+// Collision detection for a group of marchers at a single beat.  Gives the worst collision each marcher is part of.
+// BruteForce checks every pair of marchers.  SpatialHash drops each marcher into a grid of one step cells and only
+// checks marchers in neighboring cells, as DetectCollision is never true for marchers further than a step apart.
+enum class CollisionDetection {
+    BruteForce,
+    SpatialHash,
+};
+
+[[nodiscard]] auto FindAllCollisions(std::vector<Coord> const& positions, CollisionDetection method = CollisionDetection::SpatialHash) -> std::map<MarcherIndex, Coord::CollisionType>;
+
 struct Info {
     MarcherIndex mIndex;
     CalChart::Coord::CollisionType mCollision = CalChart::Coord::CollisionType::none;
@@ -48,6 +61,8 @@ struct Info {
 // The Commands are the positions, directions, and style of each marcher at their beats.
 // Because a Sheet sees all the points and where they are, the sheet can calculate all the
 // collisions that exist.
+// The Info for every marcher on every beat is worked out once when the sheet is made, so looking up a beat
+// (which happens every frame when playing or scrubbing the animation) is an index rather than a recalculation.
 class Sheet {
 public:
     Sheet(std::string name, Beats numBeats, std::vector<CompileResult> const& commands);
@@ -64,15 +79,10 @@ public:
         });
     }
 
+    [[nodiscard]] auto HasCollisionAtBeat(Beats beat) const -> bool { return beat < mBeatHasCollision.size() && mBeatHasCollision[beat]; }
     [[nodiscard]] auto GetAllBeatsWithCollisions() const -> std::set<Beats>;
     [[nodiscard]] auto GetAllMarchersWithCollisionAtBeat(Beats beat) const -> CalChart::SelectionList;
-    [[nodiscard]] auto GetAllMarchersWithCollisions() const -> CalChart::SelectionList
-    {
-        return std::accumulate(mCollisions.begin(), mCollisions.end(), CalChart::SelectionList{}, [](auto acc, auto item) {
-            acc.insert(std::get<0>(std::get<0>(item)));
-            return acc;
-        });
-    }
+    [[nodiscard]] auto GetAllMarchersWithCollisions() const -> CalChart::SelectionList const& { return mMarchersWithCollisions; }
     [[nodiscard]] auto CollisionAtBeat(MarcherIndex whichMarcher, Beats beat) const -> Coord::CollisionType;
     [[nodiscard]] auto GeneratePathToDraw(MarcherIndex whichMarcher, Coord::units endRadius) const -> std::vector<Draw::DrawCommand>
     {
@@ -87,7 +97,14 @@ public:
     [[nodiscard]] auto toOnlineViewerJSON() const -> std::vector<std::vector<nlohmann::json>>;
     [[nodiscard]] auto DebugAnimateInfoAtBeat(Beats beat, bool ignoreCollision) const -> std::vector<std::string>;
 
-    [[nodiscard]] auto AllAnimateInfoAtBeat(Beats beat) const -> std::vector<Info>;
+    // The view is valid as long as this Sheet is.
+    [[nodiscard]] auto AllAnimateInfoAtBeat(Beats beat) const
+    {
+        auto const first = FirstInfoAtBeat(beat);
+        return std::views::iota(0UL, mCommands.size()) | std::views::transform([this, first](auto whichMarcher) {
+            return Info{ static_cast<MarcherIndex>(whichMarcher), mCollisions[first + whichMarcher], mMarcherInfos[first + whichMarcher] };
+        });
+    }
 
     [[nodiscard]] auto GetAnimationErrors() const
     {
@@ -95,17 +112,25 @@ public:
     }
 
 private:
-    [[nodiscard]] auto FindAllCollisions() const -> std::map<std::tuple<MarcherIndex, Beats>, Coord::CollisionType>;
+    [[nodiscard]] auto FirstInfoAtBeat(Beats beat) const -> size_t;
+    void MarkAllCollisions();
     std::string mName;
     Beats mNumBeats;
     std::vector<Commands> mCommands;
-    std::map<std::tuple<MarcherIndex, Beats>, Coord::CollisionType> mCollisions;
+    // each beat's MarcherInfo and collision for all the marchers, one beat after another.  They are kept apart
+    // so going through the positions, as collision detection does, doesn't step over the collisions.
+    std::vector<MarcherInfo> mMarcherInfos;
+    std::vector<Coord::CollisionType> mCollisions;
+    std::vector<bool> mBeatHasCollision;
+    CalChart::SelectionList mMarchersWithCollisions;
     Errors mErrors;
 };
 
 class Sheets {
 public:
-    explicit Sheets(std::vector<Sheet> const& sheets, std::vector<unsigned> const& showSheetToAnimationSheet = {});
+    explicit Sheets(std::vector<Sheet> sheets, std::vector<unsigned> showSheetToAnimationSheet = {});
+    // compiled sheets are immutable, so they can be shared with the compile cache instead of copied.
+    explicit Sheets(std::vector<std::shared_ptr<Sheet const>> sheets, std::vector<unsigned> showSheetToAnimationSheet = {});
     [[nodiscard]] auto TotalSheets() const -> size_t { return mSheets.size(); }
     [[nodiscard]] auto TotalBeats() const -> Beats;
     [[nodiscard]] auto BeatToSheetOffsetAndBeat(Beats beat) const -> std::tuple<size_t, Beats>;
@@ -116,7 +141,7 @@ public:
         }
         return mRunningBeatCount.at(whichSheet - 1);
     }
-    [[nodiscard]] auto BeatsForSheet(size_t whichSheet) const -> Beats { return mSheets.at(whichSheet).GetNumBeats(); }
+    [[nodiscard]] auto BeatsForSheet(size_t whichSheet) const -> Beats { return mSheets.at(whichSheet)->GetNumBeats(); }
     [[nodiscard]] auto MarcherInfoAtBeat(MarcherIndex whichMarcher, Beats beat) const -> MarcherInfo;
     [[nodiscard]] auto CollisionAtBeat(MarcherIndex whichMarcher, Beats beat) const -> Coord::CollisionType;
     [[nodiscard]] auto AnimateInfoAtBeat(MarcherIndex whichMarcher, Beats beat) const -> Info
@@ -132,22 +157,27 @@ public:
     {
         return Ranges::ToVector<Errors>(
             mSheets | std::views::transform([](auto&& sheet) {
-                return sheet.GetAnimationErrors();
+                return sheet->GetAnimationErrors();
             }));
     }
 
-    [[nodiscard]] auto AllAnimateInfoAtBeat(Beats whichBeat) const -> std::vector<Info>;
+    // The view is valid as long as the sheet it comes from is.
+    [[nodiscard]] auto AllAnimateInfoAtBeat(Beats whichBeat) const
+    {
+        auto [whichSheet, newBeat] = BeatToSheetOffsetAndBeat(whichBeat);
+        return mSheets.at(whichSheet)->AllAnimateInfoAtBeat(newBeat);
+    }
 
     [[nodiscard]] auto DebugAnimateInfoAtBeat(Beats beat) const -> std::pair<std::string, std::vector<std::string>>;
 
     [[nodiscard]] auto BeatHasCollision(Beats whichBeat) const -> bool;
-    [[nodiscard]] auto GetSheetName(int whichSheet) const { return mSheets.at(whichSheet).GetName(); }
+    [[nodiscard]] auto GetSheetName(int whichSheet) const { return mSheets.at(whichSheet)->GetName(); }
     // Sheet -> selection of marchers who collided
     [[nodiscard]] auto SheetsToMarchersWhoCollided() const -> std::map<int, CalChart::SelectionList>
     {
         auto result = std::map<int, CalChart::SelectionList>{};
         for (auto whichSheet : std::views::iota(0UL, mSheets.size())) {
-            auto marchersWithCollisions = mSheets[whichSheet].GetAllMarchersWithCollisions();
+            auto const& marchersWithCollisions = mSheets[whichSheet]->GetAllMarchersWithCollisions();
             if (marchersWithCollisions.size()) {
                 result[whichSheet] = marchersWithCollisions;
             }
@@ -157,7 +187,7 @@ public:
 
     [[nodiscard]] auto GeneratePathToDraw(int whichSheet, MarcherIndex whichMarcher, Coord::units endRadius) const -> std::vector<Draw::DrawCommand>
     {
-        return mSheets.at(whichSheet).GeneratePathToDraw(whichMarcher, endRadius);
+        return mSheets.at(whichSheet)->GeneratePathToDraw(whichMarcher, endRadius);
     }
 
     [[nodiscard]] auto toOnlineViewerJSON() const -> std::vector<std::vector<std::vector<nlohmann::json>>>;
@@ -165,7 +195,7 @@ public:
     [[nodiscard]] auto ShowSheetToAnimSheetTranslate(unsigned sheet) const { return mShowSheetToAnimationSheet.at(sheet); }
 
 private:
-    std::vector<Sheet> mSheets;
+    std::vector<std::shared_ptr<Sheet const>> mSheets;
     std::vector<Beats> mRunningBeatCount;
     std::vector<unsigned> mShowSheetToAnimationSheet;
 };
@@ -0,0 +1,235 @@
+/*
+ * CalChartAssignment.cpp
+ * Matching each of n things to one of n others for the least total cost
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CalChartAssignment.h"
+#include <algorithm>
+
+namespace CalChart {
+
+AssignmentProblem::AssignmentProblem(size_t size)
+    : mSize(size)
+    , mCosts(size * size, kForbidden)
+{
+}
+
+// Follows "A Shortest Augmenting Path Algorithm for Dense and Sparse Linear Assignment Problems" (Jonker and
+// Volgenant, 1987): column reduction, reduction transfer and two rounds of augmenting row reduction give most rows a
+// column cheaply, and the rows left over are assigned by shortest augmenting paths.
+auto AssignmentProblem::Solve() const -> std::vector<unsigned>
+{
+    auto const dim = static_cast<int>(mSize);
+    if (dim == 0) {
+        return {};
+    }
+
+    // a forbidden pair costs more than every allowed pair together, so it is only used when it has to be.
+    auto mostAllowed = int64_t{};
+    for (auto cost : mCosts) {
+        if (cost != kForbidden) {
+            mostAllowed = std::max<int64_t>(mostAllowed, cost);
+        }
+    }
+    auto const forbidden = (mostAllowed + 1) * dim + 1;
+    auto costs = std::vector<int64_t>(mCosts.size());
+    std::ranges::transform(mCosts, costs.begin(), [forbidden](auto cost) { return cost == kForbidden ? forbidden : int64_t{ cost }; });
+    auto cost = [&costs, dim](int row, int column) { return costs[static_cast<size_t>(row * dim + column)]; };
+    auto const unreachable = std::numeric_limits<int64_t>::max() / 4;
+
+    auto rowsol = std::vector<int>(mSize, -1);
+    auto colsol = std::vector<int>(mSize, -1);
+    auto v = std::vector<int64_t>(mSize);
+    auto matches = std::vector<int>(mSize);
+    auto free = std::vector<int>(mSize);
+
+    // column reduction: each column goes to its cheapest row, if that row has nothing cheaper yet.
+    for (auto j = dim - 1; j >= 0; --j) {
+        auto imin = 0;
+        for (auto i = 1; i < dim; ++i) {
+            if (cost(i, j) < cost(imin, j)) {
+                imin = i;
+            }
+        }
+        v[j] = cost(imin, j);
+        if (++matches[imin] == 1) {
+            rowsol[imin] = j;
+            colsol[j] = imin;
+        } else if (v[j] < v[rowsol[imin]]) {
+            colsol[rowsol[imin]] = -1;
+            rowsol[imin] = j;
+            colsol[j] = imin;
+        } else {
+            colsol[j] = -1;
+        }
+    }
+
+    // reduction transfer: rows that got exactly one column lower its price by what they'd save over their next best.
+    auto numfree = 0;
+    for (auto i = 0; i < dim; ++i) {
+        if (matches[i] == 0) {
+            free[numfree++] = i;
+        } else if (matches[i] == 1) {
+            auto j1 = rowsol[i];
+            auto min = unreachable;
+            for (auto j = 0; j < dim; ++j) {
+                if (j != j1) {
+                    min = std::min(min, cost(i, j) - v[j]);
+                }
+            }
+            if (min != unreachable) {
+                v[j1] -= min;
+            }
+        }
+    }
+
+    // augmenting row reduction: free rows take their cheapest column, pushing out whoever had it.  Each price drop is
+    // only as big as the gap between a row's two best columns, so with a wide range of costs going straight again can
+    // take a very long time; after dim goes the rest wait for the next round, or for augmentation.
+    for (auto round = 0; round < 2; ++round) {
+        auto k = 0;
+        auto const previousNumfree = numfree;
+        auto retries = 0;
+        numfree = 0;
+        while (k < previousNumfree) {
+            auto const i = free[k++];
+            auto umin = cost(i, 0) - v[0];
+            auto usubmin = unreachable;
+            auto j1 = 0;
+            auto j2 = 0;
+            for (auto j = 1; j < dim; ++j) {
+                auto h = cost(i, j) - v[j];
+                if (h < usubmin) {
+                    if (h >= umin) {
+                        usubmin = h;
+                        j2 = j;
+                    } else {
+                        usubmin = umin;
+                        umin = h;
+                        j2 = j1;
+                        j1 = j;
+                    }
+                }
+            }
+            auto i0 = colsol[j1];
+            if (umin < usubmin) {
+                if (usubmin != unreachable) {
+                    v[j1] -= usubmin - umin;
+                }
+            } else if (i0 >= 0) {
+                j1 = j2;
+                i0 = colsol[j2];
+            }
+            rowsol[i] = j1;
+            colsol[j1] = i;
+            if (i0 >= 0) {
+                rowsol[i0] = -1;
+                if (umin < usubmin && retries++ < dim) {
+                    // the row that was pushed out goes again straight away.
+                    free[--k] = i0;
+                } else {
+                    free[numfree++] = i0;
+                }
+            }
+        }
+    }
+
+    // augmentation: each row still free finds the cheapest path to an unassigned column (Dijkstra, on the reduced costs).
+    auto d = std::vector<int64_t>(mSize);
+    auto pred = std::vector<int>(mSize);
+    auto collist = std::vector<int>(mSize);
+    for (auto f = 0; f < numfree; ++f) {
+        auto const freerow = free[f];
+        for (auto j = 0; j < dim; ++j) {
+            d[j] = cost(freerow, j) - v[j];
+            pred[j] = freerow;
+            collist[j] = j;
+        }
+        // collist[0, low) are scanned, [low, up) are at the current minimum distance, [up, dim) are still to do.
+        auto low = 0;
+        auto up = 0;
+        auto last = 0;
+        auto min = int64_t{};
+        auto endofpath = -1;
+        while (endofpath < 0) {
+            if (up == low) {
+                last = low - 1;
+                min = d[collist[up++]];
+                for (auto k = up; k < dim; ++k) {
+                    auto j = collist[k];
+                    auto h = d[j];
+                    if (h <= min) {
+                        if (h < min) {
+                            up = low;
+                            min = h;
+                        }
+                        collist[k] = collist[up];
+                        collist[up++] = j;
+                    }
+                }
+                for (auto k = low; k < up; ++k) {
+                    if (colsol[collist[k]] < 0) {
+                        endofpath = collist[k];
+                        break;
+                    }
+                }
+            }
+            if (endofpath < 0) {
+                auto const j1 = collist[low++];
+                auto const i = colsol[j1];
+                auto const h = cost(i, j1) - v[j1] - min;
+                for (auto k = up; k < dim; ++k) {
+                    auto j = collist[k];
+                    auto v2 = cost(i, j) - v[j] - h;
+                    if (v2 < d[j]) {
+                        pred[j] = i;
+                        if (v2 == min) {
+                            if (colsol[j] < 0) {
+                                endofpath = j;
+                                break;
+                            }
+                            collist[k] = collist[up];
+                            collist[up++] = j;
+                        }
+                        d[j] = v2;
+                    }
+                }
+            }
+        }
+
+        // the scanned columns get cheaper by how much closer they were than the path's end.
+        for (auto k = 0; k <= last; ++k) {
+            auto j1 = collist[k];
+            v[j1] += d[j1] - min;
+        }
+
+        // flip the assignments along the path.
+        auto i = 0;
+        do {
+            i = pred[endofpath];
+            colsol[endofpath] = i;
+            std::swap(endofpath, rowsol[i]);
+        } while (i != freerow);
+    }
+
+    return { rowsol.begin(), rowsol.end() };
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * CalChartAssignment.h
+ * Matching each of n things to one of n others for the least total cost
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * AssignmentProblem
+ *
+ * The square assignment problem: given the cost of giving each row each column, find the one to one assignment of
+ * rows to columns with the least total cost.  It is solved with the shortest augmenting path method of Jonker and
+ * Volgenant, on integer costs so ties are exact.
+ *
+ * A pair can be forbidden instead of given a cost.  Every row is always assigned, so when there is no way around
+ * them, forbidden pairs are used; as few of them as possible, and then the least cost for the rest.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace CalChart {
+
+class AssignmentProblem {
+public:
+    static constexpr auto kForbidden = std::numeric_limits<int32_t>::max();
+
+    // every pair starts forbidden.
+    explicit AssignmentProblem(size_t size);
+
+    [[nodiscard]] auto size() const { return mSize; }
+    [[nodiscard]] auto GetCost(size_t row, size_t column) const { return mCosts.at(row * mSize + column); }
+    // costs are from 0 up; kForbidden forbids the pair.
+    void SetCost(size_t row, size_t column, int32_t cost) { mCosts.at(row * mSize + column) = cost; }
+
+    // the column given to each row.
+    [[nodiscard]] auto Solve() const -> std::vector<unsigned>;
+
+private:
+    size_t mSize;
+    std::vector<int32_t> mCosts;
+};
+
+}
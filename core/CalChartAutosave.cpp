@@ -0,0 +1,129 @@
+/*
+ * CalChartAutosave.cpp
+ * Writes recovery copies of a show without holding up the editor
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CalChartAutosave.h"
+#include "CalChartShow.h"
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace CalChart {
+
+Autosaver::Autosaver(PerformanceRegistry& registry)
+    : mPerfRegistry(registry, this, "Autosave")
+    , mThread([this] { Run(); })
+{
+}
+
+Autosaver::~Autosaver()
+{
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mPending.reset();
+        mStopping = true;
+    }
+    mChanged.notify_all();
+    mThread.join();
+}
+
+void Autosaver::Save(std::shared_ptr<Show const> show, std::filesystem::path path, OnSaved onSaved)
+{
+    {
+        auto lock = std::lock_guard{ mMutex };
+        if (mPending) {
+            ++mCoalesced;
+        }
+        mPending = Request{ std::move(show), std::move(path), std::move(onSaved) };
+    }
+    mChanged.notify_all();
+}
+
+void Autosaver::Cancel()
+{
+    auto lock = std::unique_lock{ mMutex };
+    mPending.reset();
+    mChanged.wait(lock, [this] { return !mWriting; });
+}
+
+void Autosaver::Wait()
+{
+    auto lock = std::unique_lock{ mMutex };
+    mChanged.wait(lock, [this] { return !mPending && !mWriting; });
+}
+
+auto Autosaver::GetCoalescedCount() const -> size_t
+{
+    auto lock = std::lock_guard{ mMutex };
+    return mCoalesced;
+}
+
+void Autosaver::Run()
+{
+    auto lock = std::unique_lock{ mMutex };
+    while (true) {
+        mChanged.wait(lock, [this] { return mPending || mStopping; });
+        if (mStopping) {
+            return;
+        }
+        auto request = std::move(*mPending);
+        mPending.reset();
+        mWriting = true;
+        lock.unlock();
+
+        auto succeeded = [this, &request] {
+            auto measure = mPerfRegistry.doMeasure();
+            return Write(*request.show, request.path);
+        }();
+        if (request.onSaved) {
+            request.onSaved(request.path, succeeded);
+        }
+        // the snapshot goes here, off the UI thread, along with anything only it was holding on to.
+        request = {};
+
+        lock.lock();
+        mWriting = false;
+        mChanged.notify_all();
+    }
+}
+
+auto Autosaver::Write(Show const& show, std::filesystem::path const& path) -> bool
+{
+    auto temporary = path;
+    temporary += ".tmp";
+    try {
+        auto data = show.SerializeShow();
+        {
+            auto output = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+            if (!output.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size())) || !output.flush()) {
+                throw std::runtime_error("could not write " + temporary.string());
+            }
+        }
+        std::filesystem::rename(temporary, path);
+        return true;
+    } catch (std::exception const&) {
+        auto error = std::error_code{};
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+}
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+/*
+ * CalChartAutosave.h
+ * Writes recovery copies of a show without holding up the editor
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Autosaver
+ *
+ * Serializing a show with media and background images in it can take long enough to be noticed, so the
+ * Autosaver does it on its own thread.  The caller hands over a copy of the show, which is cheap because
+ * copies share their sheets and media, and keeps on editing.
+ *
+ * The file is written next to the destination and renamed over it once it is complete, so a crash part way
+ * through never leaves a broken recovery file behind.  If a save is asked for while another is still being
+ * written, only the newest one waiting is kept; the ones in between would be overwritten anyway.
+ *
+ * How long each save takes is recorded in the PerformanceRegistry under "Autosave".
+ */
+
+#include "CalChartPerformanceRegistry.h"
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace CalChart {
+
+class Show;
+
+class Autosaver {
+public:
+    // called on the autosave thread once a save is done, with whether the file was written.
+    using OnSaved = std::function<void(std::filesystem::path const& path, bool succeeded)>;
+
+    explicit Autosaver(PerformanceRegistry& registry = PerformanceRegistry::GetGlobalPerformanceRegistry());
+    // drops any save still waiting, and finishes the one being written.
+    ~Autosaver();
+
+    Autosaver(Autosaver const&) = delete;
+    Autosaver& operator=(Autosaver const&) = delete;
+
+    void Save(std::shared_ptr<Show const> show, std::filesystem::path path, OnSaved onSaved = {});
+
+    // Drops any save still waiting, and waits for the one being written.  Call before removing the file.
+    void Cancel();
+    // Waits until every save asked for has been written.
+    void Wait();
+
+    // how many saves were dropped because a newer one came along.
+    [[nodiscard]] auto GetCoalescedCount() const -> size_t;
+
+private:
+    struct Request {
+        std::shared_ptr<Show const> show;
+        std::filesystem::path path;
+        OnSaved onSaved;
+    };
+
+    void Run();
+    static auto Write(Show const& show, std::filesystem::path const& path) -> bool;
+
+    ScopedPerformanceRegistry mPerfRegistry;
+    mutable std::mutex mMutex;
+    std::condition_variable mChanged;
+    std::optional<Request> mPending;
+    bool mWriting = false;
+    bool mStopping = false;
+    size_t mCoalesced{};
+    std::thread mThread;
+};
+
+}
@@ -213,6 +213,7 @@ namespace {
     }
 
 IMPLEMENT_CONFIGURATION_FUNCTIONS(AutosaveInterval, long, 60);
+IMPLEMENT_CONFIGURATION_FUNCTIONS(UndoHistoryMemoryLimit, long, 64);
 
 IMPLEMENT_CONFIGURATION_FUNCTIONS(FieldFrameZoom_3_6_0, double, 1.0);
 IMPLEMENT_CONFIGURATION_FUNCTIONS(FieldCanvasScrollX, long, 0);
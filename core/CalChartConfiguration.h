@@ -133,6 +133,7 @@ private:                                           \
     mutable std::optional<Type> m##Key = {};
 
     DECLARE_CONFIGURATION_FUNCTIONS(AutosaveInterval, long);
+    DECLARE_CONFIGURATION_FUNCTIONS(UndoHistoryMemoryLimit, long); // in megabytes
 
     // page setup and zoom
     DECLARE_CONFIGURATION_FUNCTIONS(FieldFrameZoom_3_6_0, double);
@@ -28,12 +28,6 @@
 #include <cassert>
 #include <sstream>
 
-// These are the "magic" global variables that are in contgram and contscan.
-// The are the data objects used by the lexer and parser of the older calchart syntax.
-extern int parsecontinuity();
-extern const char* yyinputbuffer;
-extern std::vector<std::unique_ptr<CalChart::Cont::Procedure>> ParsedContinuity;
-
 namespace CalChart {
 
 // if any errors happen during parse, a ParseError may be thrown.
@@ -44,17 +38,17 @@ std::runtime_error ParseError(std::string const& str, int l, int c)
 
 std::vector<std::unique_ptr<Cont::Procedure>> ParseContinuity(std::string const& s, ParseErrorHandlers const* correct)
 {
-    ParsedContinuity = std::vector<std::unique_ptr<CalChart::Cont::Procedure>>{};
     std::string thisParse = s;
     while (1) {
-        yyinputbuffer = thisParse.c_str();
-        // parse out the error
-        if (parsecontinuity() == 0) {
-            return std::move(ParsedContinuity);
+        // each parse has its own context, so this can be called from any thread.
+        auto context = Cont::ParseContext{};
+        context.text = thisParse;
+        if (Cont::ParseContinuityText(context) == 0) {
+            return std::move(context.procedures);
         }
         if (correct && correct->mContinuityParseCorrectionHandler) {
             // give the user a chance to correct.
-            thisParse = correct->mContinuityParseCorrectionHandler(std::string("Could not parse line ") + std::to_string(yylloc.first_line) + " at " + std::to_string(yylloc.first_column), thisParse, yylloc.first_line, yylloc.first_column);
+            thisParse = correct->mContinuityParseCorrectionHandler(std::string("Could not parse line ") + std::to_string(context.errorLine) + " at " + std::to_string(context.errorColumn), thisParse, context.errorLine, context.errorColumn);
         } else {
             throw ParseError(s, 0, 0);
         }
@@ -76,55 +70,69 @@ std::vector<std::unique_ptr<Cont::Procedure>> Deserialize(Reader reader)
     return result;
 }
 
+auto Continuity::MakeParsed(std::vector<std::unique_ptr<Cont::Procedure>> procedures, std::string text) -> std::shared_ptr<Parsed const>
+{
+    auto parsed = std::make_shared<Parsed>(Parsed{ std::move(procedures), std::move(text), {} });
+    parsed->m_serialized = Lazy<std::vector<std::byte>>{ std::function<std::vector<std::byte>()>{ [&procedures = parsed->m_parsedContinuity] {
+        auto result = std::vector<std::byte>{};
+        for (auto&& procedure : procedures) {
+            Parser::Append(result, procedure->Serialize());
+        }
+        return result;
+    } } };
+    return parsed;
+}
+
 Continuity::Continuity(std::string const& s, ParseErrorHandlers const* correction)
-    : m_parsedContinuity(ParseContinuity(s, correction))
-    , m_legacyText(s)
+    : m_parsed(MakeParsed(ParseContinuity(s, correction), s))
 {
 }
 
 Continuity::~Continuity() = default;
 
-Continuity::Continuity(Continuity const& other)
-{
-    for (auto&& i : other.m_parsedContinuity) {
-        m_parsedContinuity.emplace_back(i->clone());
-    }
-}
+Continuity::Continuity(Continuity const&) = default;
 
 Continuity::Continuity(std::vector<std::unique_ptr<Cont::Procedure>> from_cont)
-    : m_parsedContinuity(std::move(from_cont))
+    : m_parsed(MakeParsed(std::move(from_cont)))
 {
 }
 
 Continuity::Continuity(Reader reader)
-    : m_parsedContinuity(Deserialize(reader))
+    : m_parsed(MakeParsed(Deserialize(reader)))
+{
+}
+
+Continuity& Continuity::operator=(Continuity const&) = default;
+
+// moving shares the same as copying, so a moved from continuity is still a usable one.
+Continuity::Continuity(Continuity&& other) noexcept
+    : m_parsed(other.m_parsed)
 {
 }
 
-Continuity& Continuity::operator=(Continuity const& other)
+Continuity& Continuity::operator=(Continuity&& other) noexcept
 {
-    Continuity copy(other);
-    swap(*this, copy);
+    m_parsed = other.m_parsed;
     return *this;
 }
 
-Continuity::Continuity(Continuity&&) noexcept = default;
-Continuity& Continuity::operator=(Continuity&&) noexcept = default;
-
 bool operator==(Continuity const& lhs, Continuity const& rhs)
 {
-    return std::equal(lhs.m_parsedContinuity.begin(), lhs.m_parsedContinuity.end(), rhs.m_parsedContinuity.begin(), rhs.m_parsedContinuity.end(), [](auto&& a, auto&& b) {
+    auto const& lhsProcedures = lhs.GetParsedContinuity();
+    auto const& rhsProcedures = rhs.GetParsedContinuity();
+    return std::equal(lhsProcedures.begin(), lhsProcedures.end(), rhsProcedures.begin(), rhsProcedures.end(), [](auto&& a, auto&& b) {
         return *a == *b;
     });
 }
 
 auto Continuity::Serialize() const -> std::vector<std::byte>
 {
-    std::vector<std::byte> result;
-    for (auto&& i : m_parsedContinuity) {
-        Parser::Append(result, i->Serialize());
-    }
-    return result;
+    return m_parsed->m_serialized.Get();
+}
+
+void Continuity::Serialize(std::vector<std::byte>& result) const
+{
+    Parser::Append(result, m_parsed->m_serialized.Get());
 }
 
 }
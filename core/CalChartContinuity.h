@@ -32,9 +32,13 @@
  * calchart files may not parse correctly, we provide a way that upon detection of error that the procedure can be "re-written".  This allows
  * us to have the user attempt to correct a unusal CalChart syntax before we "give up".
  *
+ * Once made, a Continuity doesn't change; editing one means making a new one.  So copies share the parsed
+ * procedures instead of cloning them, which keeps copying sheets cheap.
+ *
  */
 
 #include "CalChartFileFormat.h"
+#include "CalChartLazy.h"
 
 #include <memory>
 #include <stdexcept>
@@ -62,21 +66,31 @@ public:
     Continuity& operator=(Continuity&&) noexcept;
 
     [[nodiscard]] auto Serialize() const -> std::vector<std::byte>;
+    // appends what Serialize returns to result.
+    void Serialize(std::vector<std::byte>& result) const;
 
-    std::vector<std::unique_ptr<Cont::Procedure>> const& GetParsedContinuity() const noexcept { return m_parsedContinuity; }
-    [[nodiscard]] auto HasParsedContinuity() const { return !m_parsedContinuity.empty(); }
-    auto GetText() const { return m_legacyText; }
+    std::vector<std::unique_ptr<Cont::Procedure>> const& GetParsedContinuity() const noexcept { return m_parsed->m_parsedContinuity; }
+    [[nodiscard]] auto HasParsedContinuity() const { return !m_parsed->m_parsedContinuity.empty(); }
+    auto GetText() const { return m_parsed->m_legacyText; }
 
     friend void swap(Continuity& lhs, Continuity& rhs)
     {
         using std::swap;
-        swap(lhs.m_parsedContinuity, rhs.m_parsedContinuity);
+        swap(lhs.m_parsed, rhs.m_parsed);
     }
     friend bool operator==(Continuity const& lhs, Continuity const& rhs);
 
 private:
-    std::vector<std::unique_ptr<Cont::Procedure>> m_parsedContinuity;
-    std::string m_legacyText;
+    struct Parsed {
+        std::vector<std::unique_ptr<Cont::Procedure>> m_parsedContinuity;
+        std::string m_legacyText;
+        // serialized the first time it's asked for, as a continuity doesn't change.
+        Lazy<std::vector<std::byte>> m_serialized;
+    };
+    static auto MakeParsed(std::vector<std::unique_ptr<Cont::Procedure>> procedures, std::string text = "") -> std::shared_ptr<Parsed const>;
+
+    // shared by all the copies of this continuity.
+    std::shared_ptr<Parsed const> m_parsed;
 };
 
 }
@@ -430,12 +430,6 @@ static std::tuple<std::unique_ptr<ValueVar>, Reader> DeserializeValueVar(Reader
 }
 
 // Token
-Token::Token()
-    : line(yylloc.first_line)
-    , col(yylloc.first_column)
-{
-}
-
 auto Token::ToString() const -> std::string
 {
     return "[CT]";
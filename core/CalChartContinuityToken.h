@@ -182,10 +182,16 @@ auto mv(T&& p) { return std::move(p); }
 
 class Token {
 public:
-    Token();
+    Token() = default;
     virtual ~Token() = default;
     virtual auto ToString() const -> std::string;
     void SetParentPtr(Token* p) { parent_ptr = p; }
+    // where in the continuity text the parser made this.
+    void SetLocation(uint32_t l, uint32_t c)
+    {
+        line = l;
+        col = c;
+    }
     virtual void replace(Token const* which, std::unique_ptr<Token> v);
 
     [[nodiscard]] virtual auto Serialize() const -> std::vector<std::byte>;
@@ -201,7 +207,7 @@ protected:
     }
 
 private:
-    uint32_t line, col;
+    uint32_t line{}, col{};
     static constexpr auto NumParts = 0;
 };
 
@@ -0,0 +1,315 @@
+/*
+ * CalChartDisplayList.cpp
+ * A flat list of what to draw
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CalChartDisplayList.h"
+#include "CalChartUtils.h"
+
+namespace CalChart::Draw {
+
+namespace {
+    template <typename T>
+    auto AddTo(std::vector<T>& table, T const& value) -> uint32_t
+    {
+        table.push_back(value);
+        return static_cast<uint32_t>(table.size() - 1);
+    }
+}
+
+void DisplayList::Add(Line const& line)
+{
+    mOps.push_back({ .code = OpCode::Line, .c1 = line.c1, .c2 = line.c2 });
+}
+
+void DisplayList::Add(Arc const& arc)
+{
+    mOps.push_back({ .code = OpCode::Arc, .c1 = arc.c1, .c2 = arc.c2, .c3 = arc.cc });
+}
+
+void DisplayList::Add(Ellipse const& ellipse)
+{
+    mOps.push_back({ .code = OpCode::Ellipse, .filled = ellipse.filled, .c1 = ellipse.c1, .c2 = ellipse.c2 });
+}
+
+void DisplayList::Add(Circle const& circle)
+{
+    mOps.push_back({ .code = OpCode::Circle, .filled = circle.filled, .c1 = circle.c1, .value = circle.radius });
+}
+
+void DisplayList::Add(Rectangle const& rectangle)
+{
+    mOps.push_back({ .code = OpCode::Rectangle, .filled = rectangle.filled, .c1 = rectangle.start, .c2 = rectangle.size, .value = rectangle.rounding });
+}
+
+void DisplayList::Add(Text const& text)
+{
+    AddText(text.c1, text.text, text.anchor, text.withBackground, text.linePad);
+}
+
+void DisplayList::AddText(Coord where, std::string_view text, Text::TextAnchor anchor, bool withBackground, double linePad)
+{
+    auto index = static_cast<uint32_t>(mText.size());
+    mText.append(text);
+    mOps.push_back({ .code = OpCode::Text, .withBackground = withBackground, .anchor = anchor, .c1 = where, .index = index, .length = static_cast<uint32_t>(text.size()), .linePad = linePad });
+}
+
+void DisplayList::Add(Image const& image)
+{
+    mOps.push_back({ .code = OpCode::Image, .index = AddTo(mImages, image) });
+}
+
+void DisplayList::Add(DrawCommand const& command)
+{
+    std::visit(
+        overloaded{
+            [this](DrawItems const& items) {
+                std::visit(
+                    overloaded{
+                        [](Ignore const&) {},
+                        [this, &items](Tab const&) {
+                            mOps.push_back({ .code = OpCode::Command, .index = AddTo(mCommands, DrawCommand{ items }) });
+                        },
+                        [this](auto const& item) { Add(item); },
+                    },
+                    items);
+            },
+            [this](DrawManipulators const& manipulators) {
+                std::visit(
+                    overloaded{
+                        [this](OverrideFont const& c) {
+                            Push(c.font);
+                            Add(c.commands);
+                        },
+                        [this](OverrideTextForeground const& c) {
+                            PushTextForeground(c.brushAndPen);
+                            Add(c.commands);
+                        },
+                        [this](OverrideBrush const& c) {
+                            Push(c.brush);
+                            Add(c.commands);
+                        },
+                        [this](OverridePen const& c) {
+                            Push(c.pen);
+                            Add(c.commands);
+                        },
+                        [this](OverrideBrushAndPen const& c) {
+                            Push(c.brushAndPen);
+                            Add(c.commands);
+                        },
+                    },
+                    manipulators);
+                Pop();
+            },
+            [this](DrawStack const& stack) {
+                mOps.push_back({ .code = OpCode::Command, .index = AddTo(mCommands, DrawCommand{ stack }) });
+            },
+        },
+        command);
+}
+
+void DisplayList::Add(std::vector<DrawCommand> const& commands)
+{
+    for (auto&& command : commands) {
+        Add(command);
+    }
+}
+
+void DisplayList::Append(DisplayList const& other, Coord offset)
+{
+    auto textStart = static_cast<uint32_t>(mText.size());
+    auto fontsStart = static_cast<uint32_t>(mFonts.size());
+    auto brushesStart = static_cast<uint32_t>(mBrushes.size());
+    auto pensStart = static_cast<uint32_t>(mPens.size());
+    auto brushAndPensStart = static_cast<uint32_t>(mBrushAndPens.size());
+    auto imagesStart = static_cast<uint32_t>(mImages.size());
+    auto commandsStart = static_cast<uint32_t>(mCommands.size());
+
+    mText += other.mText;
+    mFonts.insert(mFonts.end(), other.mFonts.begin(), other.mFonts.end());
+    mBrushes.insert(mBrushes.end(), other.mBrushes.begin(), other.mBrushes.end());
+    mPens.insert(mPens.end(), other.mPens.begin(), other.mPens.end());
+    mBrushAndPens.insert(mBrushAndPens.end(), other.mBrushAndPens.begin(), other.mBrushAndPens.end());
+    for (auto&& image : other.mImages) {
+        mImages.push_back(image + offset);
+    }
+    for (auto&& command : other.mCommands) {
+        mCommands.push_back(command + offset);
+    }
+
+    mOps.reserve(mOps.size() + other.mOps.size());
+    for (auto op : other.mOps) {
+        switch (op.code) {
+        case OpCode::Arc:
+            op.c3 = op.c3 + offset;
+            [[fallthrough]];
+        case OpCode::Line:
+        case OpCode::Ellipse:
+            op.c1 = op.c1 + offset;
+            op.c2 = op.c2 + offset;
+            break;
+        case OpCode::Circle:
+        case OpCode::Rectangle:
+            op.c1 = op.c1 + offset;
+            break;
+        case OpCode::Text:
+            op.c1 = op.c1 + offset;
+            op.index += textStart;
+            break;
+        case OpCode::Image:
+            op.index += imagesStart;
+            break;
+        case OpCode::Command:
+            op.index += commandsStart;
+            break;
+        case OpCode::PushFont:
+            op.index += fontsStart;
+            break;
+        case OpCode::PushTextForeground:
+        case OpCode::PushBrushAndPen:
+            op.index += brushAndPensStart;
+            break;
+        case OpCode::PushBrush:
+            op.index += brushesStart;
+            break;
+        case OpCode::PushPen:
+            op.index += pensStart;
+            break;
+        case OpCode::Pop:
+            break;
+        }
+        mOps.push_back(op);
+    }
+}
+
+void DisplayList::Push(Font const& font)
+{
+    mOps.push_back({ .code = OpCode::PushFont, .index = AddTo(mFonts, font) });
+}
+
+void DisplayList::PushTextForeground(BrushAndPen const& brushAndPen)
+{
+    mOps.push_back({ .code = OpCode::PushTextForeground, .index = AddTo(mBrushAndPens, brushAndPen) });
+}
+
+void DisplayList::Push(Brush const& brush)
+{
+    mOps.push_back({ .code = OpCode::PushBrush, .index = AddTo(mBrushes, brush) });
+}
+
+void DisplayList::Push(Pen const& pen)
+{
+    mOps.push_back({ .code = OpCode::PushPen, .index = AddTo(mPens, pen) });
+}
+
+void DisplayList::Push(BrushAndPen const& brushAndPen)
+{
+    mOps.push_back({ .code = OpCode::PushBrushAndPen, .index = AddTo(mBrushAndPens, brushAndPen) });
+}
+
+void DisplayList::Pop()
+{
+    mOps.push_back({ .code = OpCode::Pop });
+}
+
+void DisplayList::clear()
+{
+    mOps.clear();
+    mText.clear();
+    mFonts.clear();
+    mBrushes.clear();
+    mPens.clear();
+    mBrushAndPens.clear();
+    mImages.clear();
+    mCommands.clear();
+}
+
+auto DisplayList::ToDrawCommands(Coord offset) const -> std::vector<DrawCommand>
+{
+    // the commands of each open Push, with the outermost level (which has no Push) first.
+    auto levels = std::vector<std::pair<Op const*, std::vector<DrawCommand>>>(1);
+    auto close = [this, &levels] {
+        auto [push, commands] = std::move(levels.back());
+        levels.pop_back();
+        auto manipulator = [this, push, &commands]() -> DrawManipulators {
+            switch (push->code) {
+            case OpCode::PushFont:
+                return OverrideFont{ GetFont(*push), std::move(commands) };
+            case OpCode::PushTextForeground:
+                return OverrideTextForeground{ GetBrushAndPen(*push), std::move(commands) };
+            case OpCode::PushBrush:
+                return OverrideBrush{ GetBrush(*push), std::move(commands) };
+            case OpCode::PushPen:
+                return OverridePen{ GetPen(*push), std::move(commands) };
+            default:
+                return OverrideBrushAndPen{ GetBrushAndPen(*push), std::move(commands) };
+            }
+        }();
+        levels.back().second.emplace_back(std::move(manipulator));
+    };
+    for (auto&& op : mOps) {
+        auto& commands = levels.back().second;
+        switch (op.code) {
+        case OpCode::Line:
+            commands.emplace_back(Line{ op.c1 + offset, op.c2 + offset });
+            break;
+        case OpCode::Arc:
+            commands.emplace_back(Arc{ op.c1 + offset, op.c2 + offset, op.c3 + offset });
+            break;
+        case OpCode::Ellipse:
+            commands.emplace_back(Ellipse{ op.c1 + offset, op.c2 + offset, op.filled });
+            break;
+        case OpCode::Circle:
+            commands.emplace_back(Circle{ op.c1 + offset, op.value, op.filled });
+            break;
+        case OpCode::Rectangle:
+            commands.emplace_back(Rectangle{ op.c1 + offset, op.c2, op.value, op.filled });
+            break;
+        case OpCode::Text:
+            commands.emplace_back(Text{ op.c1 + offset, std::string{ GetText(op) }, op.anchor, op.withBackground, op.linePad });
+            break;
+        case OpCode::Image:
+            commands.emplace_back(GetImage(op) + offset);
+            break;
+        case OpCode::Command:
+            commands.push_back(GetCommand(op) + offset);
+            break;
+        case OpCode::PushFont:
+        case OpCode::PushTextForeground:
+        case OpCode::PushBrush:
+        case OpCode::PushPen:
+        case OpCode::PushBrushAndPen:
+            levels.emplace_back(&op, std::vector<DrawCommand>{});
+            break;
+        case OpCode::Pop:
+            // a Pop without a Push has nothing to close.
+            if (levels.size() > 1) {
+                close();
+            }
+            break;
+        }
+    }
+    while (levels.size() > 1) {
+        close();
+    }
+    return std::move(levels.front().second);
+}
+
+}
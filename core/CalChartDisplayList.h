@@ -0,0 +1,139 @@
+#pragma once
+/*
+ * CalChartDisplayList.h
+ * A flat list of what to draw
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * DisplayList
+ *
+ * DrawCommand is a tree: every manipulator and stack holds a vector of its children, Text holds its own string, and
+ * moving commands somewhere else copies the whole tree.  That's fine for things drawn once, but the animation and the
+ * field are drawn every frame.
+ *
+ * A DisplayList holds the same things flat: one buffer of fixed size ops, with the text in one string and the fonts,
+ * colors and images in tables the ops refer to by index.  Manipulators become a Push op before what they apply to and
+ * a Pop op after.  Where the list is drawn is given when it is replayed, so nothing is copied to move it, and clear()
+ * keeps the buffers so a list reused for every frame stops allocating once it has grown.
+ *
+ * Stacks and Tabs need laying out to know where they go, so they are kept whole as a Command op.
+ */
+
+#include "CalChartCoord.h"
+#include "CalChartDrawCommand.h"
+#include "CalChartDrawPrimatives.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace CalChart::Draw {
+
+class DisplayList {
+public:
+    enum class OpCode : uint8_t {
+        Line,
+        Arc,
+        Ellipse,
+        Circle,
+        Rectangle,
+        Text,
+        Image,
+        Command,
+        PushFont,
+        PushTextForeground,
+        PushBrush,
+        PushPen,
+        PushBrushAndPen,
+        Pop,
+    };
+
+    // Which fields are used depends on the code:
+    //  Line: c1, c2.  Arc: c1, c2, c3 (the center).  Ellipse: c1, c2, filled.  Circle: c1, value (radius), filled.
+    //  Rectangle: c1 (start), c2 (size), value (rounding), filled.
+    //  Text: c1, index and length into the text, anchor, withBackground, linePad.
+    //  Image, Command, and the Pushes: index into their table.
+    struct Op {
+        OpCode code{};
+        bool filled{};
+        bool withBackground{};
+        Text::TextAnchor anchor{};
+        Coord c1{};
+        Coord c2{};
+        Coord c3{};
+        Coord::units value{};
+        uint32_t index{};
+        uint32_t length{};
+        double linePad{};
+        friend auto operator==(Op const&, Op const&) -> bool = default;
+    };
+
+    void Add(Line const& line);
+    void Add(Arc const& arc);
+    void Add(Ellipse const& ellipse);
+    void Add(Circle const& circle);
+    void Add(Rectangle const& rectangle);
+    void Add(Text const& text);
+    void AddText(Coord where, std::string_view text, Text::TextAnchor anchor = Text::TextAnchor::None, bool withBackground = false, double linePad = 0.0);
+    void Add(Image const& image);
+    // manipulators are flattened into Push and Pop, Ignore is dropped.
+    void Add(DrawCommand const& command);
+    void Add(std::vector<DrawCommand> const& commands);
+    void Append(DisplayList const& other, Coord offset = {});
+
+    // everything added until the matching Pop is drawn with this.
+    void Push(Font const& font);
+    void PushTextForeground(BrushAndPen const& brushAndPen);
+    void Push(Brush const& brush);
+    void Push(Pen const& pen);
+    void Push(BrushAndPen const& brushAndPen);
+    void Pop();
+
+    // empties the list, but keeps what it has allocated.
+    void clear();
+    [[nodiscard]] auto empty() const { return mOps.empty(); }
+
+    [[nodiscard]] auto GetOps() const -> std::span<Op const> { return mOps; }
+    [[nodiscard]] auto GetText(Op const& op) const -> std::string_view { return std::string_view{ mText }.substr(op.index, op.length); }
+    [[nodiscard]] auto GetFont(Op const& op) const -> Font const& { return mFonts.at(op.index); }
+    [[nodiscard]] auto GetBrush(Op const& op) const -> Brush const& { return mBrushes.at(op.index); }
+    [[nodiscard]] auto GetPen(Op const& op) const -> Pen const& { return mPens.at(op.index); }
+    [[nodiscard]] auto GetBrushAndPen(Op const& op) const -> BrushAndPen const& { return mBrushAndPens.at(op.index); }
+    [[nodiscard]] auto GetImage(Op const& op) const -> Image const& { return mImages.at(op.index); }
+    [[nodiscard]] auto GetCommand(Op const& op) const -> DrawCommand const& { return mCommands.at(op.index); }
+
+    // the same thing as a DrawCommand tree, moved by offset.
+    [[nodiscard]] auto ToDrawCommands(Coord offset = {}) const -> std::vector<DrawCommand>;
+
+    friend auto operator==(DisplayList const&, DisplayList const&) -> bool = default;
+
+private:
+    std::vector<Op> mOps;
+    std::string mText;
+    std::vector<Font> mFonts;
+    std::vector<Brush> mBrushes;
+    std::vector<Pen> mPens;
+    std::vector<BrushAndPen> mBrushAndPens;
+    std::vector<Image> mImages;
+    std::vector<DrawCommand> mCommands;
+};
+
+}
@@ -23,6 +23,8 @@
 #include "CalChartDrawCommand.h"
 #include "CalChartCoord.h"
 #include "CalChartPoint.h"
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace CalChart::Draw {
@@ -142,4 +144,103 @@ namespace Field {
 
 }
 
+namespace {
+    struct BoundingBox {
+        std::optional<std::pair<Coord, Coord>> box;
+        double imageScale = 1.0;
+
+        void Add(Coord upperLeft, Coord lowerRight)
+        {
+            if (!box) {
+                box = { upperLeft, lowerRight };
+                return;
+            }
+            box->first = { std::min(box->first.x, upperLeft.x), std::min(box->first.y, upperLeft.y) };
+            box->second = { std::max(box->second.x, lowerRight.x), std::max(box->second.y, lowerRight.y) };
+        }
+        void Add(Coord point) { Add(point, point); }
+        void AddEverywhere()
+        {
+            constexpr auto kEverywhere = std::numeric_limits<Coord::units>::max() / 2;
+            Add({ -kEverywhere, -kEverywhere }, { kEverywhere, kEverywhere });
+        }
+
+        void Add(std::vector<DrawCommand> const& commands, Font const& font)
+        {
+            for (auto&& command : commands) {
+                Add(command, font);
+            }
+        }
+
+        void Add(DrawCommand const& command, Font const& font)
+        {
+            std::visit(
+                overloaded{
+                    [this, &font](DrawItems const& item) { Add(item, font); },
+                    [this, &font](DrawManipulators const& manipulator) {
+                        std::visit(
+                            overloaded{
+                                [this](OverrideFont const& c) { Add(c.commands, c.font); },
+                                [this, &font](auto const& c) { Add(c.commands, font); },
+                            },
+                            manipulator);
+                    },
+                    [this](DrawStack const&) { AddEverywhere(); },
+                },
+                command);
+        }
+
+        void Add(DrawItems const& item, Font const& font)
+        {
+            std::visit(
+                overloaded{
+                    [this](Line const& c) {
+                        Add(c.c1);
+                        Add(c.c2);
+                    },
+                    [this](Arc const& c) {
+                        auto radius = static_cast<Coord::units>(std::ceil((c.c1 - c.cc).Magnitude()));
+                        Add(c.cc - Coord{ radius, radius }, c.cc + Coord{ radius, radius });
+                    },
+                    [this](Ellipse const& c) {
+                        Add(c.c1);
+                        Add(c.c2);
+                    },
+                    [this](Circle const& c) { Add(c.c1 - Coord{ c.radius, c.radius }, c.c1 + Coord{ c.radius, c.radius }); },
+                    [this](Rectangle const& c) {
+                        Add(c.start);
+                        Add(c.start + c.size);
+                    },
+                    [this, &font](Text const& c) {
+                        using TextAnchor = Text::TextAnchor;
+                        if ((c.anchor & (TextAnchor::ScreenTop | TextAnchor::ScreenBottom | TextAnchor::ScreenLeft | TextAnchor::ScreenRight)) != TextAnchor::None) {
+                            AddEverywhere();
+                            return;
+                        }
+                        auto reach = Coord{ static_cast<Coord::units>(font.size * std::max<size_t>(c.text.size(), 1)), font.size };
+                        Add(c.c1 - reach, c.c1 + reach);
+                    },
+                    [this](Image const& c) {
+                        if (auto const* image = std::get_if<std::shared_ptr<ImageData>>(&c.mImage); image != nullptr && *image != nullptr) {
+                            auto drawn = Coord{ static_cast<Coord::units>(std::ceil((*image)->width * imageScale)), static_cast<Coord::units>(std::ceil((*image)->height * imageScale)) };
+                            Add(c.mStart, c.mStart + drawn);
+                            return;
+                        }
+                        AddEverywhere();
+                    },
+                    [](Ignore const&) {},
+                    [](Tab const&) {},
+                },
+                item);
+        }
+    };
+}
+
+auto GetBoundingBox(std::vector<DrawCommand> const& commands, Font const& font, double imageScale) -> std::optional<std::pair<Coord, Coord>>
+{
+    auto result = BoundingBox{ .box = std::nullopt, .imageScale = imageScale };
+    result.Add(commands, font);
+    return result.box;
+}
+
 }
@@ -689,6 +689,12 @@ inline auto toCenterText(std::string text) -> DrawCommand
     return Text{ {}, std::move(text), Text::TextAnchor::HorizontalCenter | Text::TextAnchor::Top };
 }
 
+// Where a list of commands draws, as the upper left and lower right corners, or nothing if they don't draw anything.
+// Text is only known by where it starts, so it's taken to reach a font size per character every way from there.
+// Anything that needs laying out to know where it goes (stacks, text held to the screen's edges) is taken to reach
+// everywhere.  Images are drawn a pixel to imageScale Coord units, so that's how far they reach.
+auto GetBoundingBox(std::vector<DrawCommand> const& commands, Font const& font = {}, double imageScale = 1.0) -> std::optional<std::pair<Coord, Coord>>;
+
 }
 
 namespace CalChart::Draw::Field {
@@ -21,14 +21,18 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <array>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <map>
 #include <span>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include "ccvers.h"
@@ -59,7 +63,7 @@ struct Current_version_and_later {
 // show               = START , SHOW ;
 // START              = INGL_INGL , INGL_VERS ;
 // SHOW               = INGL_SHOW , BigEndianInt32(DataTill_SHOW_END) , SHOW_DATA , SHOW_END ;
-// SHOW_DATA          = NUM_MARCH , LABEL , [ DESCRIPTION ] , { SHEET }* , [ SELECTION ], CURRENT_SHEET, /**/ ;
+// SHOW_DATA          = NUM_MARCH , LABEL , [ DESCRIPTION ] , { SHEET }* , [ SELECTION ], CURRENT_SHEET, [ MEDIA | MEDIA_REF ] , [ POOL ] , /**/ ;
 // SHOW_END           = INGL_END , INGL_SHOW ;
 // NUM_MARCH          = INGL_SIZE , BigEndianInt32(4) , NUM_MARCH_DATA , NUM_MARCH_END ;
 // NUM_MARCH_DATA     = BigEndianInt32( number of marchers ) ;
@@ -74,7 +78,7 @@ struct Current_version_and_later {
 // SHOW_MODE_DATA     = ShowModeParseData ;
 // SHOW_MODE_END      = INGL_END , INGL_MODE ;
 // SHEET              = INGL_SHET , BigEndianInt32(DataTill_SHEET_END) , SHEET_DATA , SHEET_END ;
-// SHEET_DATA         = NAME , DURATION , ALL_POINTS , CONTINUITY , PRINT_CONTINUITY , /**/ ;
+// SHEET_DATA         = NAME , DURATION , ALL_POINTS , CONTINUITY , PRINT_CONTINUITY , [ BACKGROUND | BACKGROUND_REF ] , /**/ ;
 // SHEET_END          = INGL_END , INGL_SHET ;
 // SELECTION          = INGL_SELE , BigEndianInt32(DataTill_SELECTION_END) , SELECTION_DATA , SELECTION_END ;
 // SELECTION_DATA     = BigEndianInt32(SelectedPoint)* ;
@@ -111,6 +115,24 @@ struct Current_version_and_later {
 // PRINT_CONTINUITY   = INGL_PCNT , BigEndianInt32(DataTill_PRINT_CONTINUITY_END)) , PRINT_CONTINUITY_DATA , PRINT_CONTINUITY_END ;
 // PRINT_CONTINUITY_DATA = { Null-terminated char* }* ;
 // PRINT_CONTINUITY_END = INGL_END , INGL_PCNT ;
+// BACKGROUND         = INGL_BACK , BigEndianInt32(DataTill_BACKGROUND_END) , BigEndianInt32( number of images ) , { ImageInfo }* , BACKGROUND_END ;
+// BACKGROUND_END     = INGL_END , INGL_BACK ;
+// BACKGROUND_REF     = INGL_BKRF , BigEndianInt32(DataTill_BACKGROUND_REF_END) , BACKGROUND_REF_DATA , BACKGROUND_REF_END ;
+// BACKGROUND_REF_DATA = BigEndianInt32( number of images ) , { EACH_BACKGROUND_REF }* ;
+// EACH_BACKGROUND_REF = BigEndianInt32( left ) , BigEndianInt32( top ) , BigEndianInt32( scaled width ) , BigEndianInt32( scaled height ) ,
+//                       BigEndianInt32( width ) , BigEndianInt32( height ) , BigEndianInt32( pool index of data ) , BigEndianInt32( pool index of alpha ) ;
+// BACKGROUND_REF_END = INGL_END , INGL_BKRF ;
+// MEDIA              = INGL_MDIA , BigEndianInt32(DataTill_MEDIA_END) , FileData , MEDIA_END ;
+// MEDIA_END          = INGL_END , INGL_MDIA ;
+// MEDIA_REF          = INGL_MDRF , BigEndianInt32(DataTill_MEDIA_REF_END) , BigEndianInt32( pool index of media ) , Null-terminated_char* , MEDIA_REF_END ;
+// MEDIA_REF_END      = INGL_END , INGL_MDRF ;
+// POOL               = INGL_POOL , BigEndianInt32(DataTill_POOL_END) , POOL_DATA , POOL_END ;
+// POOL_DATA          = BigEndianInt32( number of resources ) , { BigEndianInt32( size ) , BigEndianInt32( stored size ) , RESOURCE_DATA }* ;
+// RESOURCE_DATA      = zlib stream of the resource, or the resource as is when stored size == size ;
+// POOL_END           = INGL_END , INGL_POOL ;
+//   From 3.9, background images and media are kept once per show in the POOL and referred to by index.
+//   Shows from earlier versions have the images inline in each sheet's BACKGROUND and the media in MEDIA,
+//   and are still read that way.  A sheet written on its own, without a show, keeps BACKGROUND.
 //
 // INGL_INGL = 'I','N','G','L' ;
 // INGL_GURK = 'G','U','R','K' ;
@@ -132,6 +154,9 @@ struct Current_version_and_later {
 // INGL_PCNT = 'P','C','N','T' ;
 // INGL_VCNT = 'V','C','N','T' ;
 // INGL_EVCT = 'E','V','C','T' ;
+// INGL_BKRF = 'B','K','R','F' ;
+// INGL_MDRF = 'M','D','R','F' ;
+// INGL_POOL = 'P','O','O','L' ;
 // INGL_END  = 'E','N','D',' ' ;
 
 // Description of the CalChart file format layout, in modified Extended
@@ -242,6 +267,9 @@ constexpr auto INGL_PNTS = Make4CharWord('P', 'N', 'T', 'S');
 constexpr auto INGL_PONT = Make4CharWord('P', 'O', 'N', 'T');
 constexpr auto INGL_DATA = Make4CharWord('D', 'A', 'T', 'A');
 constexpr auto INGL_MEDIA = Make4CharWord('M', 'D', 'I', 'A');
+constexpr auto INGL_POOL = Make4CharWord('P', 'O', 'O', 'L');
+constexpr auto INGL_BKRF = Make4CharWord('B', 'K', 'R', 'F');
+constexpr auto INGL_MDRF = Make4CharWord('M', 'D', 'R', 'F');
 constexpr auto INGL_END = Make4CharWord('E', 'N', 'D', ' ');
 
 namespace details {
@@ -353,16 +381,21 @@ namespace Parser {
     template <typename T>
     void Append(std::vector<std::byte>& d, std::vector<T> const& s)
     {
-        for (auto&& i : s) {
-            Append(d, i);
+        // byte sized things, like pixels, go in all at once.
+        if constexpr (sizeof(T) == 1 && std::is_trivially_copyable_v<T>) {
+            auto bytes = std::as_bytes(std::span{ s });
+            d.insert(d.end(), bytes.begin(), bytes.end());
+        } else {
+            for (auto&& i : s) {
+                Append(d, i);
+            }
         }
     }
 
     inline void Append(std::vector<std::byte>& d, std::string const& s)
     {
-        for (auto&& i : s) {
-            Append(d, i);
-        }
+        auto bytes = std::as_bytes(std::span{ s });
+        d.insert(d.end(), bytes.begin(), bytes.end());
     }
 
     inline void Append(std::vector<std::byte>& d, std::vector<std::byte> const& s)
@@ -370,6 +403,11 @@ namespace Parser {
         d.insert(d.end(), s.begin(), s.end());
     }
 
+    inline void Append(std::vector<std::byte>& d, std::span<std::byte const> s)
+    {
+        d.insert(d.end(), s.begin(), s.end());
+    }
+
     template <typename T, typename U>
     void AppendAndNullTerminate(T& d, const U& s)
     {
@@ -410,6 +448,29 @@ namespace Parser {
         Append(result, type);
         return result;
     }
+
+    // Writes the same block as Construct_block, but straight into d: write appends the data after the header, and
+    // the size is filled in afterwards.  Blocks written inside write end up in d too, so a whole show can be written
+    // without building each block on its own and copying it into its parent.
+    template <typename Function>
+        requires std::invocable<Function, std::vector<std::byte>&>
+    void AppendBlock(std::vector<std::byte>& d, uint32_t type, Function&& write)
+    {
+        Append(d, type);
+        auto sizeAt = d.size();
+        Append(d, uint32_t{});
+        std::invoke(std::forward<Function>(write), d);
+        details::put_big_long(d.data() + sizeAt, static_cast<uint32_t>(d.size() - sizeAt - sizeof(uint32_t)));
+        Append(d, uint32_t{ INGL_END });
+        Append(d, type);
+    }
+
+    template <typename T>
+        requires(!std::invocable<T, std::vector<std::byte>&>)
+    void AppendBlock(std::vector<std::byte>& d, uint32_t type, T const& data)
+    {
+        AppendBlock(d, type, [&data](auto& result) { Append(result, data); });
+    }
 }
 
 class Reader {
@@ -421,6 +482,8 @@ public:
     }
 
     [[nodiscard]] auto size() const { return data.size(); }
+    [[nodiscard]] auto GetBytes() const { return data; }
+    [[nodiscard]] auto GetVersion() const { return version; }
 
     // returns a reader with a section of the first N
     [[nodiscard]] auto first(std::size_t n) const -> Reader
@@ -648,10 +711,12 @@ inline auto Reader::Peek<float>() const -> float
 template <>
 inline auto Reader::Get<std::string>() -> std::string
 {
-    auto result = std::string(reinterpret_cast<char const*>(data.data()));
-    if (size() < (result.size() + 1)) {
-        throw std::runtime_error(std::string("not enough data for string.  Need " + std::to_string(result.size() + 1) + ", currently have ") + std::to_string(size()));
+    // only look for the null terminator inside of our data.
+    auto terminator = std::find(data.begin(), data.end(), std::byte{ 0 });
+    if (terminator == data.end()) {
+        throw std::runtime_error(std::string("not enough data for string.  Need " + std::to_string(size() + 1) + ", currently have ") + std::to_string(size()));
     }
+    auto result = std::string(reinterpret_cast<char const*>(data.data()), static_cast<size_t>(std::distance(data.begin(), terminator)));
     increment(result.size() + 1); // +1 for the null terminator
     return result;
 }
@@ -663,6 +728,16 @@ inline auto Reader::GetVector() -> std::vector<T>
         throw std::runtime_error(std::string("not enough data for vector size.  Need 4, currently have ") + std::to_string(size()));
     }
     auto size = Get<uint32_t>();
+    // single bytes are stored as is, so they can be copied straight out (image data can be megabytes).
+    if constexpr (sizeof(T) == 1) {
+        if (data.size() < size) {
+            throw std::runtime_error(std::string("not enough data for vector.  Need ") + std::to_string(size) + ", currently have " + std::to_string(data.size()));
+        }
+        auto result = std::vector<T>(size);
+        std::memcpy(result.data(), data.data(), size);
+        increment(size);
+        return result;
+    }
     auto result = std::vector<T>{};
     result.reserve(size);
     for (auto i = 0U; i < size; ++i) {
@@ -21,9 +21,38 @@
 
 #include "CalChartImage.h"
 #include "CalChartFileFormat.h"
+#include <algorithm>
+#include <span>
 
 namespace CalChart {
 
+ImageBytes::ImageBytes(std::vector<unsigned char> const& bytes)
+{
+    auto asBytes = std::as_bytes(std::span{ bytes });
+    mBytes = std::make_shared<std::vector<std::byte> const>(asBytes.begin(), asBytes.end());
+}
+
+ImageBytes::ImageBytes(std::initializer_list<unsigned char> bytes)
+    : ImageBytes(std::vector<unsigned char>(bytes))
+{
+}
+
+ImageBytes::ImageBytes(std::shared_ptr<std::vector<std::byte> const> bytes)
+    : mBytes(std::move(bytes))
+{
+}
+
+auto ImageBytes::Bytes() const -> std::shared_ptr<std::vector<std::byte> const>
+{
+    static auto const sEmpty = std::make_shared<std::vector<std::byte> const>();
+    return mBytes ? mBytes : sEmpty;
+}
+
+auto operator==(ImageBytes const& lhs, ImageBytes const& rhs) -> bool
+{
+    return lhs.mBytes == rhs.mBytes || std::ranges::equal(lhs, rhs);
+}
+
 auto CreateImageInfo(Reader reader) -> std::pair<ImageInfo, Reader>
 {
     auto left = reader.Get<int32_t>();
@@ -32,8 +61,8 @@ auto CreateImageInfo(Reader reader) -> std::pair<ImageInfo, Reader>
     auto scaled_height = reader.Get<int32_t>();
     auto image_width = reader.Get<int32_t>();
     auto image_height = reader.Get<int32_t>();
-    auto data = reader.GetVector<unsigned char>();
-    auto alpha = reader.GetVector<unsigned char>();
+    auto data = ImageBytes{ reader.GetVector<unsigned char>() };
+    auto alpha = ImageBytes{ reader.GetVector<unsigned char>() };
     scaled_width = (scaled_width == 0) ? image_width : scaled_width;
     scaled_height = (scaled_height == 0) ? image_height : scaled_height;
     return { ImageInfo{ left, top, scaled_width, scaled_height, ImageData{ image_width, image_height, data, alpha, nullptr } }, reader };
@@ -42,6 +71,13 @@ auto CreateImageInfo(Reader reader) -> std::pair<ImageInfo, Reader>
 auto Serialize(ImageInfo const& image) -> std::vector<std::byte>
 {
     std::vector<std::byte> result;
+    result.reserve(6 * sizeof(uint32_t) + 2 * sizeof(uint32_t) + image.data.data.size() + image.data.alpha.size());
+    Serialize(image, result);
+    return result;
+}
+
+void Serialize(ImageInfo const& image, std::vector<std::byte>& result)
+{
     Parser::Append(result, uint32_t(image.left));
     Parser::Append(result, uint32_t(image.top));
     Parser::Append(result, uint32_t(image.scaledWidth));
@@ -50,10 +86,9 @@ auto Serialize(ImageInfo const& image) -> std::vector<std::byte>
     Parser::Append(result, uint32_t(image.data.height));
     // we know data size, but let's put it in anyways
     Parser::Append(result, uint32_t(image.data.data.size()));
-    Parser::Append(result, image.data.data);
+    Parser::Append(result, std::as_bytes(std::span{ image.data.data }));
     // alpha could be zero
     Parser::Append(result, uint32_t(image.data.alpha.size()));
-    Parser::Append(result, image.data.alpha);
-    return result;
+    Parser::Append(result, std::as_bytes(std::span{ image.data.alpha }));
 }
 }
@@ -20,7 +20,9 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <vector>
 
@@ -32,14 +34,37 @@ namespace CalChart {
 
 class Reader;
 
+// The pixels of an image don't change once it's made, and a show often has the same image on many sheets, so
+// copies share them, along with the show's resource pool.  Otherwise it reads like a const std::vector<unsigned char>.
+class ImageBytes {
+public:
+    ImageBytes() = default;
+    ImageBytes(std::vector<unsigned char> const& bytes);
+    ImageBytes(std::initializer_list<unsigned char> bytes);
+    explicit ImageBytes(std::shared_ptr<std::vector<std::byte> const> bytes);
+
+    [[nodiscard]] auto data() const { return reinterpret_cast<unsigned char const*>(mBytes ? mBytes->data() : nullptr); }
+    [[nodiscard]] auto size() const { return mBytes ? mBytes->size() : size_t{}; }
+    [[nodiscard]] auto empty() const { return size() == 0; }
+    [[nodiscard]] auto begin() const { return data(); }
+    [[nodiscard]] auto end() const { return data() + size(); }
+    // never null.
+    [[nodiscard]] auto Bytes() const -> std::shared_ptr<std::vector<std::byte> const>;
+
+    friend auto operator==(ImageBytes const& lhs, ImageBytes const& rhs) -> bool;
+
+private:
+    std::shared_ptr<std::vector<std::byte> const> mBytes;
+};
+
 // Image has the complexity that while there is a platform independent way for representing their info,
 // when it comes to drawing with a specific implementation (like wxWidgets), conversions and scaling are
 // necessary.  To avoid that we allow an optional "Rendered" object stored along with the data.
 struct ImageData {
     int width{};
     int height{};
-    std::vector<unsigned char> data;
-    std::vector<unsigned char> alpha;
+    ImageBytes data;
+    ImageBytes alpha;
     std::shared_ptr<Draw::OpaqueImageData> render;
 };
 
@@ -53,5 +78,7 @@ struct ImageInfo {
 
 auto CreateImageInfo(Reader) -> std::pair<ImageInfo, Reader>;
 auto Serialize(ImageInfo const&) -> std::vector<std::byte>;
+// appends what Serialize returns to result.
+void Serialize(ImageInfo const&, std::vector<std::byte>& result);
 
 }
@@ -0,0 +1,96 @@
+#pragma once
+/*
+ * CalChartLazy.h
+ * A value that is only computed the first time it is used.
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace CalChart {
+
+// Lazy holds either a value, or the function to make it.  The function is run the first time the value
+// is asked for, and it is safe for several threads to ask at the same time.  If the function throws, the
+// exception goes to whoever asked and the next ask tries again.
+//
+// Copies share the value (or the function) until one of them asks for Mutable, so copying something
+// that hasn't been made yet doesn't make it.
+template <typename T>
+class Lazy {
+public:
+    Lazy()
+        : Lazy(T{})
+    {
+    }
+    explicit Lazy(T value)
+        : mState(std::make_shared<State>())
+    {
+        mState->mValue.emplace(std::move(value));
+        mState->mMade = true;
+    }
+    explicit Lazy(std::function<T()> make)
+        : mState(std::make_shared<State>())
+    {
+        mState->mMake = std::move(make);
+    }
+
+    [[nodiscard]] auto Get() const -> T const&
+    {
+        auto& state = *mState;
+        std::call_once(state.mOnce, [&state] {
+            if (!state.mValue) {
+                state.mValue.emplace(state.mMake());
+            }
+            state.mMake = nullptr;
+            state.mMade = true;
+        });
+        return *state.mValue;
+    }
+
+    // Anything shared with a copy is split off before it can be changed.
+    [[nodiscard]] auto Mutable() -> T&
+    {
+        auto const& value = Get();
+        if (mState.use_count() > 1) {
+            mState = Lazy(value).mState;
+        }
+        return *mState->mValue;
+    }
+
+    [[nodiscard]] auto HasValue() const -> bool { return mState->mMade; }
+
+    // Copies have the same Identity until one of them asks for Mutable.  As long as a copy is kept around
+    // the value can't be changed in place, so the same Identity means the same value.
+    [[nodiscard]] auto Identity() const -> void const* { return mState.get(); }
+
+private:
+    struct State {
+        std::once_flag mOnce;
+        std::atomic<bool> mMade{};
+        std::optional<T> mValue;
+        std::function<T()> mMake;
+    };
+    std::shared_ptr<State> mState;
+};
+
+}
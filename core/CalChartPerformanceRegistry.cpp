@@ -32,6 +32,7 @@ void PerformanceRegistry::RegisterComponent(void const* componentPtr, std::strin
         return;
     }
 
+    auto lock = std::lock_guard{ mMutex };
     mComponents.try_emplace(componentPtr, componentName);
 }
 
@@ -41,16 +42,19 @@ void PerformanceRegistry::DeregisterComponent(void const* componentPtr)
         return;
     }
 
+    auto lock = std::lock_guard{ mMutex };
     mComponents.erase(componentPtr);
 }
 
 auto PerformanceRegistry::IsRegistered(void const* componentPtr) const -> bool
 {
+    auto lock = std::lock_guard{ mMutex };
     return mComponents.find(componentPtr) != mComponents.end();
 }
 
 void PerformanceRegistry::RecordMeasurement(void const* componentPtr, Seconds seconds)
 {
+    auto lock = std::lock_guard{ mMutex };
     auto it = mComponents.find(componentPtr);
     if (it != mComponents.end()) {
         it->second.measurements.addMeasure(seconds);
@@ -59,6 +63,7 @@ void PerformanceRegistry::RecordMeasurement(void const* componentPtr, Seconds se
 
 auto PerformanceRegistry::GetStats(void const* componentPtr) const -> PerformanceStats
 {
+    auto lock = std::lock_guard{ mMutex };
     auto it = mComponents.find(componentPtr);
     if (it == mComponents.end()) {
         return PerformanceStats{};
@@ -69,6 +74,7 @@ auto PerformanceRegistry::GetStats(void const* componentPtr) const -> Performanc
 
 auto PerformanceRegistry::GetAllStats() const -> std::vector<PerformanceStats>
 {
+    auto lock = std::lock_guard{ mMutex };
     std::vector<PerformanceStats> results;
     results.reserve(mComponents.size());
 
@@ -81,6 +87,7 @@ auto PerformanceRegistry::GetAllStats() const -> std::vector<PerformanceStats>
 
 void PerformanceRegistry::ResetMeasurements()
 {
+    auto lock = std::lock_guard{ mMutex };
     for (auto& [ptr, data] : mComponents) {
         data.measurements.clear();
     }
@@ -88,6 +95,7 @@ void PerformanceRegistry::ResetMeasurements()
 
 auto PerformanceRegistry::GetRegisteredCount() const -> size_t
 {
+    auto lock = std::lock_guard{ mMutex };
     return mComponents.size();
 }
 
@@ -27,6 +27,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <utility>
@@ -54,8 +55,8 @@ public:
     // Non-copyable to avoid accidental copies
     PerformanceRegistry(PerformanceRegistry const&) = delete;
     PerformanceRegistry& operator=(PerformanceRegistry const&) = delete;
-    PerformanceRegistry(PerformanceRegistry&&) = default;
-    PerformanceRegistry& operator=(PerformanceRegistry&&) = default;
+    PerformanceRegistry(PerformanceRegistry&&) = delete;
+    PerformanceRegistry& operator=(PerformanceRegistry&&) = delete;
 
     // Register a component that will be tracked
     // componentPtr: unique identifier (typically 'this' pointer)
@@ -90,6 +91,8 @@ private:
     };
 
     using ComponentKey = void const*;
+    // measurements can come from worker threads (like autosave) while the UI reads the stats.
+    mutable std::mutex mMutex;
     std::unordered_map<ComponentKey, ComponentData> mComponents;
 
     // Calculate statistics from a vector of measurements
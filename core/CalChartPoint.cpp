@@ -22,6 +22,7 @@
 
 #include "CalChartPoint.h"
 #include "CalChartConfiguration.h"
+#include "CalChartDisplayList.h"
 #include "CalChartFileFormat.h"
 
 #include <cassert>
@@ -50,12 +51,10 @@ auto ReadPositionData(Reader& reader)
     return pos;
 }
 
-auto WritePositionData(Coord pos)
+void WritePositionData(std::vector<std::byte>& result, Coord pos)
 {
-    auto result = std::vector<std::byte>{};
     Parser::Append(result, static_cast<int16_t>(pos.x));
     Parser::Append(result, static_cast<int16_t>(pos.y));
-    return result;
 }
 
 // EACH_POINT_DATA    = BigEndianInt8(Size_rest_of_EACH_POINT_DATA) ,
@@ -84,29 +83,27 @@ Point::Point(Reader reader)
     }
 }
 
-auto Point::SerializeHelper() const -> std::vector<std::byte>
+void Point::SerializeHelper(std::vector<std::byte>& result) const
 {
     // how many reference points are we going to write?
-    auto pointsToWrite = std::vector<unsigned>{};
+    auto pointsToWrite = std::array<unsigned, Point::kNumRefPoints>{};
+    auto numPointsToWrite = size_t{};
     for (auto j = 1; j <= Point::kNumRefPoints; j++) {
         if (GetPos(j) != GetPos(0)) {
-            pointsToWrite.push_back(j);
+            pointsToWrite.at(numPointsToWrite++) = j;
         }
     }
-    auto result = std::vector<std::byte>{};
     // Point positions
     // Write block size
 
     // Write POSITION
-    Parser::Append(result, WritePositionData(GetPos()));
+    WritePositionData(result, GetPos());
 
     // Write REF_POS
-    Parser::Append(result, static_cast<uint8_t>(pointsToWrite.size()));
-    if (!pointsToWrite.empty()) {
-        for (auto j : pointsToWrite) {
-            Parser::Append(result, static_cast<uint8_t>(j));
-            Parser::Append(result, WritePositionData(GetPos(j)));
-        }
+    Parser::Append(result, static_cast<uint8_t>(numPointsToWrite));
+    for (auto j : std::span{ pointsToWrite }.first(numPointsToWrite)) {
+        Parser::Append(result, static_cast<uint8_t>(j));
+        WritePositionData(result, GetPos(j));
     }
 
     // Write SYMBOL
@@ -114,19 +111,24 @@ auto Point::SerializeHelper() const -> std::vector<std::byte>
 
     // Point labels (left or right)
     Parser::Append(result, static_cast<uint8_t>(GetFlip()));
-
-    return result;
 }
 
 auto Point::Serialize() const -> std::vector<std::byte>
 {
-    auto const serializedData = SerializeHelper();
     std::vector<std::byte> result;
-    Parser::Append(result, static_cast<uint8_t>(serializedData.size()));
-    Parser::Append(result, serializedData);
+    Serialize(result);
     return result;
 }
 
+void Point::Serialize(std::vector<std::byte>& result) const
+{
+    // the size goes first, and is filled in once the point is written.
+    auto sizeAt = result.size();
+    Parser::Append(result, uint8_t{});
+    SerializeHelper(result);
+    result.at(sizeAt) = static_cast<std::byte>(result.size() - sizeAt - 1);
+}
+
 void Point::Flip(bool val) { mFlags.set(kPointLabelFlipped, val); };
 
 void Point::SetLabelVisibility(bool isVisible) { mFlags.set(kLabelIsInvisible, !isVisible); }
@@ -157,7 +159,7 @@ void Point::SetPos(Coord c, unsigned ref)
 void Point::SetSymbol(SYMBOL_TYPE s) { mSym = s; }
 
 namespace {
-    auto CreatePointCircle(CalChart::SYMBOL_TYPE symbol, double dotRatio) -> std::vector<Draw::DrawCommand>
+    auto PointCircle(CalChart::SYMBOL_TYPE symbol, double dotRatio) -> Draw::Circle
     {
         auto const filled = [](auto symbol) {
             switch (symbol) {
@@ -174,23 +176,24 @@ namespace {
 
         auto const circ_r = CalChart::Float2CoordUnits(dotRatio) / 2.0;
 
-        return { Draw::Circle({ 0, 0 }, circ_r, filled) };
+        return Draw::Circle({ 0, 0 }, circ_r, filled);
     }
 
-    auto CreatePointCross(CalChart::SYMBOL_TYPE symbol, double dotRatio, double pLineRatio, double sLineRatio) -> std::vector<Draw::DrawCommand>
+    // calls addLine with each line of the symbol, centered on { 0, 0 }.
+    template <typename Function>
+    void ForEachPointCrossLine(CalChart::SYMBOL_TYPE symbol, double dotRatio, double pLineRatio, double sLineRatio, Function addLine)
     {
         auto const plineoff = static_cast<Coord::units>(CalChart::Float2CoordUnits(dotRatio * pLineRatio) / 2.0);
         auto const slineoff = static_cast<Coord::units>(CalChart::Float2CoordUnits(dotRatio * sLineRatio) / 2.0);
 
-        auto drawCmds = std::vector<Draw::DrawCommand>{};
         switch (symbol) {
         case CalChart::SYMBOL_SL:
         case CalChart::SYMBOL_X:
-            drawCmds.push_back(Draw::Line{ -plineoff, plineoff, plineoff, -plineoff });
+            addLine(Draw::Line{ -plineoff, plineoff, plineoff, -plineoff });
             break;
         case CalChart::SYMBOL_SOLSL:
         case CalChart::SYMBOL_SOLX:
-            drawCmds.push_back(Draw::Line{ -slineoff, slineoff, slineoff, -slineoff });
+            addLine(Draw::Line{ -slineoff, slineoff, slineoff, -slineoff });
             break;
         default:
             break;
@@ -198,15 +201,41 @@ namespace {
         switch (symbol) {
         case CalChart::SYMBOL_BKSL:
         case CalChart::SYMBOL_X:
-            drawCmds.push_back(Draw::Line{ -plineoff, -plineoff, plineoff, plineoff });
+            addLine(Draw::Line{ -plineoff, -plineoff, plineoff, plineoff });
             break;
         case CalChart::SYMBOL_SOLBKSL:
         case CalChart::SYMBOL_SOLX:
-            drawCmds.push_back(Draw::Line{ -slineoff, -slineoff, slineoff, slineoff });
+            addLine(Draw::Line{ -slineoff, -slineoff, slineoff, slineoff });
             break;
         default:
             break;
         }
+    }
+
+    // where the label goes, from the point's position.
+    auto PointLabelOffset(double dotRatio)
+    {
+        auto const circ_r = CalChart::Float2CoordUnits(dotRatio) / 2.0;
+        return -CalChart::Coord(0, circ_r);
+    }
+
+    auto PointLabelAnchor(CalChart::Point const& point)
+    {
+        auto anchor = Draw::Text::TextAnchor::Bottom;
+        return anchor | (point.GetFlip() ? Draw::Text::TextAnchor::Left : Draw::Text::TextAnchor::Right);
+    }
+
+    auto CreatePointCircle(CalChart::SYMBOL_TYPE symbol, double dotRatio) -> std::vector<Draw::DrawCommand>
+    {
+        return { PointCircle(symbol, dotRatio) };
+    }
+
+    auto CreatePointCross(CalChart::SYMBOL_TYPE symbol, double dotRatio, double pLineRatio, double sLineRatio) -> std::vector<Draw::DrawCommand>
+    {
+        auto drawCmds = std::vector<Draw::DrawCommand>{};
+        ForEachPointCrossLine(symbol, dotRatio, pLineRatio, sLineRatio, [&drawCmds](Draw::Line const& line) {
+            drawCmds.push_back(line);
+        });
         return drawCmds;
     }
 
@@ -215,10 +244,7 @@ namespace {
         if (!point.LabelIsVisible()) {
             return {};
         }
-        auto const circ_r = CalChart::Float2CoordUnits(dotRatio) / 2.0;
-        auto anchor = Draw::Text::TextAnchor::Bottom;
-        anchor = anchor | (point.GetFlip() ? Draw::Text::TextAnchor::Left : Draw::Text::TextAnchor::Right);
-        return { Draw::Text(-CalChart::Coord(0, circ_r), label, anchor) };
+        return { Draw::Text(PointLabelOffset(dotRatio), label, PointLabelAnchor(point)) };
     }
 
     auto CreatePoint(SYMBOL_TYPE sym, double dotRatio, double pLineRatio, double sLineRatio) -> std::vector<Draw::DrawCommand>
@@ -241,6 +267,18 @@ auto Point::GetDrawCommands(unsigned ref, std::string const& label, double dotRa
     return CreatePoint(*this, GetSymbol(), label, dotRatio, pLineRatio, sLineRatio) + GetPos(ref);
 }
 
+void Point::AddDrawCommands(Draw::DisplayList& result, unsigned ref, std::string_view label, double dotRatio, double pLineRatio, double sLineRatio) const
+{
+    auto where = GetPos(ref);
+    result.Add(PointCircle(GetSymbol(), dotRatio) + where);
+    ForEachPointCrossLine(GetSymbol(), dotRatio, pLineRatio, sLineRatio, [&result, where](Draw::Line const& line) {
+        result.Add(line + where);
+    });
+    if (LabelIsVisible()) {
+        result.AddText(where + PointLabelOffset(dotRatio), label, PointLabelAnchor(*this));
+    }
+}
+
 auto Point::GetDrawCommands(unsigned ref, std::string const& label, Configuration const& config) const -> std::vector<Draw::DrawCommand>
 {
     return GetDrawCommands(ref, label, config.Get_DotRatio(), config.Get_PLineRatio(), config.Get_SLineRatio());
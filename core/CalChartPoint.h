@@ -39,12 +39,16 @@
 
 #include <array>
 #include <bitset>
+#include <string_view>
 #include <vector>
 
 namespace CalChart {
 
 class Reader;
 class Configuration;
+namespace Draw {
+    class DisplayList;
+}
 
 class Point {
 public:
@@ -56,6 +60,8 @@ public:
 
     explicit Point(Reader);
     [[nodiscard]] auto Serialize() const -> std::vector<std::byte>;
+    // appends what Serialize returns to result.
+    void Serialize(std::vector<std::byte>& result) const;
 
     [[nodiscard]] auto GetFlip() const { return mFlags.test(kPointLabelFlipped); }
     void Flip(bool val = true);
@@ -73,10 +79,14 @@ public:
     [[nodiscard]] auto GetDrawCommands(std::string const& label, Configuration const& config) const -> std::vector<Draw::DrawCommand>;
     [[nodiscard]] auto GetDrawCommands(double dotRatio, double pLineRatio, double sLineRatio) const -> std::vector<Draw::DrawCommand>;
     [[nodiscard]] auto GetDrawCommands(Configuration const& config) const -> std::vector<Draw::DrawCommand>;
+    // adds the same thing as GetDrawCommands to result, without building the DrawCommands.
+    void AddDrawCommands(Draw::DisplayList& result, unsigned ref, std::string_view label, double dotRatio, double pLineRatio, double sLineRatio) const;
 
     [[nodiscard]] auto GetSymbol() const { return mSym; }
     void SetSymbol(SYMBOL_TYPE sym);
 
+    friend auto operator==(Point const&, Point const&) -> bool = default;
+
 private:
     enum {
         kPointLabelFlipped,
@@ -89,7 +99,7 @@ private:
     Coord mPos{};
     std::array<Coord, kNumRefPoints> mRef{};
 
-    [[nodiscard]] auto SerializeHelper() const -> std::vector<std::byte>;
+    void SerializeHelper(std::vector<std::byte>& result) const;
 };
 
 }
@@ -0,0 +1,259 @@
+/*
+ * CalChartResourcePool.cpp
+ * Keeps the large things in a show file (background images, media) once, compressed
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CalChartResourcePool.h"
+#include "CalChartFileFormat.h"
+#include "CalChartUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <ranges>
+#include <thread>
+#include <zlib.h>
+
+namespace CalChart {
+
+namespace {
+    // images are mostly large flat areas, where the fastest level does nearly as well as the best and
+    // saving stays quick.
+    constexpr auto kCompressionLevel = Z_BEST_SPEED;
+
+    // resources this big are compressed on their own thread while the rest of the show is written, as long
+    // as there are threads to spare; the rest are compressed when the pool is written.
+    constexpr auto kCompressAsyncSize = size_t{ 64 * 1024 };
+    std::atomic<unsigned> sCompressing{};
+
+    // deflate can't expand data by more than about 1032 to 1, so a size past that is a corrupt file, as is
+    // anything larger than a background image or media could reasonably be.
+    constexpr auto kMaxExpansion = size_t{ 1032 };
+    constexpr auto kMaxResourceSize = size_t{ 1024 * 1024 * 1024 };
+
+    auto TryStartCompressing() -> bool
+    {
+        auto const limit = std::max(1U, std::thread::hardware_concurrency());
+        auto compressing = sCompressing.load();
+        while (compressing < limit) {
+            if (sCompressing.compare_exchange_weak(compressing, compressing + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Gives back the compressed data, or nothing if compressing doesn't make it smaller.
+    auto Compress(std::span<std::byte const> data) -> ResourceBytes
+    {
+        auto result = std::vector<std::byte>(compressBound(static_cast<uLong>(data.size())));
+        auto size = static_cast<uLongf>(result.size());
+        if (compress2(reinterpret_cast<Bytef*>(result.data()), &size, reinterpret_cast<Bytef const*>(data.data()), static_cast<uLong>(data.size()), kCompressionLevel) != Z_OK
+            || size >= data.size()) {
+            return {};
+        }
+        result.resize(size);
+        return std::make_shared<std::vector<std::byte> const>(std::move(result));
+    }
+
+    auto Uncompress(std::span<std::byte const> data, size_t size) -> std::vector<std::byte>
+    {
+        auto result = std::vector<std::byte>(size);
+        auto resultSize = static_cast<uLongf>(size);
+        if (uncompress(reinterpret_cast<Bytef*>(result.data()), &resultSize, reinterpret_cast<Bytef const*>(data.data()), static_cast<uLong>(data.size())) != Z_OK
+            || resultSize != size) {
+            throw CC_FileException("Bad resource", INGL_POOL);
+        }
+        return result;
+    }
+}
+
+auto ResourceCache::Find(std::span<std::byte const> data, uint64_t hash) const -> std::optional<Entry>
+{
+    auto lock = std::lock_guard{ mMutex };
+    auto [first, last] = mEntries.equal_range(hash);
+    for (auto&& entry : std::ranges::subrange(first, last) | std::views::values) {
+        if (entry.data->data() == data.data() || std::ranges::equal(*entry.data, data)) {
+            return entry;
+        }
+    }
+    return std::nullopt;
+}
+
+auto ResourceCache::Find(ResourceBytes const& data) const -> std::optional<std::pair<uint64_t, Entry>>
+{
+    auto lock = std::lock_guard{ mMutex };
+    if (auto found = std::ranges::find(mEntries, data, [](auto&& entry) -> ResourceBytes const& { return entry.second.data; }); found != mEntries.end()) {
+        return *found;
+    }
+    return std::nullopt;
+}
+
+void ResourceCache::Add(uint64_t hash, Entry entry)
+{
+    auto lock = std::lock_guard{ mMutex };
+    mEntries.emplace(hash, std::move(entry));
+}
+
+void ResourceCache::Replace(std::multimap<uint64_t, Entry> entries)
+{
+    auto lock = std::lock_guard{ mMutex };
+    mEntries = std::move(entries);
+}
+
+ResourcePoolWriter::ResourcePoolWriter(std::shared_ptr<ResourceCache> cache)
+    : mCache(std::move(cache))
+{
+}
+
+auto ResourcePoolWriter::Find(std::span<std::byte const> data, uint64_t hash) const -> std::optional<uint32_t>
+{
+    auto [first, last] = mIndexByHash.equal_range(hash);
+    for (auto which : std::ranges::subrange(first, last) | std::views::values) {
+        if (mResources.at(which)->data() == data.data() || std::ranges::equal(*mResources.at(which), data)) {
+            return which;
+        }
+    }
+    return std::nullopt;
+}
+
+auto ResourcePoolWriter::Add(ResourceBytes data) -> uint32_t
+{
+    // an image on many sheets shares its bytes, and with what the last save wrote, so it's usually found
+    // without looking at them.
+    if (auto found = std::ranges::find(mResources, data); found != mResources.end()) {
+        return static_cast<uint32_t>(std::distance(mResources.begin(), found));
+    }
+    if (auto cached = mCache ? mCache->Find(data) : std::nullopt; cached) {
+        auto&& [hash, entry] = *cached;
+        if (auto which = Find(*data, hash); which) {
+            return *which;
+        }
+        return Add(std::move(data), hash, entry.compressed);
+    }
+    auto hash = HashBytes(*data);
+    if (auto which = Find(*data, hash); which) {
+        return *which;
+    }
+    auto cached = mCache ? mCache->Find(*data, hash) : std::nullopt;
+    return Add(std::move(data), hash, cached ? std::optional{ cached->compressed } : std::nullopt);
+}
+
+auto ResourcePoolWriter::Add(std::span<std::byte const> data) -> uint32_t
+{
+    auto hash = HashBytes(data);
+    if (auto which = Find(data, hash); which) {
+        return *which;
+    }
+    if (auto cached = mCache ? mCache->Find(data, hash) : std::nullopt; cached) {
+        return Add(cached->data, hash, cached->compressed);
+    }
+    return Add(std::make_shared<std::vector<std::byte> const>(data.begin(), data.end()), hash, std::nullopt);
+}
+
+auto ResourcePoolWriter::Add(ResourceBytes data, uint64_t hash, std::optional<ResourceBytes> compressed) -> uint32_t
+{
+    auto which = static_cast<uint32_t>(mResources.size());
+    if (compressed) {
+        mCompressed.push_back(std::async(std::launch::deferred, [compressed = *compressed] { return compressed; }).share());
+    } else if (data->size() >= kCompressAsyncSize && TryStartCompressing()) {
+        mCompressed.push_back(std::async(std::launch::async, [data] {
+            struct Done {
+                ~Done() { --sCompressing; }
+            } done;
+            return Compress(*data);
+        }).share());
+    } else {
+        mCompressed.push_back(std::async(std::launch::deferred, [data] { return Compress(*data); }).share());
+    }
+    mResources.push_back(std::move(data));
+    mHashes.push_back(hash);
+    mIndexByHash.emplace(hash, which);
+    return which;
+}
+
+void ResourcePoolWriter::Serialize(std::vector<std::byte>& result) const
+{
+    auto written = std::multimap<uint64_t, ResourceCache::Entry>{};
+    Parser::Append(result, static_cast<uint32_t>(mResources.size()));
+    for (auto which : std::views::iota(0UL, mResources.size())) {
+        auto const& resource = mResources.at(which);
+        auto const& compressed = mCompressed.at(which).get();
+        auto stored = compressed ? std::span{ *compressed } : std::span{ *resource };
+        Parser::Append(result, static_cast<uint32_t>(resource->size()));
+        Parser::Append(result, static_cast<uint32_t>(stored.size()));
+        Parser::Append(result, stored);
+        written.emplace(mHashes.at(which), ResourceCache::Entry{ resource, compressed });
+    }
+    if (mCache) {
+        mCache->Replace(std::move(written));
+    }
+}
+
+ResourcePool::ResourcePool(Reader reader, std::shared_ptr<ResourceCache> cache)
+{
+    try {
+        auto count = reader.Get<uint32_t>();
+        for ([[maybe_unused]] auto which : std::views::iota(0U, count)) {
+            auto size = reader.Get<uint32_t>();
+            auto storedSize = reader.Get<uint32_t>();
+            // what's stored is never larger than the resource, and the size is checked before anything is
+            // allocated for it.
+            if (storedSize > size || size > kMaxResourceSize || size > storedSize * kMaxExpansion) {
+                throw CC_FileException("Bad resource size", INGL_POOL);
+            }
+            auto stored = reader.first(storedSize).GetBytes();
+            reader = reader.subspan(storedSize);
+            // the file's bytes are gone once the show is read, so what was stored is kept until it's needed.
+            auto kept = std::make_shared<std::vector<std::byte> const>(stored.begin(), stored.end());
+            if (storedSize == size) {
+                mResources.emplace_back(std::function<ResourceBytes()>{ [kept, cache] {
+                    if (cache) {
+                        cache->Add(HashBytes(*kept), { kept, nullptr });
+                    }
+                    return kept;
+                } });
+                continue;
+            }
+            mResources.emplace_back(std::function<ResourceBytes()>{ [kept, size, cache] {
+                auto result = std::make_shared<std::vector<std::byte> const>(Uncompress(*kept, size));
+                if (cache) {
+                    cache->Add(HashBytes(*result), { result, kept });
+                }
+                return result;
+            } });
+        }
+    } catch (std::runtime_error const&) {
+        throw CC_FileException("Bad resource pool", INGL_POOL);
+    }
+    if (reader.size() != 0) {
+        throw CC_FileException("Bad resource pool", INGL_POOL);
+    }
+}
+
+auto ResourcePool::Get(uint32_t which) const -> ResourceBytes const&
+{
+    if (which >= mResources.size()) {
+        throw CC_FileException("No such resource", INGL_POOL);
+    }
+    return mResources.at(which).Get();
+}
+
+}
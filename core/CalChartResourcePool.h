@@ -0,0 +1,124 @@
+#pragma once
+/*
+ * CalChartResourcePool.h
+ * Keeps the large things in a show file (background images, media) once, compressed
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * Resource pool
+ *
+ * A show often has the same background image on many sheets.  Instead of writing the pixels into every
+ * sheet, a show file keeps each distinct image (and the media) once in a POOL block, compressed with zlib,
+ * and the sheets refer to them by index.
+ *
+ * ResourcePoolWriter collects the resources while the show is written: adding the same bytes twice gives
+ * back the same index, and large resources start compressing as soon as they are added.  ResourcePool reads
+ * the POOL block back, and only uncompresses a resource the first time it is asked for, so sheets read on
+ * several threads can share it.
+ *
+ * Compressing is most of the time a save takes, and the images seldom change from one save to the next, so
+ * a show keeps a ResourceCache of what it last compressed.  The pool it was read from fills it in, and each
+ * save uses it and leaves behind what it wrote.  The images and media share their buffers with the cache, so
+ * a save finds them there by buffer, without hashing or comparing their bytes.
+ *
+ * The pool is what changed the file version to 3.9: a show keeps its images and media only in the pool, so
+ * earlier versions, which would skip it, ask before opening the show.  Shows from before 3.9 have them
+ * inline, and are read that way.
+ */
+
+#include "CalChartLazy.h"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace CalChart {
+
+class Reader;
+
+using ResourceBytes = std::shared_ptr<std::vector<std::byte> const>;
+
+class ResourceCache {
+public:
+    struct Entry {
+        ResourceBytes data;
+        // null when compressing doesn't make the resource smaller.
+        ResourceBytes compressed;
+    };
+
+    [[nodiscard]] auto Find(std::span<std::byte const> data, uint64_t hash) const -> std::optional<Entry>;
+    // finds the entry holding this very buffer, along with its hash, without looking at the bytes.
+    [[nodiscard]] auto Find(ResourceBytes const& data) const -> std::optional<std::pair<uint64_t, Entry>>;
+    void Add(uint64_t hash, Entry entry);
+    // forgets everything else.
+    void Replace(std::multimap<uint64_t, Entry> entries);
+
+private:
+    mutable std::mutex mMutex;
+    std::multimap<uint64_t, Entry> mEntries;
+};
+
+class ResourcePoolWriter {
+public:
+    explicit ResourcePoolWriter(std::shared_ptr<ResourceCache> cache = {});
+
+    // Gives back the index the data is stored under.
+    [[nodiscard]] auto Add(ResourceBytes data) -> uint32_t;
+    // data is only copied if it isn't already in the pool or the cache.
+    [[nodiscard]] auto Add(std::span<std::byte const> data) -> uint32_t;
+    [[nodiscard]] auto empty() const { return mResources.empty(); }
+
+    // appends the POOL block's data to result, and leaves what was compressed in the cache.
+    void Serialize(std::vector<std::byte>& result) const;
+
+private:
+    [[nodiscard]] auto Find(std::span<std::byte const> data, uint64_t hash) const -> std::optional<uint32_t>;
+    // compressed is what the cache has for data, if it has it.
+    auto Add(ResourceBytes data, uint64_t hash, std::optional<ResourceBytes> compressed) -> uint32_t;
+
+    std::shared_ptr<ResourceCache> mCache;
+    std::vector<ResourceBytes> mResources;
+    std::vector<std::shared_future<ResourceBytes>> mCompressed;
+    std::vector<uint64_t> mHashes;
+    std::multimap<uint64_t, uint32_t> mIndexByHash;
+};
+
+class ResourcePool {
+public:
+    ResourcePool() = default;
+    // reads the POOL block's data.  throws CC_FileException if it is malformed.  Resources are added to the
+    // cache as they are uncompressed.
+    explicit ResourcePool(Reader reader, std::shared_ptr<ResourceCache> cache = {});
+
+    // throws CC_FileException if there is no such resource, or it can't be uncompressed.
+    [[nodiscard]] auto Get(uint32_t which) const -> ResourceBytes const&;
+    [[nodiscard]] auto size() const { return mResources.size(); }
+
+private:
+    std::vector<Lazy<ResourceBytes>> mResources;
+};
+
+}
@@ -334,12 +334,17 @@ auto Curve::LowerControlPointOnLine(Coord point, Coord::units searchBound) const
 auto Curve::Serialize() const -> std::vector<std::byte>
 {
     auto result = std::vector<std::byte>{};
+    Serialize(result);
+    return result;
+}
+
+void Curve::Serialize(std::vector<std::byte>& result) const
+{
     Parser::Append(result, static_cast<int32_t>(mControlPoints.size()));
     for (auto&& point : mControlPoints) {
         Parser::Append(result, static_cast<int32_t>(point.x));
         Parser::Append(result, static_cast<int32_t>(point.y));
     }
-    return result;
 }
 
 void Curve::Regenerate()
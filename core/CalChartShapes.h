@@ -362,6 +362,8 @@ public:
     [[nodiscard]] auto LowerControlPointOnLine(Coord point, Coord::units searchBound) const -> std::optional<std::tuple<size_t, double>>;
 
     [[nodiscard]] auto Serialize() const -> std::vector<std::byte>;
+    // appends what Serialize returns to result.
+    void Serialize(std::vector<std::byte>& result) const;
 
     void Regenerate();
 
@@ -24,6 +24,7 @@
 
 #include "CalChartSheet.h"
 #include "CalChartConfiguration.h"
+#include "CalChartDisplayList.h"
 #include "CalChartFileFormat.h"
 #include "CalChartRanges.h"
 #include "CalChartShow.h"
@@ -34,6 +35,7 @@
 #include <functional>
 #include <iostream>
 #include <map>
+#include <span>
 #include <sstream>
 
 namespace CalChart {
@@ -46,16 +48,21 @@ std::array<std::string, MAX_NUM_SYMBOLS> const long_contnames = {
     "Plain", "Solid", "Backslash", "Slash", "Crossed", "Solid Backslash", "Solid Slash", "Solid Crossed"
 };
 
+Sheet::Contents::Contents(size_t numPoints)
+    : mPoints(numPoints)
+{
+}
+
 Sheet::Sheet(size_t numPoints)
     : mBeats(1)
-    , mPoints(numPoints)
+    , mContents(Contents{ numPoints })
 {
 }
 
 Sheet::Sheet(size_t numPoints, std::string name)
     : mBeats(1)
-    , mPoints(numPoints)
     , mName(std::move(name))
+    , mContents(Contents{ numPoints })
 {
 }
 
@@ -151,8 +158,9 @@ namespace {
 // Constructor for shows 3.3 and ealier.
 // intentionally a reference to Reader.
 Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErrorHandlers const* correction)
-    : mPoints(numPoints)
+    : mContents(Contents{ numPoints })
 {
+    auto& points = GetContents().mPoints;
     // Read in sheet name
     // <INGL_NAME><size><string + 1>
     auto data = reader.ReadCheckIDandFillData(INGL_NAME);
@@ -166,17 +174,17 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
     // Point positions
     // <INGL_DURA><size><data>
     data = reader.ReadCheckIDandFillData(INGL_POS);
-    if (data.size() != size_t(mPoints.size() * 4)) {
+    if (data.size() != size_t(points.size() * 4)) {
         throw CC_FileException("bad POS chunk");
     }
     {
         auto reader = CalChart::Reader({ data.data(), data.size() });
-        for (unsigned i = 0; i < mPoints.size(); ++i) {
+        for (unsigned i = 0; i < points.size(); ++i) {
             auto x = reader.Get<int16_t>();
             auto y = reader.Get<int16_t>();
             auto c = Coord(x, y);
             for (unsigned j = 0; j <= Point::kNumRefPoints; j++) {
-                mPoints[i].SetPos(c, j);
+                points[i].SetPos(c, j);
             }
         }
     }
@@ -185,26 +193,26 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
     // read all the reference points
     while (INGL_REFP == name) {
         auto size = reader.Get<uint32_t>();
-        if (size != mPoints.size() * 4 + 2) {
+        if (size != points.size() * 4 + 2) {
             throw CC_FileException("Bad REFP chunk");
         }
         auto ref = reader.Get<uint16_t>();
-        for (unsigned i = 0; i < mPoints.size(); i++) {
+        for (unsigned i = 0; i < points.size(); i++) {
             auto x = reader.Get<int16_t>();
             auto y = reader.Get<int16_t>();
             auto c = Coord(x, y);
-            mPoints[i].SetPos(c, ref);
+            points[i].SetPos(c, ref);
         }
         name = reader.Get<uint32_t>();
     }
     // Point symbols
     while (INGL_SYMB == name) {
         std::vector<uint8_t> data = reader.GetVector<uint8_t>();
-        if (data.size() != mPoints.size()) {
+        if (data.size() != points.size()) {
             throw CC_FileException("Bad SYMB chunk");
         }
         uint8_t* d = &data[0];
-        for (unsigned i = 0; i < mPoints.size(); i++) {
+        for (unsigned i = 0; i < points.size(); i++) {
             SetSymbol(i, (SYMBOL_TYPE)(*(d++)));
         }
         name = reader.Get<uint32_t>();
@@ -216,11 +224,11 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
     while (INGL_TYPE == name) {
         has_type = true;
         std::vector<uint8_t> data = reader.GetVector<uint8_t>();
-        if (data.size() != mPoints.size()) {
+        if (data.size() != points.size()) {
             throw CC_FileException("Bad TYPE chunk");
         }
         uint8_t* d = &data[0];
-        for (unsigned i = 0; i < mPoints.size(); i++) {
+        for (unsigned i = 0; i < points.size(); i++) {
             CheckInconsistancy(GetSymbol(i), *(d++), continity_for_symbol,
                 symbol_for_continuity, mName, i);
         }
@@ -230,7 +238,7 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
     // if it isn't used
     if (!has_type) {
         // when a point doesn't have a cont_index, it is assumed to be 0
-        for (unsigned i = 0; i < mPoints.size(); i++) {
+        for (unsigned i = 0; i < points.size(); i++) {
             CheckInconsistancy(GetSymbol(i), 0, continity_for_symbol,
                 symbol_for_continuity, mName, i);
         }
@@ -238,13 +246,13 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
     // Point labels (left or right)
     while (INGL_LABL == name) {
         std::vector<uint8_t> data = reader.GetVector<uint8_t>();
-        if (data.size() != mPoints.size()) {
+        if (data.size() != points.size()) {
             throw CC_FileException("Bad SYMB chunk");
         }
         uint8_t* d = &data[0];
-        for (unsigned i = 0; i < mPoints.size(); i++) {
+        for (unsigned i = 0; i < points.size(); i++) {
             if (*(d++)) {
-                mPoints.at(i).Flip();
+                points.at(i).Flip();
             }
         }
         name = reader.Get<uint32_t>();
@@ -288,15 +296,14 @@ Sheet::Sheet(Version_3_3_and_earlier, size_t numPoints, Reader& reader, ParseErr
             }
         }
         std::string textstr(text);
-        mAnimationContinuity.at(symbol_index) = Continuity{ textstr, correction };
+        GetContents().mAnimationContinuity.at(symbol_index) = Continuity{ textstr, correction };
 
         name = reader.Get<uint32_t>();
     }
 }
 // -=-=-=-=-=- LEGACY CODE</end> -=-=-=-=-=-
 
-Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correction)
-    : mPoints(numPoints)
+Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correction, SheetLoading loading, std::shared_ptr<ResourcePool const> pool, ShowFileBytes file)
 {
     // construct the parser handlers
     auto parse_INGL_NAME = [](Sheet* sheet, Reader reader) {
@@ -327,20 +334,59 @@ Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correcti
             sheet->mFermata[beat] = Seconds{ secondsValue };
         }
     };
-    auto parse_INGL_PNTS = [](Sheet* sheet, Reader reader) {
-        for (auto i = 0u; i < sheet->mPoints.size(); ++i) {
+
+    std::map<uint32_t, std::function<void(Sheet*, Reader)>> const
+        parser
+        = {
+              { INGL_NAME, parse_INGL_NAME },
+              { INGL_DURA, parse_INGL_DURA },
+              { INGL_TMPO, parse_INGL_TMPO },
+              { INGL_FERM, parse_INGL_FERM },
+          };
+
+    // ParseOutLabels uses up the reader, and the contents need to read it from the start.
+    auto table = Reader{ reader }.ParseOutLabels();
+    for (auto& i : table) {
+        auto the_parser = parser.find(std::get<0>(i));
+        if (the_parser != parser.end()) {
+            the_parser->second(this, std::get<1>(i));
+        }
+    }
+
+    // the correction handlers are only around while the show is read, so if continuity text might need
+    // correcting it has to be parsed now.
+    auto hasContinuityText = std::ranges::any_of(table, [](auto&& i) { return std::get<0>(i) == INGL_CONT; });
+    if (loading == SheetLoading::Lazy && !(correction && hasContinuityText)) {
+        auto bytes = reader.GetBytes();
+        if (!file) {
+            file = std::make_shared<std::vector<std::byte> const>(bytes.begin(), bytes.end());
+        }
+        auto offset = bytes.empty() ? 0 : static_cast<size_t>(bytes.data() - file->data());
+        mContents = Lazy<Contents>(std::function<Contents()>{ [numPoints, file, offset, length = bytes.size(), version = reader.GetVersion(), pool] {
+            return ParseContents(numPoints, Reader(std::span{ *file }.subspan(offset, length), version), nullptr, pool.get());
+        } });
+        return;
+    }
+    mContents = Lazy<Contents>(ParseContents(numPoints, reader, correction, pool.get()));
+}
+
+auto Sheet::ParseContents(size_t numPoints, Reader reader, ParseErrorHandlers const* correction, ResourcePool const* pool) -> Contents
+{
+    // construct the parser handlers
+    auto parse_INGL_PNTS = [](Contents& contents, Reader reader) {
+        for (auto i = 0u; i < contents.mPoints.size(); ++i) {
             auto this_size = reader.Get<uint8_t>();
             if (this_size > reader.size()) {
                 throw CC_FileException("Incorrect size", INGL_PNTS);
             }
-            sheet->mPoints[i] = Point(reader.first(this_size));
+            contents.mPoints[i] = Point(reader.first(this_size));
             reader = reader.subspan(this_size);
         }
         if (reader.size() != 0) {
             throw CC_FileException("Incorrect size", INGL_PNTS);
         }
     };
-    auto parse_INGL_ECNT = [correction](Sheet* sheet, Reader reader) {
+    auto parse_INGL_ECNT = [correction](Contents& contents, Reader reader) {
         if (reader.size() < 2) // one byte num + 1 nil minimum
         {
             throw CC_FileException("Bad cont chunk", INGL_ECNT);
@@ -350,10 +396,10 @@ Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correcti
             throw CC_FileException("No viable symbol for name", INGL_ECNT);
         }
         auto text = reader.Get<std::string>();
-        sheet->mAnimationContinuity.at(symbol_index) = Continuity{ text, correction };
+        contents.mAnimationContinuity.at(symbol_index) = Continuity{ text, correction };
     };
-    auto parse_INGL_CONT = [parse_INGL_ECNT](Sheet* sheet, Reader reader) {
-        const std::map<uint32_t, std::function<void(Sheet*, Reader)>>
+    auto parse_INGL_CONT = [parse_INGL_ECNT](Contents& contents, Reader reader) {
+        const std::map<uint32_t, std::function<void(Contents&, Reader)>>
             parser = {
                 { INGL_ECNT, parse_INGL_ECNT },
             };
@@ -362,11 +408,11 @@ Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correcti
         for (auto& i : table) {
             auto the_parser = parser.find(std::get<0>(i));
             if (the_parser != parser.end()) {
-                the_parser->second(sheet, std::get<1>(i));
+                the_parser->second(contents, std::get<1>(i));
             }
         }
     };
-    auto parse_INGL_EVCT = [](Sheet* sheet, Reader reader) {
+    auto parse_INGL_EVCT = [](Contents& contents, Reader reader) {
         if (reader.size() < 1) // one byte for symbol
         {
             throw CC_FileException("Bad cont chunk", INGL_EVCT);
@@ -375,10 +421,10 @@ Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correcti
         if (symbol_index >= MAX_NUM_SYMBOLS) {
             throw CC_FileException("No viable symbol for name", INGL_EVCT);
         }
-        sheet->mAnimationContinuity.at(symbol_index) = Continuity{ reader };
+        contents.mAnimationContinuity.at(symbol_index) = Continuity{ reader };
     };
-    auto parse_INGL_VCNT = [parse_INGL_EVCT](Sheet* sheet, Reader reader) {
-        std::map<uint32_t, std::function<void(Sheet*, Reader)>> const
+    auto parse_INGL_VCNT = [parse_INGL_EVCT](Contents& contents, Reader reader) {
+        std::map<uint32_t, std::function<void(Contents&, Reader)>> const
             parser
             = {
                   { INGL_EVCT, parse_INGL_EVCT },
@@ -388,116 +434,133 @@ Sheet::Sheet(size_t numPoints, Reader reader, ParseErrorHandlers const* correcti
         for (auto& i : table) {
             auto the_parser = parser.find(std::get<0>(i));
             if (the_parser != parser.end()) {
-                the_parser->second(sheet, std::get<1>(i));
+                the_parser->second(contents, std::get<1>(i));
             }
         }
     };
-    auto parse_INGL_PCNT = [](Sheet* sheet, Reader reader) {
+    auto parse_INGL_PCNT = [](Contents& contents, Reader reader) {
         auto print_name = reader.Get<std::string>();
         auto print_cont = reader.Get<std::string>();
         if (reader.size() != 0) {
             throw CC_FileException("Bad Print cont chunk", INGL_PCNT);
         }
-        sheet->mPrintableContinuity = PrintContinuity(print_name, print_cont);
+        contents.mPrintableContinuity = PrintContinuity(print_name, print_cont);
     };
-    auto parse_INGL_BACK = [](Sheet* sheet, Reader reader) {
+    auto parse_INGL_BACK = [](Contents& contents, Reader reader) {
         auto num = reader.Get<int32_t>();
         while (num--) {
             auto [image, new_reader] = CreateImageInfo(reader);
-            sheet->mBackgroundImages.push_back(image);
+            contents.mBackgroundImages.Mutable().push_back(image);
             reader = new_reader;
         }
         if (reader.size() != 0) {
             throw CC_FileException("Bad Background chunk", INGL_BACK);
         }
     };
-    auto parse_INGL_CURV = [](Sheet* sheet, Reader reader) {
+    auto parse_INGL_BKRF = [pool](Contents& contents, Reader reader) {
+        if (!pool) {
+            throw CC_FileException("Background reference without a pool", INGL_BKRF);
+        }
+        // the images share their bytes with the pool.
+        auto toImageBytes = [pool](uint32_t which) { return ImageBytes{ pool->Get(which) }; };
+        auto num = reader.Get<int32_t>();
+        while (num--) {
+            auto left = reader.Get<int32_t>();
+            auto top = reader.Get<int32_t>();
+            auto scaledWidth = reader.Get<int32_t>();
+            auto scaledHeight = reader.Get<int32_t>();
+            auto width = reader.Get<int32_t>();
+            auto height = reader.Get<int32_t>();
+            auto data = toImageBytes(reader.Get<uint32_t>());
+            auto alpha = toImageBytes(reader.Get<uint32_t>());
+            contents.mBackgroundImages.Mutable().push_back(ImageInfo{ left, top, scaledWidth, scaledHeight, ImageData{ width, height, std::move(data), std::move(alpha), nullptr } });
+        }
+        if (reader.size() != 0) {
+            throw CC_FileException("Bad Background reference chunk", INGL_BKRF);
+        }
+    };
+    auto parse_INGL_CURV = [](Contents& contents, Reader reader) {
         auto num = reader.Get<int32_t>();
         while (num--) {
             auto [curve, new_reader] = CreateCurve(reader);
-            sheet->mCurves.push_back(std::pair<Curve, std::vector<MarcherIndex>>{ curve, {} });
+            contents.mCurves.push_back(std::pair<Curve, std::vector<MarcherIndex>>{ curve, {} });
             reader = new_reader;
         }
         if (reader.size() != 0) {
             throw CC_FileException("Bad curve chunk", INGL_BACK);
         }
     };
-    auto parse_INGL_CASS = [](Sheet* sheet, Reader reader) {
+    auto parse_INGL_CASS = [](Contents& contents, Reader reader) {
         auto num = reader.Get<int32_t>();
         for (auto which = 0; which < num; ++which) {
-            sheet->mCurves.at(which).second = reader.GetVector<uint32_t>();
+            contents.mCurves.at(which).second = reader.GetVector<uint32_t>();
         }
         if (reader.size() != 0) {
             throw CC_FileException("Bad Curve Assignment chunk", INGL_BACK);
         }
     };
 
-    std::map<uint32_t, std::function<void(Sheet*, Reader)>> const
+    std::map<uint32_t, std::function<void(Contents&, Reader)>> const
         parser
         = {
-              { INGL_NAME, parse_INGL_NAME },
-              { INGL_DURA, parse_INGL_DURA },
-              { INGL_TMPO, parse_INGL_TMPO },
-              { INGL_FERM, parse_INGL_FERM },
               { INGL_PNTS, parse_INGL_PNTS },
               { INGL_CONT, parse_INGL_CONT },
               { INGL_VCNT, parse_INGL_VCNT },
               { INGL_PCNT, parse_INGL_PCNT },
               { INGL_BACK, parse_INGL_BACK },
+              { INGL_BKRF, parse_INGL_BKRF },
               { INGL_CURV, parse_INGL_CURV },
               { INGL_CASS, parse_INGL_CASS },
           };
 
+    auto contents = Contents{ numPoints };
     auto table = reader.ParseOutLabels();
     for (auto& i : table) {
         auto the_parser = parser.find(std::get<0>(i));
         if (the_parser != parser.end()) {
-            the_parser->second(this, std::get<1>(i));
+            the_parser->second(contents, std::get<1>(i));
         }
     }
-    RepositionCurveMarchers();
+    RepositionCurveMarchers(contents);
+    return contents;
 }
 
-auto Sheet::SerializeAllPoints() const -> std::vector<std::byte>
+auto Sheet::GetContents() const -> Contents const& { return mContents.Get(); }
+auto Sheet::GetContents() -> Contents& { return mContents.Mutable(); }
+
+void Sheet::SerializeAllPoints(std::vector<std::byte>& result) const
 {
     // for each of the points, serialize them.  Don't need to wrap in block
     // because it's not specified that way
-    std::vector<std::byte> result;
-    for (auto&& i : mPoints) {
-        Parser::Append(result, i.Serialize());
+    for (auto&& i : GetContents().mPoints) {
+        i.Serialize(result);
     }
-    return result;
 }
 
-auto Sheet::SerializeContinuityData() const -> std::vector<std::byte>
+void Sheet::SerializeContinuityData(std::vector<std::byte>& result) const
 {
     // for each continuity in use, serialize them.
-    std::vector<std::byte> result;
     for (auto& current_symbol : k_symbols) {
         if (ContinuityInUse(current_symbol)) {
-            std::vector<std::byte> continuity;
-            Parser::Append(continuity, static_cast<uint8_t>(current_symbol));
-            Parser::Append(continuity, mAnimationContinuity.at(current_symbol).Serialize());
-            Parser::Append(result, Parser::Construct_block(INGL_EVCT, continuity));
+            Parser::AppendBlock(result, INGL_EVCT, [this, current_symbol](auto& continuity) {
+                Parser::Append(continuity, static_cast<uint8_t>(current_symbol));
+                GetContents().mAnimationContinuity.at(current_symbol).Serialize(continuity);
+            });
         }
     }
-    return result;
 }
 
-auto Sheet::SerializePrintContinuityData() const -> std::vector<std::byte>
+void Sheet::SerializePrintContinuityData(std::vector<std::byte>& result) const
 {
-    std::vector<std::byte> result;
     Parser::AppendAndNullTerminate(
-        result, mPrintableContinuity.GetPrintNumber());
+        result, GetContents().mPrintableContinuity.GetPrintNumber());
     Parser::AppendAndNullTerminate(
-        result, mPrintableContinuity.GetOriginalLine());
-    return result;
+        result, GetContents().mPrintableContinuity.GetOriginalLine());
 }
 
-auto Sheet::SerializeFermata() const -> std::vector<std::byte>
+void Sheet::SerializeFermata(std::vector<std::byte>& result) const
 {
     // Serialize as: count (uint32_t), then pairs of (beat: uint32_t, Seconds: float)
-    std::vector<std::byte> result;
     Parser::Append(result, static_cast<uint32_t>(mFermata.size()));
     for (auto const& [beat, secondsValue] : mFermata) {
         if (secondsValue == CalChart::Seconds::zero())
@@ -505,81 +568,91 @@ auto Sheet::SerializeFermata() const -> std::vector<std::byte>
         Parser::Append(result, static_cast<uint32_t>(beat));
         Parser::Append(result, secondsValue.count());
     }
-    return result;
 }
 
-auto Sheet::SerializeBackgroundImageInfo() const -> std::vector<std::byte>
+void Sheet::SerializeBackgroundImageInfo(std::vector<std::byte>& result) const
 {
-    std::vector<std::byte> result;
-    Parser::Append(result, static_cast<uint32_t>(mBackgroundImages.size()));
-    for (auto&& i : mBackgroundImages) {
-        Parser::Append(result, Serialize(i));
+    auto const& images = GetContents().mBackgroundImages.Get();
+    Parser::Append(result, static_cast<uint32_t>(images.size()));
+    for (auto&& i : images) {
+        Serialize(i, result);
     }
-    return result;
 }
 
-auto Sheet::SerializeCurves() const -> std::vector<std::byte>
+void Sheet::SerializeBackgroundImageReferences(std::vector<std::byte>& result, ResourcePoolWriter& pool) const
 {
-    std::vector<std::byte> result;
-    Parser::Append(result, static_cast<uint32_t>(mCurves.size()));
-    for (auto&& [curve, marchers] : mCurves) {
-        Parser::Append(result, curve.Serialize());
+    auto const& images = GetContents().mBackgroundImages.Get();
+    Parser::Append(result, static_cast<uint32_t>(images.size()));
+    for (auto&& image : images) {
+        Parser::Append(result, uint32_t(image.left));
+        Parser::Append(result, uint32_t(image.top));
+        Parser::Append(result, uint32_t(image.scaledWidth));
+        Parser::Append(result, uint32_t(image.scaledHeight));
+        Parser::Append(result, uint32_t(image.data.width));
+        Parser::Append(result, uint32_t(image.data.height));
+        Parser::Append(result, pool.Add(image.data.data.Bytes()));
+        Parser::Append(result, pool.Add(image.data.alpha.Bytes()));
     }
-    return result;
 }
 
-auto Sheet::SerializeCurveAssigments() const -> std::vector<std::byte>
+void Sheet::SerializeCurves(std::vector<std::byte>& result) const
 {
-    std::vector<std::byte> result;
-    Parser::Append(result, static_cast<uint32_t>(mCurves.size()));
-    for (auto&& [curve, marchers] : mCurves) {
+    Parser::Append(result, static_cast<uint32_t>(GetContents().mCurves.size()));
+    for (auto&& [curve, marchers] : GetContents().mCurves) {
+        curve.Serialize(result);
+    }
+}
+
+void Sheet::SerializeCurveAssigments(std::vector<std::byte>& result) const
+{
+    Parser::Append(result, static_cast<uint32_t>(GetContents().mCurves.size()));
+    for (auto&& [curve, marchers] : GetContents().mCurves) {
         Parser::Append(result, static_cast<uint32_t>(marchers.size()));
         Parser::Append(result, marchers);
     }
-    return result;
 }
 
-auto Sheet::SerializeSheetData() const -> std::vector<std::byte>
+void Sheet::SerializeSheetData(std::vector<std::byte>& result, ResourcePoolWriter* pool) const
 {
     // SHEET_DATA         = NAME , DURATION , TEMPO , ALL_POINTS , CONTINUITY,
     // PRINT_CONTINUITY ;
 
-    std::vector<std::byte> result;
+    // each block is written straight into result.
     // Write NAME
-    std::vector<std::byte> tstring;
-    Parser::AppendAndNullTerminate(tstring, GetName());
-    Parser::Append(
-        result, Parser::Construct_block(INGL_NAME, tstring));
+    Parser::AppendBlock(result, INGL_NAME, [this](auto& name) {
+        Parser::AppendAndNullTerminate(name, GetName());
+    });
 
     // Write DURATION
-    Parser::Append(result, Parser::Construct_block(INGL_DURA, uint32_t{ GetBeats() }));
+    Parser::AppendBlock(result, INGL_DURA, uint32_t{ GetBeats() });
     // Write TEMPO
-    Parser::Append(result, Parser::Construct_block(INGL_TMPO, uint32_t{ GetTempo() }));
+    Parser::AppendBlock(result, INGL_TMPO, uint32_t{ GetTempo() });
 
     // Write FERMATA
     if (!mFermata.empty()) {
-        Parser::Append(result, Parser::Construct_block(INGL_FERM, SerializeFermata()));
+        Parser::AppendBlock(result, INGL_FERM, [this](auto& data) { SerializeFermata(data); });
     }
 
     // Write ALL_POINTS
-    Parser::Append(result, Parser::Construct_block(INGL_PNTS, SerializeAllPoints()));
+    Parser::AppendBlock(result, INGL_PNTS, [this](auto& data) { SerializeAllPoints(data); });
 
     // Write Continuity
-    Parser::Append(result, Parser::Construct_block(INGL_VCNT, SerializeContinuityData()));
+    Parser::AppendBlock(result, INGL_VCNT, [this](auto& data) { SerializeContinuityData(data); });
 
     // Write Continuity
-    Parser::Append(result,
-        Parser::Construct_block(
-            INGL_PCNT, SerializePrintContinuityData()));
+    Parser::AppendBlock(result, INGL_PCNT, [this](auto& data) { SerializePrintContinuityData(data); });
 
     // Write Background
-    Parser::Append(result, Parser::Construct_block(INGL_BACK, SerializeBackgroundImageInfo()));
+    // in a show the images are kept in its pool; a sheet on its own keeps them inline.
+    if (!pool) {
+        Parser::AppendBlock(result, INGL_BACK, [this](auto& data) { SerializeBackgroundImageInfo(data); });
+    } else if (!GetContents().mBackgroundImages.Get().empty()) {
+        Parser::AppendBlock(result, INGL_BKRF, [this, pool](auto& data) { SerializeBackgroundImageReferences(data, *pool); });
+    }
 
     // Write Curves
-    Parser::Append(result, Parser::Construct_block(INGL_CURV, SerializeCurves()));
-    Parser::Append(result, Parser::Construct_block(INGL_CASS, SerializeCurveAssigments()));
-
-    return result;
+    Parser::AppendBlock(result, INGL_CURV, [this](auto& data) { SerializeCurves(data); });
+    Parser::AppendBlock(result, INGL_CASS, [this](auto& data) { SerializeCurveAssigments(data); });
 }
 
 // SHEET              = INGL_SHET , BigEndianInt32(DataTill_SHEET_END) ,
@@ -590,14 +663,32 @@ auto Sheet::SerializeSheetData() const -> std::vector<std::byte>
 auto Sheet::SerializeSheet() const -> std::vector<std::byte>
 {
     std::vector<std::byte> result;
-    Parser::Append(result, Parser::Construct_block(INGL_SHET, SerializeSheetData()));
+    result.reserve(SerializedSizeHint());
+    SerializeSheet(result);
+    return result;
+}
+
+void Sheet::SerializeSheet(std::vector<std::byte>& result, ResourcePoolWriter* pool) const
+{
+    Parser::AppendBlock(result, INGL_SHET, [this, pool](auto& data) { SerializeSheetData(data, pool); });
+}
+
+auto Sheet::SerializedSizeHint() const -> size_t
+{
+    // a point is at most 19 bytes, and the rest of the sheet besides the images is usually small.
+    constexpr auto kBytesPerPoint = 19;
+    constexpr auto kBytesForTheRest = 1024;
+    auto result = GetContents().mPoints.size() * kBytesPerPoint + kBytesForTheRest;
+    for (auto&& image : GetContents().mBackgroundImages.Get()) {
+        result += image.data.data.size() + image.data.alpha.size() + kBytesForTheRest;
+    }
     return result;
 }
 
 // Find point at certain coords
 auto Sheet::FindMarcher(Coord where, Coord::units searchBound, unsigned ref) const -> std::optional<MarcherIndex>
 {
-    for (auto i : std::views::iota(0ul, mPoints.size())) {
+    for (auto i : std::views::iota(0ul, GetContents().mPoints.size())) {
         Coord c = GetMarcherPosition(i, ref);
         if (((where.x + searchBound) >= c.x) && ((where.x - searchBound) <= c.x) && ((where.y + searchBound) >= c.y) && ((where.y - searchBound) <= c.y)) {
             return i;
@@ -608,7 +699,7 @@ auto Sheet::FindMarcher(Coord where, Coord::units searchBound, unsigned ref) con
 
 auto Sheet::FindCurveControlPoint(Coord where, Coord::units searchBound) const -> std::optional<std::tuple<size_t, size_t>>
 {
-    for (auto&& [whichCurve, curve] : CalChart::Ranges::enumerate_view(mCurves)) {
+    for (auto&& [whichCurve, curve] : CalChart::Ranges::enumerate_view(GetContents().mCurves)) {
         auto&& points = curve.first.GetControlPoints();
         if (auto iter = std::find_if(points.begin(), points.end(), [where, searchBound](auto point) {
                 return ((where.x + searchBound) >= point.x) && ((where.x - searchBound) <= point.x) && ((where.y + searchBound) >= point.y) && ((where.y - searchBound) <= point.y);
@@ -622,7 +713,7 @@ auto Sheet::FindCurveControlPoint(Coord where, Coord::units searchBound) const -
 
 auto Sheet::FindCurve(Coord where, Coord::units searchBound) const -> std::optional<std::tuple<size_t, size_t, double>>
 {
-    for (auto&& [whichCurve, curve] : CalChart::Ranges::enumerate_view(mCurves)) {
+    for (auto&& [whichCurve, curve] : CalChart::Ranges::enumerate_view(GetContents().mCurves)) {
         auto result = curve.first.LowerControlPointOnLine(where, searchBound);
         if (result.has_value()) {
             return std::tuple<size_t, size_t, double>{ whichCurve, std::get<0>(*result), std::get<1>(*result) };
@@ -633,13 +724,13 @@ auto Sheet::FindCurve(Coord where, Coord::units searchBound) const -> std::optio
 
 auto Sheet::GetCurveAssignments() const -> std::vector<std::vector<MarcherIndex>>
 {
-    return CalChart::Ranges::ToVector<std::vector<MarcherIndex>>(mCurves | std::views::transform([](auto&& curve) { return curve.second; }));
+    return CalChart::Ranges::ToVector<std::vector<MarcherIndex>>(GetContents().mCurves | std::views::transform([](auto&& curve) { return curve.second; }));
 }
 
 void Sheet::SetCurveAssignment(std::vector<std::vector<MarcherIndex>> curveAssignments)
 {
     for (auto&& [which, marchers] : CalChart::Ranges::enumerate_view(curveAssignments)) {
-        mCurves.at(which).second = marchers;
+        GetContents().mCurves.at(which).second = marchers;
     }
     RepositionCurveMarchers();
 }
@@ -664,7 +755,7 @@ auto Sheet::GetCurveAssignmentsWithNewAssignments(size_t whichCurve, std::vector
 void Sheet::UnassignMarchersFromAnyCurve(std::vector<MarcherIndex> marchers)
 {
     for (auto marcher : marchers) {
-        for (auto& [curve, marchers] : mCurves) {
+        for (auto& [curve, marchers] : GetContents().mCurves) {
             marchers.erase(std::remove(marchers.begin(), marchers.end(), marcher), marchers.end());
         }
     }
@@ -674,7 +765,7 @@ auto Sheet::MakeSelectPointsBySymbol(SYMBOL_TYPE i) const -> SelectionList
 {
     SelectionList select;
     std::ranges::for_each(
-        std::views::iota(0ul, mPoints.size())
+        std::views::iota(0ul, GetContents().mPoints.size())
             | std::views::filter([&](MarcherIndex j) { return GetSymbol(j) == i; }),
         [&](MarcherIndex j) { select.insert(j); });
     return select;
@@ -682,7 +773,8 @@ auto Sheet::MakeSelectPointsBySymbol(SYMBOL_TYPE i) const -> SelectionList
 
 auto Sheet::NewNumPointsPositions(int num, int columns, Coord new_march_position) const -> std::vector<Point>
 {
-    std::vector<Point> newpts(mPoints.begin(), mPoints.begin() + std::min<size_t>(mPoints.size(), num));
+    auto&& points = GetContents().mPoints;
+    std::vector<Point> newpts(points.begin(), points.begin() + std::min<size_t>(points.size(), num));
     auto c = new_march_position;
     auto col = 0;
     auto num_left = num - newpts.size();
@@ -703,7 +795,8 @@ void Sheet::DeletePoints(SelectionList const& sl)
 {
     UnassignMarchersFromAnyCurve({ sl.begin(), sl.end() });
     for (auto iter = sl.rbegin(); iter != sl.rend(); ++iter) {
-        mPoints.erase(mPoints.begin() + *iter);
+        auto& points = GetContents().mPoints;
+        points.erase(points.begin() + *iter);
     }
     RepositionCurveMarchers();
 }
@@ -711,43 +804,46 @@ void Sheet::DeletePoints(SelectionList const& sl)
 // modifying curves means reseting all the points
 void Sheet::AddCurve(Curve const& curve, size_t index)
 {
-    mCurves.insert(mCurves.begin() + index, std::pair<Curve, std::vector<MarcherIndex>>{ curve, {} });
+    auto& curves = GetContents().mCurves;
+    curves.insert(curves.begin() + index, std::pair<Curve, std::vector<MarcherIndex>>{ curve, {} });
 }
 
 void Sheet::RemoveCurve(size_t index)
 {
-    mCurves.erase(mCurves.cbegin() + index);
+    auto& curves = GetContents().mCurves;
+    curves.erase(curves.cbegin() + index);
 }
 
 void Sheet::ReplaceCurve(Curve const& curve, size_t index)
 {
-    mCurves.at(index).first = curve;
+    GetContents().mCurves.at(index).first = curve;
     RepositionCurveMarchers();
 }
 
-auto Sheet::GetCurve(size_t index) const -> Curve { return mCurves.at(index).first; }
-auto Sheet::GetNumberCurves() const -> size_t { return mCurves.size(); }
+auto Sheet::GetCurve(size_t index) const -> Curve { return GetContents().mCurves.at(index).first; }
+auto Sheet::GetNumberCurves() const -> size_t { return GetContents().mCurves.size(); }
 
 auto Sheet::RemapPoints(std::vector<MarcherIndex> const& table) const -> std::vector<Point>
 {
-    if (mPoints.size() != table.size()) {
+    auto&& points = GetContents().mPoints;
+    if (points.size() != table.size()) {
         throw std::runtime_error("wrong size for Relabel");
     }
-    std::vector<Point> newpts(mPoints.size());
+    std::vector<Point> newpts(points.size());
     for (size_t i = 0; i < newpts.size(); i++) {
-        newpts.at(i) = mPoints.at(table.at(i));
+        newpts.at(i) = points.at(table.at(i));
     }
     return newpts;
 }
 
 void Sheet::SetContinuity(SYMBOL_TYPE which, Continuity const& new_cont)
 {
-    mAnimationContinuity.at(which) = new_cont;
+    GetContents().mAnimationContinuity.at(which) = new_cont;
 }
 
 auto Sheet::ContinuityInUse(SYMBOL_TYPE idx) const -> bool
 {
-    auto points = std::vector<int>(mPoints.size());
+    auto points = std::vector<int>(GetContents().mPoints.size());
     std::iota(points.begin(), points.end(), 0);
     // is any point using this symbol?
     for (auto& point : points) {
@@ -764,57 +860,58 @@ void Sheet::SetName(std::string const& newname) { mName = newname; }
 
 auto Sheet::GetPrintNumber() const -> std::string
 {
-    return mPrintableContinuity.GetPrintNumber();
+    return GetContents().mPrintableContinuity.GetPrintNumber();
 }
 
 std::string Sheet::GetRawPrintContinuity() const
 {
-    return mPrintableContinuity.GetOriginalLine();
+    return GetContents().mPrintableContinuity.GetOriginalLine();
 }
 
 // Get position of point
 auto Sheet::GetMarcherPosition(MarcherIndex i, unsigned ref) const -> Coord
 {
-    return mPoints[i].GetPos(ref);
+    return GetContents().mPoints[i].GetPos(ref);
 }
 
 auto Sheet::GetAllMarcherPositions(unsigned ref) const -> std::vector<Coord>
 {
-    return CalChart::Ranges::ToVector<Coord>(mPoints | std::views::transform([ref](auto&& point) { return point.GetPos(ref); }));
+    return CalChart::Ranges::ToVector<Coord>(GetContents().mPoints | std::views::transform([ref](auto&& point) { return point.GetPos(ref); }));
 }
 
 // Set position of point
 void Sheet::SetPosition(Coord val, MarcherIndex i, unsigned ref)
 {
-    SetPositionHelper(val, i, ref);
+    SetPositionHelper(GetContents(), val, i, ref);
     if (ref == 0) {
         UnassignMarchersFromAnyCurve({ i });
         RepositionCurveMarchers();
     }
 }
 
-void Sheet::SetPositionHelper(Coord val, MarcherIndex i, unsigned ref)
+void Sheet::SetPositionHelper(Contents& contents, Coord val, MarcherIndex i, unsigned ref)
 {
+    auto& point = contents.mPoints[i];
     if (ref == 0) {
         for (auto j = 1; j <= Point::kNumRefPoints; j++) {
-            if (mPoints[i].GetPos(j) == mPoints[i].GetPos(0)) {
-                mPoints[i].SetPos(val, j);
+            if (point.GetPos(j) == point.GetPos(0)) {
+                point.SetPos(val, j);
             }
         }
-        mPoints[i].SetPos(val);
+        point.SetPos(val);
     } else {
-        mPoints[i].SetPos(val, ref);
+        point.SetPos(val, ref);
     }
 }
 
 void Sheet::SetPrintableContinuity(std::string const& name, std::string const& lines)
 {
-    mPrintableContinuity = PrintContinuity(name, lines);
+    GetContents().mPrintableContinuity = PrintContinuity(name, lines);
 }
 
 auto Sheet::GetPrintableContinuity() const -> Textline_list
 {
-    return mPrintableContinuity.GetChunks();
+    return GetContents().mPrintableContinuity.GetChunks();
 }
 
 // sheet beat info (tempo, fermata info)
@@ -828,27 +925,28 @@ void Sheet::SetSheetBeatInfo(SheetBeatInfo const& value)
     std::tie(mTempo, mFermata) = value;
 }
 
-auto Sheet::GetMarcher(MarcherIndex i) const -> Point { return mPoints[i]; }
+auto Sheet::GetMarcher(MarcherIndex i) const -> Point { return GetContents().mPoints[i]; }
 
 void Sheet::SetSymbol(MarcherIndex i, SYMBOL_TYPE sym)
 {
-    mPoints[i].SetSymbol(sym);
+    GetContents().mPoints[i].SetSymbol(sym);
 }
 
 void Sheet::SetMarcherFlip(MarcherIndex i, bool val)
 {
-    mPoints.at(i).Flip(val);
+    GetContents().mPoints.at(i).Flip(val);
 }
 
 void Sheet::SetMarcherLabelVisibility(MarcherIndex i, bool isVisible)
 {
-    mPoints.at(i).SetLabelVisibility(isVisible);
+    GetContents().mPoints.at(i).SetLabelVisibility(isVisible);
 }
 
 auto Sheet::GetSymbols() const -> std::vector<SYMBOL_TYPE>
 {
     std::vector<SYMBOL_TYPE> result;
-    std::transform(mPoints.begin(), mPoints.end(), std::back_inserter(result), [](auto&& i) { return i.GetSymbol(); });
+    auto&& points = GetContents().mPoints;
+    std::transform(points.begin(), points.end(), std::back_inserter(result), [](auto&& i) { return i.GetSymbol(); });
     return result;
 }
 
@@ -866,7 +964,7 @@ auto Sheet::toOnlineViewerJSON(unsigned sheetNum, std::vector<std::string> dotLa
     std::map<std::string, std::string> labelToSymbol;
     std::map<std::string, std::vector<std::string>> continuities;
 
-    for (unsigned i = 0; i < mPoints.size(); i++) {
+    for (unsigned i = 0; i < GetContents().mPoints.size(); i++) {
         auto symbolName = ToOnlineViewer::symbolName(GetSymbol(i));
         uniqueDotTypes.insert(symbolName);
         labelToSymbol[dotLabels[i]] = symbolName;
@@ -945,6 +1043,43 @@ namespace {
         };
     }
 
+    // adds the same thing as GenerateSheetMarcherDrawCommands to result.
+    void AddSheetMarcherDrawCommands(
+        CalChart::Draw::DisplayList& result,
+        CalChart::Configuration const& config,
+        CalChart::SelectionList const& selection_list,
+        std::vector<std::string> const& labels,
+        std::vector<CalChart::Point> const& points,
+        int ref,
+        std::array<Colors, 4> color)
+    {
+        auto dotRatio = config.Get_DotRatio();
+        auto pLineRatio = config.Get_PLineRatio();
+        auto sLineRatio = config.Get_SLineRatio();
+        auto addMarcher = [&](auto which) {
+            points.at(which).AddDrawCommands(result, ref, labels.at(which), dotRatio, pLineRatio, sLineRatio);
+        };
+
+        result.Push(CalChart::Font{ Float2CoordUnits(dotRatio * config.Get_NumRatio()) });
+        result.Push(config.Get_CalChartBrushAndPen(std::get<0>(color)));
+        result.PushTextForeground(config.Get_CalChartBrushAndPen(std::get<2>(color)));
+        for (auto which = MarcherIndex{}; which < labels.size(); ++which) {
+            if (!selection_list.contains(which)) {
+                addMarcher(which);
+            }
+        }
+        result.Pop();
+        result.Pop();
+        result.Push(config.Get_CalChartBrushAndPen(std::get<1>(color)));
+        result.PushTextForeground(config.Get_CalChartBrushAndPen(std::get<3>(color)));
+        for (auto which : selection_list) {
+            addMarcher(which);
+        }
+        result.Pop();
+        result.Pop();
+        result.Pop();
+    }
+
     auto GenerateCurvePoints(std::vector<CalChart::Coord> const& points, Coord::units boxSize) -> std::vector<CalChart::Draw::DrawCommand>
     {
         return CalChart::Ranges::ToVector<CalChart::Draw::DrawCommand>(points | std::views::transform([boxSize](auto&& point) {
@@ -970,6 +1105,24 @@ namespace {
         return drawCmds;
     }
 
+    // adds the same thing as GenerateCurve to result.
+    void AddCurveDrawCommands(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, CalChart::Curve const& curve, int which)
+    {
+        auto boxSize = CalChart::Float2CoordUnits(config.Get_ControlPointRatio());
+        auto points = curve.GetControlPoints();
+        result.Push(config.Get_CalChartBrushAndPen(CalChart::Colors::SHEET_CURVE));
+        result.Add(curve.GetCC_DrawCommand());
+        result.Pop();
+        result.Push(config.Get_CalChartBrushAndPen(CalChart::Colors::SHEET_CURVE_CONTROL_POINT));
+        for (auto&& point : points) {
+            result.Add(CalChart::Draw::Rectangle(point - Coord(boxSize, boxSize) / 2, Coord(boxSize, boxSize)));
+        }
+        result.Pop();
+        if (points.size()) {
+            result.AddText(points.front(), std::string("C") + std::to_string(which));
+        }
+    }
+
 }
 
 auto Sheet::GenerateGhostElements(CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels) const -> std::vector<CalChart::Draw::DrawCommand>
@@ -986,34 +1139,56 @@ auto Sheet::GenerateSheetElements(CalChart::Configuration const& config, Selecti
     }
     CalChart::append(drawCmds, GenerateSheetMarcherDrawCommands(config, selected, marcherLabels, *this, referencePoint, GetMarcherColors(false, false)));
 
-    for (auto&& [which, curve] : CalChart::Ranges::enumerate_view(mCurves)) {
+    for (auto&& [which, curve] : CalChart::Ranges::enumerate_view(GetContents().mCurves)) {
         CalChart::append(drawCmds, GenerateCurve(config, curve.first, which));
     }
     return drawCmds;
 }
 
-void Sheet::SetMarchers(std::vector<Point> const& points) { mPoints = points; }
+void Sheet::GenerateGhostElements(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels) const
+{
+    AddSheetMarcherDrawCommands(result, config, selected, marcherLabels, GetContents().mPoints, 0, GetMarcherColors(true, false));
+}
+
+void Sheet::GenerateSheetElements(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels, int referencePoint) const
+{
+    auto&& points = GetContents().mPoints;
+    if (referencePoint > 0) {
+        // if we are editing a ref point other than 0, draw the 0 one in a different color.
+        AddSheetMarcherDrawCommands(result, config, selected, marcherLabels, points, 0, GetMarcherColors(false, true));
+    }
+    AddSheetMarcherDrawCommands(result, config, selected, marcherLabels, points, referencePoint, GetMarcherColors(false, false));
+
+    for (auto&& [which, curve] : CalChart::Ranges::enumerate_view(GetContents().mCurves)) {
+        AddCurveDrawCommands(result, config, curve.first, which);
+    }
+}
+
+void Sheet::SetMarchers(std::vector<Point> const& points) { GetContents().mPoints = points; }
 
 void Sheet::AddBackgroundImage(ImageInfo const& image, size_t where)
 {
-    auto insert_point = mBackgroundImages.begin() + std::min(where, mBackgroundImages.size());
-    mBackgroundImages.insert(insert_point, image);
+    auto& images = GetContents().mBackgroundImages.Mutable();
+    auto insert_point = images.begin() + std::min(where, images.size());
+    images.insert(insert_point, image);
 }
 
 void Sheet::RemoveBackgroundImage(size_t which)
 {
-    if (which < mBackgroundImages.size()) {
-        mBackgroundImages.erase(mBackgroundImages.begin() + which);
+    auto& images = GetContents().mBackgroundImages.Mutable();
+    if (which < images.size()) {
+        images.erase(images.begin() + which);
     }
 }
 
 void Sheet::MoveBackgroundImage(size_t which, int left, int top, int scaled_width, int scaled_height)
 {
-    if (which < mBackgroundImages.size()) {
-        mBackgroundImages.at(which).left = left;
-        mBackgroundImages.at(which).top = top;
-        mBackgroundImages.at(which).scaledWidth = scaled_width;
-        mBackgroundImages.at(which).scaledHeight = scaled_height;
+    auto& images = GetContents().mBackgroundImages.Mutable();
+    if (which < images.size()) {
+        images.at(which).left = left;
+        images.at(which).top = top;
+        images.at(which).scaledWidth = scaled_width;
+        images.at(which).scaledHeight = scaled_height;
     }
 }
 
@@ -1043,11 +1218,11 @@ auto Sheet::ShouldPrintLandscape() const -> bool
     return (boundingBox.second.x - boundingBox.first.x) > CalChart::Int2CoordUnits(CalChart::kFieldStepSizeNorthSouth[0]);
 }
 
-void Sheet::RepositionCurveMarchers()
+void Sheet::RepositionCurveMarchers(Contents& contents)
 {
-    for (auto&& [curve, marchers] : mCurves) {
+    for (auto&& [curve, marchers] : contents.mCurves) {
         for (auto&& [where, marcher] : CalChart::Ranges::zip_view(curve.GetPointsOnLine(marchers.size()), marchers)) {
-            SetPositionHelper(where, marcher);
+            SetPositionHelper(contents, where, marcher);
         }
     }
 }
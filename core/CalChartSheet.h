@@ -33,12 +33,15 @@
 #include "CalChartCoord.h"
 #include "CalChartFileFormat.h"
 #include "CalChartImage.h"
+#include "CalChartLazy.h"
 #include "CalChartPoint.h"
+#include "CalChartResourcePool.h"
 #include "CalChartText.h"
 #include "CalChartTypes.h"
 
 #include <cstddef>
 #include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <ranges>
@@ -52,6 +55,18 @@ class Reader;
 class Curve;
 struct ParseErrorHandlers;
 
+// Sheets read from a file can be decoded all at once, or only have their name and timing read and the
+// rest decoded the first time something looks at it.  Problems in a lazily read sheet are thrown from
+// whatever first looks.
+enum class SheetLoading {
+    Eager,
+    Lazy,
+};
+
+// the whole file a lazily read show came from.  Each lazy sheet keeps where it is in here rather than a
+// copy of its bytes.
+using ShowFileBytes = std::shared_ptr<std::vector<std::byte> const>;
+
 // error occurred on parsing.  First arg is what went wrong, second is the values that need to be fixed.
 class Sheet {
 public:
@@ -59,25 +74,34 @@ public:
     Sheet(size_t numPoints, std::string name);
     // intentionally a reference to Reader.
     Sheet(Version_3_3_and_earlier, size_t numPoints, Reader&, ParseErrorHandlers const* correction = nullptr);
-    Sheet(size_t numPoints, Reader, ParseErrorHandlers const* correction = nullptr);
+    // background images in a show file can refer to the show's resource pool.  When given, file is what the
+    // reader reads out of.
+    Sheet(size_t numPoints, Reader, ParseErrorHandlers const* correction = nullptr, SheetLoading loading = SheetLoading::Eager, std::shared_ptr<ResourcePool const> pool = {}, ShowFileBytes file = {});
 
 private:
-    [[nodiscard]] auto SerializeAllPoints() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeContinuityData() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializePrintContinuityData() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeFermata() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeBackgroundImageInfo() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeCurves() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeCurveAssigments() const -> std::vector<std::byte>;
-    [[nodiscard]] auto SerializeSheetData() const -> std::vector<std::byte>;
+    // each of these appends its part of the sheet to result.
+    void SerializeAllPoints(std::vector<std::byte>& result) const;
+    void SerializeContinuityData(std::vector<std::byte>& result) const;
+    void SerializePrintContinuityData(std::vector<std::byte>& result) const;
+    void SerializeFermata(std::vector<std::byte>& result) const;
+    void SerializeBackgroundImageInfo(std::vector<std::byte>& result) const;
+    void SerializeBackgroundImageReferences(std::vector<std::byte>& result, ResourcePoolWriter& pool) const;
+    void SerializeCurves(std::vector<std::byte>& result) const;
+    void SerializeCurveAssigments(std::vector<std::byte>& result) const;
+    void SerializeSheetData(std::vector<std::byte>& result, ResourcePoolWriter* pool) const;
 
 public:
     [[nodiscard]] auto SerializeSheet() const -> std::vector<std::byte>;
+    // appends what SerializeSheet returns to result.  With a pool, the background images are added to it and
+    // the sheet only refers to them; a show writes its sheets this way.
+    void SerializeSheet(std::vector<std::byte>& result, ResourcePoolWriter* pool = nullptr) const;
+    // about how many bytes SerializeSheet will write, for reserving room ahead of time.
+    [[nodiscard]] auto SerializedSizeHint() const -> size_t;
 
     // continuity Functions
     [[nodiscard]] auto GetContinuityBySymbol(SYMBOL_TYPE i) const
     {
-        return mAnimationContinuity.at(i);
+        return GetContents().mAnimationContinuity.at(i);
     }
     [[nodiscard]] auto GetContinuities() const
     {
@@ -95,7 +119,7 @@ public:
     [[nodiscard]] auto GetPrintableContinuity() const -> Textline_list;
     [[nodiscard]] auto GetPrintNumber() const -> std::string;
     [[nodiscard]] auto GetRawPrintContinuity() const -> std::string;
-    [[nodiscard]] auto GetPrintContinuity() const { return mPrintableContinuity; }
+    [[nodiscard]] auto GetPrintContinuity() const { return GetContents().mPrintableContinuity; }
 
     // beats
     [[nodiscard]] auto GetBeats() const { return mBeats; }
@@ -112,16 +136,19 @@ public:
 
     // Marchers
     [[nodiscard]] auto GetMarcher(MarcherIndex i) const -> Point;
-    [[nodiscard]] auto GetAllMarchers() const { return mPoints; }
-    [[nodiscard]] auto GetSymbol(MarcherIndex i) const { return mPoints[i].GetSymbol(); }
+    [[nodiscard]] auto GetAllMarchers() const { return GetContents().mPoints; }
+    [[nodiscard]] auto GetSymbol(MarcherIndex i) const { return GetContents().mPoints[i].GetSymbol(); }
     void SetSymbol(MarcherIndex i, SYMBOL_TYPE sym);
-    [[nodiscard]] auto GetNumberPoints() const { return mPoints.size(); }
+    [[nodiscard]] auto GetNumberPoints() const { return GetContents().mPoints.size(); }
     [[nodiscard]] auto GetSymbols() const -> std::vector<SYMBOL_TYPE>;
     void SetPoints(std::vector<Point> const& points);
     [[nodiscard]] auto FindMarcher(Coord where, Coord::units searchBound, unsigned ref = 0) const -> std::optional<MarcherIndex>;
     [[nodiscard]] auto RemapPoints(std::vector<MarcherIndex> const& table) const -> std::vector<Point>;
     [[nodiscard]] auto GetMarcherPosition(MarcherIndex i, unsigned ref = 0) const -> Coord;
     [[nodiscard]] auto GetAllMarcherPositions(unsigned ref = 0) const -> std::vector<Coord>;
+    // Copies of a sheet have the same ContentsIdentity until the marchers, continuities, images or curves of
+    // one of them are changed, so while a copy is held the same identity means the same contents.
+    [[nodiscard]] auto ContentsIdentity() const { return mContents.Identity(); }
     void SetMarchers(std::vector<Point> const& points);
     void SetAllPositions(Coord val, unsigned i);
     void SetPosition(Coord val, MarcherIndex i, unsigned ref = 0);
@@ -155,19 +182,17 @@ public:
     // image
     [[nodiscard]] auto GetBackgroundImages() const -> std::vector<ImageInfo>
     {
-        return mBackgroundImages;
+        return GetContents().mBackgroundImages.Get();
     }
     [[nodiscard]] auto GetBackgroundImage(size_t which) const -> ImageInfo
     {
-        return mBackgroundImages.at(which);
+        return GetContents().mBackgroundImages.Get().at(which);
     }
-    [[nodiscard]] auto GetNumberBackgroundImages() const { return mBackgroundImages.size(); }
+    [[nodiscard]] auto GetNumberBackgroundImages() const { return GetContents().mBackgroundImages.Get().size(); }
     [[nodiscard]] auto GetBackgroundImageInfo(size_t which) const -> std::array<int, 4>
     {
-        return { mBackgroundImages.at(which).left,
-            mBackgroundImages.at(which).top,
-            mBackgroundImages.at(which).scaledWidth,
-            mBackgroundImages.at(which).scaledHeight };
+        auto&& image = GetContents().mBackgroundImages.Get().at(which);
+        return { image.left, image.top, image.scaledWidth, image.scaledHeight };
     }
     void AddBackgroundImage(ImageInfo const& image, size_t where);
     void RemoveBackgroundImage(size_t which);
@@ -175,6 +200,9 @@ public:
 
     [[nodiscard]] auto ShouldPrintLandscape() const -> bool;
 
+    // false for a lazily read sheet that nothing has looked inside of yet.
+    [[nodiscard]] auto IsDecoded() const { return mContents.HasValue(); }
+
     /*!
      * @brief Generates a JSON that could represent this
      * sheet in an Online Viewer '.viewer' file.
@@ -192,20 +220,36 @@ public:
     // the sheet can generate all the elements related to sheet specific draw aspects
     [[nodiscard]] auto GenerateGhostElements(CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels) const -> std::vector<CalChart::Draw::DrawCommand>;
     [[nodiscard]] auto GenerateSheetElements(CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels, int referencePoint) const -> std::vector<CalChart::Draw::DrawCommand>;
+    // add the same things to result, for drawing every frame without building DrawCommands.
+    void GenerateGhostElements(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels) const;
+    void GenerateSheetElements(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, SelectionList const& selected, std::vector<std::string> const& marcherLabels, int referencePoint) const;
 
 private:
-    std::array<Continuity, MAX_NUM_SYMBOLS> mAnimationContinuity;
-    PrintContinuity mPrintableContinuity;
+    // Everything but the name and timing, which is what gets put off when a sheet is read lazily.
+    // Copies of a sheet share their Contents until one of them is changed.  The continuities share their parsed
+    // procedures and the images share their pixels, so even then only the points and curves are copied.
+    struct Contents {
+        explicit Contents(size_t numPoints = 0);
+
+        std::array<Continuity, MAX_NUM_SYMBOLS> mAnimationContinuity;
+        PrintContinuity mPrintableContinuity;
+        std::vector<Point> mPoints;
+        Lazy<std::vector<ImageInfo>> mBackgroundImages;
+        std::vector<std::pair<Curve, std::vector<MarcherIndex>>> mCurves; // curves and the points assigned to them.
+    };
+    [[nodiscard]] static auto ParseContents(size_t numPoints, Reader reader, ParseErrorHandlers const* correction, ResourcePool const* pool) -> Contents;
+    [[nodiscard]] auto GetContents() const -> Contents const&;
+    [[nodiscard]] auto GetContents() -> Contents&;
+
     Beats mBeats{};
     Tempo mTempo = 120;
     Fermatas mFermata; // Map of beat to fermata hold time in Seconds
-    std::vector<Point> mPoints;
     std::string mName;
-    std::vector<ImageInfo> mBackgroundImages;
-    std::vector<std::pair<Curve, std::vector<MarcherIndex>>> mCurves; // curves and the points assigned to them.
+    Lazy<Contents> mContents;
 
-    void RepositionCurveMarchers();
-    void SetPositionHelper(Coord val, MarcherIndex i, unsigned ref = 0);
+    static void RepositionCurveMarchers(Contents& contents);
+    void RepositionCurveMarchers() { RepositionCurveMarchers(GetContents()); }
+    static void SetPositionHelper(Contents& contents, Coord val, MarcherIndex i, unsigned ref = 0);
     void UnassignMarchersFromAnyCurve(std::vector<MarcherIndex> marchers);
 };
 
@@ -28,16 +28,22 @@
 #include "CalChartFileFormat.h"
 #include "CalChartPoint.h"
 #include "CalChartRanges.h"
+#include "CalChartResourcePool.h"
 #include "CalChartShapes.h"
 #include "CalChartSheet.h"
+#include "CalChartUndoHistory.h"
 #include "ccvers.h"
 #include "e7_transition_solver.h"
 
 #include <algorithm>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <iterator>
+#include <optional>
 #include <ranges>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace CalChart {
@@ -61,15 +67,108 @@ std::unique_ptr<Show> Show::Create(ShowMode const& mode, std::vector<std::pair<s
     return show;
 }
 
-std::unique_ptr<Show> Show::Create(ShowMode const& mode, std::istream& stream, ParseErrorHandlers const* correction)
+namespace {
+    // Read everything left in the stream with bulk reads.  If the stream can tell us how much is left we
+    // allocate that up front, otherwise we grow as we go.
+    auto ReadAll(std::istream& stream) -> std::vector<std::byte>
+    {
+        constexpr auto kReadSize = std::streamsize{ 64 * 1024 };
+        auto data = std::vector<std::byte>{};
+        if (auto start = stream.tellg(); start != std::streampos(-1) && stream.seekg(0, std::ios::end)) {
+            auto end = stream.tellg();
+            stream.seekg(start);
+            if (end != std::streampos(-1) && end > start) {
+                data.reserve(static_cast<size_t>(end - start));
+            }
+        }
+        stream.clear();
+        while (stream) {
+            auto readSize = std::max(kReadSize, static_cast<std::streamsize>(data.capacity() - data.size()));
+            auto oldSize = data.size();
+            data.resize(oldSize + static_cast<size_t>(readSize));
+            stream.read(reinterpret_cast<char*>(data.data() + oldSize), readSize);
+            data.resize(oldSize + static_cast<size_t>(stream.gcount()));
+        }
+        return data;
+    }
+
+    // Sheets don't depend on each other, so they are read a group per thread.  Correcting a continuity
+    // asks the user, so the threads read without the correction handler and any sheet they can't read is
+    // read again afterwards, one at a time, with it.
+    auto ReadSheets(size_t numPoints, std::vector<Reader> const& readers, ParseErrorHandlers const* correction, SheetLoading loading, std::shared_ptr<ResourcePool const> const& pool, ShowFileBytes const& file, unsigned numberThreads) -> std::vector<Sheet>
+    {
+        auto const canCorrect = correction && correction->mContinuityParseCorrectionHandler;
+        // the correction handler asks the user, so it is only called from this thread, one sheet at a time and in
+        // order, as a serial read would.  Sheets read on the other threads don't try to correct; the ones that fail
+        // are read again here with the handler, so a sheet that needs correcting is parsed twice.
+        // an empty set of handlers still has sheets with continuity text read up front, so a bad continuity
+        // throws here rather than whenever the sheet is first looked at.
+        auto const noCorrection = ParseErrorHandlers{};
+        auto const* threadCorrection = canCorrect ? &noCorrection : correction;
+        auto readSheets = [numPoints, &readers, threadCorrection, canCorrect, loading, &pool, &file](size_t first, size_t last) {
+            return CalChart::Ranges::ToVector<std::optional<Sheet>>(std::views::iota(first, last) | std::views::transform([numPoints, &readers, threadCorrection, canCorrect, loading, &pool, &file](auto whichSheet) -> std::optional<Sheet> {
+                try {
+                    return Sheet(numPoints, readers.at(whichSheet), threadCorrection, loading, pool, file);
+                } catch (std::exception const&) {
+                    if (!canCorrect) {
+                        throw;
+                    }
+                    return std::nullopt;
+                }
+            }));
+        };
+        if (numberThreads == 0) {
+            numberThreads = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+        numberThreads = static_cast<unsigned>(std::min<size_t>(numberThreads, readers.size()));
+        auto sheets = std::vector<std::optional<Sheet>>{};
+        if (numberThreads <= 1) {
+            sheets = readSheets(0, readers.size());
+        } else {
+            auto const sheetsPerThread = (readers.size() + numberThreads - 1) / numberThreads;
+            auto futures = std::vector<std::future<std::vector<std::optional<Sheet>>>>{};
+            for (auto first = sheetsPerThread; first < readers.size(); first += sheetsPerThread) {
+                futures.push_back(std::async(std::launch::async, readSheets, first, std::min(first + sheetsPerThread, readers.size())));
+            }
+            sheets = readSheets(0, sheetsPerThread);
+            for (auto&& future : futures) {
+                std::ranges::move(future.get(), std::back_inserter(sheets));
+            }
+        }
+        return CalChart::Ranges::ToVector<Sheet>(std::views::iota(0UL, sheets.size()) | std::views::transform([numPoints, &readers, correction, loading, &pool, &file, &sheets](auto whichSheet) {
+            if (auto& sheet = sheets.at(whichSheet); sheet) {
+                return std::move(*sheet);
+            }
+            return Sheet(numPoints, readers.at(whichSheet), correction, loading, pool, file);
+        }));
+    }
+}
+
+std::unique_ptr<Show> Show::Create(ShowMode const& mode, std::istream& stream, ParseErrorHandlers const* correction, SheetLoading loading, unsigned numberThreads)
 {
-    // read the whole stream into a block, making sure we don't skip white space
-    stream.unsetf(std::ios::skipws);
-    auto data = std::vector<std::byte>{};
-    std::transform(std::istream_iterator<char>{ stream }, std::istream_iterator<char>{}, std::back_inserter(data), [](auto b) { return static_cast<std::byte>(b); });
+    auto data = ReadAll(stream);
     // wxWidgets doesn't like it when we've reach the end of file.  Remove flags
     stream.clear();
-    auto reader = Reader({ data.data(), data.size() });
+    if (loading == SheetLoading::Lazy) {
+        auto file = std::make_shared<std::vector<std::byte> const>(std::move(data));
+        return CreateFromFile(mode, *file, file, correction, loading, numberThreads);
+    }
+    return CreateFromFile(mode, data, {}, correction, loading, numberThreads);
+}
+
+std::unique_ptr<Show> Show::Create(ShowMode const& mode, std::span<std::byte const> data, ParseErrorHandlers const* correction, SheetLoading loading, unsigned numberThreads)
+{
+    // lazy sheets outlive data, so they need their own copy of it.
+    if (loading == SheetLoading::Lazy) {
+        auto file = std::make_shared<std::vector<std::byte> const>(data.begin(), data.end());
+        return CreateFromFile(mode, *file, file, correction, loading, numberThreads);
+    }
+    return CreateFromFile(mode, data, {}, correction, loading, numberThreads);
+}
+
+std::unique_ptr<Show> Show::CreateFromFile(ShowMode const& mode, std::span<std::byte const> data, ShowFileBytes file, ParseErrorHandlers const* correction, SheetLoading loading, unsigned numberThreads)
+{
+    auto reader = Reader(data);
 
     reader.ReadAndCheckID(INGL_INGL);
     auto version = reader.ReadGurkSymbolAndGetVersion(INGL_GURK);
@@ -87,7 +186,7 @@ std::unique_ptr<Show> Show::Create(ShowMode const& mode, std::istream& stream, P
 
     // debug purposes, you can uncomment this line to have the show dumped
     //	DoRecursiveParsing("", data.data(), data.data() + data.size());
-    return std::unique_ptr<Show>(new Show(mode, reader, correction));
+    return std::unique_ptr<Show>(new Show(mode, reader, correction, loading, numberThreads, std::move(file)));
 }
 
 // Create a new show
@@ -147,7 +246,7 @@ Show::Show(Version_3_3_and_earlier, ShowMode const& mode, Reader reader, ParseEr
         reader.ReadAndCheckID(INGL_SHET);
 
         Sheet sheet(Version_3_3_and_earlier{}, GetNumPoints(), reader, correction);
-        InsertSheet(sheet, GetNumSheets());
+        InsertSheet(std::move(sheet), GetNumSheets());
 
         // ReadAndCheckID(stream, INGL_END);
         reader.ReadAndCheckID(INGL_SHET);
@@ -162,7 +261,7 @@ Show::Show(Version_3_3_and_earlier, ShowMode const& mode, Reader reader, ParseEr
 }
 // -=-=-=-=-=- LEGACY CODE </end>-=-=-=-=-=-
 
-Show::Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correction)
+Show::Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correction, SheetLoading loading, unsigned numberThreads, ShowFileBytes file)
     : Show(mode)
 {
     // caller should have stripped off INGL and GURK headers
@@ -213,10 +312,14 @@ Show::Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correc
         }
         show.SetDescr(str);
     };
-    auto parse_INGL_SHET = [correction](Show& show, Reader reader) {
-        Sheet sheet(show.GetNumPoints(), reader, correction);
+    auto parse_INGL_SHETs = [correction, loading, numberThreads, file](Show& show, std::vector<Reader> const& readers, std::shared_ptr<ResourcePool const> const& pool) {
+        if (readers.empty()) {
+            return;
+        }
         auto sheet_num = show.GetCurrentSheetNum();
-        show.InsertSheet(sheet, show.GetNumSheets());
+        for (auto&& sheet : ReadSheets(show.GetNumPoints(), readers, correction, loading, pool, file, numberThreads)) {
+            show.InsertSheet(std::move(sheet), show.GetNumSheets());
+        }
         show.SetCurrentSheet(sheet_num);
     };
     auto parse_INGL_SELE = [](Show& show, Reader reader) {
@@ -237,29 +340,51 @@ Show::Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correc
         show.mMode = ShowMode::CreateShowMode(reader);
     };
     auto parse_INGL_MEDIA = [](Show& show, Reader reader) {
-        show.mMedia = ToFileData(reader);
+        show.mMedia = std::make_shared<FileData const>(ToFileData(reader));
         ++show.mMediaVersion;
     };
     // [=] needed here to pull in the parse functions
     auto parse_INGL_SHOW = [=](Show& show, Reader reader) {
+        auto table = reader.ParseOutLabels();
+        // the pool is written after the sheets that refer to it, so it's found first.
+        auto pool = std::shared_ptr<ResourcePool const>{};
+        if (auto poolBlock = std::ranges::find(table, INGL_POOL, [](auto&& i) { return std::get<0>(i); }); poolBlock != table.end()) {
+            pool = std::make_shared<ResourcePool const>(std::get<1>(*poolBlock), show.mResourceCache);
+        }
+        auto parse_INGL_MDRF = [&pool](Show& show, Reader reader) {
+            if (!pool) {
+                throw CC_FileException("Media reference without a pool", INGL_MDRF);
+            }
+            auto which = reader.Get<uint32_t>();
+            auto name = reader.Get<std::string>();
+            show.mMedia = std::make_shared<FileData const>(*pool->Get(which), name);
+            ++show.mMediaVersion;
+        };
         std::map<uint32_t, std::function<void(Show & show, Reader)>> const parser = {
             { INGL_SIZE, parse_INGL_SIZE },
             { INGL_LABL, parse_INGL_LABL },
             { INGL_INST, parse_INGL_INST },
             { INGL_DESC, parse_INGL_DESC },
-            { INGL_SHET, parse_INGL_SHET },
             { INGL_SELE, parse_INGL_SELE },
             { INGL_CURR, parse_INGL_CURR },
             { INGL_MODE, parse_INGL_MODE },
             { INGL_MEDIA, parse_INGL_MEDIA },
+            { INGL_MDRF, parse_INGL_MDRF },
         };
-        auto table = reader.ParseOutLabels();
+        // consecutive sheets are read together so they can be read concurrently.
+        auto sheets = std::vector<Reader>{};
         for (auto& i : table) {
+            if (std::get<0>(i) == INGL_SHET) {
+                sheets.push_back(std::get<1>(i));
+                continue;
+            }
+            parse_INGL_SHETs(show, std::exchange(sheets, {}), pool);
             auto the_parser = parser.find(std::get<0>(i));
             if (the_parser != parser.end()) {
                 the_parser->second(show, std::get<1>(i));
             }
         }
+        parse_INGL_SHETs(show, sheets, pool);
     };
 
     auto table = reader.ParseOutLabels();
@@ -283,72 +408,86 @@ auto anyInstrumentsBesidesDefault(T const& all)
     return instruments.size();
 }
 
-auto Show::SerializeShowData() const -> std::vector<std::byte>
+void Show::SerializeShowData(std::vector<std::byte>& result) const
 {
     using Parser::Append;
     using Parser::AppendAndNullTerminate;
-    using Parser::Construct_block;
-    std::vector<std::byte> result;
+    using Parser::AppendBlock;
     // SHOW_DATA          = NUM_MARCH , LABEL , [ DESCRIPTION ] , { SHEET }* ;
     // Write NUM_MARCH
-    Append(result, Construct_block(INGL_SIZE, static_cast<uint32_t>(GetNumPoints())));
+    AppendBlock(result, INGL_SIZE, static_cast<uint32_t>(GetNumPoints()));
 
     // Write LABEL
-    std::vector<std::byte> labels;
-    for (auto& i : mDotLabelAndInstrument) {
-        AppendAndNullTerminate(labels, i.first);
-    }
-    Append(result, Construct_block(INGL_LABL, labels));
+    AppendBlock(result, INGL_LABL, [this](auto& labels) {
+        for (auto& i : mDotLabelAndInstrument) {
+            AppendAndNullTerminate(labels, i.first);
+        }
+    });
 
     // Write INSTRUMENTS
     if (anyInstrumentsBesidesDefault(GetPointsInstrument())) {
-        std::vector<std::byte> instruments;
-        for (auto& i : mDotLabelAndInstrument) {
-            AppendAndNullTerminate(instruments, i.second == kDefault ? "" : i.second);
-        }
-        Append(result, Construct_block(INGL_INST, instruments));
+        AppendBlock(result, INGL_INST, [this](auto& instruments) {
+            for (auto& i : mDotLabelAndInstrument) {
+                AppendAndNullTerminate(instruments, i.second == kDefault ? "" : i.second);
+            }
+        });
     }
 
     // write Description
     if (!GetDescr().empty()) {
-        std::vector<std::byte> descr;
-        AppendAndNullTerminate(descr, GetDescr());
-        Append(result, Construct_block(INGL_DESC, descr));
+        AppendBlock(result, INGL_DESC, [this](auto& descr) {
+            AppendAndNullTerminate(descr, GetDescr());
+        });
     }
 
-    // Handle sheets
+    // Handle sheets; their background images go into the pool.
+    auto pool = ResourcePoolWriter{ mResourceCache };
     for (auto& sheet : mSheets) {
-        Append(result, sheet.SerializeSheet());
+        sheet.SerializeSheet(result, &pool);
     }
 
     // add selection
     if (!mSelectionList.empty()) {
-        std::vector<std::byte> selections;
-        for (auto&& i : mSelectionList) {
-            Append(selections, uint32_t(i));
-        }
-        Append(result, Construct_block(INGL_SELE, selections));
+        AppendBlock(result, INGL_SELE, [this](auto& selections) {
+            for (auto&& i : mSelectionList) {
+                Append(selections, uint32_t(i));
+            }
+        });
     }
 
     // add current sheet
-    Append(result, Construct_block(INGL_CURR, static_cast<uint32_t>(mSheetNum)));
+    AppendBlock(result, INGL_CURR, static_cast<uint32_t>(mSheetNum));
 
     // add the mode
-    Append(result, Construct_block(INGL_MODE, mMode.Serialize()));
+    AppendBlock(result, INGL_MODE, mMode.Serialize());
 
     // add media
-    if (!std::get<0>(mMedia).empty()) {
-        Append(result, Construct_block(INGL_MEDIA, SerializeFileData(mMedia)));
+    if (!std::get<0>(*mMedia).empty()) {
+        AppendBlock(result, INGL_MDRF, [this, &pool](auto& data) {
+            // the pool shares the media's bytes, so a save that follows another finds them without reading them.
+            Append(data, pool.Add(ResourceBytes{ mMedia, &std::get<0>(*mMedia) }));
+            AppendAndNullTerminate(data, std::get<1>(*mMedia));
+        });
     }
 
-    return result;
+    // and the pool last, once everything has been added to it.
+    if (!pool.empty()) {
+        AppendBlock(result, INGL_POOL, [&pool](auto& data) { pool.Serialize(data); });
+    }
 }
 
 auto Show::SerializeShow() const -> std::vector<std::byte>
 {
     using Parser::Append;
-    using Parser::Construct_block;
+    using Parser::AppendBlock;
     std::vector<std::byte> result;
+    // the show is written in one pass into one buffer, so room for all of it is made up front.
+    constexpr auto kBytesForTheRest = 4096;
+    auto sizeHint = std::get<0>(*mMedia).size() + kBytesForTheRest;
+    for (auto&& sheet : mSheets) {
+        sizeHint += sheet.SerializedSizeHint();
+    }
+    result.reserve(sizeHint);
     // show               = START , SHOW ;
     // START              = INGL_INGL , INGL_VERS ;
     // SHOW               = INGL_SHOW , BigEndianInt32(DataTill_SHOW_END) ,
@@ -358,7 +497,7 @@ auto Show::SerializeShow() const -> std::vector<std::byte>
     Append(result, uint16_t{ INGL_GURK >> 16 });
     Append(result, uint8_t{ CC_MAJOR_VERSION + '0' });
     Append(result, uint8_t{ CC_MINOR_VERSION + '0' });
-    Append(result, Construct_block(INGL_SHOW, SerializeShowData()));
+    AppendBlock(result, INGL_SHOW, [this](auto& data) { SerializeShowData(data); });
     return result;
 }
 
@@ -367,6 +506,11 @@ auto Show::GenerateSheetElements(CalChart::Configuration const& config, int refe
     return mSheets.at(mSheetNum).GenerateSheetElements(config, mSelectionList, GetPointsLabel(), referencePoint);
 }
 
+void Show::GenerateSheetElements(CalChart::Draw::DisplayList& result, CalChart::Configuration const& config, int referencePoint) const
+{
+    mSheets.at(mSheetNum).GenerateSheetElements(result, config, mSelectionList, GetPointsLabel(), referencePoint);
+}
+
 auto Show::GeneratePhatomPointsDrawCommands(
     Configuration const& config,
     MarcherToPosition const& positions) const -> std::vector<Draw::DrawCommand>
@@ -404,6 +548,15 @@ auto Show::GenerateGhostPointsDrawCommands(
     return sheet.GenerateGhostElements(config, selection_list, GetPointsLabel());
 }
 
+void Show::GenerateGhostPointsDrawCommands(
+    CalChart::Draw::DisplayList& result,
+    CalChart::Configuration const& config,
+    CalChart::SelectionList const& selection_list,
+    CalChart::Sheet const& sheet) const
+{
+    sheet.GenerateGhostElements(result, config, selection_list, GetPointsLabel());
+}
+
 auto Show::GenerateGhostPointsDrawCommands(
     int sheet,
     CalChart::Configuration const& config,
@@ -424,22 +577,23 @@ auto GeneratePointDrawCommand(Range&& points) -> std::vector<CalChart::Draw::Dra
     }));
 }
 
-auto Show::GenerateFieldWithMarchersDrawCommands(CalChart::Configuration const& config) const -> std::vector<std::vector<CalChart::Draw::DrawCommand>>
+auto Show::GenerateThumbnailFieldDrawCommands(CalChart::Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>
 {
-    auto field = CalChart::Draw::withBrushAndPen(
-        config.Get_CalChartBrushAndPen(CalChart::Colors::FIELD), CalChart::CreateModeDrawCommandsWithBorderOffset(config, mMode, CalChart::HowToDraw::Animation));
-    return CalChart::Ranges::ToVector<std::vector<CalChart::Draw::DrawCommand>>(
-        mSheets
-        | std::views::transform(
-            [this, field, &config](auto&& sheet) {
-                return std::vector<CalChart::Draw::DrawCommand>{
-                    field,
-                    CalChart::Draw::withBrushAndPen(
-                        config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_FRONT),
-                        GeneratePointDrawCommand(sheet.GetAllMarchers())),
-                }
-                + mMode.Offset();
-            }));
+    return std::vector<CalChart::Draw::DrawCommand>{
+        CalChart::Draw::withBrushAndPen(
+            config.Get_CalChartBrushAndPen(CalChart::Colors::FIELD), CalChart::CreateModeDrawCommandsWithBorderOffset(config, mMode, CalChart::HowToDraw::Animation)),
+    }
+    + mMode.Offset();
+}
+
+auto Show::GenerateThumbnailMarchersDrawCommands(CalChart::Configuration const& config, CalChart::Sheet const& sheet) const -> std::vector<CalChart::Draw::DrawCommand>
+{
+    return std::vector<CalChart::Draw::DrawCommand>{
+        CalChart::Draw::withBrushAndPen(
+            config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_FRONT),
+            GeneratePointDrawCommand(sheet.GetAllMarchers())),
+    }
+    + mMode.Offset();
 }
 
 auto Show::RemoveNthSheet(size_t sheetidx) -> Sheet_container_t
@@ -461,12 +615,12 @@ auto Show::RemoveNthSheet(size_t sheetidx) -> Sheet_container_t
     return shts;
 }
 
-void Show::InsertSheet(Sheet const& sheet, size_t sheetidx)
+void Show::InsertSheet(Sheet sheet, size_t sheetidx)
 {
     if (sheetidx > mSheets.size()) {
         return;
     }
-    mSheets.insert(mSheets.begin() + sheetidx, sheet);
+    mSheets.insert(mSheets.begin() + sheetidx, std::move(sheet));
     if (sheetidx <= GetCurrentSheetNum()) {
         SetCurrentSheet(GetCurrentSheetNum() + 1);
     }
@@ -826,10 +980,34 @@ auto Show::Create_SetSheetsBeatInfoCommand(std::vector<SheetBeatInfo> const& bea
     return { action, reaction };
 }
 
+namespace {
+    // Media is kept in the history as a view of its bytes that shares the FileData they are in.  While the
+    // history has them in memory that FileData is still around, so putting it back doesn't copy it.
+    struct KeptMedia {
+        UndoHistory::Payload bytes;
+        std::weak_ptr<FileData const> media;
+        std::string name;
+    };
+
+    auto KeepMedia(UndoHistory& history, std::shared_ptr<FileData const> const& media) -> KeptMedia
+    {
+        return { history.Keep(UndoHistory::SharedBytes{ media, &std::get<0>(*media) }), media, std::get<1>(*media) };
+    }
+
+    auto GetKeptMedia(KeptMedia const& kept) -> std::shared_ptr<FileData const>
+    {
+        if (auto media = kept.media.lock(); media) {
+            return media;
+        }
+        return std::make_shared<FileData const>(*kept.bytes.Get(), kept.name);
+    }
+}
+
 auto Show::Create_SetMediaCommand(FileData const& media) const -> Show_command_pair
 {
-    auto action = [media](Show& show) { show.mMedia = media; ++show.mMediaVersion; };
-    auto reaction = [media = mMedia, version = mMediaVersion](Show& show) { show.mMedia = media; show.mMediaVersion = version; };
+    // media files can be large, so they are kept in the undo history instead of in the commands.
+    auto action = [media = KeepMedia(*mUndoHistory, std::make_shared<FileData const>(media))](Show& show) { show.mMedia = GetKeptMedia(media); ++show.mMediaVersion; };
+    auto reaction = [media = KeepMedia(*mUndoHistory, mMedia), version = mMediaVersion](Show& show) { show.mMedia = GetKeptMedia(media); show.mMediaVersion = version; };
     return { action, reaction };
 }
 
@@ -851,18 +1029,17 @@ auto Show::Create_RemoveSheetCommand(size_t where) const -> Show_command_pair
 // remapping gets applied on this sheet till the last one
 auto Show::Create_ApplyRelabelMapping(int sheet_num_first, std::vector<MarcherIndex> const& mapping) const -> Show_command_pair
 {
-    auto current_pos = CalChart::Ranges::ToVector<std::vector<Point>>(
-        mSheets | std::views::drop(sheet_num_first) | std::views::transform([](auto&& sheet) { return sheet.GetAllMarchers(); }));
-    // first gather where all the points are;
+    // the sheets before the relabel share everything with the show until the relabel changes them.
+    auto old_sheets = CalChart::Ranges::ToVector<Sheet>(mSheets | std::views::drop(sheet_num_first));
     auto action = [sheet_num_first, mapping](Show& show) {
         for (auto index = static_cast<size_t>(sheet_num_first); index < show.mSheets.size(); ++index) {
             auto& sheet = show.mSheets.at(index);
             sheet.SetMarchers(sheet.RemapPoints(mapping));
         }
     };
-    auto reaction = [sheet_num_first, current_pos](Show& show) {
-        for (auto index = 0U; index < current_pos.size(); ++index) {
-            show.mSheets.at(index + sheet_num_first).SetMarchers(current_pos.at(index));
+    auto reaction = [sheet_num_first, old_sheets](Show& show) {
+        for (auto index = 0U; index < old_sheets.size(); ++index) {
+            show.mSheets.at(index + sheet_num_first) = old_sheets.at(index);
         }
     };
     return { action, reaction };
@@ -1139,12 +1316,40 @@ auto Show::Create_ToggleLabelVisibilityCommand() const -> Show_command_pair
     return Create_SetLabelVisiblityCommand(visible);
 }
 
+namespace {
+    // images can be large, so the pixels are kept in the undo history instead of in the commands.  The history
+    // shares the pixels with the sheets, and the image put back shares them with the history.
+    struct KeptImage {
+        ImageInfo info; // without its pixels
+        UndoHistory::Payload data;
+        UndoHistory::Payload alpha;
+    };
+
+    auto KeepImage(UndoHistory& history, ImageInfo image) -> KeptImage
+    {
+        auto data = history.Keep(image.data.data.Bytes());
+        auto alpha = history.Keep(image.data.alpha.Bytes());
+        image.data.data = {};
+        image.data.alpha = {};
+        image.data.render = nullptr;
+        return { std::move(image), std::move(data), std::move(alpha) };
+    }
+
+    auto GetKeptImage(KeptImage const& kept) -> ImageInfo
+    {
+        auto result = kept.info;
+        result.data.data = ImageBytes{ kept.data.Get() };
+        result.data.alpha = ImageBytes{ kept.alpha.Get() };
+        return result;
+    }
+}
+
 auto Show::Create_AddNewBackgroundImageCommand(ImageInfo const& image) const -> Show_command_pair
 {
     auto& sheet = mSheets.at(mSheetNum);
-    auto action = [sheet_num = mSheetNum, image, where = sheet.GetNumberBackgroundImages()](Show& show) {
+    auto action = [sheet_num = mSheetNum, image = KeepImage(*mUndoHistory, image), where = sheet.GetNumberBackgroundImages()](Show& show) {
         auto& sheet = show.mSheets.at(sheet_num);
-        sheet.AddBackgroundImage(image, where);
+        sheet.AddBackgroundImage(GetKeptImage(image), where);
     };
     auto reaction = [sheet_num = mSheetNum, where = sheet.GetNumberBackgroundImages()](Show& show) {
         auto& sheet = show.mSheets.at(sheet_num);
@@ -1163,9 +1368,9 @@ auto Show::Create_RemoveBackgroundImageCommand(int which) const -> Show_command_
         auto& sheet = show.mSheets.at(sheet_num);
         sheet.RemoveBackgroundImage(which);
     };
-    auto reaction = [sheet_num = mSheetNum, image = sheet.GetBackgroundImages().at(which), which](Show& show) {
+    auto reaction = [sheet_num = mSheetNum, image = KeepImage(*mUndoHistory, sheet.GetBackgroundImage(which)), which](Show& show) {
         auto& sheet = show.mSheets.at(sheet_num);
-        sheet.AddBackgroundImage(image, which);
+        sheet.AddBackgroundImage(GetKeptImage(image), which);
     };
     return { action, reaction };
 }
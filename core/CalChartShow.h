@@ -40,10 +40,13 @@
 #include "CalChartCoord.h"
 #include "CalChartFileFormat.h"
 #include "CalChartImage.h"
+#include "CalChartLazy.h"
+#include "CalChartResourcePool.h"
 #include "CalChartShapes.h"
 #include "CalChartSheet.h"
 #include "CalChartShowMode.h"
 #include "CalChartTypes.h"
+#include "CalChartUndoHistory.h"
 
 #include <cstddef>
 #include <functional>
@@ -53,6 +56,7 @@
 #include <nlohmann/json.hpp>
 #include <ranges>
 #include <set>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -75,12 +79,16 @@ public:
     // you can create a show in two ways, from nothing, or from an input stream
     static auto Create(ShowMode const& mode) -> std::unique_ptr<Show>;
     static auto Create(ShowMode const& mode, std::vector<std::pair<std::string, std::string>> const& labelsAndInstruments, unsigned columns) -> std::unique_ptr<Show>;
-    static auto Create(ShowMode const& mode, std::istream& stream, ParseErrorHandlers const* correction = nullptr) -> std::unique_ptr<Show>;
+    // sheets are read on numberThreads threads, 0 for all cores.
+    static auto Create(ShowMode const& mode, std::istream& stream, ParseErrorHandlers const* correction = nullptr, SheetLoading loading = SheetLoading::Eager, unsigned numberThreads = 0) -> std::unique_ptr<Show>;
+    // parses the show straight out of data, which only needs to stay around until Create returns.
+    static auto Create(ShowMode const& mode, std::span<std::byte const> data, ParseErrorHandlers const* correction = nullptr, SheetLoading loading = SheetLoading::Eager, unsigned numberThreads = 0) -> std::unique_ptr<Show>;
 
     // These constructors are exposed for testing purposes, and generally should not be used
     explicit Show(ShowMode const& mode);
     Show(Version_3_3_and_earlier, ShowMode const& mode, Reader reader, ParseErrorHandlers const* correction = nullptr);
-    Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correction = nullptr);
+    // file, when given, is what reader reads out of, and lazily read sheets keep a hold of it.
+    Show(ShowMode const& mode, Reader reader, ParseErrorHandlers const* correction = nullptr, SheetLoading loading = SheetLoading::Eager, unsigned numberThreads = 0, ShowFileBytes file = {});
 
     // Create command, consists of an action and undo action
     [[nodiscard]] auto Create_SetCurrentSheetCommand(size_t n) const -> Show_command_pair;
@@ -257,9 +265,14 @@ public:
     [[nodiscard]] auto FindCurveOnCurrentSheet(CalChart::Coord pos, Coord::units searchBounds) const -> std::optional<std::tuple<size_t, size_t, double>>;
 
     // Media
-    [[nodiscard]] auto GetMedia() const -> FileData const& { return mMedia; }
+    [[nodiscard]] auto GetMedia() const -> FileData const& { return *mMedia; }
     [[nodiscard]] auto GetMediaVersion() const -> uint64_t { return mMediaVersion; }
 
+    // The commands this show makes keep their images and media in this history.  Each show starts with its own;
+    // a document gives the shows it opens the history that goes with its undo stack.
+    [[nodiscard]] auto GetUndoHistory() const -> std::shared_ptr<UndoHistory> const& { return mUndoHistory; }
+    void SetUndoHistory(std::shared_ptr<UndoHistory> undoHistory) { mUndoHistory = std::move(undoHistory); }
+
     // utility
     [[nodiscard]] static auto GetRelabelMapping(std::vector<Coord> const& source_marchers, std::vector<Coord> const& target_marchers, CalChart::Coord::units tolerance) -> std::optional<std::vector<MarcherIndex>>;
     [[nodiscard]] auto MakeSelectAll() const -> SelectionList;
@@ -308,6 +321,10 @@ public:
     [[nodiscard]] auto GenerateSheetElements(
         CalChart::Configuration const& config,
         int ref) const -> std::vector<CalChart::Draw::DrawCommand>;
+    void GenerateSheetElements(
+        CalChart::Draw::DisplayList& result,
+        CalChart::Configuration const& config,
+        int ref) const;
 
     [[nodiscard]] auto GeneratePhatomPointsDrawCommands(
         CalChart::Configuration const& config,
@@ -317,12 +334,21 @@ public:
         CalChart::Configuration const& config,
         CalChart::SelectionList const& selection_list,
         CalChart::Sheet const& sheet) const -> std::vector<CalChart::Draw::DrawCommand>;
+    void GenerateGhostPointsDrawCommands(
+        CalChart::Draw::DisplayList& result,
+        CalChart::Configuration const& config,
+        CalChart::SelectionList const& selection_list,
+        CalChart::Sheet const& sheet) const;
     [[nodiscard]] auto GenerateGhostPointsDrawCommands(
         int sheet,
         CalChart::Configuration const& config,
         CalChart::SelectionList const& selection_list) const -> std::vector<CalChart::Draw::DrawCommand>;
-    [[nodiscard]] auto GenerateFieldWithMarchersDrawCommands(
-        CalChart::Configuration const& config) const -> std::vector<std::vector<CalChart::Draw::DrawCommand>>;
+    // a sheet's thumbnail is the field with the marchers of that sheet drawn over it.
+    [[nodiscard]] auto GenerateThumbnailFieldDrawCommands(
+        CalChart::Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>;
+    [[nodiscard]] auto GenerateThumbnailMarchersDrawCommands(
+        CalChart::Configuration const& config,
+        CalChart::Sheet const& sheet) const -> std::vector<CalChart::Draw::DrawCommand>;
 
     // modify per edit session
     void SetCurrentReferencePoint(int currentReferencePoint)
@@ -331,9 +357,12 @@ public:
     }
 
 private:
+    // data is the whole file; file is set when the sheets are read lazily and owns data.
+    static auto CreateFromFile(ShowMode const& mode, std::span<std::byte const> data, ShowFileBytes file, ParseErrorHandlers const* correction, SheetLoading loading, unsigned numberThreads) -> std::unique_ptr<Show>;
+
     // modification of show is private, and externally done through create and exeucte commands
     auto RemoveNthSheet(size_t sheetidx) -> Sheet_container_t;
-    void InsertSheet(Sheet const& nsheet, size_t sheetidx);
+    void InsertSheet(Sheet nsheet, size_t sheetidx);
     void InsertSheet(Sheet_container_t const& nsheet, size_t sheetidx);
     void SetCurrentSheet(size_t n) { mSheetNum = n; }
 
@@ -356,7 +385,7 @@ private:
     void SetShowMode(ShowMode const&);
 
     // implementation and helper functions
-    [[nodiscard]] auto SerializeShowData() const -> std::vector<std::byte>;
+    void SerializeShowData(std::vector<std::byte>& result) const;
 
     // members
     std::string mDescr;
@@ -364,8 +393,12 @@ private:
     std::vector<std::pair<std::string, std::string>> mDotLabelAndInstrument;
     Sheet_container_t mSheets;
     ShowMode mMode;
-    FileData mMedia;
+    // media can be large, and copies of the show (like the one autosave writes out) and the undo history share it.
+    std::shared_ptr<FileData const> mMedia = std::make_shared<FileData const>();
     uint64_t mMediaVersion = 0;
+    // what the last save compressed, so the next one doesn't have to again.  Copies share it.
+    std::shared_ptr<ResourceCache> mResourceCache = std::make_shared<ResourceCache>();
+    std::shared_ptr<UndoHistory> mUndoHistory = std::make_shared<UndoHistory>();
 
     // the more "transient" settings, representing a current set of manipulations by the user, but preserved in the show
     SelectionList mSelectionList; // order of selections
@@ -0,0 +1,390 @@
+/*
+ * CalChartUndoHistory.cpp
+ * Keeps the large things undo commands hold on to
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "CalChartUndoHistory.h"
+#include "CalChartUtils.h"
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+#include <variant>
+
+namespace CalChart {
+
+namespace {
+    auto ReadFile(std::filesystem::path const& path, size_t size) -> std::vector<std::byte>
+    {
+        auto input = std::ifstream(path, std::ios::binary);
+        auto result = std::vector<std::byte>(size);
+        if (!input.read(reinterpret_cast<char*>(result.data()), static_cast<std::streamsize>(size))) {
+            throw std::runtime_error(std::format("could not read undo history from {}", path.string()));
+        }
+        return result;
+    }
+
+    auto WriteFile(std::filesystem::path const& path, std::vector<std::byte> const& data) -> bool
+    {
+        auto output = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        return static_cast<bool>(output.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size())));
+    }
+}
+
+struct UndoHistory::State {
+    ~State()
+    {
+        if (mMadeSpillDirectory) {
+            auto error = std::error_code{};
+            std::filesystem::remove_all(mSpillDirectory, error);
+        }
+    }
+
+    // Writes out the least recently used payloads that only the history holds until what's left fits.  Call
+    // without mMutex held; the payloads are picked and put on disk with it held, and written without it.
+    void Spill();
+    auto SpillDirectory() -> std::filesystem::path const&;
+    // Moves an entry in memory to the most recently used end.  Call with mMutex held.
+    void Touch(Entry& entry);
+    // Starts keeping a new entry in memory.  Call with mMutex held.
+    void Add(Entry& entry);
+    // The bytes in memory that nothing but the history holds.  Call with mMutex held.
+    [[nodiscard]] auto BytesOnlyInHistory() const -> size_t;
+
+    std::mutex mMutex;
+    size_t mMemoryLimit{};
+    std::filesystem::path mSpillDirectory;
+    bool mMadeSpillDirectory = false;
+    size_t mNumberEntries{};
+    // the entries that were kept as bytes, by the hash of their bytes.
+    std::unordered_multimap<uint64_t, Entry*> mEntries;
+    // the entries in memory, by their buffer.
+    std::unordered_map<void const*, Entry*> mByBuffer;
+    // the entries in memory, least recently used first.
+    std::list<Entry*> mInMemory;
+    uint64_t mFiles{};
+    size_t mBytesOnDisk{};
+    size_t mBytesShared{};
+};
+
+struct UndoHistory::Entry : std::enable_shared_from_this<Entry> {
+    Entry(std::shared_ptr<State> state, SharedBytes data, std::optional<uint64_t> hash)
+        : mState(std::move(state))
+        , mHash(hash)
+        , mSize(data->size())
+        , mData(std::move(data))
+    {
+    }
+
+    ~Entry()
+    {
+        auto lock = std::lock_guard{ mState->mMutex };
+        --mState->mNumberEntries;
+        if (mHash) {
+            auto [first, last] = mState->mEntries.equal_range(*mHash);
+            mState->mEntries.erase(std::find_if(first, last, [this](auto&& entry) { return entry.second == this; }));
+        }
+        if (mFile.empty()) {
+            if (auto found = mState->mByBuffer.find(mData.get()); found != mState->mByBuffer.end() && found->second == this) {
+                mState->mByBuffer.erase(found);
+            }
+            if (mSize > 0) {
+                mState->mInMemory.erase(mInMemoryPosition);
+            }
+        } else {
+            mState->mBytesOnDisk -= mSize;
+            auto error = std::error_code{};
+            std::filesystem::remove(mFile, error);
+        }
+    }
+
+    // An entry's bytes are either in memory, or in a file that doesn't change once written.  Reading the file
+    // can take a while, so this only copies out where the bytes are, and Read gets them.  Call with the state's
+    // mutex held.
+    [[nodiscard]] auto Where() const -> std::variant<SharedBytes, std::filesystem::path>
+    {
+        if (mFile.empty()) {
+            return mData;
+        }
+        return mFile;
+    }
+
+    [[nodiscard]] auto Read(std::variant<SharedBytes, std::filesystem::path> where) const -> SharedBytes
+    {
+        if (auto* data = std::get_if<SharedBytes>(&where); data) {
+            return std::move(*data);
+        }
+        return std::make_shared<std::vector<std::byte> const>(ReadFile(std::get<std::filesystem::path>(where), mSize));
+    }
+
+    std::shared_ptr<State> mState;
+    std::optional<uint64_t> mHash; // when kept as bytes
+    size_t mSize{};
+    SharedBytes mData; // null once written to mFile
+    std::filesystem::path mFile;
+    std::list<Entry*>::iterator mInMemoryPosition; // while in memory, and not empty
+};
+
+auto UndoHistory::State::SpillDirectory() -> std::filesystem::path const&
+{
+    if (!mMadeSpillDirectory && mSpillDirectory.empty()) {
+        mSpillDirectory = std::filesystem::temp_directory_path() / std::format("CalChartUndo-{:016x}", std::random_device{}() * uint64_t{ 0x100000000 } + std::random_device{}());
+    }
+    if (!mMadeSpillDirectory) {
+        auto error = std::error_code{};
+        mMadeSpillDirectory = std::filesystem::create_directories(mSpillDirectory, error);
+    }
+    return mSpillDirectory;
+}
+
+void UndoHistory::State::Spill()
+{
+    // while a payload is being written it's held here as well, so it doesn't count as only in the history and
+    // another spill won't pick it.  These are declared before the lock, so an entry whose last payload went
+    // while it was being written goes after the lock is released.
+    struct Victim {
+        std::shared_ptr<Entry> entry;
+        SharedBytes data;
+        std::filesystem::path file;
+    };
+    auto victims = std::vector<Victim>{};
+    {
+        auto lock = std::lock_guard{ mMutex };
+        auto bytesOnlyInHistory = BytesOnlyInHistory();
+        for (auto* entry : mInMemory) {
+            if (bytesOnlyInHistory <= mMemoryLimit) {
+                break;
+            }
+            // writing out what something else still holds wouldn't free anything.
+            if (entry->mData.use_count() > 1) {
+                continue;
+            }
+            // an entry on its way out is about to free its bytes anyway.
+            auto shared = entry->weak_from_this().lock();
+            if (!shared) {
+                continue;
+            }
+            auto file = SpillDirectory() / std::format("{:016x}-{}", entry->mHash.value_or(0), mFiles++);
+            bytesOnlyInHistory -= entry->mSize;
+            victims.push_back({ std::move(shared), entry->mData, std::move(file) });
+        }
+    }
+    if (victims.empty()) {
+        return;
+    }
+
+    // if the disk won't take one, the rest are kept in memory instead of being lost.
+    auto written = std::ranges::find_if_not(victims, [](auto&& victim) { return WriteFile(victim.file, *victim.data); });
+    auto unused = std::vector<std::filesystem::path>{};
+    std::ranges::transform(written, victims.end(), std::back_inserter(unused), &Victim::file);
+    victims.erase(written, victims.end());
+
+    {
+        auto lock = std::lock_guard{ mMutex };
+        for (auto&& victim : victims) {
+            auto& entry = *victim.entry;
+            // something that asked for the bytes while they were written still holds them, so they stay.
+            if (entry.mData != victim.data || entry.mData.use_count() > 2) {
+                unused.push_back(victim.file);
+                continue;
+            }
+            entry.mFile = victim.file;
+            mByBuffer.erase(entry.mData.get());
+            entry.mData = nullptr;
+            mInMemory.erase(entry.mInMemoryPosition);
+            mBytesOnDisk += entry.mSize;
+        }
+    }
+    for (auto&& file : unused) {
+        auto error = std::error_code{};
+        std::filesystem::remove(file, error);
+    }
+}
+
+void UndoHistory::State::Touch(Entry& entry)
+{
+    if (entry.mFile.empty() && entry.mSize > 0) {
+        mInMemory.splice(mInMemory.end(), mInMemory, entry.mInMemoryPosition);
+    }
+}
+
+void UndoHistory::State::Add(Entry& entry)
+{
+    ++mNumberEntries;
+    if (entry.mHash) {
+        mEntries.emplace(*entry.mHash, &entry);
+    }
+    // an entry on its way out may still be listed under the same buffer.
+    mByBuffer[entry.mData.get()] = &entry;
+    if (entry.mSize > 0) {
+        entry.mInMemoryPosition = mInMemory.insert(mInMemory.end(), &entry);
+    }
+}
+
+auto UndoHistory::State::BytesOnlyInHistory() const -> size_t
+{
+    auto result = size_t{};
+    for (auto* entry : mInMemory) {
+        if (entry->mData.use_count() == 1) {
+            result += entry->mSize;
+        }
+    }
+    return result;
+}
+
+UndoHistory::UndoHistory(size_t memoryLimit, std::filesystem::path spillDirectory)
+    : mState(std::make_shared<State>())
+{
+    mState->mMemoryLimit = memoryLimit;
+    mState->mSpillDirectory = std::move(spillDirectory);
+}
+
+// payloads still held by commands keep the state, and the files, until they go.
+UndoHistory::~UndoHistory() = default;
+
+UndoHistory::Payload::Payload(std::shared_ptr<Entry> entry)
+    : mEntry(std::move(entry))
+{
+}
+
+auto UndoHistory::Payload::Get() const -> SharedBytes
+{
+    auto where = [this] {
+        auto lock = std::lock_guard{ mEntry->mState->mMutex };
+        mEntry->mState->Touch(*mEntry);
+        return mEntry->Where();
+    }();
+    return mEntry->Read(std::move(where));
+}
+
+auto UndoHistory::Payload::size() const -> size_t { return mEntry->mSize; }
+
+auto UndoHistory::Payload::IsInMemory() const -> bool
+{
+    auto lock = std::lock_guard{ mEntry->mState->mMutex };
+    return mEntry->mFile.empty();
+}
+
+auto UndoHistory::Keep(SharedBytes data) -> Payload
+{
+    auto entry = [this, &data]() -> std::shared_ptr<Entry> {
+        auto lock = std::lock_guard{ mState->mMutex };
+        if (auto found = mState->mByBuffer.find(data.get()); found != mState->mByBuffer.end()) {
+            // an entry on its way out can't be shared.
+            if (auto shared = found->second->weak_from_this().lock(); shared) {
+                mState->Touch(*shared);
+                mState->mBytesShared += shared->mSize;
+                return shared;
+            }
+        }
+        auto size = data->size();
+        auto added = std::make_shared<Entry>(mState, std::move(data), std::nullopt);
+        mState->Add(*added);
+        if (added->mData.use_count() > 1) {
+            mState->mBytesShared += size;
+        }
+        return added;
+    }();
+    // writing out what no longer fits is done without holding the history up.
+    mState->Spill();
+    return Payload{ entry };
+}
+
+auto UndoHistory::Keep(std::vector<std::byte> data) -> Payload
+{
+    auto hash = HashBytes(data);
+    // entries on disk with the same hash and size have to be read back to compare, which is done outside the
+    // lock.  These are declared first so a candidate that turns out to be the last reference goes after it.
+    auto candidates = std::vector<std::pair<std::shared_ptr<Entry>, std::filesystem::path>>{};
+    {
+        auto lock = std::lock_guard{ mState->mMutex };
+        auto [first, last] = mState->mEntries.equal_range(hash);
+        for (auto* entry : std::ranges::subrange(first, last) | std::views::values) {
+            if (entry->mSize != data.size() || (entry->mFile.empty() && *entry->mData != data)) {
+                continue;
+            }
+            // an entry on its way out can't be shared.
+            auto shared = entry->weak_from_this().lock();
+            if (!shared) {
+                continue;
+            }
+            if (shared->mFile.empty()) {
+                mState->Touch(*shared);
+                mState->mBytesShared += data.size();
+                return Payload{ shared };
+            }
+            candidates.emplace_back(std::move(shared), entry->mFile);
+        }
+    }
+    for (auto&& [candidate, file] : candidates) {
+        auto holds = [&candidate, &file, &data] {
+            try {
+                return ReadFile(file, candidate->mSize) == data;
+            } catch (std::exception const&) {
+                return false;
+            }
+        }();
+        if (holds) {
+            auto lock = std::lock_guard{ mState->mMutex };
+            mState->Touch(*candidate);
+            mState->mBytesShared += data.size();
+            return Payload{ candidate };
+        }
+    }
+
+    auto entry = std::make_shared<Entry>(mState, std::make_shared<std::vector<std::byte> const>(std::move(data)), hash);
+    {
+        auto lock = std::lock_guard{ mState->mMutex };
+        mState->Add(*entry);
+    }
+    mState->Spill();
+    return Payload{ entry };
+}
+
+void UndoHistory::SetMemoryLimit(size_t memoryLimit)
+{
+    {
+        auto lock = std::lock_guard{ mState->mMutex };
+        mState->mMemoryLimit = memoryLimit;
+    }
+    mState->Spill();
+}
+
+auto UndoHistory::GetMemoryLimit() const -> size_t
+{
+    auto lock = std::lock_guard{ mState->mMutex };
+    return mState->mMemoryLimit;
+}
+
+auto UndoHistory::GetUsage() const -> Usage
+{
+    auto lock = std::lock_guard{ mState->mMutex };
+    return Usage{ mState->mNumberEntries, mState->BytesOnlyInHistory(), mState->mBytesOnDisk, mState->mBytesShared };
+}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+/*
+ * CalChartUndoHistory.h
+ * Keeps the large things undo commands hold on to
+ */
+
+/*
+   Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * UndoHistory
+ *
+ * Most undo commands only hold on to a few indices and positions, but some hold on to a whole media file or
+ * background image.  Over a long editing session those add up, so commands keep them in the UndoHistory instead
+ * of capturing them directly.  Each document has its own UndoHistory, with its own memory limit.
+ *
+ * Images and media are immutable, shared buffers, and the history keeps a reference to the buffer rather than
+ * a copy.  While the show (or anything else) still holds a buffer, keeping it costs nothing and writing it to
+ * disk would free nothing, so only the buffers the history alone holds count against the memory limit.  When
+ * those go over the limit, the ones that were used least recently are written to disk, and read back when a
+ * command asks for them.  A payload is forgotten when the last command holding it goes away.
+ *
+ * Keeping the same bytes twice (like setting the media back and forth) gives back a Payload that shares the
+ * first one.
+ *
+ * Payloads are kept whole; there is no delta encoding between them.  The other undo commands are already
+ * small, and copies of sheets share their contents, so the whole images and media are what is worth bounding.
+ */
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace CalChart {
+
+class UndoHistory {
+    struct State;
+    struct Entry;
+
+public:
+    static constexpr size_t kDefaultMemoryLimit = 64 * 1024 * 1024;
+    using SharedBytes = std::shared_ptr<std::vector<std::byte> const>;
+
+    // Payloads that go over the memory limit are written into spillDirectory, which is made if it isn't there.
+    explicit UndoHistory(size_t memoryLimit = kDefaultMemoryLimit, std::filesystem::path spillDirectory = {});
+    ~UndoHistory();
+
+    UndoHistory(UndoHistory const&) = delete;
+    UndoHistory& operator=(UndoHistory const&) = delete;
+
+    // What a command holds on to.  Copies refer to the same bytes.
+    class Payload {
+    public:
+        // The buffer that was kept while it is in memory.  throws std::runtime_error if the bytes were written
+        // to disk and can't be read back.
+        [[nodiscard]] auto Get() const -> SharedBytes;
+        [[nodiscard]] auto size() const -> size_t;
+        [[nodiscard]] auto IsInMemory() const -> bool;
+
+    private:
+        friend class UndoHistory;
+        explicit Payload(std::shared_ptr<Entry> entry);
+        std::shared_ptr<Entry> mEntry;
+    };
+
+    // Keeps a reference to data, which must not be null, without copying it.
+    [[nodiscard]] auto Keep(SharedBytes data) -> Payload;
+    [[nodiscard]] auto Keep(std::vector<std::byte> data) -> Payload;
+
+    void SetMemoryLimit(size_t memoryLimit);
+    [[nodiscard]] auto GetMemoryLimit() const -> size_t;
+
+    struct Usage {
+        size_t payloads{};
+        // only what the history alone holds, which is what counts against the memory limit.
+        size_t bytesInMemory{};
+        size_t bytesOnDisk{};
+        // bytes that were kept by reference, or kept again, instead of being stored.
+        size_t bytesShared{};
+    };
+    [[nodiscard]] auto GetUsage() const -> Usage;
+
+private:
+    std::shared_ptr<State> mState;
+};
+
+}
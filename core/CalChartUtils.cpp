@@ -23,7 +23,9 @@
 #include "CalChartUtils.h"
 #include "CalChartFileFormat.h"
 #include "CalChartTypes.h"
+#include <algorithm>
 #include <charconv>
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <optional>
@@ -118,6 +120,23 @@ auto ToString(Fermatas const& input) -> std::string
     return result;
 }
 
+auto HashBytes(std::span<std::byte const> data) -> uint64_t
+{
+    constexpr auto kPrime = uint64_t{ 1099511628211ULL };
+    auto result = uint64_t{ 14695981039346656037ULL } ^ data.size();
+    auto words = data.size() / sizeof(uint64_t);
+    for (auto which = size_t{}; which < words; ++which) {
+        auto word = uint64_t{};
+        std::memcpy(&word, data.data() + which * sizeof(uint64_t), sizeof(uint64_t));
+        result = (result ^ word) * kPrime;
+        result ^= result >> 32;
+    }
+    for (auto byte : data.subspan(words * sizeof(uint64_t))) {
+        result = (result ^ static_cast<uint64_t>(byte)) * kPrime;
+    }
+    return result;
+}
+
 auto ToFileData(const std::filesystem::path& path) -> std::optional<FileData>
 {
     std::ifstream file(path, std::ios::binary | std::ios::ate);
@@ -141,6 +160,56 @@ auto ToFileData(const std::filesystem::path& path) -> std::optional<FileData>
     return FileData{ buffer, path.filename().string() };
 }
 
+namespace {
+    // Adds the .shw files under directory to shows, and the directories under it that can't be read to
+    // unreadable.
+    void ShowFilesInDirectory(std::filesystem::path const& directory, std::vector<std::filesystem::path>& shows, std::vector<std::pair<std::filesystem::path, std::error_code>>& unreadable)
+    {
+        auto error = std::error_code{};
+        auto entries = std::filesystem::directory_iterator(directory, error);
+        for (; !error && entries != std::filesystem::directory_iterator{}; entries.increment(error)) {
+            auto const& entry = *entries;
+            // like recursive_directory_iterator, links to directories aren't followed.
+            auto entryError = std::error_code{};
+            if (entry.is_directory(entryError) && !entry.is_symlink(entryError)) {
+                ShowFilesInDirectory(entry.path(), shows, unreadable);
+            } else if (entry.is_regular_file(entryError) && entry.path().extension() == ".shw") {
+                shows.push_back(entry.path());
+            }
+        }
+        if (error) {
+            unreadable.emplace_back(directory, error);
+        }
+    }
+}
+
+auto ShowFilesInPaths(std::vector<std::string> const& paths, std::vector<std::pair<std::filesystem::path, std::error_code>>& unreadable) -> std::vector<std::filesystem::path>
+{
+    auto result = std::vector<std::filesystem::path>{};
+    for (auto&& path : paths) {
+        auto error = std::error_code{};
+        if (!std::filesystem::is_directory(path, error)) {
+            result.emplace_back(path);
+            continue;
+        }
+        auto shows = std::vector<std::filesystem::path>{};
+        ShowFilesInDirectory(path, shows, unreadable);
+        std::ranges::sort(shows);
+        result.insert(result.end(), shows.begin(), shows.end());
+    }
+    return result;
+}
+
+auto ShowFilesInPaths(std::vector<std::string> const& paths) -> std::vector<std::filesystem::path>
+{
+    auto unreadable = std::vector<std::pair<std::filesystem::path, std::error_code>>{};
+    auto result = ShowFilesInPaths(paths, unreadable);
+    if (!unreadable.empty()) {
+        throw std::filesystem::filesystem_error("could not read directory", unreadable.front().first, unreadable.front().second);
+    }
+    return result;
+}
+
 auto ToFileData(CalChart::Reader reader) -> FileData
 {
     auto table = reader.ParseOutLabels();
@@ -157,18 +226,23 @@ auto ToFileData(CalChart::Reader reader) -> FileData
 
 auto SerializeFileData(CalChart::FileData const& fileData) -> std::vector<std::byte>
 {
-    // Write Name
-    std::vector<std::byte> tdata;
-    Parser::Append(tdata, static_cast<uint32_t>(std::get<0>(fileData).size()));
-    Parser::Append(tdata, std::get<0>(fileData));
-    std::vector<std::byte> result = Parser::Construct_block(INGL_DATA, tdata);
+    std::vector<std::byte> result;
+    SerializeFileData(fileData, result);
+    return result;
+}
 
-    // Write Name
-    std::vector<std::byte> tstring;
-    Parser::AppendAndNullTerminate(tstring, std::get<1>(fileData));
-    Parser::Append(result, Parser::Construct_block(INGL_NAME, tstring));
+void SerializeFileData(CalChart::FileData const& fileData, std::vector<std::byte>& result)
+{
+    // Write Data
+    Parser::AppendBlock(result, INGL_DATA, [&fileData](auto& data) {
+        Parser::Append(data, static_cast<uint32_t>(std::get<0>(fileData).size()));
+        Parser::Append(data, std::get<0>(fileData));
+    });
 
-    return result;
+    // Write Name
+    Parser::AppendBlock(result, INGL_NAME, [&fileData](auto& name) {
+        Parser::AppendAndNullTerminate(name, std::get<1>(fileData));
+    });
 }
 
 }
@@ -23,9 +23,15 @@
 
 #include "CalChartTypes.h"
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <ranges>
+#include <span>
+#include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 namespace CalChart {
@@ -158,11 +164,23 @@ auto append(std::vector<T>& v, R&& range) -> std::vector<T>&
     return v;
 }
 
+// FNV-1a style hash over 8 bytes at a time, for telling large blobs (images, undo data) apart quickly.
+// Equal data always hashes the same; a collision only means the data needs comparing.
+auto HashBytes(std::span<std::byte const> data) -> uint64_t;
+
 class Reader;
 
 auto ToFileData(const std::filesystem::path& path) -> std::optional<FileData>;
+
+// The shows named by paths, in order; a directory stands for all the .shw files under it, sorted.
+// Directories that can't be read are left out, and added to unreadable with why.
+auto ShowFilesInPaths(std::vector<std::string> const& paths, std::vector<std::pair<std::filesystem::path, std::error_code>>& unreadable) -> std::vector<std::filesystem::path>;
+// throws std::filesystem::filesystem_error for the first directory that can't be read.
+auto ShowFilesInPaths(std::vector<std::string> const& paths) -> std::vector<std::filesystem::path>;
 auto ToFileData(Reader path) -> FileData;
 
 auto SerializeFileData(FileData const& fileData) -> std::vector<std::byte>;
+// appends what SerializeFileData returns to result.
+void SerializeFileData(FileData const& fileData, std::vector<std::byte>& result);
 
 }
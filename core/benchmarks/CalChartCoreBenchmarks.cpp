@@ -0,0 +1,356 @@
+//
+//  CalChartCoreBenchmarks.cpp
+//  CalChartCoreBenchmarks
+//
+//  Times the core engine on the shows in the corpus and writes the results as JSON, so runs can be
+//  compared over time.
+//
+//  Usage: CalChartCoreBenchmarks [--iterations=<n>] [--filter=<benchmark>] [--output=<file>] [<shows>...]
+//  With no shows the corpus the benchmarks were built with is used.  Directories are searched for shows.
+//
+
+#include "CalChartAnimation.h"
+#include "CalChartAnimationSheet.h"
+#include "CalChartAssignment.h"
+#include "CalChartConstants.h"
+#include "CalChartPrintShowToPS.hpp"
+#include "CalChartRanges.h"
+#include "CalChartSheet.h"
+#include "CalChartShow.h"
+#include "CalChartShowMode.h"
+#include "CalChartUtils.h"
+#include "ccvers.h"
+#include "e7_transition_solver.h"
+#include "munkres.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <set>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Options {
+    int iterations = 5;
+    std::string filter;
+    std::string output;
+    std::vector<std::string> shows;
+};
+
+auto ParseOptions(int argc, char* argv[]) -> Options
+{
+    auto options = Options{};
+    for (auto arg : std::span(argv + 1, argv + argc) | std::views::transform([](auto arg) { return std::string_view{ arg }; })) {
+        if (arg.starts_with("--iterations=")) {
+            options.iterations = std::max(std::stoi(std::string(arg.substr(13))), 1);
+        } else if (arg.starts_with("--filter=")) {
+            options.filter = arg.substr(9);
+        } else if (arg.starts_with("--output=")) {
+            options.output = arg.substr(9);
+        } else if (arg.starts_with("--")) {
+            throw std::runtime_error(std::format("unknown option {}", arg));
+        } else {
+            options.shows.emplace_back(arg);
+        }
+    }
+    if (options.shows.empty()) {
+        options.shows.emplace_back(CALCHART_SHOWS_DIR);
+    }
+    return options;
+}
+
+auto ReadFile(std::filesystem::path const& path)
+{
+    auto data = CalChart::ToFileData(path);
+    if (!data) {
+        throw std::runtime_error(std::format("could not open file {}", path.string()));
+    }
+    return std::get<0>(*data);
+}
+
+auto Wanted(Options const& options, std::string_view name)
+{
+    return options.filter.empty() || name.find(options.filter) != std::string_view::npos;
+}
+
+// Results are handed here so the work that made them can't be optimized away.
+std::atomic<size_t> gSink;
+template <typename T>
+void Consume(T const& result)
+{
+    if constexpr (requires { result.size(); }) {
+        gSink += result.size();
+    } else {
+        gSink += sizeof(result);
+    }
+}
+
+// Runs the benchmark the requested number of times and records how long each run took.
+template <typename Function>
+auto Measure(std::string_view name, int iterations, Function&& function) -> nlohmann::json
+{
+    auto times = std::vector<double>{};
+    for (auto iteration = 0; iteration < iterations; ++iteration) {
+        auto start = std::chrono::steady_clock::now();
+        Consume(function());
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::ranges::sort(times);
+    return {
+        { "name", name },
+        { "iterations", iterations },
+        { "mean_ms", std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size()) },
+        { "median_ms", times.at(times.size() / 2) },
+        { "min_ms", times.front() },
+        { "max_ms", times.back() },
+    };
+}
+
+auto PrintToPS(CalChart::Show const& show)
+{
+    auto printShowToPS = CalChart::PrintShowToPS(
+        show, false, true, true, true, 50, CalChart::ShowMode::GetDefaultShowMode(),
+        { { "Palatino-Bold", "Helvetica", "Helvetica-Bold", "Courier", "Courier-Bold", "Courier-Italic", "Courier-BoldItalic" } },
+        { 7.5, 10.0, 0.5, 0.5, 11.0 },
+        { 3.0, 1.5, 10.0 },
+        { 0.9, 1.35, 1.2, 1.2, 0.2 },
+        CalChart::kDefaultYardLines);
+    auto picked = std::set<size_t>{};
+    for (auto i : std::views::iota(0UL, show.GetNumSheets())) {
+        picked.insert(i);
+    }
+    return std::get<0>(printShowToPS(picked, "show"));
+}
+
+// The solver runs to completion, so the benchmark measures a full solve.
+class RunToCompletion : public CalChart::TransitionSolverDelegate {
+public:
+    void OnProgress(double) override { }
+    void OnSubtaskProgress(double) override { }
+    void OnNewPreferredSolution(unsigned) override { }
+    void OnCalculationComplete(CalChart::TransitionSolverResult) override { }
+    bool ShouldAbortCalculation() override { return false; }
+};
+
+auto SolverParams(CalChart::TransitionSolverParams::AlgorithmIdentifier algorithm = CalChart::TransitionSolverParams::AlgorithmIdentifier::BEGIN)
+{
+    using Params = CalChart::TransitionSolverParams;
+    auto params = Params{};
+    params.algorithm = algorithm;
+    for (auto i : std::views::iota(0UL, params.availableInstructions.size())) {
+        params.availableInstructionsMask.at(i) = true;
+        params.availableInstructions.at(i).waitBeats = static_cast<unsigned>(i / Params::MarcherInstruction::Pattern::END) * 2;
+        params.availableInstructions.at(i).movementPattern = static_cast<Params::MarcherInstruction::Pattern>(i % Params::MarcherInstruction::Pattern::END);
+    }
+    return params;
+}
+
+// The solver only takes sheets of a certain shape, so the first pair of sheets in the show it can take
+// is used.
+auto FirstSolvableSheets(CalChart::Show const& show) -> std::optional<std::pair<CalChart::Sheet, CalChart::Sheet>>
+{
+    for (auto which : std::views::iota(1UL, std::max(show.GetNumSheets(), 1UL))) {
+        auto from = show.CopySheet(static_cast<unsigned>(which - 1));
+        auto to = show.CopySheet(static_cast<unsigned>(which));
+        if (CalChart::validateSheetForTransitionSolver(from).empty() && CalChart::validateSheetForTransitionSolver(to).empty()) {
+            return std::pair{ std::move(from), std::move(to) };
+        }
+    }
+    return std::nullopt;
+}
+
+auto BenchmarkShow(std::filesystem::path const& path, Options const& options) -> std::vector<nlohmann::json>
+{
+    using CalChart::Animation;
+    using CalChart::Show;
+    auto results = std::vector<nlohmann::json>{};
+    auto const mode = CalChart::ShowMode::GetDefaultShowMode();
+    auto run = [&results, &options, &path](std::string_view name, auto&& function) {
+        if (!Wanted(options, name)) {
+            return;
+        }
+        auto result = Measure(name, options.iterations, function);
+        result["show"] = path.string();
+        results.push_back(result);
+    };
+
+    run("read_file", [&path] { return ReadFile(path); });
+    // the way shows used to be read, for comparison.
+    run("read_file_by_character", [&path] {
+        auto input = std::ifstream(path, std::ios::binary);
+        input.unsetf(std::ios::skipws);
+        return std::vector<char>(std::istream_iterator<char>{ input }, std::istream_iterator<char>{});
+    });
+    auto const data = ReadFile(path);
+    run("load", [&mode, &data] { return Show::Create(mode, std::span<std::byte const>{ data }); });
+    run("load_lazily", [&mode, &data] { return Show::Create(mode, std::span<std::byte const>{ data }, nullptr, CalChart::SheetLoading::Lazy); });
+    run("load_from_stream", [&mode, &path] {
+        auto input = std::ifstream(path, std::ios::binary);
+        return Show::Create(mode, input);
+    });
+    auto const show = Show::Create(mode, std::span<std::byte const>{ data });
+    run("animation", [&show] { return Animation{ *show }.GetTotalNumberBeats(); });
+
+    auto const animation = Animation{ *show };
+    auto const beats = std::views::iota(0U, animation.GetTotalNumberBeats());
+    auto const positions = CalChart::Ranges::ToVector<std::vector<CalChart::Coord>>(beats | std::views::transform([&animation](auto beat) {
+        return CalChart::Ranges::ToVector<CalChart::Coord>(animation.GetAllAnimateInfo(beat) | std::views::transform([](auto&& info) {
+            return info.mMarcherInfo.mPosition;
+        }));
+    }));
+    auto findAllCollisions = [&positions](CalChart::Animate::CollisionDetection method) {
+        return CalChart::Ranges::ToVector<std::map<CalChart::MarcherIndex, CalChart::Coord::CollisionType>>(positions | std::views::transform([method](auto&& beatPositions) {
+            return CalChart::Animate::FindAllCollisions(beatPositions, method);
+        }));
+    };
+    if (Wanted(options, "find_all_collisions") && findAllCollisions(CalChart::Animate::CollisionDetection::SpatialHash) != findAllCollisions(CalChart::Animate::CollisionDetection::BruteForce)) {
+        throw std::runtime_error("collision detection methods disagree");
+    }
+    run("find_all_collisions", [&findAllCollisions] { return findAllCollisions(CalChart::Animate::CollisionDetection::SpatialHash); });
+    run("find_all_collisions_brute_force", [&findAllCollisions] { return findAllCollisions(CalChart::Animate::CollisionDetection::BruteForce); });
+    run("all_animate_info_at_beat", [&animation, beats] {
+        auto infos = size_t{};
+        for (auto beat : beats) {
+            infos += animation.GetAllAnimateInfo(beat).size();
+        }
+        return infos;
+    });
+    run("beat_to_sheet_offset_and_beat", [&animation, beats] {
+        auto offsets = size_t{};
+        for (auto beat : beats) {
+            offsets += std::get<0>(animation.BeatToSheetOffsetAndBeat(beat));
+        }
+        return offsets;
+    });
+    run("beat_has_collision", [&animation, beats] {
+        return std::ranges::count_if(beats, [&animation](auto beat) { return animation.BeatHasCollision(beat); });
+    });
+    run("online_viewer_json", [&show, &animation] { return show->toOnlineViewerJSON(animation).dump(); });
+    run("serialize_show", [&show] { return show->SerializeShow(); });
+    run("print_show_to_ps", [&show] { return PrintToPS(*show); });
+    if (auto sheets = FirstSolvableSheets(*show); sheets) {
+        run("e7_solver", [&sheets] {
+            auto delegate = RunToCompletion{};
+            return CalChart::runTransitionSolver(sheets->first, sheets->second, SolverParams(), &delegate).finalPositions;
+        });
+        run("e7_solver_naminiasl_ramirez_zhang", [&sheets] {
+            auto delegate = RunToCompletion{};
+            return CalChart::runTransitionSolver(sheets->first, sheets->second, SolverParams(CalChart::TransitionSolverParams::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG), &delegate).finalPositions;
+        });
+        run("e7_solver_sover_eliceiri_hershkovitz", [&sheets] {
+            auto delegate = RunToCompletion{};
+            return CalChart::runTransitionSolver(sheets->first, sheets->second, SolverParams(CalChart::TransitionSolverParams::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ), &delegate).finalPositions;
+        });
+        run("e7_solver_portfolio", [&sheets] {
+            auto delegate = RunToCompletion{};
+            return CalChart::runTransitionSolver(sheets->first, sheets->second, SolverParams(CalChart::TransitionSolverParams::E7_ALGORITHM__PORTFOLIO), &delegate).finalPositions;
+        });
+    }
+    return results;
+}
+
+// The solver's assignment stage on its own, against the Munkres solver it replaced.  Like the solver, this works in two
+// step units, with the Manhattan distances between random spots on a 100 yard field, 84 steps deep.
+auto BenchmarkAssignment(Options const& options) -> std::vector<nlohmann::json>
+{
+    auto results = std::vector<nlohmann::json>{};
+    auto run = [&results, &options](std::string_view name, auto&& function) {
+        if (!Wanted(options, name)) {
+            return;
+        }
+        results.push_back(Measure(name, options.iterations, function));
+    };
+
+    for (auto numMarchers : { 100UL, 200UL, 300UL, 400UL }) {
+        auto generator = std::mt19937{ static_cast<unsigned>(numMarchers) };
+        auto x = std::uniform_int_distribution<int>{ 0, 160 / 2 };
+        auto y = std::uniform_int_distribution<int>{ 0, 84 / 2 };
+        auto spot = [&] { return std::pair{ x(generator), y(generator) }; };
+        auto starts = std::vector<std::pair<int, int>>(numMarchers);
+        auto ends = std::vector<std::pair<int, int>>(numMarchers);
+        std::ranges::generate(starts, spot);
+        std::ranges::generate(ends, spot);
+        auto distance = [&starts, &ends](auto from, auto to) {
+            return std::abs(starts[from].first - ends[to].first) + std::abs(starts[from].second - ends[to].second);
+        };
+
+        run(std::format("assignment_jv_{}", numMarchers), [numMarchers, &distance] {
+            auto problem = CalChart::AssignmentProblem{ numMarchers };
+            for (auto from : std::views::iota(0UL, numMarchers)) {
+                for (auto to : std::views::iota(0UL, numMarchers)) {
+                    problem.SetCost(from, to, distance(from, to));
+                }
+            }
+            return problem.Solve();
+        });
+        run(std::format("assignment_munkres_{}", numMarchers), [numMarchers, &distance] {
+            auto matrix = Matrix<double>(numMarchers, numMarchers);
+            for (auto from : std::views::iota(0UL, numMarchers)) {
+                for (auto to : std::views::iota(0UL, numMarchers)) {
+                    matrix(from, to) = distance(from, to);
+                }
+            }
+            Munkres<double>{}.solve(matrix);
+            return matrix;
+        });
+    }
+    return results;
+}
+
+}
+
+auto main(int argc, char* argv[]) -> int
+{
+    try {
+        auto const options = ParseOptions(argc, argv);
+        auto benchmarks = nlohmann::json::array();
+        auto totals = std::map<std::string, double>{};
+        auto failures = nlohmann::json::array();
+        for (auto&& result : BenchmarkAssignment(options)) {
+            totals[result["name"]] += result["mean_ms"].get<double>();
+            benchmarks.push_back(result);
+        }
+        for (auto&& path : CalChart::ShowFilesInPaths(options.shows)) {
+            try {
+                for (auto&& result : BenchmarkShow(path, options)) {
+                    totals[result["name"]] += result["mean_ms"].get<double>();
+                    benchmarks.push_back(result);
+                }
+                std::cerr << std::format("benchmarked {}\n", path.string());
+            } catch (std::exception const& e) {
+                failures.push_back({ { "show", path.string() }, { "error", e.what() } });
+            }
+        }
+        auto const report = nlohmann::json{
+            { "version", CC_GIT_VERSION },
+            { "iterations", options.iterations },
+            { "benchmarks", benchmarks },
+            { "totals_mean_ms", totals },
+            { "failures", failures },
+        };
+        if (options.output.empty()) {
+            std::cout << std::setw(4) << report << "\n";
+        } else {
+            std::ofstream(options.output) << std::setw(4) << report << "\n";
+        }
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -36,13 +36,18 @@
 
 //#define YYDEBUG 1
 
-int yyerror(const char *s);
-extern int yylex();
-extern void initscanner();
-
-std::vector<std::unique_ptr<CalChart::Cont::Procedure>> ParsedContinuity;
+%}
 
+%{
+	/* The parser is pure, with the scanner and what has been parsed so far passed in, so any number
+	   of continuities can be parsed at the same time.  The scanner hands back where each token is
+	   along with it. */
 %}
+%pure-parser
+%locations
+%parse-param {void* scanner}
+%parse-param {CalChart::Cont::ParseContext& context}
+%lex-param {void* scanner}
 
 %{
 #ifdef _MSC_VER
@@ -84,6 +89,19 @@ std::vector<std::unique_ptr<CalChart::Cont::Procedure>> ParsedContinuity;
 	CalChart::Cont::ValueVar *var;
 }
 
+%{
+int yylex(YYSTYPE* lvalp, YYLTYPE* llocp, void* scanner);
+int yyerror(YYLTYPE* llocp, void* scanner, CalChart::Cont::ParseContext& context, const char *s);
+
+// tokens are given where the scanner last read, the lookahead if the parser has one.
+template <typename T>
+T* Located(YYLTYPE const& where, T* token)
+{
+	token->SetLocation(where.first_line, where.first_column);
+	return token;
+}
+%}
+
 %type <list> proc_list
 %type <proc> procedure
 %type <pnt> point
@@ -100,88 +118,88 @@ proc_list
 	: // Empty
 		{}
 	| proc_list procedure
-		{ ParsedContinuity.emplace_back($2); }
+		{ context.procedures.emplace_back($2); }
 	;
 
 procedure
 	: varvalue '=' value
-		{ $$ = new CalChart::Cont::ProcSet($1, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcSet($1, $3)); }
 	| pBLAM
-		{ $$ = new CalChart::Cont::ProcBlam(); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcBlam()); }
 	| pCOUNTERMARCH point point value value value value
-		{ $$ = new CalChart::Cont::ProcCM($2, $3, $4, $5, $6, $7); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcCM($2, $3, $4, $5, $6, $7)); }
 	| pDMCM point point value
-		{ $$ = new CalChart::Cont::ProcDMCM($2, $3, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcDMCM($2, $3, $4)); }
 	| pDMHS point
-		{ $$ = new CalChart::Cont::ProcDMHS($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcDMHS($2)); }
 	| pEVEN value point
-		{ $$ = new CalChart::Cont::ProcEven($2, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcEven($2, $3)); }
 	| pEWNS point
-		{ $$ = new CalChart::Cont::ProcEWNS($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcEWNS($2)); }
 	| pFOUNTAIN value value point
-		{ $$ = new CalChart::Cont::ProcFountain($2, $3, NULL, NULL, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcFountain($2, $3, NULL, NULL, $4)); }
 	| pFOUNTAIN value value value value point
-		{ $$ = new CalChart::Cont::ProcFountain($2, $3, $4, $5, $6); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcFountain($2, $3, $4, $5, $6)); }
 	| pFM value value
-		{ $$ = new CalChart::Cont::ProcFM($2, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcFM($2, $3)); }
 	| pFMTO point
-		{ $$ = new CalChart::Cont::ProcFMTO($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcFMTO($2)); }
 	| pGRID value
-		{ $$ = new CalChart::Cont::ProcGrid($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcGrid($2)); }
 	| pHSCM point point value
-		{ $$ = new CalChart::Cont::ProcHSCM($2, $3, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcHSCM($2, $3, $4)); }
 	| pHSDM point
-		{ $$ = new CalChart::Cont::ProcHSDM($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcHSDM($2)); }
 	| pMAGIC point
-		{ $$ = new CalChart::Cont::ProcMagic($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcMagic($2)); }
 	| pMARCH value value value
-		{ $$ = new CalChart::Cont::ProcMarch($2, $3, $4, NULL); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcMarch($2, $3, $4, NULL)); }
 	| pMARCH value value value value
-		{ $$ = new CalChart::Cont::ProcMarch($2, $3, $4, $5); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcMarch($2, $3, $4, $5)); }
 	| pMT value value
-		{ $$ = new CalChart::Cont::ProcMT($2, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcMT($2, $3)); }
 	| pMTRM value
-		{ $$ = new CalChart::Cont::ProcMTRM($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcMTRM($2)); }
 	| pNSEW point
-		{ $$ = new CalChart::Cont::ProcNSEW($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcNSEW($2)); }
 	| pROTATE value value point
-		{ $$ = new CalChart::Cont::ProcRotate($2, $3, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ProcRotate($2, $3, $4)); }
 	;
 
 point
 	: rwP
-		{ $$ = new CalChart::Cont::Point(); }
+		{ $$ = Located(yylloc, new CalChart::Cont::Point()); }
 	| rwSP
-		{ $$ = new CalChart::Cont::StartPoint(); }
+		{ $$ = Located(yylloc, new CalChart::Cont::StartPoint()); }
 	| rwNP
-		{ $$ = new CalChart::Cont::NextPoint(); }
+		{ $$ = Located(yylloc, new CalChart::Cont::NextPoint()); }
 	| rwR FLOATCONST
-		{ $$ = new CalChart::Cont::RefPoint((unsigned)$2 - 0); }
+		{ $$ = Located(yylloc, new CalChart::Cont::RefPoint((unsigned)$2 - 0)); }
 	;
 
 value
 	: FLOATCONST
-		{ $$ = new CalChart::Cont::ValueFloat($1); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueFloat($1)); }
 	| DEFINECONST
-		{ $$ = new CalChart::Cont::ValueDefined($1); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueDefined($1)); }
 	| value '+' value
-		{ $$ = new CalChart::Cont::ValueAdd($1, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueAdd($1, $3)); }
 	| value '-' value
-		{ $$ = new CalChart::Cont::ValueSub($1, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueSub($1, $3)); }
 	| value '*' value
-		{ $$ = new CalChart::Cont::ValueMult($1, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueMult($1, $3)); }
 	| value '/' value
-		{ $$ = new CalChart::Cont::ValueDiv($1, $3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueDiv($1, $3)); }
 	| '-' value %prec UNARY
-		{ $$ = new CalChart::Cont::ValueNeg($2); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueNeg($2)); }
 	| '(' value ')'
 		{ $$ = $2; }
 	| rwREM
-		{ $$ = new CalChart::Cont::ValueREM(); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueREM()); }
 	| rwDOF
-		{ $$ = new CalChart::Cont::ValueVar(CalChart::Cont::Variable::DOF); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueVar(CalChart::Cont::Variable::DOF)); }
 	| rwDOH
-		{ $$ = new CalChart::Cont::ValueVar(CalChart::Cont::Variable::DOH); }
+		{ $$ = Located(yylloc, new CalChart::Cont::ValueVar(CalChart::Cont::Variable::DOH)); }
 	| varvalue
 		{ $$ = $1; }
 	| function
@@ -190,19 +208,19 @@ value
 
 function
 	: fDIR '(' point ')'
-		{ $$ = new CalChart::Cont::FuncDir($3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncDir($3)); }
 	| fDIRFROM '(' point point ')'
-		{ $$ = new CalChart::Cont::FuncDirFrom($3, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncDirFrom($3, $4)); }
 	| fDIST '(' point ')'
-		{ $$ = new CalChart::Cont::FuncDist($3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncDist($3)); }
 	| fDISTFROM '(' point point ')'
-		{ $$ = new CalChart::Cont::FuncDistFrom($3, $4); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncDistFrom($3, $4)); }
 	| fEITHER '(' value value point ')'
-		{ $$ = new CalChart::Cont::FuncEither($3, $4, $5); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncEither($3, $4, $5)); }
 	| fOPP '(' value ')'
-		{ $$ = new CalChart::Cont::FuncOpp($3); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncOpp($3)); }
 	| fSTEP '(' value value point ')'
-		{ $$ = new CalChart::Cont::FuncStep($3, $4, $5); }
+		{ $$ = Located(yylloc, new CalChart::Cont::FuncStep($3, $4, $5)); }
 	;
 
 varvalue
@@ -239,7 +257,7 @@ varvalue
 		    i = 6;
 		    break;
 		  }
-		  $$ = new CalChart::Cont::ValueVar(static_cast<CalChart::Cont::Variable>(i));
+		  $$ = Located(yylloc, new CalChart::Cont::ValueVar(static_cast<CalChart::Cont::Variable>(i)));
 		}
 	;
 
@@ -252,16 +270,10 @@ varvalue
 #endif // _MSC_VER
 
 
-int parsecontinuity()
-{
-  ParsedContinuity.clear();
-  initscanner();
-//  yydebug = 1;
-  return yyparse();
-}
-
-int yyerror(const char *)
+int yyerror(YYLTYPE* llocp, void*, CalChart::Cont::ParseContext& context, const char *)
 {
   // handled outside
+  context.errorLine = llocp->first_line;
+  context.errorColumn = llocp->first_column;
   return 0;
 }
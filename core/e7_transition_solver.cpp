@@ -7,13 +7,20 @@
 //
 
 #include <algorithm>
+#include <cassert>
 #include <fstream>
+#include <future>
 #include <limits>
 #include <math.h>
+#include <mutex>
+#include <optional>
 #include <random>
+#include <ranges>
+#include <thread>
+#include <unordered_map>
 
 #include "e7_transition_solver.h"
-#include "munkres.h"
+#include "CalChartAssignment.h"
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -342,23 +349,71 @@ private:
     // ------------------------------------------------
 
     /*!
-     * @brief Records all of the collisions occuring at each grid position, on each beat.
-     * @detail m_collisions[i][j][t], if it exists, contains the site of the collision
-     * between the marchers with indices i and j on beat t. If no entry exists for time
-     * t in m_collisions[i][j], then there is no collision between marchers i and j
-     * on that beat. Note that this is only accurate up to the clip beat; no collisions
-     * are recorded for any beat after the clip beat.
+     * @brief A collision between a pair of marchers on one beat.
+     * @detail The collisions of each pair are kept as a list through m_collisionRecords,
+     * linked by next (an index into m_collisionRecords plus one, or zero at the end of the list).
      */
-    mutable std::vector<std::vector<std::map<unsigned, SolverCoord>>> m_collisions;
+    struct CollisionRecord {
+        unsigned beat;
+        SolverCoord position;
+        uint32_t next;
+    };
+
+    /*!
+     * @brief What is known about a pair of marchers (the first with the lower index).
+     * @detail firstRecord is the head of the pair's list of collisions in m_collisionRecords,
+     * and collidingIndex is where the pair is in m_collidingPairs; both are an index plus one,
+     * or zero if the pair has no collisions.
+     */
+    struct MarcherPair {
+        uint32_t firstRecord;
+        uint32_t collidingIndex;
+    };
+
+    /*!
+     * @brief Records all of the collisions between each pair of marchers, on each beat.
+     * @detail m_marcherPairs[pairKey(i, j)], for i < j, holds the collisions between
+     * marchers i and j. Only pairs that have collided are kept, so this grows with the
+     * collisions rather than with the square of the number of marchers. Records that are
+     * no longer used are kept in a list starting at m_freeCollisionRecord, to be used again.
+     * Note that this is only accurate up to the clip beat; no collisions are recorded for
+     * any beat after the clip beat.
+     */
+    std::unordered_map<uint64_t, MarcherPair> m_marcherPairs;
+    std::vector<CollisionRecord> m_collisionRecords;
+    uint32_t m_freeCollisionRecord;
+
+    /*!
+     * @brief The pairs of marchers that have at least one collision, in no particular order.
+     * @detail This is kept up to date as collisions are registered and forgotten, so that
+     * collecting the collisions doesn't need to look at every pair of marchers.
+     */
+    std::vector<std::pair<unsigned, unsigned>> m_collidingPairs;
+
+    /*!
+     * @brief The size of the grid, and the number of grid positions in it.
+     */
+    unsigned m_gridXSize;
+    unsigned m_gridYSize;
+    unsigned m_numGridPositions;
 
     /*!
      * @brief Records all of the marchers that are present at each grid position, on each beat.
-     * @detail m_marcherGrid[x][y][t] is a set containing the indices of all  marchers
-     * that reside at grid location (x, y) on beat t.
-     * m_marcherGrid is reliable up to (and including) the clip beat. All locations are empty
+     * @detail The marchers at each grid position on a beat form a list:
+     * m_gridHeads[t * m_numGridPositions + gridIndex(x, y)] is the first marcher at grid
+     * location (x, y) on beat t, and m_occupancy[t * numMarchers + i].next is the marcher after
+     * marcher i. Both are a marcher index plus one, or zero at the end of the list.
+     * m_occupancy[t * numMarchers + i].gridPosition is where marcher i is on beat t, as a
+     * grid index plus one, or zero if it isn't placed on that beat.
+     * These are reliable up to (and including) the clip beat. All locations are empty
      * for all beats after the clip beat.
      */
-    mutable std::vector<std::vector<std::vector<std::set<unsigned>>>> m_marcherGrid;
+    struct Occupancy {
+        uint32_t gridPosition;
+        uint32_t next;
+    };
+    std::vector<uint32_t> m_gridHeads;
+    std::vector<Occupancy> m_occupancy;
 
     /*!
      * @brief Captures the state of all marchers on the current clip beat (that is, where they
@@ -569,35 +624,40 @@ private:
     void instructMarcher(unsigned which, const MovingMarcher& newInstructions);
 
     /*!
-     * @brief Returns the indices of all marchers present at a particular
-     * location at a particular
-     * time.
-     * @param gridX The x coordinate of the position containing the returned
-     * marchers, where the coordinate system matches the one that is understood
-     * by SolverCoords.
-     * @param gridY The y coordinate of the position containing the returned
-     * marchers, where the coordinate system matches the one that is understood
-     * by SolverCoords.
-     * @param beat The beat on which to check the occupants of the provided location.
-     * @return A set containing the indices of all marchers present at location
-     * (gridX, gridY) on provided beat.
-     */
-    const std::set<unsigned>& getMarchersAt(unsigned gridX, unsigned gridY, unsigned beat) const;
-    /*!
-     * @brief Returns the indices of all marchers present at a particular
-     * location at a particular
-     * time.
-     * @param gridX The x coordinate of the position containing the returned
-     * marchers, where the coordinate system matches the one that is understood
-     * by SolverCoords.
-     * @param gridY The y coordinate of the position containing the returned
-     * marchers, where the coordinate system matches the one that is understood
-     * by SolverCoords.
+     * @brief Converts a location into an index into the grid.
+     * @param gridX The x coordinate of the location, where the coordinate system matches
+     * the one that is understood by SolverCoords.
+     * @param gridY The y coordinate of the location, where the coordinate system matches
+     * the one that is understood by SolverCoords.
+     * @return The index of the location in the grid.
+     */
+    unsigned gridIndex(unsigned gridX, unsigned gridY) const;
+
+    /*!
+     * @brief Calls a function with the index of each marcher present at a particular
+     * location at a particular time.
+     * @param gridX The x coordinate of the location, where the coordinate system matches
+     * the one that is understood by SolverCoords.
+     * @param gridY The y coordinate of the location, where the coordinate system matches
+     * the one that is understood by SolverCoords.
      * @param beat The beat on which to check the occupants of the provided location.
-     * @return A set containing the indices of all marchers present at location
-     * (gridX, gridY) on provided beat.
+     * @param function The function to call with the index of each marcher at location
+     * (gridX, gridY) on the provided beat.
      */
-    std::set<unsigned>& getMarchersAt(unsigned gridX, unsigned gridY, unsigned beat);
+    template <typename Function>
+    void forEachMarcherAt(unsigned gridX, unsigned gridY, unsigned beat, Function function) const;
+
+    /*!
+     * @brief Finds the first collision between two marchers.
+     * @return The record of the first collision between the two marchers, or nullptr
+     * if they don't collide.
+     */
+    const CollisionRecord* firstCollisionBetweenMarchers(unsigned marcher1, unsigned marcher2) const;
+
+    /*!
+     * @brief The key of a pair of marchers in m_marcherPairs, the first with the lower index.
+     */
+    static uint64_t pairKey(unsigned firstMarcher, unsigned secondMarcher);
 
     void _forgetCollision(unsigned firstMarcher, unsigned secondMarcher, unsigned beat);
     void _registerCollision(unsigned firstMarcher, unsigned secondMarcher, unsigned beat, SolverCoord pos);
@@ -661,32 +721,25 @@ private:
      * @param firstCoord The coordinate at which all of the marcher start.
      * @param secondCoord The coordinate to which all of the marchers move by
      * the next beat.
-     * @return A set of the indices of all marchers who start at firstCoord on
+     * @return The indices of all marchers who start at firstCoord on
      * startBeat and end on secondCoord at time (startBeat + 1).
      */
-    std::set<unsigned> getMarchersWithMovePattern(unsigned startBeat, SolverCoord firstCoord, SolverCoord secondCoord) const;
+    std::vector<unsigned> getMarchersWithMovePattern(unsigned startBeat, SolverCoord firstCoord, SolverCoord secondCoord) const;
 };
 
 CollisionSpace::CollisionSpace(unsigned gridXSize, unsigned gridYSize, const std::vector<SolverCoord>& marcherStartPositions, unsigned maxBeats)
     : m_numBeats(maxBeats)
     , m_clipBeat(m_numBeats)
+    , m_freeCollisionRecord(0)
+    , m_gridXSize(gridXSize + 1)
+    , m_gridYSize(gridYSize + 1)
+    , m_numGridPositions(m_gridXSize * m_gridYSize)
     , m_cachedCollisionsNeedRefresh(true)
     , m_cachedCollisionsBeat(0)
     , m_clipBeatCollisionsNeedRefresh(true)
 {
-    m_marcherGrid.resize(gridXSize + 1);
-    for (auto yGridIter = m_marcherGrid.begin(); yGridIter != m_marcherGrid.end(); yGridIter++) {
-        auto& yGrid = *yGridIter;
-        yGrid.resize(gridYSize + 1);
-        for (auto beatsVecIter = yGrid.begin(); beatsVecIter != yGrid.end(); beatsVecIter++) {
-            auto& beatsVec = *beatsVecIter;
-            beatsVec.resize(maxBeats + 1);
-        }
-    }
-    m_collisions.resize(marcherStartPositions.size());
-    for (auto collisionsIter = m_collisions.begin(); collisionsIter != m_collisions.end(); collisionsIter++) {
-        (*collisionsIter).resize(marcherStartPositions.size());
-    }
+    m_gridHeads.resize(m_numGridPositions * (maxBeats + 1));
+    m_occupancy.resize(marcherStartPositions.size() * (maxBeats + 1));
     m_marchers.resize(marcherStartPositions.size());
     m_clippedMarchers.resize(marcherStartPositions.size());
     m_moveSchedules.resize(marcherStartPositions.size());
@@ -769,27 +822,42 @@ std::vector<Collision> CollisionSpace::collectCollisionPairs(unsigned maxBeat) c
 std::vector<Collision> CollisionSpace::_collectCollisionPairs(unsigned maxBeat) const
 {
     std::vector<Collision> collisions;
-    for (unsigned i = 0; i < m_marchers.size(); i++) {
-        for (unsigned j = i + 1; j < m_marchers.size(); j++) {
-            unsigned firstColBeat = beatsBeforeCollisionBetweenMarchers(i, j);
-            if (firstColBeat <= maxBeat) {
-                collisions.push_back({ firstColBeat, i, j, m_collisions.at(i).at(j).at(firstColBeat).toShowSpace((unsigned)m_marcherGrid.size(), (unsigned)m_marcherGrid[0].size()) });
-            }
+    for (auto [i, j] : m_collidingPairs) {
+        auto firstCollision = firstCollisionBetweenMarchers(i, j);
+        if (firstCollision->beat <= maxBeat) {
+            collisions.push_back({ firstCollision->beat, i, j, firstCollision->position.toShowSpace(m_gridXSize, m_gridYSize) });
         }
     }
+    // Keep the order of the marchers, as the algorithms work through the collisions in order
+    std::sort(collisions.begin(), collisions.end(), [](const Collision& lhs, const Collision& rhs) {
+        return std::tie(lhs.firstMarcher, lhs.secondMarcher) < std::tie(rhs.firstMarcher, rhs.secondMarcher);
+    });
     return collisions;
 }
 
-unsigned CollisionSpace::beatsBeforeCollisionBetweenMarchers(unsigned marcher1, unsigned marcher2) const
+const CollisionSpace::CollisionRecord* CollisionSpace::firstCollisionBetweenMarchers(unsigned marcher1, unsigned marcher2) const
 {
-    auto& collisionsBetweenMarchers = m_collisions[marcher1][marcher2];
-    unsigned firstColBeat = m_numBeats + 1;
-    for (auto colIter = collisionsBetweenMarchers.begin(); colIter != collisionsBetweenMarchers.end(); colIter++) {
-        if (colIter->first < firstColBeat) {
-            firstColBeat = colIter->first;
+    if (marcher1 > marcher2) {
+        std::swap(marcher1, marcher2);
+    }
+    const CollisionRecord* firstCollision = nullptr;
+    auto pair = m_marcherPairs.find(pairKey(marcher1, marcher2));
+    if (pair == m_marcherPairs.end()) {
+        return nullptr;
+    }
+    for (auto record = pair->second.firstRecord; record != 0; record = m_collisionRecords[record - 1].next) {
+        const CollisionRecord& collision = m_collisionRecords[record - 1];
+        if (firstCollision == nullptr || collision.beat < firstCollision->beat) {
+            firstCollision = &collision;
         }
     }
-    return firstColBeat;
+    return firstCollision;
+}
+
+unsigned CollisionSpace::beatsBeforeCollisionBetweenMarchers(unsigned marcher1, unsigned marcher2) const
+{
+    auto firstCollision = firstCollisionBetweenMarchers(marcher1, marcher2);
+    return firstCollision ? firstCollision->beat : m_numBeats + 1;
 }
 
 unsigned CollisionSpace::firstBeatAfterMovment() const
@@ -949,33 +1017,73 @@ void CollisionSpace::clipToBeat(unsigned clipBeat)
     m_clipBeat = clipBeat;
 }
 
-const std::set<unsigned>& CollisionSpace::getMarchersAt(unsigned gridX, unsigned gridY, unsigned beat) const
+unsigned CollisionSpace::gridIndex(unsigned gridX, unsigned gridY) const
 {
-    return m_marcherGrid.at(gridX).at(gridY).at(beat);
+    return gridX * m_gridYSize + gridY;
 }
 
-std::set<unsigned>& CollisionSpace::getMarchersAt(unsigned gridX, unsigned gridY, unsigned beat)
+template <typename Function>
+void CollisionSpace::forEachMarcherAt(unsigned gridX, unsigned gridY, unsigned beat, Function function) const
 {
-    return m_marcherGrid[gridX][gridY][beat];
+    for (auto marcher = m_gridHeads[beat * m_numGridPositions + gridIndex(gridX, gridY)]; marcher != 0; marcher = m_occupancy[beat * m_marchers.size() + marcher - 1].next) {
+        function(marcher - 1);
+    }
+}
+
+uint64_t CollisionSpace::pairKey(unsigned firstMarcher, unsigned secondMarcher)
+{
+    return (uint64_t(firstMarcher) << 32) | secondMarcher;
 }
 
 void CollisionSpace::_forgetCollision(unsigned int firstMarcher, unsigned int secondMarcher, unsigned int beat)
 {
-    auto& collisionsBetweenThem = m_collisions[firstMarcher][secondMarcher];
-    auto theCollision = collisionsBetweenThem.find(beat);
-    if (theCollision != collisionsBetweenThem.end()) {
-        collisionsBetweenThem.erase(theCollision);
+    auto found = m_marcherPairs.find(pairKey(firstMarcher, secondMarcher));
+    if (found == m_marcherPairs.end()) {
+        return;
+    }
+    auto& pair = found->second;
+    for (auto* record = &pair.firstRecord; *record != 0; record = &m_collisionRecords[*record - 1].next) {
+        auto& collision = m_collisionRecords[*record - 1];
+        if (collision.beat == beat) {
+            auto removed = *record;
+            *record = collision.next;
+            collision.next = m_freeCollisionRecord;
+            m_freeCollisionRecord = removed;
+            break;
+        }
     }
-    if (firstMarcher < secondMarcher) {
-        _forgetCollision(secondMarcher, firstMarcher, beat);
+    if (pair.firstRecord == 0 && pair.collidingIndex != 0) {
+        // Move the last colliding pair into the place of this one
+        auto [lastFirst, lastSecond] = m_collidingPairs.back();
+        m_marcherPairs.at(pairKey(lastFirst, lastSecond)).collidingIndex = pair.collidingIndex;
+        m_collidingPairs[pair.collidingIndex - 1] = m_collidingPairs.back();
+        m_collidingPairs.pop_back();
+        m_marcherPairs.erase(found);
     }
 }
 
 void CollisionSpace::_registerCollision(unsigned int firstMarcher, unsigned int secondMarcher, unsigned int beat, SolverCoord pos)
 {
-    m_collisions[firstMarcher][secondMarcher][beat] = pos;
-    if (firstMarcher < secondMarcher) {
-        _registerCollision(secondMarcher, firstMarcher, beat, pos);
+    auto& pair = m_marcherPairs[pairKey(firstMarcher, secondMarcher)];
+    for (auto record = pair.firstRecord; record != 0; record = m_collisionRecords[record - 1].next) {
+        if (m_collisionRecords[record - 1].beat == beat) {
+            m_collisionRecords[record - 1].position = pos;
+            return;
+        }
+    }
+    uint32_t added;
+    if (m_freeCollisionRecord != 0) {
+        added = m_freeCollisionRecord;
+        m_freeCollisionRecord = m_collisionRecords[added - 1].next;
+        m_collisionRecords[added - 1] = { beat, pos, pair.firstRecord };
+    } else {
+        m_collisionRecords.push_back({ beat, pos, pair.firstRecord });
+        added = (uint32_t)m_collisionRecords.size();
+    }
+    pair.firstRecord = added;
+    if (pair.collidingIndex == 0) {
+        m_collidingPairs.emplace_back(firstMarcher, secondMarcher);
+        pair.collidingIndex = (uint32_t)m_collidingPairs.size();
     }
 }
 
@@ -999,12 +1107,19 @@ void CollisionSpace::registerCollision(unsigned int firstMarcher, unsigned int s
 
 void CollisionSpace::removeMarcher(unsigned marcher, unsigned gridX, unsigned gridY, unsigned beat, const SolverCoord& moveVectorFromPrevBeat)
 {
-    auto& marchersAtGridLoc = getMarchersAt(gridX, gridY, beat);
-
-    marchersAtGridLoc.erase(marcher);
-    for (auto otherMarcher : marchersAtGridLoc) {
-        forgetCollision(marcher, otherMarcher, beat);
+    auto& occupancy = m_occupancy[beat * m_marchers.size() + marcher];
+    if (occupancy.gridPosition == gridIndex(gridX, gridY) + 1) {
+        for (auto* other = &m_gridHeads[beat * m_numGridPositions + gridIndex(gridX, gridY)]; *other != 0; other = &m_occupancy[beat * m_marchers.size() + *other - 1].next) {
+            if (*other == marcher + 1) {
+                *other = occupancy.next;
+                break;
+            }
+        }
+        occupancy = { 0, 0 };
     }
+    forEachMarcherAt(gridX, gridY, beat, [this, marcher, beat](unsigned otherMarcher) {
+        forgetCollision(marcher, otherMarcher, beat);
+    });
 
     // Retract collisions resulting from swaps
     if (beat > 0 && !(moveVectorFromPrevBeat == 0)) {
@@ -1018,11 +1133,15 @@ void CollisionSpace::removeMarcher(unsigned marcher, unsigned gridX, unsigned gr
 
 void CollisionSpace::placeMarcher(unsigned marcher, unsigned gridX, unsigned gridY, unsigned beat, const SolverCoord& moveVectorFromPrevBeat)
 {
-    SolverCoord thisLocation((int32_t)gridX, (int32_t)gridY);
-    auto& marchersAtGridLoc = getMarchersAt(gridX, gridY, beat);
-    for (auto otherMarcher : marchersAtGridLoc) {
-        registerCollision(marcher, otherMarcher, beat, CalChart::Coord(gridX, gridY));
+    auto& occupancy = m_occupancy[beat * m_marchers.size() + marcher];
+    if (occupancy.gridPosition == gridIndex(gridX, gridY) + 1) {
+        return;
     }
+    // a marcher is in one place on a beat; it has to be removed before it is placed somewhere else.
+    assert(occupancy.gridPosition == 0);
+    forEachMarcherAt(gridX, gridY, beat, [this, marcher, beat, gridX, gridY](unsigned otherMarcher) {
+        registerCollision(marcher, otherMarcher, beat, CalChart::Coord(gridX, gridY));
+    });
 
     // Add collisions resulting from swaps
     if (beat > 0 && !(moveVectorFromPrevBeat == 0)) {
@@ -1033,21 +1152,21 @@ void CollisionSpace::placeMarcher(unsigned marcher, unsigned gridX, unsigned gri
         }
     }
 
-    marchersAtGridLoc.insert(marcher);
+    auto& head = m_gridHeads[beat * m_numGridPositions + gridIndex(gridX, gridY)];
+    occupancy = { gridIndex(gridX, gridY) + 1, head };
+    head = marcher + 1;
 }
 
-std::set<unsigned> CollisionSpace::getMarchersWithMovePattern(unsigned startBeat, SolverCoord firstCoord, SolverCoord secondCoord) const
+std::vector<unsigned> CollisionSpace::getMarchersWithMovePattern(unsigned startBeat, SolverCoord firstCoord, SolverCoord secondCoord) const
 {
-    std::set<unsigned> result;
-
-    auto& marchersAtFirstCoord = getMarchersAt(firstCoord.x, firstCoord.y, startBeat);
-    auto& marchersAtSecondCoord = getMarchersAt(secondCoord.x, secondCoord.y, startBeat + 1);
+    std::vector<unsigned> result;
 
-    for (unsigned i : marchersAtFirstCoord) {
-        if (marchersAtSecondCoord.find(i) != marchersAtSecondCoord.end()) {
-            result.insert(i);
+    auto secondPosition = gridIndex(secondCoord.x, secondCoord.y) + 1;
+    forEachMarcherAt(firstCoord.x, firstCoord.y, startBeat, [this, &result, startBeat, secondPosition](unsigned i) {
+        if (m_occupancy[(startBeat + 1) * m_marchers.size() + i].gridPosition == secondPosition) {
+            result.push_back(i);
         }
-    }
+    });
 
     return result;
 }
@@ -1067,42 +1186,19 @@ void convertPositionsOnSheetToSolverSpace(const CalChart::Sheet& sheet, std::vec
 }
 
 /*!
- * @brief Creates a matrix of distances to be used with the Hungarian Algorithm,
- * for assigning marchers to destinations in such a way as to attempt to minimize
- * the total distance traveled by the marchers.
- * @detail In the returned matrix, the value at matrix(i,j) gives the manhattan
- * distance from the start location of the marcher at index i to the destination
- * at index j. The manhattan distance is equal to the number of steps that the
- * marcher would take to the destination, if it were following a NSEW or EWNS move
- * pattern. If the marcher cannot reach a particular destination within the number
- * of beats allowed for the transition, then the distance for that marcher to
- * that destination will be replaced by some huge number, effectively indicating
- * that the destination is impossible to reach.
- * @param startPositions A list of all of the marcher start locations, indexed
- * by the indices of the marchers that start at those locations.
- * @param endPositions A list of all of the possible destinations that the marchers
- * can reach.
- * @param numBeats The maximum number of beats available for the transition.
- * @return A matrix cataloguing the costs associated with moving each marcher
- * to each potential destination. The cost associated with moving marcher i to
- * destination j can be found at matrix position matrix(i,j).
+ * @brief Converts all of the point positions in a CalChart stuntsheet into the SolverCoord
+ * coordinate system, scaled by half, as the solver works on a grid with every other step.
+ * @param sheet The CalChart stuntsheet whose dot positions will be converted.
+ * @return The converted dot positions.
  */
-Matrix<double> makeHungarianDistanceMatrix(const std::vector<SolverCoord>& startPositions, const std::vector<SolverCoord>& endPositions, unsigned numBeats)
+std::vector<SolverCoord> convertPositionsOnSheetToScaledSolverSpace(const CalChart::Sheet& sheet)
 {
-    size_t numMarchers = startPositions.size();
-    Matrix<double> matrix = Matrix<double>(numMarchers, numMarchers);
-    for (size_t i = 0; i < endPositions.size(); i++) {
-        for (size_t j = 0; j < startPositions.size(); j++) {
-            auto diff = startPositions.at(j) - endPositions.at(i);
-            unsigned manhattanDist = abs(diff.x) + abs(diff.y);
-            if (manhattanDist > numBeats) {
-                matrix(j, i) = std::numeric_limits<double>::max(); // std::numeric_limits<double>::infinity();
-            } else {
-                matrix(j, i) = manhattanDist + 1;
-            }
-        }
+    std::vector<SolverCoord> positions;
+    convertPositionsOnSheetToSolverSpace(sheet, positions);
+    for (auto& position : positions) {
+        position /= 2;
     }
-    return matrix;
+    return positions;
 }
 
 /*!
@@ -1591,6 +1687,145 @@ bool DestinationConstraints::destinationIsAllowed(unsigned marcher, SolverCoord
     return destinationIsAllowed(marcher, m_destinationPositionsToIndices.at(destination));
 }
 
+/*!
+ * @brief Assigns a destination to each marcher, so as to minimize the total distance traveled by
+ * the marchers, while assigning only one marcher to each destination.
+ * @detail The distance is the manhattan distance, which is the number of steps that a marcher
+ * would take to the destination if it were following a NSEW or EWNS move pattern. A marcher is
+ * not sent to a destination that its group constraints don't allow, or that it can't reach in
+ * the number of beats allowed for the transition, unless there is no way to assign everyone
+ * otherwise.
+ * The distances are worked out once and shared by every number of beats that the solver tries.
+ * The best assignment when there is no limit on the number of beats is also the best for any
+ * number of beats that is enough for all of its marchers to reach their destinations, so it is
+ * used for those without solving again. This can be used from several threads at once; the first
+ * thread to ask for a number of beats solves for it, outside the lock, and the others wait for that.
+ */
+class DestinationAssignment {
+public:
+    /*!
+     * @brief Constructor.
+     * @param startPositions A list of all of the marcher start locations, indexed
+     * by the indices of the marchers that start at those locations.
+     * @param endPositions A list of all of the possible destinations that the marchers
+     * can reach.
+     * @param destinationConstraints The destinations that each marcher is allowed.
+     */
+    DestinationAssignment(const std::vector<SolverCoord>& startPositions, const std::vector<SolverCoord>& endPositions, const DestinationConstraints& destinationConstraints);
+
+    /*!
+     * @brief Returns the index of the destination assigned to each marcher.
+     * @param numBeats The maximum number of beats available for the transition.
+     */
+    std::vector<unsigned> assignmentsFor(unsigned numBeats);
+
+private:
+    struct Unlimited {
+        std::vector<unsigned> assignments;
+        /*!
+         * @brief The longest distance in assignments, or nothing if it needs a destination
+         * that a marcher isn't allowed.
+         */
+        std::optional<unsigned> longestDistance;
+    };
+
+    /*!
+     * @brief Solves for the assignments, allowing only the destinations within reach.
+     * @param numBeats The number of beats available for the transition; any destination further
+     * than this is not allowed.
+     */
+    std::vector<unsigned> solve(unsigned numBeats) const;
+    Unlimited solveUnlimited() const;
+
+    /*!
+     * @brief The manhattan distance from each marcher to each destination, with the distances
+     * for the destinations that a marcher is not allowed by its group constraints replaced by
+     * AssignmentProblem::kForbidden. The distance from marcher i to destination j is at
+     * m_distances[i * numMarchers + j].
+     */
+    std::vector<int32_t> m_distances;
+    size_t m_numMarchers;
+
+    // guards the maps of futures only; the futures are waited on without it.
+    std::mutex m_mutex;
+    std::shared_future<Unlimited> m_unlimited;
+    std::map<unsigned, std::shared_future<std::vector<unsigned>>> m_limited;
+};
+
+DestinationAssignment::DestinationAssignment(const std::vector<SolverCoord>& startPositions, const std::vector<SolverCoord>& endPositions, const DestinationConstraints& destinationConstraints)
+    : m_distances(startPositions.size() * endPositions.size())
+    , m_numMarchers(startPositions.size())
+{
+    for (unsigned i = 0; i < startPositions.size(); i++) {
+        for (unsigned j = 0; j < endPositions.size(); j++) {
+            auto diff = startPositions[i] - endPositions[j];
+            m_distances[i * m_numMarchers + j] = destinationConstraints.destinationIsAllowed(i, j) ? abs(diff.x) + abs(diff.y) : AssignmentProblem::kForbidden;
+        }
+    }
+}
+
+std::vector<unsigned> DestinationAssignment::assignmentsFor(unsigned numBeats)
+{
+    auto unlimited = [this] {
+        auto lock = std::lock_guard{ m_mutex };
+        if (!m_unlimited.valid()) {
+            m_unlimited = std::async(std::launch::deferred, [this] { return solveUnlimited(); }).share();
+        }
+        return m_unlimited;
+    }();
+    if (auto const& [assignments, longestDistance] = unlimited.get(); longestDistance && *longestDistance <= numBeats) {
+        return assignments;
+    }
+    auto limited = [this, numBeats] {
+        auto lock = std::lock_guard{ m_mutex };
+        auto found = m_limited.find(numBeats);
+        if (found == m_limited.end()) {
+            found = m_limited.emplace(numBeats, std::async(std::launch::deferred, [this, numBeats] { return solve(numBeats); }).share()).first;
+        }
+        return found->second;
+    }();
+    return limited.get();
+}
+
+DestinationAssignment::Unlimited DestinationAssignment::solveUnlimited() const
+{
+    auto result = Unlimited{ solve(std::numeric_limits<unsigned>::max()), 0U };
+    for (unsigned i = 0; i < m_numMarchers; i++) {
+        auto distance = m_distances[i * m_numMarchers + result.assignments.at(i)];
+        if (distance == AssignmentProblem::kForbidden) {
+            result.longestDistance.reset();
+            break;
+        }
+        result.longestDistance = std::max(*result.longestDistance, (unsigned)distance);
+    }
+    return result;
+}
+
+std::vector<unsigned> DestinationAssignment::solve(unsigned numBeats) const
+{
+    // Many assignments travel the same total distance; of those, prefer the one with the most even
+    // distances (the least sum of their squares), which keeps the longest moves short
+    int64_t longest = 0;
+    for (auto distance : m_distances) {
+        if (distance != AssignmentProblem::kForbidden && (unsigned)distance <= numBeats) {
+            longest = std::max<int64_t>(longest, distance);
+        }
+    }
+    int64_t tieBreakScale = (int64_t)m_numMarchers * longest * longest + 1;
+    bool breakTies = longest * tieBreakScale + longest * longest < AssignmentProblem::kForbidden;
+
+    AssignmentProblem problem(m_numMarchers);
+    for (unsigned i = 0; i < m_numMarchers; i++) {
+        for (unsigned j = 0; j < m_numMarchers; j++) {
+            int64_t distance = m_distances[i * m_numMarchers + j];
+            if (distance != AssignmentProblem::kForbidden && (unsigned)distance <= numBeats) {
+                problem.SetCost(i, j, (int32_t)(breakTies ? distance * tieBreakScale + distance * distance : distance));
+            }
+        }
+    }
+    return problem.Solve();
+}
+
 #pragma mark - Algorithm By: Chiu Zamora Malani
 
 // ==============================================
@@ -1879,8 +2114,12 @@ namespace e7NaminiaslRamirezZhang {
     // Second, we look through ALL options for each marcher, and choose the one that offers the LEAST number of collisions
     using namespace e7ChiuZamoraMalani;
 
-    void iterateSolution(std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace, unsigned maxBeats, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions, TransitionSolverDelegate* delegate)
+    // On the last beat, the collisions are worked on until they stop changing, which may be never, so only this many times.
+    constexpr unsigned kLastBeatImprovementIterations = 100;
+
+    void iterateSolution(std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace, unsigned maxBeats, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions, unsigned seed, TransitionSolverDelegate* delegate)
     {
+        std::mt19937 generator{ seed };
         const std::vector<SolutionAdjustmentInstruction> unfilteredOptions = unfilteredAdjustmentOptions(instructionOptions);
 
         std::vector<Collision> collisionPairs;
@@ -1898,7 +2137,11 @@ namespace e7NaminiaslRamirezZhang {
 
             collisionSpace.clipToBeat(beat);
 
-            for (unsigned improvementIteration = 0; improvementIteration < 3 || beat == maxBeats; improvementIteration++) {
+            for (unsigned improvementIteration = 0; improvementIteration < (beat == maxBeats ? kLastBeatImprovementIterations : 3); improvementIteration++) {
+                if (improvementIteration > 0 && delegate && delegate->ShouldAbortCalculation()) {
+                    break;
+                }
+
                 collisionPairs = collisionSpace.collectCollisionPairs();
 
                 if (collisionPairs == lastCollisionPairs) {
@@ -1908,8 +2151,7 @@ namespace e7NaminiaslRamirezZhang {
 
                 lastCollisionPairs = collisionSpace.collectCollisionPairs();
 
-                std::random_device rd;
-                std::shuffle(collisionPairs.begin(), collisionPairs.end(), std::mt19937{ rd() });
+                std::shuffle(collisionPairs.begin(), collisionPairs.end(), generator);
                 for (unsigned collisionIndex = 0; collisionIndex < collisionPairs.size(); collisionIndex++) {
 
                     Collision& col = collisionPairs[collisionIndex];
@@ -2016,8 +2258,10 @@ namespace e7NaminiaslRamirezZhang {
 
 namespace e7SoverEliceiriHershkovitz {
 
-    void iterateSolution(std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace, unsigned /*maxBeats*/, const DestinationConstraints& /*destinationConstraints*/, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions, TransitionSolverDelegate* delegate)
+    void iterateSolution(std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace, unsigned /*maxBeats*/, const DestinationConstraints& /*destinationConstraints*/, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions, unsigned seed, TransitionSolverDelegate* delegate)
     {
+        std::mt19937 generator{ seed };
+
         // Prioritize commands in the order that we will be willing to give them to a marcher
         // We're much more willing to change direction than to increase the number of wait beats
         std::vector<TransitionSolverParams::MarcherInstruction> prioritizedInstructionOptions = instructionOptions;
@@ -2105,8 +2349,7 @@ namespace e7SoverEliceiriHershkovitz {
             }
 
             // Shuffle the people who need priority of replacement
-            std::random_device rd;
-            std::shuffle(unplacedMarchers.begin(), unplacedMarchers.end(), std::mt19937{ rd() });
+            std::shuffle(unplacedMarchers.begin(), unplacedMarchers.end(), generator);
 
             // Re-add the unplaced marchers with higher priority
             marchOrder.insert(marchOrder.begin(), unplacedMarchers.begin(), unplacedMarchers.end());
@@ -2134,7 +2377,7 @@ std::vector<std::string> validateSheetForTransitionSolver(const CalChart::Sheet&
 {
     std::vector<std::string> errors;
 
-    // Verify that all points are in the grid, and that all of them can be converted to and from solver space
+    // Verify that all points are in the grid, on the field, and that all of them can be converted to and from solver space
     for (unsigned i = 0; i < sheet.GetAllMarchers().size(); i++) {
         CalChart::Coord showPosition;
         SolverCoord solverPosition;
@@ -2148,64 +2391,285 @@ std::vector<std::string> validateSheetForTransitionSolver(const CalChart::Sheet&
         if (solverPosition.toShowSpace() != showPosition) {
             errors.push_back("Bad location for marcher " + std::to_string(i));
         }
+        if (solverPosition.x < 0 || solverPosition.x > (int32_t)SolverCoord::kFieldWidthInSteps || solverPosition.y < 0 || solverPosition.y > (int32_t)SolverCoord::kFieldHeightInSteps) {
+            errors.push_back("Marcher " + std::to_string(i) + " is not on the field.");
+        }
     }
 
     return errors;
 }
 
-TransitionSolverResult runSolverWithExplicitBeatCap(const CalChart::Sheet& sheet1, const CalChart::Sheet& sheet2, TransitionSolverParams params, unsigned numBeats, TransitionSolverDelegate* delegate)
+/*!
+ * @brief Returns how many threads to use, given the number asked for in the TransitionSolverParams.
+ */
+unsigned resolveNumberThreads(unsigned numberThreads)
 {
+    if (numberThreads == 0) {
+        return std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    return numberThreads;
+}
 
-    TransitionSolverResult results;
-
-    // Convert the start and end locations of the stuntsheets so that they are represented in the SolverCoord coordinate system
-    std::vector<SolverCoord> startPositions;
-    std::vector<SolverCoord> endPositions;
-    convertPositionsOnSheetToSolverSpace(sheet1, startPositions);
-    convertPositionsOnSheetToSolverSpace(sheet2, endPositions);
-
-    auto fieldWidth = SolverCoord::kFieldWidthInSteps;
-    auto fieldHeight = SolverCoord::kFieldHeightInSteps;
-    unsigned maxBeats = numBeats;
-
-    // Scale the field and the transition duration by half, so that we can perform less calculations
-    fieldWidth /= 2;
-    fieldHeight /= 2;
-    maxBeats /= 2;
-    for (unsigned i = 0; i < startPositions.size(); i++) {
-        startPositions[i] /= 2;
-        endPositions[i] /= 2;
+/*!
+ * @brief Runs one of the algorithms to improve a solution.
+ * @param algorithm The algorithm to run. This can't be E7_ALGORITHM__PORTFOLIO.
+ * @param seed The seed for the random choices the algorithm makes, if it makes any.
+ */
+void iterateSolution(TransitionSolverParams::AlgorithmIdentifier algorithm, std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace, unsigned maxBeats, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions, unsigned seed, TransitionSolverDelegate* delegate)
+{
+    switch (algorithm) {
+    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__CHIU_ZAMORA_MALANI:
+        e7ChiuZamoraMalani::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, delegate);
+        break;
+    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG:
+        e7NaminiaslRamirezZhang::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, seed, delegate);
+        break;
+    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ:
+        e7SoverEliceiriHershkovitz::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, seed, delegate);
+        break;
+    default:
+        break;
     }
+}
 
-    // Generate a preliminary cost matrix for the hungarian algorithm
-    // This will minimize the distance travelled by our marchers (assuming they are moving either EWNS or NSEW) to get to the next stuntsheet, while assigning only one marcher to each destination
-    // We will use this to assign reasonable destinations to each marcher to start
-    Matrix<double> distances;
-    DestinationConstraints destinationConstraints(params.groups, endPositions);
-    distances = makeHungarianDistanceMatrix(startPositions, endPositions, maxBeats);
+/*!
+ * @brief Returns a number of beats that no solution to the transition can be shorter than.
+ * @detail A marcher moves at most one step along each axis on each beat, and waits at least as
+ * long as the shortest wait of any instruction, so no marcher can finish sooner than that wait
+ * plus the larger of its distances along each axis to the closest destination it is allowed.
+ */
+unsigned fewestPossibleBeats(const std::vector<SolverCoord>& startPositions, const std::vector<SolverCoord>& endPositions, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions)
+{
+    unsigned shortestWait = std::numeric_limits<unsigned>::max();
+    for (auto&& instruction : instructionOptions) {
+        shortestWait = std::min(shortestWait, instruction.waitBeats);
+    }
+    if (instructionOptions.empty()) {
+        shortestWait = 0;
+    }
 
-    // Here, we take into account the constraints that were passed to us in the TransitionSolverParams
-    // For any assignment that matches a marcher to a destination that is not listed as one of its allowed destinations in the group constraints, we'll make the cost outrageously large
+    unsigned fewestBeats = 0;
     for (unsigned i = 0; i < startPositions.size(); i++) {
+        unsigned closest = std::numeric_limits<unsigned>::max();
         for (unsigned k = 0; k < endPositions.size(); k++) {
-            if (!destinationConstraints.destinationIsAllowed(i, k)) {
-                distances(i, k) = std::numeric_limits<double>::max();
+            if (destinationConstraints.destinationIsAllowed(i, k)) {
+                SolverCoord diff = endPositions[k] - startPositions[i];
+                closest = std::min(closest, (unsigned)std::max(std::abs(diff.x), std::abs(diff.y)));
+            }
+        }
+        if (closest != std::numeric_limits<unsigned>::max()) {
+            fewestBeats = std::max(fewestBeats, closest + shortestWait);
+        }
+    }
+    return fewestBeats;
+}
+
+/*!
+ * @brief Runs several algorithms, or one randomized algorithm with several seeds, on the same beat
+ * cap, each on its own copy of the collision space, and keeps the best solution that any of them
+ * finds.
+ * @detail For E7_ALGORITHM__PORTFOLIO, each algorithm is run once, and then the randomized ones are
+ * run again as restarts, as many times as TransitionSolverParams::portfolioRestarts asks. For a
+ * randomized algorithm, it is run as many times as TransitionSolverParams::multiStartRuns asks. Up
+ * to the given number run at once, in that order. Once one of them solves the transition in as few
+ * beats as any solution could take, the ones after it are cancelled, since none of them could do
+ * better; the ones before it keep going, as they'd win a tie, so which solution is kept doesn't
+ * depend on which finished first.
+ */
+class AlgorithmPortfolio {
+public:
+    class Entrant : public TransitionSolverDelegate {
+    public:
+        Entrant(AlgorithmPortfolio& portfolio, unsigned which, TransitionSolverParams::AlgorithmIdentifier algorithm, unsigned seed, const std::vector<MarcherSolution>& marcherSolutions, const CollisionSpace& collisionSpace)
+            : mPortfolio(portfolio)
+            , mWhich(which)
+            , mAlgorithm(algorithm)
+            , mSeed(seed)
+            , mMarcherSolutions(marcherSolutions)
+            , mCollisionSpace(collisionSpace)
+        {
+        }
+
+        void run(unsigned maxBeats, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions)
+        {
+            iterateSolution(mAlgorithm, mMarcherSolutions, mCollisionSpace, maxBeats, destinationConstraints, instructionOptions, mSeed, this);
+            mPortfolio.finished(mWhich, mCollisionSpace.isSolved(), mCollisionSpace.firstBeatAfterMovment());
+        }
+
+        void OnProgress(double) override { }
+        void OnSubtaskProgress(double progress) override { mPortfolio.subtaskProgress(mWhich, progress); }
+        void OnNewPreferredSolution(unsigned) override { }
+        void OnCalculationComplete(TransitionSolverResult) override { }
+        bool ShouldAbortCalculation() override { return mPortfolio.shouldAbort(mWhich); }
+
+    private:
+        friend class AlgorithmPortfolio;
+
+        AlgorithmPortfolio& mPortfolio;
+        unsigned mWhich;
+        TransitionSolverParams::AlgorithmIdentifier mAlgorithm;
+        unsigned mSeed;
+        std::vector<MarcherSolution> mMarcherSolutions;
+        CollisionSpace mCollisionSpace;
+    };
+
+    AlgorithmPortfolio(const TransitionSolverParams& params, const std::vector<MarcherSolution>& marcherSolutions, const CollisionSpace& collisionSpace, unsigned fewestPossibleBeats, TransitionSolverDelegate* delegate)
+        : mDelegate(delegate)
+        , mFewestPossibleBeats(fewestPossibleBeats)
+    {
+        auto runs = runsToMake(params);
+        mEntrants.reserve(runs.size());
+        for (unsigned i = 0; i < runs.size(); i++) {
+            mEntrants.emplace_back(*this, i, runs[i].first, runs[i].second, marcherSolutions, collisionSpace);
+        }
+        mSubtaskProgress.resize(mEntrants.size(), 0.0);
+    }
+
+    /*!
+     * @brief The algorithms to run for the given parameters, and the seed for each, in the order
+     * that they are started. Each run of an algorithm after its first uses the next seed.
+     */
+    static std::vector<std::pair<TransitionSolverParams::AlgorithmIdentifier, unsigned>> runsToMake(const TransitionSolverParams& params)
+    {
+        using AlgorithmIdentifier = TransitionSolverParams::AlgorithmIdentifier;
+        switch (params.algorithm) {
+        case AlgorithmIdentifier::E7_ALGORITHM__PORTFOLIO: {
+            std::vector<std::pair<AlgorithmIdentifier, unsigned>> runs = {
+                { AlgorithmIdentifier::E7_ALGORITHM__CHIU_ZAMORA_MALANI, params.seed },
+                { AlgorithmIdentifier::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG, params.seed },
+                { AlgorithmIdentifier::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ, params.seed },
+            };
+            for (unsigned i = 1; i <= params.portfolioRestarts; i++) {
+                runs.emplace_back(AlgorithmIdentifier::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG, params.seed + i);
+                runs.emplace_back(AlgorithmIdentifier::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ, params.seed + i);
+            }
+            return runs;
+        }
+        case AlgorithmIdentifier::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG:
+        case AlgorithmIdentifier::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ: {
+            std::vector<std::pair<AlgorithmIdentifier, unsigned>> runs;
+            for (unsigned i = 0; i < std::max(params.multiStartRuns, 1U); i++) {
+                runs.emplace_back(params.algorithm, params.seed + i);
+            }
+            return runs;
+        }
+        default:
+            return { { params.algorithm, params.seed } };
+        }
+    }
+
+    void run(unsigned numberThreads, unsigned maxBeats, const DestinationConstraints& destinationConstraints, const std::vector<TransitionSolverParams::MarcherInstruction>& instructionOptions)
+    {
+        auto runEntrants = [this, maxBeats, &destinationConstraints, &instructionOptions] {
+            while (auto which = nextEntrant()) {
+                mEntrants[*which].run(maxBeats, destinationConstraints, instructionOptions);
             }
+        };
+        // The first thread is this one
+        std::vector<std::future<void>> futures;
+        for (unsigned i = 1; i < std::min<size_t>(numberThreads, mEntrants.size()); i++) {
+            futures.push_back(std::async(std::launch::async, runEntrants));
+        }
+        runEntrants();
+        for (auto&& future : futures) {
+            future.get();
         }
     }
 
-    // Use the hungarian algorithm to come up with a reasonable destination for each marcher (ignoring collisions)
-    Munkres<double> solver;
-    solver.solve(distances);
-    std::vector<unsigned> assignments;
-    for (size_t i = 0; i < startPositions.size(); i++) {
-        for (size_t j = 0; j < startPositions.size(); j++) {
-            if (distances(i, j) == 0) {
-                assignments.push_back((unsigned)j);
+    /*!
+     * @brief Replaces the solution with the best one that was found: a solved one over an unsolved
+     * one, then the fewest beats of movement, with ties going to whichever was started first.
+     */
+    void takeBestSolution(std::vector<MarcherSolution>& marcherSolutions, CollisionSpace& collisionSpace)
+    {
+        Entrant* best = nullptr;
+        for (auto&& entrant : mEntrants) {
+            if (!entrant.mCollisionSpace.isSolved()) {
+                continue;
+            }
+            if (best == nullptr || entrant.mCollisionSpace.firstBeatAfterMovment() < best->mCollisionSpace.firstBeatAfterMovment()) {
+                best = &entrant;
             }
         }
+        if (best == nullptr) {
+            best = &mEntrants.front();
+        }
+        marcherSolutions = std::move(best->mMarcherSolutions);
+        collisionSpace = std::move(best->mCollisionSpace);
+    }
+
+private:
+    std::optional<unsigned> nextEntrant()
+    {
+        auto lock = std::lock_guard{ mMutex };
+        if (mAborted || mNextEntrant >= mEntrants.size() || isCancelled(mNextEntrant)) {
+            return std::nullopt;
+        }
+        return mNextEntrant++;
+    }
+
+    void finished(unsigned which, bool solved, unsigned numBeats)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mSubtaskProgress.at(which) = 1.0;
+        if (solved && numBeats <= mFewestPossibleBeats && !isCancelled(which)) {
+            mCancelledAfter = which;
+        }
+    }
+
+    void subtaskProgress(unsigned which, double progress)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mSubtaskProgress.at(which) = progress;
+        if (mDelegate) {
+            auto total = 0.0;
+            for (auto&& entrantProgress : mSubtaskProgress) {
+                total += entrantProgress;
+            }
+            mDelegate->OnSubtaskProgress(total / (double)mSubtaskProgress.size());
+        }
+    }
+
+    bool shouldAbort(unsigned which)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        if (!mAborted && mDelegate && mDelegate->ShouldAbortCalculation()) {
+            mAborted = true;
+        }
+        return mAborted || isCancelled(which);
     }
 
+    bool isCancelled(unsigned which) const { return mCancelledAfter && which > *mCancelledAfter; }
+
+    std::mutex mMutex;
+    TransitionSolverDelegate* mDelegate;
+    unsigned mFewestPossibleBeats;
+    std::vector<Entrant> mEntrants;
+    std::vector<double> mSubtaskProgress;
+    unsigned mNextEntrant = 0;
+    bool mAborted = false;
+    // the first entrant to solve in the fewest possible beats; the ones after it are cancelled.
+    std::optional<unsigned> mCancelledAfter;
+};
+
+TransitionSolverResult runSolverWithExplicitBeatCap(const CalChart::Sheet& sheet1, const CalChart::Sheet& sheet2, TransitionSolverParams params, unsigned numBeats, DestinationAssignment& destinationAssignment, TransitionSolverDelegate* delegate)
+{
+
+    TransitionSolverResult results;
+
+    // Convert the start and end locations of the stuntsheets so that they are represented in the SolverCoord coordinate system
+    // The field and the transition duration are scaled by half, so that we can perform less calculations
+    std::vector<SolverCoord> startPositions = convertPositionsOnSheetToScaledSolverSpace(sheet1);
+    std::vector<SolverCoord> endPositions = convertPositionsOnSheetToScaledSolverSpace(sheet2);
+
+    auto fieldWidth = SolverCoord::kFieldWidthInSteps / 2;
+    auto fieldHeight = SolverCoord::kFieldHeightInSteps / 2;
+    unsigned maxBeats = numBeats / 2;
+
+    // Assign a reasonable destination to each marcher to start, minimizing the distance travelled by our marchers (ignoring collisions)
+    DestinationConstraints destinationConstraints(params.groups, endPositions);
+    std::vector<unsigned> assignments = destinationAssignment.assignmentsFor(maxBeats);
+
     std::vector<MarcherSolution> marcherSolutions(assignments.size());
 
     CollisionSpace collisionSpace(fieldWidth, fieldHeight, startPositions, maxBeats);
@@ -2230,18 +2694,13 @@ TransitionSolverResult runSolverWithExplicitBeatCap(const CalChart::Sheet& sheet
     if (delegate) {
         delegate->OnSubtaskProgress(0);
     }
-    switch (params.algorithm) {
-    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__CHIU_ZAMORA_MALANI:
-        e7ChiuZamoraMalani::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, delegate);
-        break;
-    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG:
-        e7NaminiaslRamirezZhang::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, delegate);
-        break;
-    case TransitionSolverParams::AlgorithmIdentifier::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ:
-        e7SoverEliceiriHershkovitz::iterateSolution(marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, delegate);
-        break;
-    default:
-        break;
+    if (AlgorithmPortfolio::runsToMake(params).size() > 1) {
+        unsigned fewestBeats = fewestPossibleBeats(startPositions, endPositions, destinationConstraints, instructionOptions);
+        AlgorithmPortfolio portfolio(params, marcherSolutions, collisionSpace, fewestBeats, delegate);
+        portfolio.run(resolveNumberThreads(params.numberThreads), maxBeats, destinationConstraints, instructionOptions);
+        portfolio.takeBestSolution(marcherSolutions, collisionSpace);
+    } else {
+        iterateSolution(params.algorithm, marcherSolutions, collisionSpace, maxBeats, destinationConstraints, instructionOptions, params.seed, delegate);
     }
     if (delegate) {
         delegate->OnSubtaskProgress(1);
@@ -2297,46 +2756,193 @@ TransitionSolverResult runSolverWithExplicitBeatCap(const CalChart::Sheet& sheet
     return results;
 }
 
-TransitionSolverResult runTransitionSolver(const CalChart::Sheet& sheet1, const CalChart::Sheet& sheet2, TransitionSolverParams params, TransitionSolverDelegate* delegate)
-{
+/*!
+ * @brief Hands out the beat caps that runTransitionSolver tries, to however many threads are
+ * solving them, and keeps what they find.
+ * @detail Each thread solves through its own Worker, which stands in for the caller's delegate:
+ * calls to the caller's delegate are made one at a time, and subtask progress is the average over
+ * the caps being solved. Every cap is solved, so the result is the same as solving them one after
+ * another, unless stopAtFirstSolved is set; then a cap is aborted once a shorter cap has been
+ * solved.
+ */
+class BeatCapSweep {
+public:
+    class Worker : public TransitionSolverDelegate {
+    public:
+        Worker(BeatCapSweep& sweep, unsigned which)
+            : mSweep(sweep)
+            , mWhich(which)
+        {
+        }
 
-    TransitionSolverResult finalResult;
-    TransitionSolverResult recentResult;
+        void run(const CalChart::Sheet& sheet1, const CalChart::Sheet& sheet2, const TransitionSolverParams& params)
+        {
+            while (auto cap = mSweep.nextCap(mWhich)) {
+                mCap = *cap;
+                mSweep.finished(mWhich, mCap, runSolverWithExplicitBeatCap(sheet1, sheet2, params, mCap * 2, mSweep.mDestinationAssignment, this));
+            }
+        }
 
-    auto scaledHighestBeatCap = (sheet1.GetBeats() + (sheet1.GetBeats() / 2)) / 2;
-    auto scaledBeatCapForCurrentCalculation = CalChart::Beats{};
-    finalResult.successfullySolved = false;
-    finalResult.numBeatsOfMovement = sheet1.GetBeats();
+        void OnProgress(double) override { }
+        void OnSubtaskProgress(double progress) override { mSweep.subtaskProgress(mWhich, progress); }
+        void OnNewPreferredSolution(unsigned) override { }
+        void OnCalculationComplete(TransitionSolverResult) override { }
+        bool ShouldAbortCalculation() override { return mSweep.shouldAbort(mCap); }
 
-    // Try to solve the transition at different transition durations, starting from 0 and increasing to from there
-    // This will give us chances to find different solutions to the problem, and we can choose the best solution from the options
-    // Since the best options are more likely to be found when we force a shorter number of beats in the transition, we'll start the transition duration at zero and count up
-    while (scaledBeatCapForCurrentCalculation <= scaledHighestBeatCap) {
+    private:
+        BeatCapSweep& mSweep;
+        unsigned mWhich;
+        unsigned mCap = 0;
+    };
 
-        // If a delegate was provided, indicate the current process, and offer an opportunity to end the calculation prematurely
-        if (delegate) {
-            delegate->OnProgress(((double)scaledBeatCapForCurrentCalculation) / (double)scaledHighestBeatCap);
-            if (delegate->ShouldAbortCalculation()) {
-                break;
+    BeatCapSweep(unsigned numCaps, unsigned numWorkers, bool stopAtFirstSolved, DestinationAssignment& destinationAssignment, TransitionSolverDelegate* delegate)
+        : mStopAtFirstSolved(stopAtFirstSolved)
+        , mDelegate(delegate)
+        , mDestinationAssignment(destinationAssignment)
+        , mResults(numCaps)
+        , mSubtaskProgress(numWorkers)
+    {
+    }
+
+    /*!
+     * @brief The result the sequential sweep would have settled on from the caps that were solved:
+     * the fewest beats of movement, with ties going to the longer cap.
+     */
+    TransitionSolverResult bestResult(unsigned beatsIfUnsolved) const
+    {
+        TransitionSolverResult finalResult;
+        finalResult.successfullySolved = false;
+        finalResult.numBeatsOfMovement = beatsIfUnsolved;
+        for (auto&& result : mResults) {
+            if (result && result->successfullySolved && result->numBeatsOfMovement <= finalResult.numBeatsOfMovement) {
+                finalResult = *result;
             }
         }
+        return finalResult;
+    }
 
-        // Solve the transition for the current transition duration
-        recentResult = runSolverWithExplicitBeatCap(sheet1, sheet2, params, scaledBeatCapForCurrentCalculation * 2, delegate);
+private:
+    std::optional<unsigned> nextCap(unsigned worker)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mSubtaskProgress.at(worker).reset();
+        if (mAborted || mNextCap >= mResults.size() || mNextCap > mShortestSolvedCap) {
+            return std::nullopt;
+        }
+        if (mDelegate) {
+            mDelegate->OnProgress((double)mNextCap / (double)mResults.size());
+            if (mDelegate->ShouldAbortCalculation()) {
+                mAborted = true;
+                return std::nullopt;
+            }
+        }
+        mSubtaskProgress.at(worker) = 0.0;
+        return mNextCap++;
+    }
 
-        // If a solution was successfully found, compare it to our current favorite solution, and remember the new one instead if it is better
-        if (recentResult.successfullySolved) {
-            if (recentResult.numBeatsOfMovement <= finalResult.numBeatsOfMovement) {
-                finalResult = recentResult;
-                if (delegate) {
-                    delegate->OnNewPreferredSolution(finalResult.numBeatsOfMovement);
+    void finished(unsigned worker, unsigned cap, TransitionSolverResult result)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mSubtaskProgress.at(worker).reset();
+        // a longer cap than one that was solved was aborted, so what it has is thrown away.
+        if (cap > mShortestSolvedCap) {
+            return;
+        }
+        if (result.successfullySolved) {
+            if (mStopAtFirstSolved) {
+                mShortestSolvedCap = cap;
+                for (auto& longer : mResults | std::views::drop(cap + 1)) {
+                    longer.reset();
                 }
             }
+            auto isBetter = [&result](auto&& other) { return other && other->successfullySolved && other->numBeatsOfMovement < result.numBeatsOfMovement; };
+            if (mDelegate && std::ranges::none_of(mResults, isBetter)) {
+                mDelegate->OnNewPreferredSolution(result.numBeatsOfMovement);
+            }
         }
+        mResults.at(cap) = std::move(result);
+    }
 
-        scaledBeatCapForCurrentCalculation += 1;
+    void subtaskProgress(unsigned worker, double progress)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mSubtaskProgress.at(worker) = progress;
+        if (!mDelegate) {
+            return;
+        }
+        auto total = 0.0;
+        auto count = 0;
+        for (auto&& workerProgress : mSubtaskProgress) {
+            if (workerProgress) {
+                total += *workerProgress;
+                ++count;
+            }
+        }
+        mDelegate->OnSubtaskProgress(total / count);
     }
 
+    bool shouldAbort(unsigned cap)
+    {
+        auto lock = std::lock_guard{ mMutex };
+        if (!mAborted && mDelegate && mDelegate->ShouldAbortCalculation()) {
+            mAborted = true;
+        }
+        return mAborted || cap > mShortestSolvedCap;
+    }
+
+    std::mutex mMutex;
+    bool mStopAtFirstSolved;
+    TransitionSolverDelegate* mDelegate;
+    DestinationAssignment& mDestinationAssignment;
+    std::vector<std::optional<TransitionSolverResult>> mResults;
+    // the progress of the cap each worker is solving, if it is solving one.
+    std::vector<std::optional<double>> mSubtaskProgress;
+    unsigned mNextCap = 0;
+    unsigned mShortestSolvedCap = std::numeric_limits<unsigned>::max();
+    bool mAborted = false;
+};
+
+TransitionSolverResult runTransitionSolver(const CalChart::Sheet& sheet1, const CalChart::Sheet& sheet2, TransitionSolverParams params, TransitionSolverDelegate* delegate)
+{
+    // Try to solve the transition at different transition durations, starting from 0 and increasing to from there
+    // This will give us chances to find different solutions to the problem, and we can choose the best solution from the options
+    // Since the best options are more likely to be found when we force a shorter number of beats in the transition, we'll start the transition duration at zero and count up
+    // The durations are solved on several threads at once, shortest first.  Once one is solved the longer ones are cancelled, unless asked to solve all of them
+    unsigned numCaps = (sheet1.GetBeats() + (sheet1.GetBeats() / 2)) / 2 + 1;
+    unsigned numberThreads = resolveNumberThreads(params.numberThreads);
+    // A portfolio, or a multi-start run, makes several runs on each duration, so the threads are shared between the durations and the runs
+    if (auto runsForEachCap = (unsigned)AlgorithmPortfolio::runsToMake(params).size(); runsForEachCap > 1) {
+        unsigned threadsForEachCap = std::min(numberThreads, runsForEachCap);
+        params.numberThreads = threadsForEachCap;
+        numberThreads = std::max(numberThreads / threadsForEachCap, 1U);
+    }
+    numberThreads = std::min(numberThreads, numCaps);
+
+    // The destinations are assigned from the same distances for every duration, so they're only worked out once
+    std::vector<SolverCoord> startPositions = convertPositionsOnSheetToScaledSolverSpace(sheet1);
+    std::vector<SolverCoord> endPositions = convertPositionsOnSheetToScaledSolverSpace(sheet2);
+    DestinationAssignment destinationAssignment(startPositions, endPositions, DestinationConstraints(params.groups, endPositions));
+
+    BeatCapSweep sweep(numCaps, numberThreads, params.stopAtFirstSolvedDuration, destinationAssignment, delegate);
+    std::vector<BeatCapSweep::Worker> workers;
+    workers.reserve(numberThreads);
+    for (unsigned i = 0; i < numberThreads; i++) {
+        workers.emplace_back(sweep, i);
+    }
+    // The first worker runs on this thread while the others run
+    std::vector<std::future<void>> futures;
+    for (unsigned i = 1; i < numberThreads; i++) {
+        futures.push_back(std::async(std::launch::async, [&worker = workers[i], &sheet1, &sheet2, &params] {
+            worker.run(sheet1, sheet2, params);
+        }));
+    }
+    workers.front().run(sheet1, sheet2, params);
+    for (auto&& future : futures) {
+        future.get();
+    }
+
+    TransitionSolverResult finalResult = sweep.bestResult(sheet1.GetBeats());
+
     // Inform the delegate of the final solution, if a delegate exists
     if (delegate) {
         delegate->OnCalculationComplete(finalResult);
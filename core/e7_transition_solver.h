@@ -24,12 +24,16 @@ struct TransitionSolverParams {
     /*!
      * @brief An enumeration that uniquely identifies
      * each algorithm that can be used to solve a transition.
+     * @detail E7_ALGORITHM__PORTFOLIO isn't an algorithm of its own: it
+     * runs all of the others against each other, and keeps the best solution
+     * that any of them finds.
      */
     enum AlgorithmIdentifier {
         BEGIN = 0,
         E7_ALGORITHM__CHIU_ZAMORA_MALANI = BEGIN,
         E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG,
         E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ,
+        E7_ALGORITHM__PORTFOLIO,
         END,
     };
 
@@ -134,6 +138,51 @@ struct TransitionSolverParams {
      * indicates that the instruction cannot be used.
      */
     std::array<bool, 8> availableInstructionsMask;
+
+    /*!
+     * @brief How many of the transition durations the solver tries are
+     * solved at once, each on its own thread.
+     * @detail A value of 0 uses one thread for each core.
+     */
+    unsigned numberThreads = 0;
+
+    /*!
+     * @brief Whether to stop trying longer transition durations once a shorter
+     * one has been solved.
+     * @detail By default the longer durations still being solved are cancelled,
+     * and the shortest solved duration is kept. Turning this off tries every
+     * duration and keeps the solution with the fewest beats of movement, since a
+     * longer duration can still give a shorter solution, at the cost of solving
+     * all of them.
+     */
+    bool stopAtFirstSolvedDuration = true;
+
+    /*!
+     * @brief When the algorithm is E7_ALGORITHM__PORTFOLIO, how many more times
+     * each of the randomized algorithms is run, in addition to once.
+     * @detail Each run uses a different seed, so more runs give more chances of
+     * finding a shorter solution, at the cost of more work.
+     */
+    unsigned portfolioRestarts = 2;
+
+    /*!
+     * @brief The seed for the random choices that the randomized algorithms
+     * make, so that solving the same transition with the same parameters
+     * always gives the same solution.
+     */
+    unsigned seed = 0;
+
+    /*!
+     * @brief When the algorithm is E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG or
+     * E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ, how many times it is run on
+     * each transition duration, each run with its own seed, keeping the best
+     * solution.
+     * @detail The runs share the threads given by numberThreads with the
+     * durations. The first run uses seed and the rest count up from it, so the
+     * solution doesn't depend on the number of threads, and more runs never
+     * solve a duration worse than fewer would.
+     */
+    unsigned multiStartRuns = 1;
 };
 
 /*!
@@ -192,6 +241,8 @@ struct TransitionSolverResult {
  * in the transition solving process by helping control when to abort
  * and by receiving live notifications about the progress of the solver while
  * it works.
+ * @detail The solver may call these methods from threads other than the one it
+ * was started on, but never more than one at a time.
  */
 class TransitionSolverDelegate {
 public:
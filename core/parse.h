@@ -21,9 +21,28 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-struct YYLTYPE {
-    int first_line;
-    int first_column;
+#include "CalChartContinuityToken.h"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace CalChart::Cont {
+
+// Everything one parse of a continuity works with.  The scanner and parser keep nothing between calls,
+// so continuities can be parsed on as many threads as needed.
+struct ParseContext {
+    std::string_view text;
+    int line = 1;
+    int column = 1;
+    std::vector<std::unique_ptr<Procedure>> procedures;
+    // where the parser gave up.
+    int errorLine = 0;
+    int errorColumn = 0;
 };
 
-extern YYLTYPE yylloc;
+// Parses context.text into context.procedures.  Returns 0 on success; on failure the context has where the
+// parser gave up.
+auto ParseContinuityText(ParseContext& context) -> int;
+
+}
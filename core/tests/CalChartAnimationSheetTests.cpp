@@ -1,5 +1,6 @@
 #include "CalChartAnimationSheet.h"
 #include <catch2/catch_test_macros.hpp>
+#include <random>
 
 // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, cppcoreguidelines-avoid-do-while, readability-magic-numbers, readability-function-cognitive-complexity)
 
@@ -35,6 +36,19 @@ TEST_CASE("AnimationSheetTest", "Animate::Sheet")
     auto collided = uut.GetAllMarchersWithCollisionAtBeat(6);
     CHECK(collisions == std::set<CalChart::Beats>{ 6 });
     CHECK(collided == CalChart::SelectionList{ 0, 1 });
+
+    for (auto beat : std::views::iota(0U, uut.GetNumBeats())) {
+        auto infos = uut.AllAnimateInfoAtBeat(beat);
+        REQUIRE(infos.size() == 2);
+        for (auto whichMarcher : { 0U, 1U }) {
+            CHECK(infos[whichMarcher].mIndex == whichMarcher);
+            CHECK(infos[whichMarcher].mMarcherInfo == uut.MarcherInfoAtBeat(whichMarcher, beat));
+            CHECK(infos[whichMarcher].mCollision == uut.CollisionAtBeat(whichMarcher, beat));
+        }
+    }
+    CHECK(uut.AllAnimateInfoAtBeat(6)[0].mCollision == CalChart::Coord::CollisionType::intersect);
+    CHECK(uut.AllAnimateInfoAtBeat(5)[0].mCollision == CalChart::Coord::CollisionType::none);
+    CHECK_THROWS(uut.AllAnimateInfoAtBeat(16));
 }
 
 TEST_CASE("NoCollision", "Animate::Sheet")
@@ -98,4 +112,80 @@ TEST_CASE("Animate::Sheets", "Animate::Sheets")
     CHECK(std::tuple<size_t, Beats>{ 2, 1 } == uut.BeatToSheetOffsetAndBeat(27));
 }
 
+TEST_CASE("Animate::SheetsCollisions", "Animate::Sheets")
+{
+    auto left = CalChart::Animate::CompileResult{
+        { CalChart::Animate::CommandStill{ { 64, 16 }, 16, CalChart::Animate::CommandStill::Style::MarkTime, CalChart::Degree::North() } },
+        {}
+    };
+    auto right = CalChart::Animate::CompileResult{
+        { CalChart::Animate::CommandStill{ { 160, 16 }, 16, CalChart::Animate::CommandStill::Style::MarkTime, CalChart::Degree::North() } },
+        {}
+    };
+    auto towards = CalChart::Animate::CompileResult{
+        { CalChart::Animate::CommandMove{ { 16, 16 }, 8, { 0, 128 } } },
+        {}
+    };
+    auto away = CalChart::Animate::CompileResult{
+        { CalChart::Animate::CommandMove{ { 16, 144 }, 8, { 0, -128 } } },
+        {}
+    };
+    auto quiet = CalChart::Animate::Sheet{ "quiet", 16, { left, right } };
+    auto crossing = CalChart::Animate::Sheet{ "crossing", 8, { towards, away } };
+    auto uut = CalChart::Animate::Sheets{ { quiet, crossing, quiet } };
+
+    CHECK(crossing.GetAllBeatsWithCollisions() == std::set<CalChart::Beats>{ 4 });
+    CHECK(crossing.HasCollisionAtBeat(4));
+    CHECK(!crossing.HasCollisionAtBeat(3));
+    CHECK(!crossing.HasCollisionAtBeat(100));
+    CHECK(crossing.GetAllMarchersWithCollisionAtBeat(4) == CalChart::SelectionList{ 0, 1 });
+    CHECK(crossing.GetAllMarchersWithCollisionAtBeat(3).empty());
+    CHECK(crossing.GetAllMarchersWithCollisions() == CalChart::SelectionList{ 0, 1 });
+    CHECK(quiet.GetAllMarchersWithCollisions().empty());
+
+    for (auto beat : std::views::iota(0U, uut.TotalBeats() + 4)) {
+        CHECK(uut.BeatHasCollision(beat) == (beat == 20));
+    }
+    CHECK(uut.SheetsToMarchersWhoCollided() == std::map<int, CalChart::SelectionList>{ { 1, { 0, 1 } } });
+}
+
+TEST_CASE("FindAllCollisions", "Animate::Sheet")
+{
+    using CalChart::Animate::CollisionDetection;
+    using CollisionType = CalChart::Coord::CollisionType;
+    auto positions = std::vector<CalChart::Coord>{
+        { 0, 0 }, // intersects with 1, warning with 2
+        { 8, 0 },
+        { 0, 16 },
+        { -16, -16 }, // diagonal from 0, too far
+        { -32, -40 }, // across the origin, intersecting with 5
+        { -24, -40 },
+        { 160, 160 }, // off by itself
+    };
+    auto expected = std::map<CalChart::MarcherIndex, CollisionType>{
+        { 0, CollisionType::intersect },
+        { 1, CollisionType::intersect },
+        { 2, CollisionType::warning },
+        { 4, CollisionType::intersect },
+        { 5, CollisionType::intersect },
+    };
+    CHECK(CalChart::Animate::FindAllCollisions(positions, CollisionDetection::BruteForce) == expected);
+    CHECK(CalChart::Animate::FindAllCollisions(positions, CollisionDetection::SpatialHash) == expected);
+    CHECK(CalChart::Animate::FindAllCollisions({}, CollisionDetection::SpatialHash).empty());
+    CHECK(CalChart::Animate::FindAllCollisions({ { 0, 0 } }, CollisionDetection::SpatialHash).empty());
+
+    // a crowded field, both ways should agree.
+    auto generator = std::mt19937{ 42 };
+    auto distribution = std::uniform_int_distribution<CalChart::Coord::units>{ -160, 160 };
+    for (auto test = 0; test < 20; ++test) {
+        auto crowd = std::vector<CalChart::Coord>(200);
+        for (auto& position : crowd) {
+            // keep some on exact step boundaries so we see warnings as well as intersects
+            position = (test % 2) ? CalChart::Coord{ distribution(generator), distribution(generator) }
+                                  : CalChart::Coord{ distribution(generator) / 16 * 16, distribution(generator) / 16 * 16 };
+        }
+        CHECK(CalChart::Animate::FindAllCollisions(crowd, CollisionDetection::BruteForce) == CalChart::Animate::FindAllCollisions(crowd, CollisionDetection::SpatialHash));
+    }
+}
+
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, cppcoreguidelines-avoid-do-while, readability-magic-numbers, readability-function-cognitive-complexity)
@@ -0,0 +1,136 @@
+#include "CalChartAnimation.h"
+#include "CalChartContinuity.h"
+#include "CalChartShow.h"
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, cppcoreguidelines-avoid-do-while, readability-magic-numbers, readability-function-cognitive-complexity)
+
+using namespace CalChart;
+
+namespace {
+
+// Four marchers over four sheets.  Every sheet ends with MTRM E so the variables handed to the next
+// sheet are the same no matter where the marchers were going.
+auto CreateTestShow(std::string const& continuity = "MT 4 E\nEWNS NP\nMTRM E")
+{
+    auto show = Show::Create(ShowMode::GetDefaultShowMode());
+    show->Create_SetupMarchersCommand({ { "A", "A" }, { "B", "B" }, { "C", "C" }, { "D", "D" } }, 1, 0).first(*show);
+    show->Create_RemoveSheetCommand(0).first(*show);
+    for (auto whichSheet : std::views::iota(0, 4)) {
+        auto sheet = Sheet(4, std::to_string(whichSheet + 1));
+        for (auto whichMarcher : std::views::iota(0, 4)) {
+            sheet.SetPosition({ Int2CoordUnits(whichMarcher * 4 + whichSheet), Int2CoordUnits(whichSheet * 2) }, whichMarcher);
+        }
+        sheet.SetBeats(16);
+        sheet.SetContinuity(SYMBOL_PLAIN, Continuity{ continuity });
+        show->Create_AddSheetsCommand({ sheet }, whichSheet).first(*show);
+    }
+    return show;
+}
+
+void CheckSameAnimation(Animation const& lhs, Animation const& rhs)
+{
+    REQUIRE(lhs.GetNumberSheets() == rhs.GetNumberSheets());
+    REQUIRE(lhs.GetTotalNumberBeats() == rhs.GetTotalNumberBeats());
+    CHECK(lhs.GetErrors() == rhs.GetErrors());
+    CHECK(lhs.GetCollisions() == rhs.GetCollisions());
+    CHECK(lhs.toOnlineViewerJSON() == rhs.toOnlineViewerJSON());
+    for (auto beat : std::views::iota(0U, lhs.GetTotalNumberBeats())) {
+        auto lhsInfo = lhs.GetAllAnimateInfo(beat);
+        auto rhsInfo = rhs.GetAllAnimateInfo(beat);
+        REQUIRE(lhsInfo.size() == rhsInfo.size());
+        for (auto i : std::views::iota(0UL, lhsInfo.size())) {
+            CHECK(lhsInfo[i].mIndex == rhsInfo[i].mIndex);
+            CHECK(lhsInfo[i].mCollision == rhsInfo[i].mCollision);
+            CHECK(lhsInfo[i].mMarcherInfo == rhsInfo[i].mMarcherInfo);
+        }
+    }
+}
+
+}
+
+TEST_CASE("IncrementalCompileMatchesFullCompile", "CalChartAnimationTests")
+{
+    auto show = CreateTestShow();
+    auto cache = Animate::CompileCache{};
+
+    auto first = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 4);
+    CheckSameAnimation(first, Animation{ *show });
+
+    // nothing changed, so nothing should be recompiled
+    auto second = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 0);
+    CheckSameAnimation(second, Animation{ *show });
+
+    // moving a marcher on the second sheet affects the first sheet (where the marcher is going) and the second.
+    auto [moveDo, moveUndo] = show->Create_MovePointsCommand(1, { { 2, { Int2CoordUnits(12), Int2CoordUnits(4) } } }, 0);
+    moveDo(*show);
+    auto moved = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 2);
+    CheckSameAnimation(moved, Animation{ *show });
+
+    // undo moves the marcher back in place, which gives the second sheet a new identity, so only it is compiled again.
+    moveUndo(*show);
+    auto undone = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 1);
+    CheckSameAnimation(undone, Animation{ *show });
+    CheckSameAnimation(undone, first);
+}
+
+TEST_CASE("IncrementalCompileVariablesCarryOver", "CalChartAnimationTests")
+{
+    auto show = CreateTestShow();
+    auto cache = Animate::CompileCache{};
+    (void)Animation{ *show, cache };
+
+    // changing how the first sheet ends changes the variables the second sheet starts with.
+    show->Create_SetCurrentSheetCommand(0).first(*show);
+    show->Create_SetContinuityCommand(SYMBOL_PLAIN, Continuity{ "MT 4 E\nEWNS NP\nMTRM W" }).first(*show);
+    auto changed = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 2);
+    CheckSameAnimation(changed, Animation{ *show });
+}
+
+TEST_CASE("IncrementalCompileSheetInsertAndRemove", "CalChartAnimationTests")
+{
+    auto show = CreateTestShow();
+    auto cache = Animate::CompileCache{};
+    (void)Animation{ *show, cache };
+
+    auto [removeDo, removeUndo] = show->Create_RemoveSheetCommand(3);
+    removeDo(*show);
+    auto removed = Animation{ *show, cache };
+    // the new last sheet is compiled differently as it has no next sheet.
+    CHECK(cache.GetNumberSheetsCompiled() == 1);
+    CheckSameAnimation(removed, Animation{ *show });
+
+    removeUndo(*show);
+    auto restored = Animation{ *show, cache };
+    CHECK(cache.GetNumberSheetsCompiled() == 0);
+    CheckSameAnimation(restored, Animation{ *show });
+
+    // sheets with no beats are not in the animation, but the sheets after them still need to line up.
+    show->Create_SetCurrentSheetCommand(1).first(*show);
+    show->Create_SetSheetBeatsCommand(0).first(*show);
+    auto skipped = Animation{ *show, cache };
+    CHECK(skipped.GetNumberSheets() == 3);
+    CheckSameAnimation(skipped, Animation{ *show });
+}
+
+TEST_CASE("ParallelCompileMatchesSerialCompile", "CalChartAnimationTests")
+{
+    // each sheet marks time for as long as the distance each marcher travelled on the sheet before.
+    auto show = CreateTestShow("MT A E\nA = DIST(NP)\nEWNS NP\nMTRM E");
+    show->Create_MovePointsCommand(1, { { 2, { Int2CoordUnits(2), Int2CoordUnits(8) } } }, 0).first(*show);
+    show->Create_MovePointsCommand(2, { { 0, { Int2CoordUnits(0), Int2CoordUnits(0) } } }, 0).first(*show);
+    auto serial = Animation{ *show };
+
+    for (auto numberThreads : { 2U, 3U, 4U, 16U, 0U }) {
+        CheckSameAnimation(Animation{ *show, numberThreads }, serial);
+        auto cache = Animate::CompileCache{};
+        CheckSameAnimation(Animation{ *show, cache, numberThreads }, serial);
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, cppcoreguidelines-avoid-do-while, readability-magic-numbers, readability-function-cognitive-complexity)
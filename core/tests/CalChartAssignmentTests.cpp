@@ -0,0 +1,130 @@
+#include "CalChartAssignment.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <numeric>
+#include <random>
+#include <ranges>
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
+
+namespace {
+using CalChart::AssignmentProblem;
+
+auto IsPermutation(std::vector<unsigned> assignment)
+{
+    std::ranges::sort(assignment);
+    return std::ranges::equal(assignment, std::views::iota(0U, static_cast<unsigned>(assignment.size())));
+}
+
+// how many forbidden pairs, and the cost of the rest.
+auto Cost(AssignmentProblem const& problem, std::vector<unsigned> const& assignment)
+{
+    auto forbidden = 0;
+    auto total = int64_t{};
+    for (auto row : std::views::iota(0UL, assignment.size())) {
+        auto cost = problem.GetCost(row, assignment[row]);
+        if (cost == AssignmentProblem::kForbidden) {
+            ++forbidden;
+        } else {
+            total += cost;
+        }
+    }
+    return std::pair{ forbidden, total };
+}
+
+auto BruteForce(AssignmentProblem const& problem)
+{
+    auto assignment = std::vector<unsigned>(problem.size());
+    std::iota(assignment.begin(), assignment.end(), 0U);
+    auto best = Cost(problem, assignment);
+    while (std::ranges::next_permutation(assignment).found) {
+        best = std::min(best, Cost(problem, assignment));
+    }
+    return best;
+}
+}
+
+TEST_CASE("AssignmentProblem")
+{
+    SECTION("Empty")
+    {
+        CHECK(AssignmentProblem{ 0 }.Solve().empty());
+    }
+
+    SECTION("One")
+    {
+        auto uut = AssignmentProblem{ 1 };
+        CHECK(uut.Solve() == std::vector<unsigned>{ 0 });
+        uut.SetCost(0, 0, 5);
+        CHECK(uut.Solve() == std::vector<unsigned>{ 0 });
+    }
+
+    SECTION("Simple")
+    {
+        auto uut = AssignmentProblem{ 3 };
+        auto const costs = std::vector<std::vector<int32_t>>{ { 4, 1, 3 }, { 2, 0, 5 }, { 3, 2, 2 } };
+        for (auto row : std::views::iota(0UL, 3UL)) {
+            for (auto column : std::views::iota(0UL, 3UL)) {
+                uut.SetCost(row, column, costs[row][column]);
+            }
+        }
+        CHECK(uut.Solve() == std::vector<unsigned>{ 1, 0, 2 });
+    }
+
+    SECTION("AvoidsForbidden")
+    {
+        // the cheapest pairs are all on the diagonal, which is forbidden.
+        auto uut = AssignmentProblem{ 4 };
+        for (auto row : std::views::iota(0UL, 4UL)) {
+            for (auto column : std::views::iota(0UL, 4UL)) {
+                uut.SetCost(row, column, row == column ? AssignmentProblem::kForbidden : static_cast<int32_t>(100 + row * column));
+            }
+        }
+        auto assignment = uut.Solve();
+        CHECK(IsPermutation(assignment));
+        CHECK(Cost(uut, assignment) == BruteForce(uut));
+        CHECK(Cost(uut, assignment).first == 0);
+    }
+
+    SECTION("FewestForbidden")
+    {
+        // rows 0 and 1 can only have column 0, so one of them has to have a forbidden column.
+        auto uut = AssignmentProblem{ 3 };
+        uut.SetCost(0, 0, 1);
+        uut.SetCost(1, 0, 1);
+        uut.SetCost(2, 1, 50);
+        uut.SetCost(2, 2, 1);
+        auto assignment = uut.Solve();
+        CHECK(IsPermutation(assignment));
+        CHECK(Cost(uut, assignment) == BruteForce(uut));
+        CHECK(Cost(uut, assignment).first == 1);
+    }
+
+    SECTION("AllForbidden")
+    {
+        auto assignment = AssignmentProblem{ 5 }.Solve();
+        CHECK(IsPermutation(assignment));
+    }
+
+    SECTION("MatchesBruteForce")
+    {
+        auto generator = std::mt19937{ 7 };
+        for (auto trial : std::views::iota(0, 300)) {
+            auto const size = static_cast<size_t>(1 + trial % 7);
+            // few distinct costs, so there are lots of ties.
+            auto cost = std::uniform_int_distribution<int32_t>{ 0, trial % 2 == 0 ? 3 : 1000 };
+            auto forbid = std::uniform_int_distribution<int>{ 0, 9 };
+            auto uut = AssignmentProblem{ size };
+            for (auto row : std::views::iota(0UL, size)) {
+                for (auto column : std::views::iota(0UL, size)) {
+                    uut.SetCost(row, column, forbid(generator) < trial % 4 ? AssignmentProblem::kForbidden : cost(generator));
+                }
+            }
+            auto assignment = uut.Solve();
+            REQUIRE(IsPermutation(assignment));
+            CHECK(Cost(uut, assignment) == BruteForce(uut));
+        }
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
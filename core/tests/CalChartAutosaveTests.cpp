@@ -0,0 +1,71 @@
+#include "CalChartAutosave.h"
+#include "CalChartShow.h"
+#include "CalChartShowMode.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+using namespace CalChart;
+
+namespace {
+auto ReadBytes(std::filesystem::path const& path)
+{
+    auto input = std::ifstream(path, std::ios::binary);
+    auto chars = std::vector<char>(std::istreambuf_iterator<char>(input), {});
+    auto result = std::vector<std::byte>(chars.size());
+    std::ranges::transform(chars, result.begin(), [](auto c) { return static_cast<std::byte>(c); });
+    return result;
+}
+}
+
+TEST_CASE("AutosaverWritesTheSnapshot", "CalChartAutosaveTests")
+{
+    auto directory = std::filesystem::temp_directory_path() / "CalChartAutosaveTests";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto path = directory / "show.shw~";
+
+    auto registry = PerformanceRegistry{};
+    auto autosaver = Autosaver{ registry };
+    auto show = Show::Create(ShowMode::GetDefaultShowMode(), { { "A0", "trumpet" }, { "A1", "trumpet" } }, 2);
+    auto [setMedia, unsetMedia] = show->Create_SetMediaCommand(FileData{ std::vector<std::byte>(1000, std::byte{ 7 }), "song.mp3" });
+    setMedia(*show);
+
+    // the snapshot is what gets written, even if the show changes while it's being written.
+    auto const expected = show->SerializeShow();
+    auto saved = std::optional<bool>{};
+    autosaver.Save(std::make_shared<Show const>(*show), path, [&saved](auto const&, bool succeeded) { saved = succeeded; });
+    unsetMedia(*show);
+    autosaver.Wait();
+    CHECK(saved == true);
+    CHECK(ReadBytes(path) == expected);
+    CHECK_FALSE(std::filesystem::exists(directory / "show.shw~.tmp"));
+    CHECK(std::get<1>(registry.GetAllStats().front()).callCount == 1);
+
+    // saves that come faster than they're written only write the newest.
+    for (auto i = 0; i < 10; ++i) {
+        autosaver.Save(std::make_shared<Show const>(*show), path);
+    }
+    autosaver.Wait();
+    CHECK(ReadBytes(path) == show->SerializeShow());
+    CHECK(std::get<1>(registry.GetAllStats().front()).callCount + autosaver.GetCoalescedCount() == 11);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("AutosaverReportsFailures", "CalChartAutosaveTests")
+{
+    auto directory = std::filesystem::temp_directory_path() / "CalChartAutosaveTests-missing";
+    std::filesystem::remove_all(directory);
+
+    auto registry = PerformanceRegistry{};
+    auto autosaver = Autosaver{ registry };
+    auto saved = std::optional<bool>{};
+    autosaver.Save(Show::Create(ShowMode::GetDefaultShowMode()), directory / "show.shw~", [&saved](auto const&, bool succeeded) { saved = succeeded; });
+    autosaver.Wait();
+    CHECK(saved == false);
+    CHECK_FALSE(std::filesystem::exists(directory));
+}
@@ -1,5 +1,11 @@
 #include "CalChartContinuity.h"
+#include "CalChartShow.h"
+#include "CalChartShowMode.h"
+#include "CalChartUtils.h"
 #include <catch2/catch_test_macros.hpp>
+#include <future>
+#include <optional>
+#include <set>
 
 using namespace CalChart;
 
@@ -55,6 +61,67 @@ TEST_CASE("ContinuitySerializedTests", "CalChartShowTests")
     }
 }
 
+TEST_CASE("ContinuityConcurrentParseTests", "CalChartShowTests")
+{
+    // the continuities written as text in the shows in the corpus.
+    auto texts = std::set<std::string>{};
+    auto const handlers = ParseErrorHandlers{ [](std::string const&, std::string const&, int, int) { return std::string{}; }, {} };
+    // shows from before 3.3.5 that this version refuses to open, and says so.
+    auto const refused = std::set<std::string>{ "Pregame2010 - Perc Remix.shw", "pregame2006.shw" };
+    for (auto&& path : ShowFilesInPaths({ CALCHART_SHOWS_DIR })) {
+        INFO(path.string());
+        auto const data = std::get<0>(ToFileData(path).value());
+        auto show = std::unique_ptr<Show>{};
+        try {
+            show = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }, &handlers);
+        } catch (CC_FileException const& e) {
+            INFO(e.what());
+            CHECK(refused.contains(path.filename().string()));
+            continue;
+        }
+        REQUIRE(show);
+        for (auto&& sheet : show->CopySheets()) {
+            for (auto&& continuity : sheet.GetContinuities()) {
+                if (!continuity.GetText().empty()) {
+                    texts.insert(continuity.GetText());
+                }
+            }
+        }
+    }
+    REQUIRE_FALSE(texts.empty());
+    auto const corpus = std::vector<std::string>(texts.begin(), texts.end());
+
+    // a parse that fails gives nothing, otherwise what it serializes to, which has where each token was.
+    auto parse = [](std::string const& text) -> std::optional<std::vector<std::byte>> {
+        try {
+            return Continuity{ text }.Serialize();
+        } catch (std::runtime_error const&) {
+            return std::nullopt;
+        }
+    };
+    auto expected = std::vector<std::optional<std::vector<std::byte>>>{};
+    for (auto&& text : corpus) {
+        expected.push_back(parse(text));
+    }
+
+    // every thread parses the whole corpus, each starting at a different place.
+    constexpr auto kThreads = 16;
+    auto futures = std::vector<std::future<bool>>{};
+    for (auto whichThread = 0UL; whichThread < kThreads; ++whichThread) {
+        futures.push_back(std::async(std::launch::async, [&corpus, &expected, &parse, whichThread] {
+            auto matches = true;
+            for (auto iteration = 0UL; iteration < corpus.size(); ++iteration) {
+                auto which = (whichThread * corpus.size() / kThreads + iteration) % corpus.size();
+                matches = matches && parse(corpus.at(which)) == expected.at(which);
+            }
+            return matches;
+        }));
+    }
+    for (auto&& future : futures) {
+        CHECK(future.get());
+    }
+}
+
 TEST_CASE("CalChartContinuityTests", "CalChartShowTests")
 {
     // test some defaults:
@@ -0,0 +1,145 @@
+#include "CalChartDisplayList.h"
+#include "CalChartPoint.h"
+#include <catch2/catch_test_macros.hpp>
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
+
+namespace {
+auto MakeCommands()
+{
+    using namespace CalChart::Draw;
+    using CalChart::Coord;
+    return std::vector<DrawCommand>{
+        Line{ Coord{ 0, 0 }, Coord{ 10, 0 } },
+        withFont(
+            CalChart::Font{ 12 },
+            std::vector<DrawCommand>{
+                Text{ Coord{ 1, 2 }, "A", Text::TextAnchor::Bottom, true },
+                withBrushAndPen(
+                    CalChart::BrushAndPen{ CalChart::Color(1, 2, 3) },
+                    std::vector<DrawCommand>{
+                        Circle{ Coord{ 3, 4 }, 5, true },
+                        Rectangle{ Coord{ 6, 7 }, Coord{ 8, 9 } },
+                    }),
+                withTextForeground(CalChart::BrushAndPen{ CalChart::Color(4, 5, 6) }, Text{ Coord{ 5, 5 }, "BC" }),
+            }),
+        withPen(CalChart::Pen{}, Arc{ Coord{ 0, 0 }, Coord{ 2, 2 }, Coord{ 1, 1 } }),
+        withBrush(CalChart::Brush{ CalChart::Color() }, Ellipse{ Coord{ -1, -1 }, Coord{ 1, 1 } }),
+        VStack{ std::vector<DrawCommand>{ Text{ "top" }, Text{ "bottom" } } },
+    };
+}
+}
+
+TEST_CASE("DisplayList")
+{
+    using namespace CalChart::Draw;
+    using CalChart::Coord;
+
+    SECTION("Empty")
+    {
+        auto uut = DisplayList{};
+        CHECK(uut.empty());
+        CHECK(uut.ToDrawCommands().empty());
+    }
+
+    SECTION("RoundTrip")
+    {
+        auto uut = DisplayList{};
+        uut.Add(MakeCommands());
+        CHECK_FALSE(uut.empty());
+        CHECK(uut.ToDrawCommands() == MakeCommands());
+    }
+
+    SECTION("Flattened")
+    {
+        auto uut = DisplayList{};
+        uut.Add(withFont(CalChart::Font{ 12 }, std::vector<DrawCommand>{ Text{ Coord{ 1, 2 }, "AB" }, Ignore{}, Text{ Coord{ 3, 4 }, "C" } }));
+        auto ops = uut.GetOps();
+        REQUIRE(ops.size() == 4);
+        CHECK(ops[0].code == DisplayList::OpCode::PushFont);
+        CHECK(uut.GetFont(ops[0]) == CalChart::Font{ 12 });
+        CHECK(ops[1].code == DisplayList::OpCode::Text);
+        CHECK(uut.GetText(ops[1]) == "AB");
+        CHECK(ops[2].code == DisplayList::OpCode::Text);
+        CHECK(uut.GetText(ops[2]) == "C");
+        CHECK(ops[3].code == DisplayList::OpCode::Pop);
+    }
+
+    SECTION("Offset")
+    {
+        auto uut = DisplayList{};
+        uut.Add(MakeCommands());
+        CHECK(uut.ToDrawCommands(Coord{ 20, -30 }) == MakeCommands() + Coord{ 20, -30 });
+    }
+
+    SECTION("Append")
+    {
+        auto other = DisplayList{};
+        other.Add(MakeCommands());
+        auto uut = DisplayList{};
+        uut.Add(Line{ Coord{ 1, 1 }, Coord{ 2, 2 } });
+        uut.Append(other, Coord{ 5, 6 });
+        uut.Append(other);
+
+        auto expected = std::vector<DrawCommand>{ Line{ Coord{ 1, 1 }, Coord{ 2, 2 } } };
+        auto moved = MakeCommands() + Coord{ 5, 6 };
+        expected.insert(expected.end(), moved.begin(), moved.end());
+        auto commands = MakeCommands();
+        expected.insert(expected.end(), commands.begin(), commands.end());
+        CHECK(uut.ToDrawCommands() == expected);
+    }
+
+    SECTION("Equality")
+    {
+        auto uut1 = DisplayList{};
+        uut1.Add(MakeCommands());
+        auto uut2 = DisplayList{};
+        uut2.Add(MakeCommands());
+        CHECK(uut1 == uut2);
+        uut2.Add(Line{ Coord{ 1, 1 }, Coord{ 2, 2 } });
+        CHECK_FALSE(uut1 == uut2);
+    }
+
+    SECTION("Clear")
+    {
+        auto uut = DisplayList{};
+        uut.Add(MakeCommands());
+        uut.clear();
+        CHECK(uut.empty());
+        CHECK(uut == DisplayList{});
+        uut.AddText(Coord{ 1, 1 }, "X");
+        CHECK(uut.ToDrawCommands() == std::vector<DrawCommand>{ Text{ Coord{ 1, 1 }, "X" } });
+    }
+
+    SECTION("PointsMatchDrawCommands")
+    {
+        for (auto symbol : CalChart::k_symbols) {
+            for (auto flip : { false, true }) {
+                for (auto visible : { false, true }) {
+                    auto point = CalChart::Point{ Coord{ 3, 5 }, symbol };
+                    point.SetPos(Coord{ -7, 11 }, 1);
+                    point.Flip(flip);
+                    point.SetLabelVisibility(visible);
+                    for (auto ref : { 0U, 1U }) {
+                        auto uut = DisplayList{};
+                        point.AddDrawCommands(uut, ref, "A", 1.2, 1.4, 1.6);
+                        auto expected = DisplayList{};
+                        expected.Add(point.GetDrawCommands(ref, "A", 1.2, 1.4, 1.6));
+                        CHECK(uut == expected);
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("UnbalancedPops")
+    {
+        auto uut = DisplayList{};
+        uut.Pop();
+        uut.Push(CalChart::Pen{});
+        uut.Add(Line{ Coord{ 1, 1 }, Coord{ 2, 2 } });
+        CHECK(uut.ToDrawCommands() == std::vector<DrawCommand>{ withPen(CalChart::Pen{}, Line{ Coord{ 1, 1 }, Coord{ 2, 2 } }) });
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
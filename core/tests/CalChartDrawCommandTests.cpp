@@ -317,4 +317,39 @@ TEST_CASE("DrawCommand")
     }
 }
 
+TEST_CASE("DrawCommandBoundingBox")
+{
+    using CalChart::Coord;
+    using namespace CalChart::Draw;
+    CHECK_FALSE(GetBoundingBox({}).has_value());
+    CHECK_FALSE(GetBoundingBox({ withFont(CalChart::Font{ 10 }, std::vector<DrawCommand>{}) }).has_value());
+
+    auto box = GetBoundingBox({ Line{ { 1, 2 }, { 3, -4 } }, withPen(CalChart::Pen{}, Circle{ { 10, 10 }, 2 }) });
+    REQUIRE(box.has_value());
+    CHECK(box->first == Coord{ 1, -4 });
+    CHECK(box->second == Coord{ 12, 12 });
+
+    // text reaches a font size per character each way, in the font it is drawn in.
+    box = GetBoundingBox({ withFont(CalChart::Font{ 10 }, Text{ { 100, 100 }, "A1" }) });
+    REQUIRE(box.has_value());
+    CHECK(box->first == Coord{ 80, 90 });
+    CHECK(box->second == Coord{ 120, 110 });
+
+    // images reach as far as they're drawn.
+    auto image = std::make_shared<CalChart::ImageData>(CalChart::ImageData{ 40, 20, {}, {}, nullptr });
+    box = GetBoundingBox({ Image{ { 10, 10 }, image } });
+    REQUIRE(box.has_value());
+    CHECK(box->second == Coord{ 50, 30 });
+    box = GetBoundingBox({ Image{ { 10, 10 }, image } }, {}, 0.5);
+    REQUIRE(box.has_value());
+    CHECK(box->first == Coord{ 10, 10 });
+    CHECK(box->second == Coord{ 30, 20 });
+
+    // things that need laying out could be anywhere.
+    box = GetBoundingBox({ Line{ { 1, 2 }, { 3, 4 } }, VStack{ { Line{ { 1, 2 }, { 3, 4 } } } } });
+    REQUIRE(box.has_value());
+    CHECK(box->first.x < -1000);
+    CHECK(box->second.y > 1000);
+}
+
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
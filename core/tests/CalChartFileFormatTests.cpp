@@ -82,3 +82,47 @@ TEST_CASE("Advanced", "CalChartParser")
         TestSerializeVector<float>(10);
     }
 }
+
+TEST_CASE("OutOfData", "CalChartParser")
+{
+    // strings have to be terminated inside of the data.
+    auto unterminated = std::vector<std::byte>{ std::byte{ 'a' }, std::byte{ 'b' } };
+    auto reader = CalChart::Reader({ unterminated.data(), unterminated.size() });
+    CHECK_THROWS_AS(reader.Get<std::string>(), std::runtime_error);
+    auto terminated = std::vector<std::byte>{ std::byte{ 'a' }, std::byte{ 'b' }, std::byte{ 0 }, std::byte{ 'c' } };
+    auto terminatedReader = CalChart::Reader({ terminated.data(), terminated.size() });
+    CHECK(terminatedReader.Get<std::string>() == "ab");
+    CHECK(terminatedReader.size() == 1);
+
+    // vectors can't be longer than the data.
+    auto uut = std::vector<std::byte>{};
+    CalChart::Parser::Append(uut, uint32_t{ 4 });
+    CalChart::Parser::Append(uut, std::vector<uint8_t>{ 1, 2, 3 });
+    auto vectorReader = CalChart::Reader({ uut.data(), uut.size() });
+    CHECK_THROWS_AS(vectorReader.GetVector<uint8_t>(), std::runtime_error);
+}
+
+TEST_CASE("AppendBlock", "CalChartParser")
+{
+    using namespace CalChart;
+    using namespace CalChart::Parser;
+    auto const data = std::vector<std::byte>{ std::byte{ 1 }, std::byte{ 2 }, std::byte{ 3 } };
+    auto const pixels = std::vector<unsigned char>{ 4, 5, 6 };
+
+    auto expected = std::vector<std::byte>{};
+    Append(expected, uint8_t{ 9 });
+    auto inner = Construct_block(INGL_DATA, data);
+    Append(inner, Construct_block(INGL_SIZE, uint32_t{ 7 }));
+    Append(inner, pixels);
+    Append(expected, Construct_block(INGL_SHOW, inner));
+
+    // blocks written in place, including ones inside others, come out the same as ones constructed.
+    auto result = std::vector<std::byte>{};
+    Append(result, uint8_t{ 9 });
+    AppendBlock(result, INGL_SHOW, [&data, &pixels](auto& show) {
+        AppendBlock(show, INGL_DATA, data);
+        AppendBlock(show, INGL_SIZE, uint32_t{ 7 });
+        Append(show, pixels);
+    });
+    CHECK(result == expected);
+}
@@ -0,0 +1,109 @@
+#include "CalChartFileFormat.h"
+#include "CalChartResourcePool.h"
+#include "CalChartUtils.h"
+#include <catch2/catch_test_macros.hpp>
+#include <random>
+#include <tuple>
+
+using namespace CalChart;
+
+TEST_CASE("ResourcePoolKeepsEachResourceOnce", "CalChartResourcePoolTests")
+{
+    auto flat = std::vector<std::byte>(10000, std::byte{ 3 });
+    auto sameAsFlat = flat;
+    auto noisy = std::vector<std::byte>(1000);
+    auto random = std::mt19937{ 42 };
+    for (auto& byte : noisy) {
+        byte = static_cast<std::byte>(random());
+    }
+
+    auto writer = ResourcePoolWriter{};
+    CHECK(writer.empty());
+    CHECK(writer.Add(flat) == 0);
+    CHECK(writer.Add(noisy) == 1);
+    CHECK(writer.Add(sameAsFlat) == 0);
+    CHECK(writer.Add(std::span<std::byte const>{}) == 2);
+    CHECK(writer.Add(std::make_shared<std::vector<std::byte> const>()) == 2);
+
+    auto data = std::vector<std::byte>{};
+    writer.Serialize(data);
+    // the flat one compresses, the noisy one is kept as is.
+    CHECK(data.size() < flat.size());
+    CHECK(data.size() > noisy.size());
+
+    auto pool = ResourcePool{ Reader{ data } };
+    REQUIRE(pool.size() == 3);
+    CHECK(*pool.Get(0) == flat);
+    CHECK(*pool.Get(1) == noisy);
+    CHECK(pool.Get(2)->empty());
+    CHECK_THROWS_AS(pool.Get(3), CC_FileException);
+}
+
+TEST_CASE("ResourcePoolReusesWhatWasCompressed", "CalChartResourcePoolTests")
+{
+    auto flat = std::make_shared<std::vector<std::byte> const>(10000, std::byte{ 3 });
+    auto cache = std::make_shared<ResourceCache>();
+    auto hash = HashBytes(*flat);
+    CHECK_FALSE(cache->Find(*flat, hash));
+
+    auto data = std::vector<std::byte>{};
+    {
+        auto writer = ResourcePoolWriter{ cache };
+        std::ignore = writer.Add(flat);
+        writer.Serialize(data);
+    }
+    auto cached = cache->Find(*flat, hash);
+    REQUIRE(cached);
+    CHECK(cached->data == flat);
+    REQUIRE(cached->compressed);
+    // the buffer itself is found without hashing it, and an equal copy of it isn't.
+    REQUIRE(cache->Find(flat));
+    CHECK(cache->Find(flat)->first == hash);
+    CHECK_FALSE(cache->Find(std::make_shared<std::vector<std::byte> const>(*flat)));
+
+    // the next save writes the same bytes without compressing them again, and forgets what it didn't write.
+    auto again = std::vector<std::byte>{};
+    {
+        auto writer = ResourcePoolWriter{ cache };
+        std::ignore = writer.Add(*flat);
+        writer.Serialize(again);
+    }
+    CHECK(again == data);
+    CHECK(cache->Find(*flat, hash)->compressed == cached->compressed);
+    ResourcePoolWriter{ cache }.Serialize(again);
+    CHECK_FALSE(cache->Find(*flat, hash));
+
+    // reading a pool fills in the cache as resources are asked for.
+    auto pool = ResourcePool{ Reader{ data }, cache };
+    CHECK_FALSE(cache->Find(*flat, hash));
+    CHECK(*pool.Get(0) == *flat);
+    cached = cache->Find(*flat, hash);
+    REQUIRE(cached);
+    CHECK(cached->data == pool.Get(0));
+    CHECK(cached->compressed);
+}
+
+TEST_CASE("ResourcePoolRejectsBadData", "CalChartResourcePoolTests")
+{
+    auto writer = ResourcePoolWriter{};
+    auto flat = std::vector<std::byte>(10000, std::byte{ 3 });
+    std::ignore = writer.Add(flat);
+    auto data = std::vector<std::byte>{};
+    writer.Serialize(data);
+
+    auto truncated = std::vector<std::byte>(data.begin(), data.end() - 1);
+    CHECK_THROWS_AS(ResourcePool{ Reader{ truncated } }, CC_FileException);
+
+    // a size the stored bytes couldn't uncompress to is rejected before anything is allocated for it.
+    for (auto size : { uint32_t{ 0xFFFFFFFF }, uint32_t{ 0x01000000 } }) {
+        auto oversized = data;
+        details::put_big_long(oversized.data() + 4, size);
+        CHECK_THROWS_AS(ResourcePool{ Reader{ oversized } }, CC_FileException);
+    }
+
+    // a broken stream is only found when the resource is asked for.
+    auto corrupted = data;
+    corrupted.at(12) ^= std::byte{ 0xFF };
+    auto pool = ResourcePool{ Reader{ corrupted } };
+    CHECK_THROWS_AS(pool.Get(0), CC_FileException);
+}
@@ -66,6 +66,76 @@ TEST_CASE("RoundTrip3", "CalChartSheetTests")
     CHECK(is_equal);
 }
 
+TEST_CASE("LazyLoading", "CalChartSheetTests")
+{
+    using namespace CalChart;
+    auto sheet = Sheet(2, "lazy");
+    sheet.SetBeats(8);
+    sheet.SetPosition(Coord(10, 10), 0);
+    sheet.SetPosition(Coord(30, 40), 1);
+    sheet.SetContinuity(SYMBOL_PLAIN, Continuity{ "MT E REM" });
+    auto sheet_data = sheet.SerializeSheet();
+    auto table = Reader({ sheet_data.data(), sheet_data.size() }).ParseOutLabels();
+    REQUIRE(table.size() == 1);
+
+    // the name and beats are read up front, the rest waits until something asks.
+    auto lazy_sheet = Sheet(2, std::get<1>(table.front()), nullptr, SheetLoading::Lazy);
+    CHECK_FALSE(lazy_sheet.IsDecoded());
+    CHECK(lazy_sheet.GetName() == "lazy");
+    CHECK(lazy_sheet.GetBeats() == 8);
+    CHECK_FALSE(lazy_sheet.IsDecoded());
+    auto copy = lazy_sheet;
+    CHECK(lazy_sheet.GetMarcherPosition(1) == Coord(30, 40));
+    CHECK(lazy_sheet.IsDecoded());
+    CHECK(lazy_sheet.SerializeSheet() == sheet_data);
+
+    // copies don't see each other's changes.
+    copy.SetPosition(Coord(50, 60), 1);
+    CHECK(copy.GetMarcherPosition(1) == Coord(50, 60));
+    CHECK(lazy_sheet.GetMarcherPosition(1) == Coord(30, 40));
+    CHECK(Sheet(2, std::get<1>(table.front())).SerializeSheet() == sheet_data);
+
+    // problems in the contents only show up when they're looked at.
+    auto bad_data = sheet_data;
+    auto points = std::ranges::search(bad_data, std::array{ std::byte{ 'P' }, std::byte{ 'N' }, std::byte{ 'T' }, std::byte{ 'S' } });
+    REQUIRE(points.end() != bad_data.end());
+    // make the first point say it's bigger than the block.
+    *(points.end() + 4) = std::byte{ 0xFF };
+    auto bad_table = Reader({ bad_data.data(), bad_data.size() }).ParseOutLabels();
+    REQUIRE(bad_table.size() == 1);
+    auto bad_sheet = Sheet(2, std::get<1>(bad_table.front()), nullptr, SheetLoading::Lazy);
+    CHECK(bad_sheet.GetName() == "lazy");
+    CHECK_THROWS(bad_sheet.GetAllMarchers());
+}
+
+TEST_CASE("CopiesShareUntilChanged", "CalChartSheetTests")
+{
+    using namespace CalChart;
+    auto sheet = Sheet(2, "shared");
+    sheet.SetContinuity(SYMBOL_PLAIN, Continuity{ "MT E REM" });
+    sheet.AddBackgroundImage(ImageInfo{ 1, 2, 3, 4, ImageData{ 1, 1, { 1, 2, 3 }, {}, nullptr } }, 0);
+    auto const original = sheet.SerializeSheet();
+
+    // copies of a continuity share what was parsed.
+    auto continuity = sheet.GetContinuityBySymbol(SYMBOL_PLAIN);
+    CHECK(&continuity.GetParsedContinuity() == &sheet.GetContinuityBySymbol(SYMBOL_PLAIN).GetParsedContinuity());
+    auto moved = std::move(continuity);
+    CHECK(moved == sheet.GetContinuityBySymbol(SYMBOL_PLAIN));
+
+    // changing one copy leaves the other as it was.
+    auto copy = sheet;
+    copy.SetPosition(Coord(50, 60), 1);
+    copy.SetContinuity(SYMBOL_PLAIN, Continuity{ "MT W REM" });
+    copy.MoveBackgroundImage(0, 5, 6, 7, 8);
+    copy.AddBackgroundImage(ImageInfo{}, 1);
+    CHECK(copy.GetNumberBackgroundImages() == 2);
+    CHECK(copy.GetBackgroundImageInfo(0) == std::array{ 5, 6, 7, 8 });
+    CHECK(sheet.GetNumberBackgroundImages() == 1);
+    CHECK(sheet.GetBackgroundImageInfo(0) == std::array{ 1, 2, 3, 4 });
+    CHECK(sheet.SerializeSheet() == original);
+    CHECK(copy.SerializeSheet() != original);
+}
+
 TEST_CASE("AssigningToCurves", "CalChartSheetTests")
 {
     using namespace CalChart;
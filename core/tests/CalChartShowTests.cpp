@@ -1,5 +1,9 @@
+#include "CalChartImage.h"
 #include "CalChartShow.h"
+#include "CalChartUtils.h"
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <filesystem>
 
 using namespace CalChart;
 using namespace CalChart::Parser;
@@ -64,6 +68,20 @@ TEST_CASE("RoundTrip", "CalChartShowTests")
     CHECK(is_equal);
 }
 
+TEST_CASE("RoundTripFromData", "CalChartShowTests")
+{
+    using namespace CalChart;
+    auto show = Show::Create(ShowMode::GetDefaultShowMode(), { { "A", "A" }, { "B", "B" } }, 2);
+    auto show_data = show->SerializeShow();
+    auto char_data = std::string{};
+    std::transform(show_data.begin(), show_data.end(), std::back_inserter(char_data), [](auto a) { return std::to_integer<char>(a); });
+    std::istringstream is(char_data);
+    auto from_stream = Show::Create(ShowMode::GetDefaultShowMode(), is);
+    auto from_data = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ show_data });
+    CHECK(from_stream->SerializeShow() == show_data);
+    CHECK(from_data->SerializeShow() == show_data);
+}
+
 TEST_CASE("RoundTripWithNumberLabelDescription", "CalChartShowTests")
 {
     using namespace CalChart;
@@ -150,13 +168,15 @@ TEST_CASE("FutureShow", "CalChartShowTests")
     std::transform(blank_show_data.begin(), blank_show_data.end(), std::back_inserter(char_data), [](auto a) { return std::to_integer<char>(a); });
     CHECK(char_data.at(6) - '0' == CC_MAJOR_VERSION);
     CHECK(char_data.at(7) - '0' == CC_MINOR_VERSION);
+    // the version is one digit each, so the next major release is the future.
+    auto const [major, minor] = std::pair{ char_data.at(6), char_data.at(7) };
     ++char_data.at(6);
-    ++char_data.at(7);
+    char_data.at(7) = '0';
     std::istringstream is(std::string{ char_data.data(), char_data.size() });
     auto re_read_show = Show::Create(ShowMode::GetDefaultShowMode(), is);
     auto re_read_show_data = blank_show->SerializeShow();
-    --char_data.at(6);
-    --char_data.at(7);
+    char_data.at(6) = major;
+    char_data.at(7) = minor;
     bool is_equal = blank_show_data.size() == re_read_show_data.size() && std::equal(blank_show_data.begin(), blank_show_data.end(), re_read_show_data.begin());
     (void)is_equal;
     CHECK(is_equal);
@@ -410,3 +430,202 @@ TEST_CASE("GetDownbeatTimes", "CalChartShowTests")
     CHECK(downbeatTimes[14].count() == 7.25f);
     CHECK(downbeatTimes[15].count() == 7.625f);
 }
+
+TEST_CASE("UndoKeepsMediaAndImagesInHistory", "CalChartShowTests")
+{
+    using namespace CalChart;
+    auto show = Show::Create(ShowMode::GetDefaultShowMode());
+    auto const original = show->SerializeShow();
+
+    auto media = FileData{ std::vector<std::byte>(1000, std::byte{ 7 }), "song.mp3" };
+    auto [setMedia, unsetMedia] = show->Create_SetMediaCommand(media);
+    setMedia(*show);
+    CHECK(show->GetMedia() == media);
+    // putting the media back uses what the history kept rather than a copy of it.
+    auto const* setTo = &show->GetMedia();
+    unsetMedia(*show);
+    setMedia(*show);
+    CHECK(&show->GetMedia() == setTo);
+
+    auto image = ImageInfo{ 1, 2, 3, 4, ImageData{ 2, 1, std::vector<unsigned char>(6, 9), std::vector<unsigned char>(2, 8), nullptr } };
+    auto [addImage, removeAddedImage] = show->Create_AddNewBackgroundImageCommand(image);
+    addImage(*show);
+    auto [removeImage, restoreImage] = show->Create_RemoveBackgroundImageCommand(0);
+    removeImage(*show);
+    CHECK(show->GetSheetBackgroundImagesOnCurrentSheet().empty());
+    restoreImage(*show);
+    REQUIRE(show->GetSheetBackgroundImagesOnCurrentSheet().size() == 1);
+    auto restored = show->GetSheetBackgroundImagesOnCurrentSheet().front();
+    CHECK(restored.scaledHeight == 4);
+    CHECK(restored.data.data == image.data.data);
+    CHECK(restored.data.alpha == image.data.alpha);
+    // the history shares the pixels with the image it was given instead of copying them.
+    CHECK(restored.data.data.Bytes() == image.data.data.Bytes());
+    CHECK(restored.data.alpha.Bytes() == image.data.alpha.Bytes());
+    CHECK(show->GetUndoHistory()->GetUsage().payloads == 4);
+
+    removeAddedImage(*show);
+    unsetMedia(*show);
+    CHECK(show->SerializeShow() == original);
+}
+
+TEST_CASE("ImagesAndMediaAreKeptOncePerShow", "CalChartShowTests")
+{
+    using namespace CalChart;
+    auto show = Show::Create(ShowMode::GetDefaultShowMode(), { { "A0", "trumpet" }, { "A1", "trumpet" } }, 2);
+    auto media = FileData{ std::vector<std::byte>(1000, std::byte{ 7 }), "song.mp3" };
+    show->Create_SetMediaCommand(media).first(*show);
+    auto image = ImageInfo{ 1, 2, 3, 4, ImageData{ 100, 100, std::vector<unsigned char>(30000, 9), std::vector<unsigned char>(10000, 8), nullptr } };
+    show->Create_AddNewBackgroundImageCommand(image).first(*show);
+    show->Create_AddSheetsCommand({ show->CopySheet(0), show->CopySheet(0) }, 1).first(*show);
+    REQUIRE(show->GetNumSheets() == 3);
+
+    // the same image on three sheets is stored once in the pool, and compressed.
+    auto const data = show->SerializeShow();
+    auto const findBlock = [](auto const& table, uint32_t name) {
+        return std::ranges::find(table, name, [](auto&& i) { return std::get<0>(i); });
+    };
+    auto const hasBlock = [](Reader block, uint32_t name) {
+        return std::ranges::any_of(block.ParseOutLabels(), [name](auto&& i) { return std::get<0>(i) == name; });
+    };
+    auto const showTable = std::get<1>(Reader{ data }.subspan(8).ParseOutLabels().front()).ParseOutLabels();
+    REQUIRE(findBlock(showTable, INGL_POOL) != showTable.end());
+    CHECK(std::get<1>(*findBlock(showTable, INGL_POOL)).size() < image.data.data.size());
+
+    // the images and media are only in the pool, so the show is stamped 3.9 or later for earlier versions to
+    // ask before opening it.
+    CHECK(findBlock(showTable, INGL_MEDIA) == showTable.end());
+    for (auto&& [name, sheet] : showTable) {
+        if (name == INGL_SHET) {
+            CHECK_FALSE(hasBlock(sheet, INGL_BACK));
+        }
+    }
+    CHECK(static_cast<int>(data.at(6)) - '0' == CC_MAJOR_VERSION);
+    CHECK(static_cast<int>(data.at(7)) - '0' == CC_MINOR_VERSION);
+    CHECK(std::pair{ CC_MAJOR_VERSION, CC_MINOR_VERSION } >= std::pair{ 3, 9 });
+
+    // and reading it back doesn't complain.
+    auto mismatches = 0;
+    auto const handlers = ParseErrorHandlers{ {}, [&mismatches](int, int) { ++mismatches; return false; } };
+    for (auto loading : { SheetLoading::Eager, SheetLoading::Lazy }) {
+        auto reread = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }, &handlers, loading);
+        CHECK(reread->GetMedia() == media);
+        for (auto&& images : reread->GetSheetsBackgroundImages()) {
+            REQUIRE(images.size() == 1);
+            CHECK(images.front().left == 1);
+            CHECK(images.front().scaledHeight == 4);
+            CHECK(images.front().data.width == 100);
+            CHECK(images.front().data.data == image.data.data);
+            CHECK(images.front().data.alpha == image.data.alpha);
+        }
+        // the sheets share the image's bytes.
+        auto const images = reread->GetSheetsBackgroundImages();
+        CHECK(images.front().front().data.data.data() == images.back().front().data.data.data());
+        CHECK(reread->SerializeShow() == data);
+    }
+    CHECK(mismatches == 0);
+
+    // a show from before 3.9 has the images in each sheet and the media inline.
+    auto legacy = std::vector<std::byte>{};
+    Parser::Append(legacy, uint32_t{ INGL_INGL });
+    Parser::Append(legacy, uint16_t{ INGL_GURK >> 16 });
+    Parser::Append(legacy, uint8_t{ '3' });
+    Parser::Append(legacy, uint8_t{ '8' });
+    Parser::AppendBlock(legacy, INGL_SHOW, [&](auto& legacyShow) {
+        auto whichSheet = 0;
+        for (auto&& [name, block] : showTable) {
+            if (name == INGL_SHET) {
+                show->CopySheet(whichSheet++).SerializeSheet(legacyShow);
+            } else if (name != INGL_POOL && name != INGL_MDRF) {
+                Parser::AppendBlock(legacyShow, name, [&block](auto& d) { Parser::Append(d, block.GetBytes()); });
+            }
+        }
+        Parser::AppendBlock(legacyShow, INGL_MEDIA, [&media](auto& d) { SerializeFileData(media, d); });
+    });
+    auto const legacyTable = std::get<1>(Reader{ legacy }.subspan(8).ParseOutLabels().front()).ParseOutLabels();
+    REQUIRE(findBlock(legacyTable, INGL_SHET) != legacyTable.end());
+    CHECK(hasBlock(std::get<1>(*findBlock(legacyTable, INGL_SHET)), INGL_BACK));
+    for (auto loading : { SheetLoading::Eager, SheetLoading::Lazy }) {
+        auto reread = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ legacy }, nullptr, loading);
+        CHECK(reread->GetMedia() == media);
+        REQUIRE(reread->GetNumSheets() == 3);
+        for (auto&& images : reread->GetSheetsBackgroundImages()) {
+            REQUIRE(images.size() == 1);
+            CHECK(images.front().data.data == image.data.data);
+            CHECK(images.front().data.alpha == image.data.alpha);
+        }
+        // and saving it again moves them into the pool.
+        CHECK(reread->SerializeShow() == data);
+    }
+}
+
+TEST_CASE("ContinuityCorrectionWhenReadingSheets", "CalChartShowTests")
+{
+    using namespace CalChart;
+    // this show has a continuity that doesn't parse.
+    auto const path = std::filesystem::path(CALCHART_SHOWS_DIR) / "Bears to Axe.shw";
+    auto const data = std::get<0>(ToFileData(path).value());
+    REQUIRE_THROWS(Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }));
+
+    for (auto loading : { SheetLoading::Eager, SheetLoading::Lazy }) {
+        auto corrections = std::vector<std::string>{};
+        auto const handlers = ParseErrorHandlers{
+            [&corrections](std::string const&, std::string const& text, int, int) {
+                corrections.push_back(text);
+                return std::string{};
+            },
+            {},
+        };
+        auto show = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }, &handlers, loading);
+        REQUIRE(show);
+        CHECK(show->GetNumSheets() > 0);
+        REQUIRE_FALSE(corrections.empty());
+        CHECK(std::ranges::find(corrections, "even step 16") != corrections.end());
+    }
+}
+
+TEST_CASE("ThreadedReadsCorrectSheetsLikeASerialRead", "CalChartShowTests")
+{
+    using namespace CalChart;
+    auto const path = std::filesystem::path(CALCHART_SHOWS_DIR) / "Bears to Axe.shw";
+    auto const data = std::get<0>(ToFileData(path).value());
+    auto read = [&data](unsigned numberThreads) {
+        auto corrections = std::vector<std::string>{};
+        auto const handlers = ParseErrorHandlers{
+            [&corrections](std::string const&, std::string const& text, int, int) {
+                corrections.push_back(text);
+                return std::string{};
+            },
+            {},
+        };
+        auto show = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }, &handlers, SheetLoading::Eager, numberThreads);
+        REQUIRE(show);
+        return std::pair{ show->SerializeShow(), corrections };
+    };
+
+    // the sheets that fail on other threads are corrected again on this one, each asked about once and in order.
+    auto const [serial, serialCorrections] = read(1);
+    REQUIRE_FALSE(serialCorrections.empty());
+    for (auto numberThreads : { 2U, 8U }) {
+        auto const [threaded, threadedCorrections] = read(numberThreads);
+        CHECK(threaded == serial);
+        CHECK(threadedCorrections == serialCorrections);
+    }
+}
+
+TEST_CASE("LazySheetsOutliveTheirData", "CalChartShowTests")
+{
+    using namespace CalChart;
+    auto const path = std::filesystem::path(CALCHART_SHOWS_DIR) / "Bears to Axe.shw";
+    auto const original = std::get<0>(ToFileData(path).value());
+    auto const handlers = ParseErrorHandlers{ [](std::string const&, std::string const&, int, int) { return std::string{}; }, {} };
+    auto const expected = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ original }, &handlers)->SerializeShow();
+
+    // saved again, the continuities are in the current format and the sheets are decoded only when looked at.
+    auto data = expected;
+    auto show = Show::Create(ShowMode::GetDefaultShowMode(), std::span<std::byte const>{ data }, nullptr, SheetLoading::Lazy);
+    std::ranges::fill(data, std::byte{});
+    data.clear();
+    data.shrink_to_fit();
+    CHECK(show->SerializeShow() == expected);
+}
@@ -0,0 +1,202 @@
+#include "CalChartSheet.h"
+#include "e7_transition_solver.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <optional>
+#include <ranges>
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
+
+namespace {
+using CalChart::TransitionSolverParams;
+
+class TestDelegate : public CalChart::TransitionSolverDelegate {
+public:
+    explicit TestDelegate(bool abort = false)
+        : mAbort(abort)
+    {
+    }
+    void OnProgress(double progress) override { mProgress.push_back(progress); }
+    void OnSubtaskProgress(double progress) override { mSubtaskProgress.push_back(progress); }
+    void OnNewPreferredSolution(unsigned numBeats) override { mPreferred.push_back(numBeats); }
+    void OnCalculationComplete(CalChart::TransitionSolverResult) override { ++mCompleted; }
+    bool ShouldAbortCalculation() override { return mAbort; }
+
+    bool mAbort{};
+    std::vector<double> mProgress;
+    std::vector<double> mSubtaskProgress;
+    std::vector<unsigned> mPreferred;
+    int mCompleted{};
+};
+
+// a block of marchers, every 2 steps, with its top left at x, y.
+auto MakeSheet(int x, int y, int columns, int rows, CalChart::Beats beats)
+{
+    auto sheet = CalChart::Sheet(static_cast<size_t>(columns * rows), "sheet");
+    sheet.SetBeats(beats);
+    for (auto which : std::views::iota(0, columns * rows)) {
+        auto where = CalChart::Coord{ CalChart::Int2CoordUnits(x + (which % columns) * 2), CalChart::Int2CoordUnits(y + (which / columns) * 2) };
+        sheet.SetPosition(where, static_cast<CalChart::MarcherIndex>(which));
+    }
+    return sheet;
+}
+
+auto MakeParams(TransitionSolverParams::AlgorithmIdentifier algorithm, unsigned numberThreads)
+{
+    auto params = TransitionSolverParams{};
+    params.algorithm = algorithm;
+    params.numberThreads = numberThreads;
+    for (auto i : std::views::iota(0UL, params.availableInstructions.size())) {
+        params.availableInstructionsMask.at(i) = true;
+        params.availableInstructions.at(i).waitBeats = static_cast<unsigned>(i / TransitionSolverParams::MarcherInstruction::Pattern::END) * 2;
+        params.availableInstructions.at(i).movementPattern = static_cast<TransitionSolverParams::MarcherInstruction::Pattern>(i % TransitionSolverParams::MarcherInstruction::Pattern::END);
+    }
+    return params;
+}
+
+auto AllPositions(CalChart::Sheet const& sheet)
+{
+    auto positions = std::vector<CalChart::Coord>{};
+    for (auto which : std::views::iota(0UL, sheet.GetNumberPoints())) {
+        positions.push_back(sheet.GetMarcher(static_cast<unsigned>(which)).GetPos());
+    }
+    std::ranges::sort(positions);
+    return positions;
+}
+}
+
+TEST_CASE("TransitionSolver")
+{
+    // a 4 by 4 block turns into an 8 by 2 block that overlaps where it started.
+    auto const from = MakeSheet(-4, -4, 4, 4, 16);
+    auto const to = MakeSheet(-8, 0, 8, 2, 16);
+    REQUIRE(CalChart::validateSheetForTransitionSolver(from).empty());
+    REQUIRE(CalChart::validateSheetForTransitionSolver(to).empty());
+
+    SECTION("Solves")
+    {
+        auto delegate = TestDelegate{};
+        auto result = CalChart::runTransitionSolver(from, to, MakeParams(TransitionSolverParams::E7_ALGORITHM__CHIU_ZAMORA_MALANI, 0), &delegate);
+        REQUIRE(result.successfullySolved);
+        CHECK(result.numBeatsOfMovement <= 16);
+        auto finalPositions = result.finalPositions;
+        std::ranges::sort(finalPositions);
+        CHECK(finalPositions == AllPositions(to));
+        CHECK(result.marcherDotTypes.size() == 16);
+        CHECK(delegate.mCompleted == 1);
+        CHECK_FALSE(delegate.mPreferred.empty());
+        CHECK(std::ranges::all_of(delegate.mProgress, [](auto progress) { return progress >= 0.0 && progress <= 1.0; }));
+        CHECK(std::ranges::all_of(delegate.mSubtaskProgress, [](auto progress) { return progress >= 0.0 && progress <= 1.0; }));
+    }
+
+    SECTION("SameOnAnyNumberOfThreads")
+    {
+        auto delegate = TestDelegate{};
+        auto oneThread = CalChart::runTransitionSolver(from, to, MakeParams(TransitionSolverParams::E7_ALGORITHM__CHIU_ZAMORA_MALANI, 1), &delegate);
+        for (auto numberThreads : { 2U, 3U, 8U }) {
+            auto result = CalChart::runTransitionSolver(from, to, MakeParams(TransitionSolverParams::E7_ALGORITHM__CHIU_ZAMORA_MALANI, numberThreads), &delegate);
+            CHECK(result.successfullySolved == oneThread.successfullySolved);
+            CHECK(result.numBeatsOfMovement == oneThread.numBeatsOfMovement);
+            CHECK(result.finalPositions == oneThread.finalPositions);
+            CHECK(result.marcherDotTypes == oneThread.marcherDotTypes);
+        }
+    }
+
+    SECTION("SolvesEveryDuration")
+    {
+        // asked to, on one thread the durations are solved one after another, as the sweep always has, and all 13 are tried.
+        auto everyDuration = [](unsigned numberThreads) {
+            auto params = MakeParams(TransitionSolverParams::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG, numberThreads);
+            params.stopAtFirstSolvedDuration = false;
+            return params;
+        };
+        auto sequentialDelegate = TestDelegate{};
+        auto sequential = CalChart::runTransitionSolver(from, to, everyDuration(1), &sequentialDelegate);
+        REQUIRE(sequential.successfullySolved);
+        CHECK(sequentialDelegate.mProgress.size() == 13);
+        for (auto numberThreads : { 2U, 8U }) {
+            auto delegate = TestDelegate{};
+            auto result = CalChart::runTransitionSolver(from, to, everyDuration(numberThreads), &delegate);
+            CHECK(result.numBeatsOfMovement == sequential.numBeatsOfMovement);
+            CHECK(result.finalPositions == sequential.finalPositions);
+            CHECK(result.marcherDotTypes == sequential.marcherDotTypes);
+            CHECK(delegate.mProgress.size() == 13);
+        }
+
+        // by default the longer durations are cancelled once one is solved, so fewer are tried, and it is never better.
+        auto firstSolved = std::optional<CalChart::TransitionSolverResult>{};
+        for (auto numberThreads : { 1U, 8U }) {
+            auto delegate = TestDelegate{};
+            auto result = CalChart::runTransitionSolver(from, to, MakeParams(TransitionSolverParams::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG, numberThreads), &delegate);
+            REQUIRE(result.successfullySolved);
+            CHECK(sequential.numBeatsOfMovement <= result.numBeatsOfMovement);
+            CHECK(delegate.mProgress.size() < 13);
+            // the same on any number of threads.
+            if (!firstSolved) {
+                firstSolved = result;
+            }
+            CHECK(result.numBeatsOfMovement == firstSolved->numBeatsOfMovement);
+            CHECK(result.finalPositions == firstSolved->finalPositions);
+        }
+    }
+
+    SECTION("Portfolio")
+    {
+        auto oneThread = std::optional<CalChart::TransitionSolverResult>{};
+        for (auto numberThreads : { 1U, 4U }) {
+            auto delegate = TestDelegate{};
+            auto params = MakeParams(TransitionSolverParams::E7_ALGORITHM__PORTFOLIO, numberThreads);
+            params.portfolioRestarts = 1;
+            auto result = CalChart::runTransitionSolver(from, to, params, &delegate);
+            REQUIRE(result.successfullySolved);
+            CHECK(result.numBeatsOfMovement <= 16);
+            auto finalPositions = result.finalPositions;
+            std::ranges::sort(finalPositions);
+            CHECK(finalPositions == AllPositions(to));
+            CHECK(result.marcherDotTypes.size() == 16);
+            CHECK(delegate.mCompleted == 1);
+            CHECK(std::ranges::all_of(delegate.mSubtaskProgress, [](auto progress) { return progress >= 0.0 && progress <= 1.0; }));
+            // the same on any number of threads.
+            if (!oneThread) {
+                oneThread = result;
+            }
+            CHECK(result.numBeatsOfMovement == oneThread->numBeatsOfMovement);
+            CHECK(result.finalPositions == oneThread->finalPositions);
+            CHECK(result.marcherDotTypes == oneThread->marcherDotTypes);
+        }
+    }
+
+    SECTION("MultiStart")
+    {
+        for (auto algorithm : { TransitionSolverParams::E7_ALGORITHM__NAMINIASL_RAMIREZ_ZHANG, TransitionSolverParams::E7_ALGORITHM__SOVER_ELICEIRI_HERSHKOVITZ }) {
+            auto delegate = TestDelegate{};
+            auto params = MakeParams(algorithm, 1);
+            params.seed = 3;
+            auto singleRun = CalChart::runTransitionSolver(from, to, params, &delegate);
+            CHECK(CalChart::runTransitionSolver(from, to, params, &delegate).finalPositions == singleRun.finalPositions);
+
+            params.multiStartRuns = 4;
+            auto oneThread = CalChart::runTransitionSolver(from, to, params, &delegate);
+            REQUIRE(oneThread.successfullySolved);
+            CHECK((!singleRun.successfullySolved || oneThread.numBeatsOfMovement <= singleRun.numBeatsOfMovement));
+            for (auto numberThreads : { 2U, 8U }) {
+                params.numberThreads = numberThreads;
+                auto result = CalChart::runTransitionSolver(from, to, params, &delegate);
+                CHECK(result.successfullySolved == oneThread.successfullySolved);
+                CHECK(result.numBeatsOfMovement == oneThread.numBeatsOfMovement);
+                CHECK(result.finalPositions == oneThread.finalPositions);
+                CHECK(result.marcherDotTypes == oneThread.marcherDotTypes);
+            }
+        }
+    }
+
+    SECTION("Abort")
+    {
+        auto delegate = TestDelegate{ true };
+        auto result = CalChart::runTransitionSolver(from, to, MakeParams(TransitionSolverParams::E7_ALGORITHM__CHIU_ZAMORA_MALANI, 4), &delegate);
+        CHECK_FALSE(result.successfullySolved);
+        CHECK(delegate.mCompleted == 1);
+    }
+}
+
+// NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
@@ -0,0 +1,139 @@
+#include "CalChartUndoHistory.h"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <vector>
+
+using namespace CalChart;
+
+namespace {
+auto Bytes(size_t size, unsigned char value)
+{
+    return std::vector<std::byte>(size, std::byte{ value });
+}
+}
+
+TEST_CASE("UndoHistoryKeepsPayloads", "CalChartUndoHistoryTests")
+{
+    auto history = UndoHistory{ 1000 };
+    auto first = history.Keep(Bytes(100, 1));
+    CHECK(*first.Get() == Bytes(100, 1));
+    CHECK(first.size() == 100);
+    CHECK(history.GetUsage().payloads == 1);
+    CHECK(history.GetUsage().bytesInMemory == 100);
+
+    // the same bytes are shared, different ones are not.
+    auto again = history.Keep(Bytes(100, 1));
+    auto other = history.Keep(Bytes(100, 2));
+    CHECK(history.GetUsage().payloads == 2);
+    CHECK(history.GetUsage().bytesInMemory == 200);
+    CHECK(history.GetUsage().bytesShared == 100);
+    CHECK(*again.Get() == Bytes(100, 1));
+    CHECK(*other.Get() == Bytes(100, 2));
+
+    // a payload goes when the last one holding it does.
+    {
+        auto gone = history.Keep(Bytes(10, 3));
+        CHECK(history.GetUsage().payloads == 3);
+    }
+    CHECK(history.GetUsage().payloads == 2);
+}
+
+TEST_CASE("UndoHistorySpillsToDisk", "CalChartUndoHistoryTests")
+{
+    auto directory = std::filesystem::temp_directory_path() / "CalChartUndoHistoryTests";
+    std::filesystem::remove_all(directory);
+    {
+        auto history = UndoHistory{ 250, directory };
+        auto first = history.Keep(Bytes(100, 1));
+        auto second = history.Keep(Bytes(100, 2));
+        CHECK(first.IsInMemory());
+        CHECK(second.IsInMemory());
+
+        // going over the limit writes out what was used least recently.
+        CHECK(*first.Get() == Bytes(100, 1));
+        auto third = history.Keep(Bytes(100, 3));
+        CHECK(first.IsInMemory());
+        CHECK_FALSE(second.IsInMemory());
+        CHECK(third.IsInMemory());
+        CHECK(history.GetUsage().bytesInMemory == 200);
+        CHECK(history.GetUsage().bytesOnDisk == 100);
+
+        // and it can be read back, or shared, from disk.
+        CHECK(*second.Get() == Bytes(100, 2));
+        auto secondAgain = history.Keep(Bytes(100, 2));
+        CHECK(history.GetUsage().payloads == 3);
+        CHECK(*secondAgain.Get() == Bytes(100, 2));
+
+        // lowering the limit writes out more.
+        history.SetMemoryLimit(0);
+        CHECK(history.GetUsage().bytesInMemory == 0);
+        CHECK(history.GetUsage().bytesOnDisk == 300);
+        CHECK(*third.Get() == Bytes(100, 3));
+        CHECK_FALSE(std::filesystem::is_empty(directory));
+    }
+    // the files go with the payloads.
+    CHECK((!std::filesystem::exists(directory) || std::filesystem::is_empty(directory)));
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE("UndoHistoryPayloadsOutliveHistory", "CalChartUndoHistoryTests")
+{
+    auto payload = std::optional<UndoHistory::Payload>{};
+    {
+        auto history = UndoHistory{ 0 };
+        payload = history.Keep(Bytes(10, 4));
+        CHECK_FALSE(payload->IsInMemory());
+    }
+    CHECK(*payload->Get() == Bytes(10, 4));
+}
+
+TEST_CASE("UndoHistorySharesBuffers", "CalChartUndoHistoryTests")
+{
+    auto history = UndoHistory{ 0 };
+    auto buffer = std::make_shared<std::vector<std::byte> const>(Bytes(100, 5));
+    auto payload = history.Keep(buffer);
+    auto again = history.Keep(buffer);
+    CHECK(history.GetUsage().payloads == 1);
+
+    // while something else holds the buffer it isn't copied, counted, or written out.
+    CHECK(payload.Get() == buffer);
+    CHECK(payload.IsInMemory());
+    CHECK(history.GetUsage().bytesInMemory == 0);
+    CHECK(history.GetUsage().bytesShared == 200);
+
+    // once the history is all that holds it, it goes to disk like anything else.
+    buffer = nullptr;
+    history.SetMemoryLimit(0);
+    CHECK_FALSE(payload.IsInMemory());
+    CHECK(history.GetUsage().bytesOnDisk == 100);
+    CHECK(*again.Get() == Bytes(100, 5));
+}
+
+TEST_CASE("UndoHistorySpillsWhileRead", "CalChartUndoHistoryTests")
+{
+    // payloads are written out while other threads read them and look at the usage.
+    auto history = UndoHistory{ 1000 };
+    constexpr auto kThreads = 8;
+    constexpr auto kPayloads = 50;
+    auto futures = std::vector<std::future<bool>>{};
+    for (auto whichThread = 0; whichThread < kThreads; ++whichThread) {
+        futures.push_back(std::async(std::launch::async, [&history, whichThread] {
+            auto payloads = std::vector<UndoHistory::Payload>{};
+            auto matches = true;
+            for (auto which = 0; which < kPayloads; ++which) {
+                payloads.push_back(history.Keep(Bytes(100, static_cast<unsigned char>(whichThread * kPayloads + which))));
+                matches = matches && history.GetUsage().bytesInMemory <= 100 * kThreads * kPayloads;
+                auto const& earlier = payloads.at(static_cast<size_t>(which / 2));
+                matches = matches && *earlier.Get() == Bytes(100, static_cast<unsigned char>(whichThread * kPayloads + which / 2));
+            }
+            return matches;
+        }));
+    }
+    for (auto&& future : futures) {
+        CHECK(future.get());
+    }
+    CHECK(history.GetUsage().payloads == 0);
+    CHECK(history.GetUsage().bytesOnDisk == 0);
+}
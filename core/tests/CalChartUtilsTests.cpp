@@ -214,4 +214,19 @@ TEST_CASE("Fermatas", "CalChartSheetTests")
     }
 }
 
+TEST_CASE("HashBytes", "CalChartUtils")
+{
+    auto data = std::vector<std::byte>(1001, std::byte{ 7 });
+    auto same = data;
+    CHECK(CalChart::HashBytes(data) == CalChart::HashBytes(same));
+    // the size counts, as does every byte, including the ones past the last whole word.
+    CHECK(CalChart::HashBytes(data) != CalChart::HashBytes(std::span{ data }.first(1000)));
+    same.back() = std::byte{ 8 };
+    CHECK(CalChart::HashBytes(data) != CalChart::HashBytes(same));
+    same = data;
+    same.front() = std::byte{ 8 };
+    CHECK(CalChart::HashBytes(data) != CalChart::HashBytes(same));
+    CHECK(CalChart::HashBytes({}) != CalChart::HashBytes(std::span{ data }.first(1)));
+}
+
 // NOLINTEND(cppcoreguidelines-avoid-magic-numbers, readability-magic-numbers, readability-function-cognitive-complexity)
@@ -143,8 +143,9 @@ void AnimationCanvas::OnPaint(wxPaintEvent&)
         wxCalChart::setPen(dc, mConfig.Get_CalChartBrushAndPen(CalChart::Colors::SHAPES));
         dc.DrawRectangle(mMouseStart.x, mMouseStart.y, mMouseEnd.x - mMouseStart.x, mMouseEnd.y - mMouseStart.y);
     }
-    wxCalChart::Draw::DrawCommandList(dc,
-        mPanel.GenerateDrawCommands());
+    mDisplayList.clear();
+    mPanel.GenerateDrawCommands(mDisplayList);
+    wxCalChart::Draw::DrawDisplayList(dc, mDisplayList, mPanel.GetShowFieldOffset());
 }
 
 void AnimationCanvas::OnLeftDownMouseEvent(wxMouseEvent& event)
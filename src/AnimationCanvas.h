@@ -21,6 +21,7 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "CalChartDisplayList.h"
 #include "CalChartPerformanceRegistry.h"
 #include <wx/wx.h>
 
@@ -74,4 +75,7 @@ private:
     wxPoint mMouseEnd{};
     CalChart::Configuration& mConfig;
     CalChart::ScopedPerformanceRegistry mPerfRegistry;
+
+    // refilled every paint, kept so its buffers are reused.
+    CalChart::Draw::DisplayList mDisplayList;
 };
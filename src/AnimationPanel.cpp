@@ -189,10 +189,10 @@ void AnimationPanel::CreateControls()
     Layout();
 }
 
-auto AnimationPanel::GenerateDrawCommands() -> std::vector<CalChart::Draw::DrawCommand>
+void AnimationPanel::GenerateDrawCommands(CalChart::Draw::DisplayList& result)
 {
     if (!mView) {
-        return {};
+        return;
     }
     mSprites.RegenerateImages(mConfig);
 
@@ -200,7 +200,8 @@ auto AnimationPanel::GenerateDrawCommands() -> std::vector<CalChart::Draw::DrawC
     if (mTimerOn) {
         onBeat = OnBeat();
     }
-    return mView->GenerateAnimationDrawCommands(
+    mView->GenerateAnimationDrawCommands(
+        result,
         mCurrentBeat,
         mDrawCollisionWarning,
         onBeat,
@@ -403,6 +404,14 @@ auto AnimationPanel::GetShowFieldSize() const -> CalChart::Coord
     return mView->GetShowFieldSize();
 }
 
+auto AnimationPanel::GetShowFieldOffset() const -> CalChart::Coord
+{
+    if (!mView) {
+        return {};
+    }
+    return mView->GetShowFieldOffset();
+}
+
 auto AnimationPanel::GetMarcherInfo() const -> std::vector<CalChart::Animate::Info>
 {
     return mView->GetAnimationInfo(mCurrentBeat);
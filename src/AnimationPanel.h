@@ -40,6 +40,9 @@ class wxMediaCtrl;
 
 namespace CalChart {
 class Configuration;
+namespace Draw {
+    class DisplayList;
+}
 }
 
 class AnimationPanel : public wxPanel {
@@ -87,7 +90,9 @@ public:
     void GotoSheetBeat(int whichSheet, CalChart::Beats whichBeat);
     [[nodiscard]] auto AtEndOfShow() const -> bool;
 
-    [[nodiscard]] auto GenerateDrawCommands() -> std::vector<CalChart::Draw::DrawCommand>;
+    // adds to result what to draw, which is drawn at GetShowFieldOffset().
+    void GenerateDrawCommands(CalChart::Draw::DisplayList& result);
+    [[nodiscard]] auto GetShowFieldOffset() const -> CalChart::Coord;
 
 private:
     void Init();
@@ -0,0 +1,254 @@
+/*
+ * BackgroundImageCache.cpp
+ * Keeps scaled copies of the background images
+ */
+
+/*
+ Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BackgroundImageCache.h"
+#include "CalChartDrawPrimativesHelper.h"
+#include "CalChartImage.h"
+#include <algorithm>
+#include <ranges>
+
+namespace {
+// scaled bitmaps past this many bytes are let go, least recently drawn first.
+constexpr auto kScaledBudget = size_t{ 256 } * 1024 * 1024;
+
+// the pyramids the worker scales from are let go past this many bytes, least recently scaled first.
+constexpr auto kPyramidBudget = size_t{ 256 } * 1024 * 1024;
+
+// the images that haven't been used for the longest, and that nothing is drawing, are let go once there are
+// more than this many.
+constexpr auto kMaxSources = size_t{ 32 };
+
+auto AtLeastOnePixel(wxSize size)
+{
+    return wxSize{ std::max(size.x, 1), std::max(size.y, 1) };
+}
+
+auto BitmapBytes(wxBitmap const& bitmap)
+{
+    return static_cast<size_t>(bitmap.GetWidth()) * static_cast<size_t>(bitmap.GetHeight()) * 4;
+}
+
+auto ImageBytes(wxImage const& image)
+{
+    return static_cast<size_t>(image.GetWidth()) * static_cast<size_t>(image.GetHeight()) * (image.HasAlpha() ? 4 : 3);
+}
+}
+
+BackgroundImageCache::BackgroundImageCache(OnReady onReady)
+    : mOnReady(std::move(onReady))
+    , mThread([this] { Run(); })
+{
+}
+
+BackgroundImageCache::~BackgroundImageCache()
+{
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mRequests.clear();
+        mStopping = true;
+    }
+    mChanged.notify_all();
+    mThread.join();
+}
+
+auto BackgroundImageCache::Add(CalChart::ImageData const& image) -> std::shared_ptr<Source>
+{
+    auto key = Key{ image.data.Bytes().get(), image.alpha.Bytes().get(), image.width, image.height };
+    auto& source = mSources[key];
+    if (!source) {
+        source = std::make_shared<Source>(Source{
+            key,
+            std::make_shared<CalChart::ImageData const>(CalChart::ImageData{ image.width, image.height, image.data, image.alpha, nullptr }),
+        });
+    }
+    source->lastUsed = ++mUseCount;
+    auto result = source;
+    Trim();
+    return result;
+}
+
+auto BackgroundImageCache::GetScaled(Source& source, wxSize size) -> wxBitmap
+{
+    size = AtLeastOnePixel(size);
+    source.lastUsed = ++mUseCount;
+    Collect();
+    auto which = ScaledKey{ source.key, size.x, size.y };
+    if (auto found = mScaled.find(which); found != mScaled.end()) {
+        found->second.lastUsed = mUseCount;
+        return found->second.bitmap;
+    }
+    {
+        auto lock = std::lock_guard{ mMutex };
+        mRequests.push_back({ source.key, source.data, size });
+    }
+    mChanged.notify_all();
+    auto quick = GetQuickScaled(source, size);
+    Insert(which, quick, false);
+    return quick;
+}
+
+auto BackgroundImageCache::GetQuickScaled(Source& source, wxSize size) -> wxBitmap
+{
+    size = AtLeastOnePixel(size);
+    if (!source.image.IsOk()) {
+        source.image = wxCalChart::towxImage(*source.data);
+    }
+    return wxBitmap{ source.image.Scale(size.x, size.y) };
+}
+
+auto BackgroundImageCache::GetFinishedCount() -> uint64_t
+{
+    auto lock = std::lock_guard{ mMutex };
+    return mFinishedCount;
+}
+
+void BackgroundImageCache::Collect()
+{
+    auto finished = std::vector<Finished>{};
+    {
+        auto lock = std::lock_guard{ mMutex };
+        std::swap(finished, mFinished);
+    }
+    for (auto&& [key, data, size, image] : finished) {
+        // the image may have been let go while it was being scaled.
+        if (auto found = mSources.find(key); found == mSources.end() || found->second->data != data) {
+            continue;
+        }
+        // bitmaps can only be made on the UI thread.
+        Insert({ key, size.x, size.y }, wxBitmap{ image }, true);
+    }
+}
+
+void BackgroundImageCache::Insert(ScaledKey const& which, wxBitmap bitmap, bool final)
+{
+    auto& scaled = mScaled[which];
+    mScaledBytes -= BitmapBytes(scaled.bitmap);
+    mScaledBytes += BitmapBytes(bitmap);
+    scaled = { std::move(bitmap), final, ++mUseCount };
+    Trim();
+}
+
+void BackgroundImageCache::Trim()
+{
+    while (mScaledBytes > kScaledBudget && mScaled.size() > 1) {
+        auto oldest = std::ranges::min_element(mScaled, {}, [](auto&& scaled) { return scaled.second.lastUsed; });
+        mScaledBytes -= BitmapBytes(oldest->second.bitmap);
+        mScaled.erase(oldest);
+    }
+    auto forget = std::vector<Key>{};
+    while (mSources.size() > kMaxSources) {
+        // an image something still holds stays, so it keeps getting its high quality scales.
+        auto unheld = mSources | std::views::filter([](auto&& source) { return source.second.use_count() == 1; });
+        auto oldest = std::ranges::min_element(unheld, {}, [](auto&& source) { return source.second->lastUsed; });
+        if (oldest == unheld.end()) {
+            break;
+        }
+        auto key = oldest->first;
+        forget.push_back(key);
+        mSources.erase(oldest.base());
+        // once the buffers are gone their addresses can come back as a different image.
+        std::erase_if(mScaled, [this, &key](auto&& scaled) {
+            if (std::get<0>(scaled.first) != key) {
+                return false;
+            }
+            mScaledBytes -= BitmapBytes(scaled.second.bitmap);
+            return true;
+        });
+    }
+    if (!forget.empty()) {
+        auto lock = std::lock_guard{ mMutex };
+        mForget.insert(mForget.end(), forget.begin(), forget.end());
+    }
+}
+
+void BackgroundImageCache::TrimPyramids(Key const& keep)
+{
+    while (mPyramidBytes > kPyramidBudget) {
+        auto others = mPyramids | std::views::filter([&keep](auto&& pyramid) { return pyramid.first != keep; });
+        auto oldest = std::ranges::min_element(others, {}, [](auto&& pyramid) { return pyramid.second.lastUsed; });
+        if (oldest == others.end()) {
+            break;
+        }
+        mPyramidBytes -= oldest->second.bytes;
+        mPyramids.erase(oldest.base());
+    }
+}
+
+void BackgroundImageCache::Run()
+{
+    auto lock = std::unique_lock{ mMutex };
+    while (true) {
+        mChanged.wait(lock, [this] { return !mRequests.empty() || mStopping; });
+        if (mStopping) {
+            return;
+        }
+        for (auto&& key : mForget) {
+            if (auto found = mPyramids.find(key); found != mPyramids.end()) {
+                mPyramidBytes -= found->second.bytes;
+                mPyramids.erase(found);
+            }
+        }
+        mForget.clear();
+        auto request = std::move(mRequests.front());
+        mRequests.pop_front();
+        lock.unlock();
+
+        // each level is half the one before it, down to the smallest one that is still at least as big as
+        // what's asked for.  Scaling down from there is quicker than from the full image, and looks as good.
+        auto& pyramid = mPyramids[request.key];
+        pyramid.lastUsed = ++mPyramidUseCount;
+        auto& levels = pyramid.levels;
+        auto const levelsBefore = levels.size();
+        if (levels.empty()) {
+            levels.push_back(wxCalChart::towxImage(*request.data));
+        }
+        while (levels.back().GetWidth() >= request.size.x * 2 && levels.back().GetHeight() >= request.size.y * 2) {
+            levels.push_back(levels.back().ShrinkBy(2, 2));
+        }
+        for (auto const& added : levels | std::views::drop(levelsBefore)) {
+            pyramid.bytes += ImageBytes(added);
+            mPyramidBytes += ImageBytes(added);
+        }
+        auto const* level = &levels.front();
+        for (auto const& candidate : levels) {
+            if (candidate.GetWidth() >= request.size.x && candidate.GetHeight() >= request.size.y) {
+                level = &candidate;
+            }
+        }
+        // wxImage shares its data between copies without locking, so nothing handed to the UI thread can
+        // share data with a level; Scale gives back a shared copy when the size doesn't change.
+        auto scaled = level->GetSize() == request.size ? level->Copy() : level->Scale(request.size.x, request.size.y, wxIMAGE_QUALITY_HIGH);
+        // the one just used stays even if it alone is over, as it's likely to be asked for again.
+        TrimPyramids(request.key);
+
+        lock.lock();
+        mFinished.push_back({ request.key, std::move(request.data), request.size, scaled });
+        ++mFinishedCount;
+        // let go of our reference while the lock is held, so the UI thread is the only one touching it.
+        scaled = wxImage{};
+        lock.unlock();
+        if (mOnReady) {
+            mOnReady();
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+/*
+ * BackgroundImageCache.h
+ * Keeps scaled copies of the background images
+ */
+/*
+ Copyright (C) 1995-2024  Garrick Brian Meeker, Richard Michael Powell
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * BackgroundImageCache
+ *
+ * Scaling a background image with wxIMAGE_QUALITY_HIGH is slow, and used to be done again every time the
+ * show changed.  The cache keeps the scaled bitmaps by which pixel buffers the image shares and the size it is
+ * drawn at, so repaints, going back and forth between sheets, and sheets that share an image all reuse the
+ * same bitmap.  Copies of an image share its buffers, so nothing needs to look at the pixels to find it.
+ *
+ * The high quality scaling happens on a worker thread, starting from a pyramid of halved copies of the image
+ * so each scale begins close to the size wanted.  Until it is done a quick scale is given back instead, and
+ * onReady is called from the worker thread so the owner can repaint.  Pyramids hold the full sized image, so
+ * like the scaled bitmaps they are kept to a budget.
+ *
+ * Other than onReady, everything here is called from the UI thread.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <wx/bitmap.h>
+#include <wx/image.h>
+
+namespace CalChart {
+struct ImageData;
+}
+
+class BackgroundImageCache {
+public:
+    using OnReady = std::function<void()>;
+
+    // images that share their pixel buffers have the same key.  The cache holds on to the buffers for as long
+    // as it uses a key, so a buffer can't be freed and its address handed to a different image meanwhile.
+    struct Key {
+        void const* data{};
+        void const* alpha{};
+        int width{};
+        int height{};
+        auto operator<=>(Key const&) const = default;
+    };
+
+    explicit BackgroundImageCache(OnReady onReady = {});
+    ~BackgroundImageCache();
+
+    BackgroundImageCache(BackgroundImageCache const&) = delete;
+    BackgroundImageCache(BackgroundImageCache&&) = delete;
+    auto operator=(BackgroundImageCache const&) -> BackgroundImageCache& = delete;
+    auto operator=(BackgroundImageCache&&) -> BackgroundImageCache& = delete;
+
+    // what Add gives back; the cache can let go of an image, but not while something still holds it.
+    struct Source {
+        Key key;
+        // the worker reads this too, so it's never changed.
+        std::shared_ptr<CalChart::ImageData const> data;
+        // made the first time a quick scale is needed.
+        wxImage image;
+        uint64_t lastUsed{};
+    };
+
+    [[nodiscard]] auto Add(CalChart::ImageData const& image) -> std::shared_ptr<Source>;
+
+    // gives back a quick scale if the high quality one isn't ready yet, and asks for it.
+    [[nodiscard]] auto GetScaled(Source& source, wxSize size) -> wxBitmap;
+
+    // a quick scale that isn't kept, for while an image is being resized.
+    [[nodiscard]] auto GetQuickScaled(Source& source, wxSize size) -> wxBitmap;
+
+    // goes up each time a high quality scale is ready.
+    [[nodiscard]] auto GetFinishedCount() -> uint64_t;
+
+private:
+    using ScaledKey = std::tuple<Key, int, int>;
+
+    struct Scaled {
+        wxBitmap bitmap;
+        bool final{};
+        uint64_t lastUsed{};
+    };
+    struct Request {
+        Key key;
+        std::shared_ptr<CalChart::ImageData const> data;
+        wxSize size;
+    };
+    struct Finished {
+        Key key;
+        // held until the UI thread looks at it, so the key still names the same buffers.
+        std::shared_ptr<CalChart::ImageData const> data;
+        wxSize size;
+        wxImage image;
+    };
+
+    // each level is half the size of the one before it.
+    struct Pyramid {
+        std::vector<wxImage> levels;
+        size_t bytes{};
+        uint64_t lastUsed{};
+    };
+
+    void Collect();
+    void Insert(ScaledKey const& which, wxBitmap bitmap, bool final);
+    void Trim();
+    void TrimPyramids(Key const& keep);
+    void Run();
+
+    OnReady mOnReady;
+    uint64_t mUseCount{};
+    std::map<Key, std::shared_ptr<Source>> mSources;
+    std::map<ScaledKey, Scaled> mScaled;
+    size_t mScaledBytes{};
+
+    // shared with the worker
+    std::mutex mMutex;
+    std::condition_variable mChanged;
+    std::deque<Request> mRequests;
+    std::vector<Finished> mFinished;
+    std::vector<Key> mForget;
+    uint64_t mFinishedCount{};
+    bool mStopping{};
+
+    // only touched by the worker
+    std::map<Key, Pyramid> mPyramids;
+    size_t mPyramidBytes{};
+    uint64_t mPyramidUseCount{};
+
+    std::thread mThread;
+};
@@ -21,6 +21,7 @@
  */
 
 #include "BackgroundImages.h"
+#include "BackgroundImageCache.h"
 #include "CalChartDrawPrimativesHelper.h"
 #include "CalChartDrawing.h"
 #include "CalChartImage.h"
@@ -31,24 +32,29 @@
 
 class BackgroundImage {
 public:
-    explicit BackgroundImage(CalChart::ImageInfo const& image);
+    BackgroundImage(CalChart::ImageInfo const& image, BackgroundImageCache& cache);
 
+    [[nodiscard]] auto SameAs(BackgroundImage const& other) const
+    {
+        return mImage == other.mImage && mPosition == other.mPosition && mScaledSize == other.mScaledSize;
+    }
     [[nodiscard]] auto MouseClickIsHit(wxMouseEvent const& event, wxDC const& dc) const -> bool;
     void OnMouseLeftDown(wxMouseEvent const& event, wxDC const& dc);
 
     // returns left, top, width, height
     [[nodiscard]] auto OnMouseLeftUp(wxMouseEvent const& event, wxDC const& dc) -> std::array<int, 4>;
 
-    void OnMouseMove(wxMouseEvent const& event, wxDC const& dc);
-    void OnPaint(wxDC& dc, bool drawPicAdjustDots, bool selected) const;
+    void OnMouseMove(wxMouseEvent const& event, wxDC const& dc, BackgroundImageCache& cache);
+    void OnPaint(wxDC& dc, BackgroundImageCache& cache, bool drawPicAdjustDots, bool selected) const;
 
 private:
     static constexpr auto kCircleSize = 6;
 
     CalChart::Coord mPosition{};
     CalChart::Coord mScaledSize{};
-    wxImage mRawImage;
-    wxBitmap mBitmap;
+    std::shared_ptr<BackgroundImageCache::Source> mImage;
+    // while the image is being resized it's drawn from a quick scale instead of from the cache.
+    std::optional<wxBitmap> mResizing;
 
     // what type of background adjustments could we do
     enum class BackgroundAdjustType {
@@ -110,11 +116,10 @@ private:
     std::optional<CalculateScaleAndMove> mScaleAndMove;
 };
 
-BackgroundImage::BackgroundImage(CalChart::ImageInfo const& image)
+BackgroundImage::BackgroundImage(CalChart::ImageInfo const& image, BackgroundImageCache& cache)
     : mPosition{ image.left, image.top }
     , mScaledSize{ image.scaledWidth, image.scaledHeight }
-    , mRawImage{ wxCalChart::towxImage(image.data) }
-    , mBitmap{ mRawImage.Scale(mScaledSize.x, mScaledSize.y, wxIMAGE_QUALITY_HIGH) }
+    , mImage{ cache.Add(image.data) }
 {
 }
 
@@ -169,8 +174,8 @@ void BackgroundImage::OnMouseLeftDown(wxMouseEvent const& event, wxDC const& dc)
 std::array<int, 4> BackgroundImage::OnMouseLeftUp(const wxMouseEvent&, const wxDC&)
 {
     if (mScaleAndMove) {
-        // done moving, lock down the picture and make it pretty:
-        mBitmap = wxBitmap(mRawImage.Scale(mBitmap.GetWidth(), mBitmap.GetHeight(), wxIMAGE_QUALITY_HIGH));
+        // done moving, the cache makes the picture pretty again.
+        mResizing.reset();
         auto [width, height] = wxCalChart::toSize(mScaledSize);
         auto [x, y] = wxCalChart::toPoint(mPosition);
         std::array<int, 4> data{ { x, y, width, height } };
@@ -181,7 +186,7 @@ std::array<int, 4> BackgroundImage::OnMouseLeftUp(const wxMouseEvent&, const wxD
     return { { 0, 0, 0, 0 } };
 }
 
-void BackgroundImage::OnMouseMove(const wxMouseEvent& event, const wxDC& dc)
+void BackgroundImage::OnMouseMove(const wxMouseEvent& event, const wxDC& dc, BackgroundImageCache& cache)
 {
     auto point = event.GetPosition();
     auto x = dc.DeviceToLogicalX(point.x);
@@ -190,15 +195,18 @@ void BackgroundImage::OnMouseMove(const wxMouseEvent& event, const wxDC& dc)
     if (event.Dragging() && event.LeftIsDown() && mScaleAndMove) {
         auto rect = (*mScaleAndMove)(x, y, { wxCalChart::toPoint(mPosition), wxCalChart::toSize(mScaledSize) });
         mPosition = wxCalChart::toCoord(rect.GetPosition());
-        mScaledSize = wxCalChart::toCoord(rect.GetSize());
-        mBitmap = wxBitmap(mRawImage.Scale(mScaledSize.x, mScaledSize.y));
+        if (auto size = wxCalChart::toCoord(rect.GetSize()); size != mScaledSize) {
+            mScaledSize = size;
+            mResizing = cache.GetQuickScaled(*mImage, rect.GetSize());
+        }
     }
 }
 
-void BackgroundImage::OnPaint(wxDC& dc, bool drawPicAdjustDots, bool selected) const
+void BackgroundImage::OnPaint(wxDC& dc, BackgroundImageCache& cache, bool drawPicAdjustDots, bool selected) const
 {
+    auto bitmap = mResizing ? *mResizing : cache.GetScaled(*mImage, wxCalChart::toSize(mScaledSize));
     auto drawCmds = std::vector<CalChart::Draw::DrawCommand>{
-        CalChart::Draw::Image{ mPosition, std::make_shared<wxCalChart::BitmapHolder>(mBitmap) },
+        CalChart::Draw::Image{ mPosition, std::make_shared<wxCalChart::BitmapHolder>(bitmap) },
     };
 
     if (drawPicAdjustDots) {
@@ -330,23 +338,37 @@ wxRect BackgroundImage::CalculateScaleAndMove::operator()(wxCoord x, wxCoord y,
     }
 }
 
-BackgroundImages::BackgroundImages() = default;
+BackgroundImages::BackgroundImages(std::function<void()> onImageReady)
+    : mCache{ std::make_unique<BackgroundImageCache>(std::move(onImageReady)) }
+{
+}
+
 BackgroundImages::~BackgroundImages() = default;
 
 void BackgroundImages::SetBackgroundImages(std::vector<CalChart::ImageInfo> const& images)
 {
     auto previousSize = mBackgroundImages.size();
-    mBackgroundImages = CalChart::Ranges::ToVector<BackgroundImage>(
-        images | std::views::transform([](auto&& image) { return BackgroundImage{ image }; }));
+    auto backgroundImages = CalChart::Ranges::ToVector<BackgroundImage>(
+        images | std::views::transform([this](auto&& image) { return BackgroundImage{ image, *mCache }; }));
+    if (!std::ranges::equal(backgroundImages, mBackgroundImages, [](auto&& lhs, auto&& rhs) { return lhs.SameAs(rhs); })) {
+        ++mVersion;
+    }
+    mBackgroundImages = std::move(backgroundImages);
     if (mBackgroundImages.size() != previousSize) {
         mWhichBackgroundIndex = std::nullopt;
     }
 }
 
+auto BackgroundImages::GetVersion() const -> uint64_t
+{
+    // both only go up, so neither can undo a change in the other.
+    return mVersion + mCache->GetFinishedCount();
+}
+
 void BackgroundImages::OnPaint(wxDC& dc) const
 {
     for (auto&& [i, backgroundImages] : CalChart::Ranges::enumerate_view(mBackgroundImages)) {
-        backgroundImages.OnPaint(dc, mAdjustBackgroundMode, mWhichBackgroundIndex.has_value() ? *mWhichBackgroundIndex == static_cast<size_t>(i) : false);
+        backgroundImages.OnPaint(dc, *mCache, mAdjustBackgroundMode, mWhichBackgroundIndex.has_value() ? *mWhichBackgroundIndex == static_cast<size_t>(i) : false);
     }
 }
 
@@ -368,6 +390,7 @@ void BackgroundImages::OnMouseLeftDown(wxMouseEvent const& event, wxDC const& dc
     if (mWhichBackgroundIndex.has_value()) {
         mBackgroundImages[*mWhichBackgroundIndex].OnMouseLeftDown(event, dc);
     }
+    ++mVersion;
 }
 
 std::optional<std::tuple<int, std::array<int, 4>>> BackgroundImages::OnMouseLeftUp(wxMouseEvent const& event, wxDC const& dc)
@@ -376,6 +399,7 @@ std::optional<std::tuple<int, std::array<int, 4>>> BackgroundImages::OnMouseLeft
         return {};
     }
     if (mWhichBackgroundIndex.has_value()) {
+        ++mVersion;
         return { { *mWhichBackgroundIndex, mBackgroundImages[*mWhichBackgroundIndex].OnMouseLeftUp(event, dc) } };
     }
     return {};
@@ -387,6 +411,7 @@ void BackgroundImages::OnMouseMove(wxMouseEvent const& event, wxDC const& dc)
         return;
     }
     if (mWhichBackgroundIndex.has_value()) {
-        mBackgroundImages[*mWhichBackgroundIndex].OnMouseMove(event, dc);
+        mBackgroundImages[*mWhichBackgroundIndex].OnMouseMove(event, dc, *mCache);
+        ++mVersion;
     }
 }
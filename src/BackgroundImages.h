@@ -21,6 +21,8 @@
  */
 
 #include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <wx/dc.h>
@@ -31,16 +33,25 @@ struct ImageInfo;
 }
 
 class BackgroundImage;
+class BackgroundImageCache;
 
 class BackgroundImages {
 public:
-    BackgroundImages();
+    // onImageReady is called, from another thread, when a better looking image is ready to be painted.
+    explicit BackgroundImages(std::function<void()> onImageReady = {});
     ~BackgroundImages();
 
     void SetBackgroundImages(std::vector<CalChart::ImageInfo> const& images);
 
     [[nodiscard]] auto GetAdjustBackgroundMode() const { return mAdjustBackgroundMode; }
-    void SetAdjustBackgroundMode(bool adjustBackgroundMode) { mAdjustBackgroundMode = adjustBackgroundMode; }
+    void SetAdjustBackgroundMode(bool adjustBackgroundMode)
+    {
+        mAdjustBackgroundMode = adjustBackgroundMode;
+        ++mVersion;
+    }
+
+    // changes whenever OnPaint would draw something different.
+    [[nodiscard]] auto GetVersion() const -> uint64_t;
 
     [[nodiscard]] auto GetCurrentIndex() const { return mWhichBackgroundIndex; }
 
@@ -51,7 +62,10 @@ public:
     void OnPaint(wxDC& dc) const;
 
 private:
+    // kept across sheets, so going back to a sheet doesn't scale its images again.
+    std::unique_ptr<BackgroundImageCache> mCache;
     std::vector<BackgroundImage> mBackgroundImages;
     bool mAdjustBackgroundMode{};
+    uint64_t mVersion = 1;
     std::optional<std::size_t> mWhichBackgroundIndex = std::nullopt;
 };
@@ -26,22 +26,25 @@
 #include "CalChartConfiguration.h"
 #include "CalChartConstants.h"
 #include "CalChartContinuity.h"
+#include "CalChartDisplayList.h"
 #include "CalChartDocCommand.h"
 #include "CalChartPoint.h"
 #include "CalChartPrintShowToPS.hpp"
 #include "CalChartShapes.h"
 #include "CalChartSheet.h"
 #include "CalChartShowMode.h"
+#include "CalChartUndoHistory.h"
 #include "CalChartUtils.h"
 #include "ContinuityEditorPopup.h"
 #include "SystemConfiguration.h"
 #include "platconf.h"
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <thread>
 #include <wx/textfile.h>
-#include <wx/wfstream.h>
 
 using namespace CalChart;
 
@@ -59,6 +62,8 @@ CalChartDoc::CalChartDoc()
     , mTimer(*this)
 {
     mTimer.Start(static_cast<int>(mConfig.Get_AutosaveInterval()) * 1000);
+    mUndoHistory->SetMemoryLimit(static_cast<size_t>(std::max(mConfig.Get_UndoHistoryMemoryLimit(), 0L)) * 1024 * 1024);
+    mShow->SetUndoHistory(mUndoHistory);
 }
 
 // When a file is opened, we first check to see if there is a temporary
@@ -96,6 +101,8 @@ bool CalChartDoc::OnOpenDocument(const wxString& filename)
 bool CalChartDoc::OnCloseDocument()
 {
     bool success = super::OnCloseDocument();
+    // a recovery file still being written would come back after we remove it.
+    mAutosaver.Cancel();
     // first check to see if there is a recover file:
     wxString recoveryFile = TranslateNameToAutosaveName(GetFilename());
     if (!IsModified() && wxFileExists(recoveryFile)) {
@@ -121,6 +128,7 @@ bool CalChartDoc::OnNewDocument()
 bool CalChartDoc::OnSaveDocument(wxString const& filename)
 {
     bool result = super::OnSaveDocument(filename);
+    mAutosaver.Cancel();
     wxString recoveryFile = TranslateNameToAutosaveName(filename);
     if (result && wxFileExists(recoveryFile)) {
         wxRemoveFile(recoveryFile);
@@ -198,15 +206,6 @@ T& CalChartDoc::SaveObjectInternal(T& stream)
     return stream;
 }
 
-template <>
-wxFFileOutputStream& CalChartDoc::SaveObjectInternal<wxFFileOutputStream>(
-    wxFFileOutputStream& stream)
-{
-    auto data = mShow->SerializeShow();
-    stream.Write(&data[0], data.size());
-    return stream;
-}
-
 template <typename T>
 T& CalChartDoc::LoadObjectGeneric(T& stream)
 {
@@ -239,6 +238,7 @@ T& CalChartDoc::LoadObjectGeneric(T& stream)
             },
         };
         mShow = Show::Create(GetConfigShowMode(mConfig, CalChart::GetShowModeNames()[0]), stream, &handlers);
+        mShow->SetUndoHistory(mUndoHistory);
     } catch (std::exception const& e) {
         auto message = std::string{ "Error encountered:\n" };
         message += e.what();
@@ -247,7 +247,8 @@ T& CalChartDoc::LoadObjectGeneric(T& stream)
         modified = false;
     }
     super::Modify(modified);
-    mAnimation = Animation{ *mShow };
+    mAnimationCache.Clear();
+    mAnimation = Animation{ *mShow, mAnimationCache, std::thread::hardware_concurrency() };
     CalChartDoc_FinishedLoading finishedLoading;
     UpdateAllViews(NULL, &finishedLoading);
     return stream;
@@ -334,10 +335,10 @@ void CalChartDoc::Modify(bool b)
 {
     super::Modify(b);
     CalChartDoc_modified showMod;
-    // generate a new animation
+    // generate a new animation, only recompiling the sheets affected by the change
     // uncomment below to see how long it takes to print
     //    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
-    mAnimation = Animation{ *mShow };
+    mAnimation = Animation{ *mShow, mAnimationCache, std::thread::hardware_concurrency() };
     //    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
     //    std::cout << "generation "
     //             << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
@@ -360,14 +361,15 @@ wxString CalChartDoc::TranslateNameToAutosaveName(const wxString& name)
 void CalChartDoc::Autosave()
 {
     if (GetFilename() != wxT("") && IsModified()) {
-        wxFFileOutputStream outputStream(
-            TranslateNameToAutosaveName(GetFilename()));
-        if (outputStream.IsOk()) {
-            SaveObjectInternal(outputStream);
-        }
-        if (!outputStream.IsOk()) {
-            wxMessageBox(wxT("Error creating recovery file.  Take heed, save often!"), wxT("Recovery Error"));
-        }
+        // copies of the show share their sheets and media, so this is cheap; the writing happens elsewhere.
+        auto snapshot = std::make_shared<CalChart::Show const>(*mShow);
+        mAutosaver.Save(snapshot, TranslateNameToAutosaveName(GetFilename()).ToStdWstring(), [this](auto const&, bool succeeded) {
+            if (!succeeded) {
+                CallAfter([] {
+                    wxMessageBox(wxT("Error creating recovery file.  Take heed, save often!"), wxT("Recovery Error"));
+                });
+            }
+        });
     }
 }
 
@@ -394,16 +396,18 @@ auto CalChartDoc::GetAnimationCollisions() const -> std::map<int, CalChart::Sele
     return mAnimation->GetCollisions();
 }
 
-auto CalChartDoc::GenerateAnimationDrawCommands(
+void CalChartDoc::GenerateAnimationDrawCommands(
+    CalChart::Draw::DisplayList& result,
     CalChart::Beats whichBeat,
     bool drawCollisionWarning,
     std::optional<bool> onBeat,
-    CalChart::Animation::AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>
+    CalChart::Animation::AngleStepToImageFunction const& imageFunction) const
 {
     if (!mAnimation) {
-        return {};
+        return;
     }
-    return mAnimation->GenerateDrawCommands(
+    mAnimation->GenerateDrawCommands(
+        result,
         whichBeat,
         mShow->GetSelectionList(),
         mShow->GetShowMode(),
@@ -419,7 +423,7 @@ auto CalChartDoc::GetAnimationInfo(CalChart::Beats whichBeat) const -> std::vect
         return {};
     }
     if (mShow->GetSelectionList().empty()) {
-        return mAnimation->GetAllAnimateInfo(whichBeat);
+        return CalChart::Ranges::ToVector<CalChart::Animate::Info>(mAnimation->GetAllAnimateInfo(whichBeat));
     }
     return mAnimation->GetAllAnimateInfo(whichBeat, mShow->GetSelectionList());
 }
@@ -539,31 +543,36 @@ auto TransformIndexToDrawPathCommands(CalChart::Animation const& animation, unsi
 
 }
 
-auto CalChartDoc::GenerateGhostPointsDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>
+void CalChartDoc::GenerateGhostPointsDrawCommands(CalChart::Draw::DisplayList& result) const
 {
     if (auto ghostSheet = GetGhostSheet()) {
-        return mShow->GenerateGhostPointsDrawCommands(
+        mShow->GenerateGhostPointsDrawCommands(
+            result,
             GetConfiguration(),
             CalChart::SelectionList(),
             *ghostSheet);
     }
-    return {};
 }
 
 auto CalChartDoc::GenerateCurrentSheetPointsDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>
 {
-    auto drawCmds = std::vector<CalChart::Draw::DrawCommand>{};
-    auto& config = GetConfiguration();
-    auto origin = GetShowFieldOffset();
-    CalChart::append(drawCmds, CalChart::CreateModeDrawCommandsWithBorderOffset(config, GetShowMode(), CalChart::HowToDraw::FieldView));
-    CalChart::append(drawCmds, GenerateGhostPointsDrawCommands());
-    auto sheetNum = GetCurrentSheetNum();
-    if (sheetNum >= GetNumSheets()) {
-        return drawCmds;
+    auto marchers = CalChart::Draw::DisplayList{};
+    GenerateCurrentSheetMarchersDrawCommands(marchers);
+    return CalChart::append(GenerateFieldDrawCommands(), marchers.ToDrawCommands(GetShowFieldOffset()));
+}
+
+auto CalChartDoc::GenerateFieldDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>
+{
+    return CalChart::CreateModeDrawCommandsWithBorderOffset(GetConfiguration(), GetShowMode(), CalChart::HowToDraw::FieldView) + GetShowFieldOffset();
+}
+
+void CalChartDoc::GenerateCurrentSheetMarchersDrawCommands(CalChart::Draw::DisplayList& result) const
+{
+    GenerateGhostPointsDrawCommands(result);
+    if (GetCurrentSheetNum() < GetNumSheets()) {
+        mShow->GenerateSheetElements(result, GetConfiguration(), GetCurrentReferencePoint());
+        result.Add(GeneratePathsDrawCommands());
     }
-    CalChart::append(drawCmds, mShow->GenerateSheetElements(config, GetCurrentReferencePoint()));
-    CalChart::append(drawCmds, GeneratePathsDrawCommands());
-    return drawCmds + origin;
 }
 
 auto CalChartDoc::GeneratePhatomPointsDrawCommands(CalChart::MarcherToPosition const& positions) const -> std::vector<CalChart::Draw::DrawCommand>
@@ -593,6 +602,7 @@ auto CalChartDoc::GeneratePathsDrawCommands() const -> std::vector<CalChart::Dra
 void CalChartDoc::WizardSetupNewShow(std::vector<std::pair<std::string, std::string>> const& labelsAndInstruments, int columns, ShowMode const& newmode)
 {
     mShow = Show::Create(newmode, labelsAndInstruments, columns);
+    mShow->SetUndoHistory(mUndoHistory);
     UpdateAllViews();
 }
 
@@ -20,6 +20,7 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "CalChartAutosave.h"
 #include "CalChartMovePointsTool.h"
 #include "CalChartSelectTool.h"
 #include "CalChartShow.h"
@@ -45,6 +46,9 @@ class Sheet;
 class Lasso;
 class Animation;
 class Configuration;
+namespace Draw {
+    class DisplayList;
+}
 struct TransitionSolverParams;
 class TransitionSolverDelegate;
 
@@ -315,16 +319,19 @@ public:
     void SetGhostSource(GhostSource source, int which = 0);
 
     [[nodiscard]] CalChart::Configuration& GetConfiguration() const { return mConfig; }
+    [[nodiscard]] auto GetUndoHistory() const -> std::shared_ptr<CalChart::UndoHistory const> { return mUndoHistory; }
 
     [[nodiscard]] auto GetAnimationInfo(CalChart::Beats whichBeat) const -> std::vector<CalChart::Animate::Info>;
     [[nodiscard]] auto GetAnimationInfo(CalChart::MarcherIndex whichMarcher, CalChart::Beats whichBeat) const -> std::optional<CalChart::Animate::Info>;
     [[nodiscard]] auto GetAnimationErrors() const -> std::vector<CalChart::Animate::Errors>;
     [[nodiscard]] auto GetAnimationCollisions() const -> std::map<int, CalChart::SelectionList>;
-    [[nodiscard]] auto GenerateAnimationDrawCommands(
+    // adds to result what to draw for this beat; it's meant to be drawn at GetShowFieldOffset().
+    void GenerateAnimationDrawCommands(
+        CalChart::Draw::DisplayList& result,
         CalChart::Beats whichBeat,
         bool drawCollisionWarning,
         std::optional<bool> onBeat,
-        CalChart::Animation::AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>;
+        CalChart::Animation::AngleStepToImageFunction const& imageFunction) const;
     [[nodiscard]] auto GetTotalNumberAnimationBeats() const -> std::optional<CalChart::Beats>;
     [[nodiscard]] auto AnimationBeatToSheetOffsetAndBeat(CalChart::Beats whichBeat) const -> std::optional<std::tuple<size_t, CalChart::Beats>>;
     [[nodiscard]] auto AnimationBeatsForSheet(int whichSheet) const -> CalChart::Beats;
@@ -336,11 +343,16 @@ public:
     [[nodiscard]] auto BeatHasCollision(CalChart::Beats whichBeat) const -> bool;
     [[nodiscard]] auto GetAnimationBeatForCurrentSheet() const -> CalChart::Beats;
 
-    [[nodiscard]] auto GenerateGhostPointsDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>;
+    void GenerateGhostPointsDrawCommands(CalChart::Draw::DisplayList& result) const;
     [[nodiscard]] auto GenerateCurrentSheetPointsDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>;
+    // the two halves of GenerateCurrentSheetPointsDrawCommands, so the field can be kept while the sheet changes.
+    [[nodiscard]] auto GenerateFieldDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>;
+    // adds to result what to draw for the current sheet; it's meant to be drawn at GetShowFieldOffset().
+    void GenerateCurrentSheetMarchersDrawCommands(CalChart::Draw::DisplayList& result) const;
 
     [[nodiscard]] auto GeneratePhatomPointsDrawCommands(CalChart::MarcherToPosition const& positions) const -> std::vector<CalChart::Draw::DrawCommand>;
-    [[nodiscard]] auto GenerateFieldWithMarchersDrawCommands() const { return mShow->GenerateFieldWithMarchersDrawCommands(mConfig); }
+    [[nodiscard]] auto GenerateThumbnailFieldDrawCommands() const { return mShow->GenerateThumbnailFieldDrawCommands(mConfig); }
+    [[nodiscard]] auto GenerateThumbnailMarchersDrawCommands(CalChart::Sheet const& sheet) const { return mShow->GenerateThumbnailMarchersDrawCommands(mConfig, sheet); }
 
     [[nodiscard]] auto AlreadyHasPrintContinuity() const { return mShow->AlreadyHasPrintContinuity(); }
 
@@ -408,6 +420,7 @@ private:
     // that file instead.
     // When we save a file, the recovery file should be removed to prevent
     // a false detection that the file writing failed.
+    // The recovery file is written by mAutosaver on its own thread, from a copy of the show.
     static auto TranslateNameToAutosaveName(const wxString& name) -> wxString;
     void Autosave();
 
@@ -428,8 +441,11 @@ private:
     // This include temporary non-saved aspects like what configuration tools are in (select mode), or what reference
     // points are currently being moved.
     CalChart::Configuration& mConfig;
+    // where this document's undo commands keep their images and media, under the configured memory limit.
+    std::shared_ptr<CalChart::UndoHistory> mUndoHistory = std::make_shared<CalChart::UndoHistory>();
     std::unique_ptr<CalChart::Show> mShow;
     std::optional<CalChart::Animation> mAnimation;
+    CalChart::Animate::CompileCache mAnimationCache;
     CalChart::Select mSelect = CalChart::Select::Box;
     CalChart::MoveMode mCurrentMove = CalChart::MoveMode::Normal;
     bool mDrawPaths{};
@@ -437,5 +453,6 @@ private:
     GhostSource mGhostSource = GhostSource::disabled;
     int mGhostSheet = 0;
     AutoSaveTimer mTimer;
+    CalChart::Autosaver mAutosaver;
     bool mDrawingCurve = false;
 };
@@ -289,9 +289,10 @@ struct BitmapHolder : CalChart::Draw::OpaqueImageData {
     BitmapHolder(CalChart::ImageData const& image)
     {
         wxImage converted = [](CalChart::ImageData const& image) {
-            auto data = image.data;
+            // the image's bytes are shared, and wxImage wants ones it can write to.
+            auto data = std::vector<unsigned char>(image.data.begin(), image.data.end());
             if (image.alpha.size()) {
-                auto alpha = image.alpha;
+                auto alpha = std::vector<unsigned char>(image.alpha.begin(), image.alpha.end());
                 return wxImage{ image.width, image.height, data.data(), alpha.data(), true };
             }
             return wxImage{ image.width, image.height, data.data(), true };
@@ -27,6 +27,7 @@
 #include "CalChartAnimationCommand.h"
 #include "CalChartConfiguration.h"
 #include "CalChartCoordHelper.h"
+#include "CalChartDisplayList.h"
 #include "CalChartDoc.h"
 #include "CalChartDrawCommand.h"
 #include "CalChartDrawPrimativesHelper.h"
@@ -658,7 +659,7 @@ void DrawForPrinting(wxDC* printerdc, CalChart::Configuration const& config, Cal
 namespace wxCalChart::Draw {
 
 // this draws the yardline labels
-static void DrawText(wxDC& dc, std::string text, wxPoint where, CalChart::Draw::Text::TextAnchor anchor, bool withBox)
+static void DrawText(wxDC& dc, wxString const& text, wxPoint where, CalChart::Draw::Text::TextAnchor anchor, bool withBox)
 {
     auto textSize = dc.GetTextExtent(text);
     using TextAnchor = CalChart::Draw::Text::TextAnchor;
@@ -846,4 +847,116 @@ namespace details {
             cmd);
     }
 }
+
+void DrawDisplayList(wxDC& dc, CalChart::Draw::DisplayList const& list, CalChart::Coord offset)
+{
+    using OpCode = CalChart::Draw::DisplayList::OpCode;
+    // what each open Push replaced, so the matching Pop can put it back.
+    struct Saved {
+        OpCode code{};
+        wxFont font{};
+        wxBrush brush{};
+        wxPen pen{};
+        wxColour textForeground{};
+    };
+    auto saved = std::vector<Saved>{};
+    auto restore = [&dc](Saved const& last) {
+        switch (last.code) {
+        case OpCode::PushFont:
+            dc.SetFont(last.font);
+            break;
+        case OpCode::PushTextForeground:
+            dc.SetTextForeground(last.textForeground);
+            break;
+        case OpCode::PushBrush:
+            dc.SetBrush(last.brush);
+            break;
+        case OpCode::PushPen:
+            dc.SetPen(last.pen);
+            break;
+        default:
+            dc.SetBrush(last.brush);
+            dc.SetPen(last.pen);
+            break;
+        }
+    };
+    // each op is drawn straight from the list, rather than being turned back into a DrawCommand.
+    auto at = [offset](CalChart::Coord where) { return fDIP(wxCalChart::to_wxPoint(where + offset)); };
+    auto drawShape = [&dc](bool filled, auto&& draw) {
+        SaveAndRestore::Brush restore(dc);
+        if (!filled) {
+            dc.SetBrush(*wxTRANSPARENT_BRUSH);
+        }
+        draw();
+    };
+    for (auto&& op : list.GetOps()) {
+        switch (op.code) {
+        case OpCode::Line:
+            dc.DrawLine(at(op.c1), at(op.c2));
+            break;
+        case OpCode::Arc:
+            dc.DrawArc(at(op.c1), at(op.c2), at(op.c3));
+            break;
+        case OpCode::Ellipse:
+            drawShape(op.filled, [&] { dc.DrawEllipse(at(op.c1), fDIP(wxCalChart::to_wxSize(op.c2 - op.c1))); });
+            break;
+        case OpCode::Circle:
+            drawShape(op.filled, [&] { dc.DrawCircle(at(op.c1), fDIP(op.value)); });
+            break;
+        case OpCode::Rectangle:
+            drawShape(op.filled, [&] {
+                if (op.value > 0) {
+                    dc.DrawRoundedRectangle(at(op.c1), fDIP(wxCalChart::to_wxSize(op.c2)), fDIP(op.value));
+                } else {
+                    dc.DrawRectangle(at(op.c1), fDIP(wxCalChart::to_wxSize(op.c2)));
+                }
+            });
+            break;
+        case OpCode::Text: {
+            auto text = list.GetText(op);
+            DrawText(dc, wxString{ text.data(), text.size() }, at(op.c1), op.anchor, op.withBackground);
+            break;
+        }
+        case OpCode::Image: {
+            auto&& image = list.GetImage(op);
+            dc.DrawBitmap(wxCalChart::ConvertTowxBitmap(image), at(image.mStart));
+            break;
+        }
+        case OpCode::Command:
+            // stacks lay themselves out from where they are, so they are moved rather than drawn somewhere else.
+            details::DrawCommand(dc, { { 0, 0 }, dc.GetSize() }, list.GetCommand(op) + offset);
+            break;
+        case OpCode::PushFont:
+            saved.push_back({ .code = op.code, .font = dc.GetFont() });
+            wxCalChart::setFont(dc, list.GetFont(op));
+            break;
+        case OpCode::PushTextForeground:
+            saved.push_back({ .code = op.code, .textForeground = dc.GetTextForeground() });
+            wxCalChart::setTextForeground(dc, list.GetBrushAndPen(op));
+            break;
+        case OpCode::PushBrush:
+            saved.push_back({ .code = op.code, .brush = dc.GetBrush() });
+            wxCalChart::setBrush(dc, list.GetBrush(op));
+            break;
+        case OpCode::PushPen:
+            saved.push_back({ .code = op.code, .pen = dc.GetPen() });
+            wxCalChart::setPen(dc, list.GetPen(op));
+            break;
+        case OpCode::PushBrushAndPen:
+            saved.push_back({ .code = op.code, .brush = dc.GetBrush(), .pen = dc.GetPen() });
+            wxCalChart::setBrushAndPen(dc, list.GetBrushAndPen(op));
+            break;
+        case OpCode::Pop:
+            if (!saved.empty()) {
+                restore(saved.back());
+                saved.pop_back();
+            }
+            break;
+        }
+    }
+    // anything left open is put back as if it had been popped.
+    for (auto&& last : saved | std::views::reverse) {
+        restore(last);
+    }
+}
 }
@@ -46,6 +46,9 @@ using Textline_list = std::vector<Textline>;
 class Point;
 class Configuration;
 class ShowMode;
+namespace Draw {
+    class DisplayList;
+}
 }
 class CalChartDoc;
 
@@ -125,4 +128,7 @@ void DrawCommandList(wxDC& dc, R&& draw_commands)
     DrawCommandList(dc, { { 0, 0 }, dc.GetSize() }, std::forward<R>(draw_commands));
 }
 
+// Draw a display list, moved by offset.
+void DrawDisplayList(wxDC& dc, CalChart::Draw::DisplayList const& list, CalChart::Coord offset = {});
+
 }
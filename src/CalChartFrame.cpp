@@ -929,7 +929,8 @@ void CalChartFrame::OnShowDrawPerformance()
 {
     // Create the dialog if it doesn't exist
     if (!mPerformanceDialog) {
-        mPerformanceDialog = new PerformanceDialog(this, CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry());
+        auto* doc = GetShow();
+        mPerformanceDialog = new PerformanceDialog(this, CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), doc ? doc->GetUndoHistory() : nullptr);
     }
 
     // Show and raise the dialog
@@ -1611,7 +1612,7 @@ void CalChartFrame::OnUpdate()
     SetStatusText(PointStatusText(), 2);
 
     SetTitle(GetDocument()->GetUserReadableName());
-    mCanvas->Refresh();
+    mCanvas->OnUpdate();
 
     mContinuityBrowser->OnUpdate();
     mFieldThumbnailBrowser->OnUpdate();
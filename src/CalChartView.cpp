@@ -123,6 +123,16 @@ auto CalChartView::GeneratePhatomPointsDrawCommands(CalChart::MarcherToPosition
     return mShow->GeneratePhatomPointsDrawCommands(positions);
 }
 
+auto CalChartView::GenerateFieldDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>
+{
+    return mShow->GenerateFieldDrawCommands();
+}
+
+void CalChartView::GenerateCurrentSheetMarchersDrawCommands(CalChart::Draw::DisplayList& result) const
+{
+    mShow->GenerateCurrentSheetMarchersDrawCommands(result);
+}
+
 void CalChartView::OnDrawBackground(wxDC& dc)
 {
     if (!mShow->GetDrawBackground()) {
@@ -131,6 +141,11 @@ void CalChartView::OnDrawBackground(wxDC& dc)
     mBackgroundImages.OnPaint(dc);
 }
 
+auto CalChartView::GetBackgroundVersion() const -> uint64_t
+{
+    return mShow->GetDrawBackground() ? mBackgroundImages.GetVersion() : 0;
+}
+
 void CalChartView::OnUpdate(wxView* WXUNUSED(sender), wxObject* hint)
 {
     if (hint && hint->IsKindOf(CLASSINFO(CalChartDoc_setup))) {
@@ -439,13 +454,15 @@ std::map<int, CalChart::SelectionList> CalChartView::GetAnimationCollisions() co
     return mShow->GetAnimationCollisions();
 }
 
-auto CalChartView::GenerateAnimationDrawCommands(
+void CalChartView::GenerateAnimationDrawCommands(
+    CalChart::Draw::DisplayList& result,
     CalChart::Beats whichBeat,
     bool drawCollisionWarning,
     std::optional<bool> onBeat,
-    CalChart::Animation::AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>
+    CalChart::Animation::AngleStepToImageFunction const& imageFunction) const
 {
-    return mShow->GenerateAnimationDrawCommands(
+    mShow->GenerateAnimationDrawCommands(
+        result,
         whichBeat,
         drawCollisionWarning,
         onBeat,
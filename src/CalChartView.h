@@ -25,6 +25,7 @@
 #include "CalChartDoc.h"
 #include "CalChartShowMode.h"
 #include "CalChartTypes.h"
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <optional>
@@ -46,6 +47,8 @@ public:
 
     void OnDraw(wxDC* dc) override;
     void OnDrawBackground(wxDC& dc);
+    // changes whenever OnDrawBackground would draw something different.
+    [[nodiscard]] auto GetBackgroundVersion() const -> uint64_t;
 
     ///// Modify the show. /////
     // Issue the change to the docs command processor, it allows for the ability to undo the change.
@@ -91,6 +94,7 @@ public:
     [[nodiscard]] auto GetShowFullSize() const { return mShow->GetShowMode().Size(); }
     [[nodiscard]] auto GetShowFieldSize() const { return mShow->GetShowMode().FieldSize(); }
     [[nodiscard]] auto GetSheetsName() const { return mShow->GetSheetsName(); }
+    [[nodiscard]] auto CopySheets() const { return mShow->CopySheets(); }
     [[nodiscard]] auto GetSheetPrintNumberOnCurrentSheet() const { return mShow->GetSheetPrintNumberOnCurrentSheet(); }
     [[nodiscard]] auto GetSheetRawPrintContinuityOnCurrentSheet() const { return mShow->GetSheetRawPrintContinuityOnCurrentSheet(); }
     [[nodiscard]] auto GetSheetPrintContinuityOnCurrentSheet() const { return mShow->GetSheetPrintContinuityOnCurrentSheet(); }
@@ -164,12 +168,17 @@ public:
     ///// Drawing marcher's paths /////
     // Generate Draw Commands
     [[nodiscard]] auto GeneratePhatomPointsDrawCommands(CalChart::MarcherToPosition const& positions) const -> std::vector<CalChart::Draw::DrawCommand>;
-    [[nodiscard]] auto GenerateFieldWithMarchersDrawCommands() const { return mShow->GenerateFieldWithMarchersDrawCommands(); }
-    [[nodiscard]] auto GenerateAnimationDrawCommands(
+    [[nodiscard]] auto GenerateFieldDrawCommands() const -> std::vector<CalChart::Draw::DrawCommand>;
+    // meant to be drawn at GetShowFieldOffset().
+    void GenerateCurrentSheetMarchersDrawCommands(CalChart::Draw::DisplayList& result) const;
+    [[nodiscard]] auto GenerateThumbnailFieldDrawCommands() const { return mShow->GenerateThumbnailFieldDrawCommands(); }
+    [[nodiscard]] auto GenerateThumbnailMarchersDrawCommands(CalChart::Sheet const& sheet) const { return mShow->GenerateThumbnailMarchersDrawCommands(sheet); }
+    void GenerateAnimationDrawCommands(
+        CalChart::Draw::DisplayList& result,
         CalChart::Beats whichBeat,
         bool drawCollisionWarning,
         std::optional<bool> onBeat,
-        CalChart::Animation::AngleStepToImageFunction imageFunction) const -> std::vector<CalChart::Draw::DrawCommand>;
+        CalChart::Animation::AngleStepToImageFunction const& imageFunction) const;
 
     // call this when we need to generate the marcher's paths.
     void OnEnableDrawPaths(bool enable);
@@ -189,8 +198,15 @@ private:
 
     CalChartFrame* mFrame{};
     CalChartDoc* mShow{};
-    // a cached version of the sheet background images for convenience.
-    BackgroundImages mBackgroundImages;
+    // a cached version of the sheet background images for convenience.  Images are scaled on another thread,
+    // so repaint when one is ready.
+    BackgroundImages mBackgroundImages{ [this] {
+        CallAfter([this] {
+            if (auto* frame = GetFrame(); frame != nullptr) {
+                frame->Refresh();
+            }
+        });
+    } };
 
     DECLARE_DYNAMIC_CLASS(CalChartView)
 
@@ -69,8 +69,14 @@ auto GetDebugFieldThumbnailBrowserHandlers(
         [&show]() {
             return show.GetSheetsName();
         },
+        [&show]() {
+            return show.CopySheets();
+        },
         [&show, &config]() {
-            return show.GenerateFieldWithMarchersDrawCommands(config);
+            return show.GenerateThumbnailFieldDrawCommands(config);
+        },
+        [&show, &config](CalChart::Sheet const& sheet) {
+            return show.GenerateThumbnailMarchersDrawCommands(config, sheet);
         },
         [&show, window](size_t sheet_num) {
             auto numSheets = show.GetNumSheets();
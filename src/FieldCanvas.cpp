@@ -32,12 +32,20 @@
 #include "CalChartTypes.h"
 #include "CalChartUtils.h"
 #include "CalChartView.h"
+#include <algorithm>
 #include <optional>
 #include <print>
 #include <ranges>
 #include <wx/dcbuffer.h>
+#include <wx/dcclient.h>
+#include <wx/dcmemory.h>
 
 namespace {
+// sheets kept drawn so going back and forth between them doesn't draw them again.
+constexpr auto kMaxSheetLayers = size_t{ 4 };
+// in pixels, for the width of pens and the labels around the points being moved.
+constexpr auto kOverlayMargin = 4;
+
 auto TranslateMouseToCoord(wxClientDC& dc, wxMouseEvent& event)
 {
     auto mousePos = event.GetPosition();
@@ -124,6 +132,8 @@ FieldCanvas::FieldCanvas(wxWindow* parent, CalChartView* view, float def_zoom, C
     , mView(view)
     , mConfig(config)
     , mPerfRegistry(CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), this, "FieldCanvas::OnPaint")
+    , mFieldLayerPerfRegistry(CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), &mFieldLayer, "FieldCanvas::DrawFieldLayer")
+    , mSheetLayerPerfRegistry(CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), &mSheetLayers, "FieldCanvas::DrawSheetLayer")
 {
     Init();
     super::SetZoom(def_zoom);
@@ -137,6 +147,13 @@ void FieldCanvas::Init()
 void FieldCanvas::SetView(CalChartView* view)
 {
     mView = view;
+    OnUpdate();
+}
+
+void FieldCanvas::OnUpdate()
+{
+    mLayerCommandsStale = true;
+    Refresh();
 }
 
 // Painting involves deferring to the view as it has much of the information about how to draw consistently
@@ -210,19 +227,108 @@ void FieldCanvas::OnPaint(wxPaintEvent&, CalChart::Configuration const& config)
         return;
     }
     wxBufferedPaintDC dc(this);
+    if (mLayerCommandsStale) {
+        UpdateLayerCommands();
+    }
+
+    // background images move with the mouse while they're being adjusted, so there's nothing worth keeping.
+    if (mView->DoingPictureAdjustment()) {
+        PrepareDC(dc);
+        PaintBackground(dc, config);
+        mView->OnDrawBackground(dc);
+        wxCalChart::Draw::DrawCommandList(dc, mFieldCommands);
+        auto const& layer = mSheetLayers[mCurrentSheet];
+        wxCalChart::Draw::DrawDisplayList(dc, layer.commands, layer.offset);
+    } else {
+        dc.DrawBitmap(GetSheetLayer(GetLayerGeometry(), config), 0, 0);
+        PrepareDC(dc);
+    }
+
+    // draw the move points dots
+    mOverlayCommands = GenerateOverlayDrawCommands(config);
+    wxCalChart::Draw::DrawCommandList(dc, mOverlayCommands);
+    mOverlayRect = GetOverlayRect(mOverlayCommands);
+    mOverlayGeometry = GetLayerGeometry();
+}
+
+void FieldCanvas::UpdateLayerCommands()
+{
+    mLayerCommandsStale = false;
+    // worked out once per change rather than on every paint, and compared with what's drawn so that going back to a
+    // sheet, or a change somewhere else in the show, keeps the layers that are already drawn.
+    if (auto fieldCommands = mView->GenerateFieldDrawCommands(); fieldCommands != mFieldCommands) {
+        mFieldCommands = std::move(fieldCommands);
+        ++mFieldCommandsVersion;
+    }
+    mCurrentSheet = static_cast<size_t>(mView->GetCurrentSheetNum());
+    auto& layer = mSheetLayers[mCurrentSheet];
+    mSheetCommands.clear();
+    mView->GenerateCurrentSheetMarchersDrawCommands(mSheetCommands);
+    if (auto offset = mView->GetShowFieldOffset(); mSheetCommands != layer.commands || offset != layer.offset) {
+        std::swap(layer.commands, mSheetCommands);
+        layer.offset = offset;
+        layer.bitmap = wxBitmap{};
+    }
+    layer.lastUsed = ++mSheetLayerUseCount;
+    while (mSheetLayers.size() > kMaxSheetLayers) {
+        mSheetLayers.erase(std::ranges::min_element(mSheetLayers, {}, [](auto&& entry) { return entry.second.lastUsed; }));
+    }
+}
+
+auto FieldCanvas::GetLayerGeometry() -> LayerGeometry
+{
+    wxMemoryDC dc;
     PrepareDC(dc);
+    auto result = LayerGeometry{ .origin = dc.GetDeviceOrigin(), .size = GetClientSize() };
+    dc.GetUserScale(&result.scaleX, &result.scaleY);
+    return result;
+}
 
-    // draw the background
-    PaintBackground(dc, config);
+auto FieldCanvas::CreateLayerBitmap(LayerGeometry const& geometry) const -> wxBitmap
+{
+    auto result = wxBitmap{};
+    result.CreateWithDIPSize(ToDIP(geometry.size), GetDPIScaleFactor());
+    return result;
+}
 
-    // draw Background Image
+auto FieldCanvas::GetFieldLayer(LayerGeometry const& geometry, CalChart::Configuration const& config) -> wxBitmap const&
+{
+    auto backgroundVersion = mView->GetBackgroundVersion();
+    auto fieldBrush = config.Get_CalChartBrushAndPen(CalChart::Colors::FIELD);
+    if (mFieldLayer && mFieldLayer->geometry == geometry && mFieldLayer->commandsVersion == mFieldCommandsVersion && mFieldLayer->backgroundVersion == backgroundVersion && mFieldLayer->fieldBrush == fieldBrush) {
+        return mFieldLayer->bitmap;
+    }
+    auto measure = mFieldLayerPerfRegistry.doMeasure();
+    mFieldLayer = FieldLayer{ geometry, mFieldCommandsVersion, backgroundVersion, fieldBrush, CreateLayerBitmap(geometry) };
+    ++mFieldLayerVersion;
+    wxMemoryDC dc(mFieldLayer->bitmap);
+    PrepareDC(dc);
+    PaintBackground(dc, config);
     mView->OnDrawBackground(dc);
+    wxCalChart::Draw::DrawCommandList(dc, mFieldCommands);
+    return mFieldLayer->bitmap;
+}
 
-    // draw the view
-    mView->OnDraw(&dc);
+auto FieldCanvas::GetSheetLayer(LayerGeometry const& geometry, CalChart::Configuration const& config) -> wxBitmap const&
+{
+    auto const& field = GetFieldLayer(geometry, config);
+    auto& layer = mSheetLayers[mCurrentSheet];
+    if (layer.bitmap.IsOk() && layer.geometry == geometry && layer.fieldVersion == mFieldLayerVersion) {
+        return layer.bitmap;
+    }
+    auto measure = mSheetLayerPerfRegistry.doMeasure();
+    layer.geometry = geometry;
+    layer.fieldVersion = mFieldLayerVersion;
+    layer.bitmap = CreateLayerBitmap(geometry);
+    wxMemoryDC dc(layer.bitmap);
+    dc.DrawBitmap(field, 0, 0);
+    PrepareDC(dc);
+    wxCalChart::Draw::DrawDisplayList(dc, layer.commands, layer.offset);
+    return layer.bitmap;
+}
 
-    // draw the move points dots
-    auto origin = mView->GetShowFieldOffset();
+auto FieldCanvas::GenerateOverlayDrawCommands(CalChart::Configuration const& config) const -> std::vector<CalChart::Draw::DrawCommand>
+{
     auto drawCmds = mView->GeneratePhatomPointsDrawCommands(mUncommittedMovePoints);
     CalChart::append(drawCmds,
         GenerateShapeBasedCommands(mSelectTool, mMovePointsTool.get(), config));
@@ -231,8 +337,56 @@ void FieldCanvas::OnPaint(wxPaintEvent&, CalChart::Configuration const& config)
         CalChart::append(drawCmds,
             DrawCurve(mCurve->mCurve, mCurve->mPointsSelected, config));
     }
+    return drawCmds + mView->GetShowFieldOffset();
+}
 
-    wxCalChart::Draw::DrawCommandList(dc, drawCmds + origin);
+auto FieldCanvas::GetOverlayRect(std::vector<CalChart::Draw::DrawCommand> const& overlayCommands) -> std::optional<wxRect>
+{
+    // images are drawn a pixel to a pixel, and Coords are in DIPs.
+    constexpr auto kPixels = 1000;
+    auto box = CalChart::Draw::GetBoundingBox(overlayCommands, {}, static_cast<double>(kPixels) / fDIP(wxSize{ kPixels, kPixels }).x);
+    if (!box) {
+        return std::nullopt;
+    }
+    wxClientDC dc(this);
+    PrepareDC(dc);
+    // only what's on screen matters, and things that could be anywhere are much bigger than that.
+    auto clip = [&dc, client = GetClientSize()](CalChart::Coord point) {
+        auto where = fDIP(point);
+        return wxPoint{
+            std::clamp(dc.LogicalToDeviceX(std::clamp(where.x, dc.DeviceToLogicalX(0), dc.DeviceToLogicalX(client.x))), 0, client.x),
+            std::clamp(dc.LogicalToDeviceY(std::clamp(where.y, dc.DeviceToLogicalY(0), dc.DeviceToLogicalY(client.y))), 0, client.y),
+        };
+    };
+    // pens have width, so leave a little room around the edges.
+    return wxRect{ clip(box->first), clip(box->second) }.Inflate(kOverlayMargin);
+}
+
+void FieldCanvas::RefreshOverlay()
+{
+    // where the overlay was is only known for the scroll and zoom it was drawn with.
+    if (!mView || mLayerCommandsStale || mView->DoingPictureAdjustment() || mOverlayGeometry != GetLayerGeometry()) {
+        RefreshAll();
+        return;
+    }
+    auto overlayCommands = GenerateOverlayDrawCommands(mConfig);
+    if (overlayCommands == mOverlayCommands) {
+        return;
+    }
+    auto rect = GetOverlayRect(overlayCommands);
+    if (mOverlayRect) {
+        RefreshRect(rect ? rect->Union(*mOverlayRect) : *mOverlayRect, false);
+    } else if (rect) {
+        RefreshRect(*rect, false);
+    }
+    mOverlayRect = rect;
+}
+
+void FieldCanvas::RefreshAll()
+{
+    mOverlayRect.reset();
+    mOverlayGeometry.reset();
+    Refresh();
 }
 
 void FieldCanvas::PaintBackground(wxDC& dc, CalChart::Configuration const& config)
@@ -255,7 +409,7 @@ void FieldCanvas::OnMouseLeftDown(wxMouseEvent& event)
     if (!mView) {
         return;
     }
-    auto _ = Defer([this]() { Refresh(); });
+    auto _ = Defer([this]() { RefreshOverlay(); });
     wxClientDC dc(this);
     PrepareDC(dc);
 
@@ -425,7 +579,7 @@ void FieldCanvas::OnMouseLeftUp(wxMouseEvent& event)
     if (!mView) {
         return;
     }
-    auto _ = Defer([this]() { Refresh(); });
+    auto _ = Defer([this]() { RefreshOverlay(); });
     wxClientDC dc(this);
     PrepareDC(dc);
 
@@ -474,7 +628,7 @@ void FieldCanvas::OnMouseLeftDoubleClick(wxMouseEvent& event)
     }
     wxClientDC dc(this);
     PrepareDC(dc);
-    auto _ = Defer([this]() { Refresh(); });
+    auto _ = Defer([this]() { RefreshOverlay(); });
 
     if (IsCurveDrawingMode()) {
         auto mousePos = TranslateMouseToCoord(dc, event);
@@ -519,7 +673,7 @@ void FieldCanvas::OnMouseMove(wxMouseEvent& event)
     if (!mView) {
         return;
     }
-    auto _ = Defer([this]() { Refresh(); });
+    auto _ = Defer([this]() { RefreshOverlay(); });
     super::OnMouseMove(event);
 
     if (IsScrolling()) {
@@ -635,6 +789,12 @@ void FieldCanvas::MoveDrag(CalChart::Coord end)
     }
 }
 
+void FieldCanvas::OnMouseWheel(wxMouseEvent& event)
+{
+    super::OnMouseWheel(event);
+    RefreshAll();
+}
+
 // Allow clicking within pixels to close polygons
 void FieldCanvas::OnMousePinchToZoom(wxMouseEvent& event)
 {
@@ -698,14 +858,14 @@ float FieldCanvas::ZoomToFitFactor() const
 void FieldCanvas::SetZoom(float factor)
 {
     super::SetZoom(factor);
-    Refresh();
+    RefreshAll();
 }
 
 void FieldCanvas::SetZoomAroundCenter(float factor)
 {
     auto size = GetSize();
     super::SetZoom(factor, { size.x / 2, size.y / 2 });
-    Refresh();
+    RefreshAll();
 }
 
 void FieldCanvas::BeginSelectDrag(CalChart::Select type, CalChart::Coord start)
@@ -21,6 +21,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "CalChartDisplayList.h"
+#include "CalChartDrawCommand.h"
 #include "CalChartMovePointsTool.h"
 #include "CalChartPerformanceRegistry.h"
 #include "CalChartPoint.h"
@@ -29,10 +31,13 @@
 #include "CalChartTypes.h"
 #include "basic_ui.h"
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
 #include <vector>
+#include <wx/bitmap.h>
 #include <wx/docview.h>
 
 class CalChartView;
@@ -59,6 +64,8 @@ public:
     ~FieldCanvas() override = default;
 
     void SetView(CalChartView* view);
+    // the show changed; works out what needs drawing again.
+    void OnUpdate();
 
     // Misc show functions
     float ZoomToFitFactor() const;
@@ -86,6 +93,7 @@ private:
     void OnMouseRightDown(wxMouseEvent& event);
     void OnMouseMove(wxMouseEvent& event) override;
     void OnMousePinchToZoom(wxMouseEvent& event) override;
+    void OnMouseWheel(wxMouseEvent& event) override;
 
     // Internals
     void BeginSelectDrag(CalChart::Select select, CalChart::Coord start);
@@ -109,6 +117,47 @@ private:
     void OnPaint(wxPaintEvent& event, const CalChart::Configuration& config);
     void PaintBackground(wxDC& dc, const CalChart::Configuration& config);
 
+    // The field is painted in layers.  The field lines and background images, and the marchers on a sheet, are each
+    // kept in a bitmap the size of the window until what they draw changes or the field is scrolled or zoomed.  The
+    // tools and the points being moved are drawn on top on every paint, and when only they change just the part of
+    // the window they were and are in gets painted again.
+    struct LayerGeometry {
+        wxPoint origin;
+        double scaleX{};
+        double scaleY{};
+        wxSize size;
+        auto operator==(LayerGeometry const&) const -> bool = default;
+    };
+    struct FieldLayer {
+        LayerGeometry geometry;
+        uint64_t commandsVersion{};
+        uint64_t backgroundVersion{};
+        // the field color is baked in, so a change in the preferences needs a new layer.
+        CalChart::BrushAndPen fieldBrush;
+        wxBitmap bitmap;
+    };
+    // the sheet is drawn from a flat DisplayList, moved to the field when it's replayed.
+    struct SheetLayer {
+        CalChart::Draw::DisplayList commands;
+        CalChart::Coord offset;
+        LayerGeometry geometry;
+        uint64_t fieldVersion{};
+        uint64_t lastUsed{};
+        wxBitmap bitmap;
+    };
+    void UpdateLayerCommands();
+    [[nodiscard]] auto GetLayerGeometry() -> LayerGeometry;
+    [[nodiscard]] auto CreateLayerBitmap(LayerGeometry const& geometry) const -> wxBitmap;
+    [[nodiscard]] auto GetFieldLayer(LayerGeometry const& geometry, const CalChart::Configuration& config) -> wxBitmap const&;
+    [[nodiscard]] auto GetSheetLayer(LayerGeometry const& geometry, const CalChart::Configuration& config) -> wxBitmap const&;
+    [[nodiscard]] auto GenerateOverlayDrawCommands(const CalChart::Configuration& config) const -> std::vector<CalChart::Draw::DrawCommand>;
+    // where on the screen the commands draw, if anywhere.
+    [[nodiscard]] auto GetOverlayRect(std::vector<CalChart::Draw::DrawCommand> const& overlayCommands) -> std::optional<wxRect>;
+    // paints again where the overlay was and where it is now.
+    void RefreshOverlay();
+    // paints everything again, for when what's on the screen has moved.
+    void RefreshAll();
+
     void OnMouseLeftDown_Normal(CalChart::Coord pos, bool shiftDown, bool altDown);
     void OnMouseLeftDown_Swap(CalChart::Coord pos);
     void OnMouseLeftDown_DrawingCurve(CalChart::Coord pos, bool shiftDown, bool altDown);
@@ -146,5 +195,24 @@ private:
         std::optional<ExistingCurveInfo> mExistingCurve;
     };
     std::optional<CurveDrawInfo> mCurve;
+
+    bool mLayerCommandsStale = true;
+    std::vector<CalChart::Draw::DrawCommand> mFieldCommands;
+    uint64_t mFieldCommandsVersion{};
+    std::optional<FieldLayer> mFieldLayer;
+    uint64_t mFieldLayerVersion{};
+    size_t mCurrentSheet{};
+    std::map<size_t, SheetLayer> mSheetLayers;
+    // what the current sheet draws is generated into this, and swapped with the layer's when it's different, so the
+    // lists keep their buffers from one change to the next.
+    CalChart::Draw::DisplayList mSheetCommands;
+    uint64_t mSheetLayerUseCount{};
+    std::vector<CalChart::Draw::DrawCommand> mOverlayCommands;
+    // where the overlay is on the screen, which only holds while the scroll and zoom it was drawn with do.
+    std::optional<wxRect> mOverlayRect;
+    std::optional<LayerGeometry> mOverlayGeometry;
+
     CalChart::ScopedPerformanceRegistry mPerfRegistry;
+    CalChart::ScopedPerformanceRegistry mFieldLayerPerfRegistry;
+    CalChart::ScopedPerformanceRegistry mSheetLayerPerfRegistry;
 };
@@ -32,8 +32,12 @@
 #include "CalChartView.h"
 #include "basic_ui.h"
 
+#include <algorithm>
+#include <map>
 #include <ranges>
+#include <tuple>
 #include <wx/dcbuffer.h>
+#include <wx/dcmemory.h>
 
 namespace {
 constexpr auto kXLeftPadding = 4;
@@ -63,7 +67,6 @@ auto CalcUserScale(wxSize box_size, CalChart::Coord mode_size)
 
 template <typename Range>
 auto LayoutSheetThumbnails(
-    size_t current_sheet_num,
     Range&& sheet_names,
     CalChart::Configuration const& config,
     int YNameSize,
@@ -71,7 +74,6 @@ auto LayoutSheetThumbnails(
     CalChart::Coord box_size,
     CalChart::Coord box_offset)
 {
-    auto highlight_offset = box_offset + current_sheet_num * thumbnail_offset;
     return std::vector<CalChart::Draw::DrawCommand>{
         CalChart::Draw::withFont(
             CalChart::Font{ YNameSize },
@@ -87,8 +89,22 @@ auto LayoutSheetThumbnails(
                           + (which * thumbnail_offset);
                       })
                     | std::views::join)),
-        CalChart::Draw::withBrushAndPen(
-            config.Get_CalChartBrushAndPen(CalChart::Colors::FIELD),
+    }
+    + CalChart::Coord(kXLeftPadding, kYUpperPadding);
+}
+
+auto LayoutSheetHighlight(
+    size_t current_sheet_num,
+    CalChart::Configuration const& config,
+    CalChart::Coord thumbnail_offset,
+    CalChart::Coord box_size,
+    CalChart::Coord box_offset)
+{
+    auto highlight_offset = box_offset + current_sheet_num * thumbnail_offset;
+    return std::vector<CalChart::Draw::DrawCommand>{
+        // drawn over the thumbnail, so only the outline.
+        CalChart::Draw::withBrush(
+            CalChart::Brush::TransparentBrush(),
             CalChart::Draw::withPen(CalChart::toPen(config.Get_CalChartBrushAndPen(CalChart::Colors::POINT_HILIT_TEXT)).withWidth(kHighlightWidth),
                 CalChart::Draw::Rectangle(highlight_offset, box_size))),
     }
@@ -115,19 +131,30 @@ auto GetSheetsName(FieldThumbnailBrowser::Handlers const& handle)
     return std::get<3>(handle)();
 }
 
-auto GenerateFieldWithMarchersDrawCommands(FieldThumbnailBrowser::Handlers const& handle)
+auto CopySheets(FieldThumbnailBrowser::Handlers const& handle)
 {
     return std::get<4>(handle)();
 }
 
+auto GenerateThumbnailFieldDrawCommands(FieldThumbnailBrowser::Handlers const& handle)
+{
+    return std::get<5>(handle)();
+}
+
+auto GenerateThumbnailMarchersDrawCommands(FieldThumbnailBrowser::Handlers const& handle, CalChart::Sheet const& sheet)
+{
+    return std::get<6>(handle)(sheet);
+}
+
 auto GoToSheet(FieldThumbnailBrowser::Handlers const& handle, size_t sheet_num)
 {
-    std::get<5>(handle)(sheet_num);
+    std::get<7>(handle)(sheet_num);
 }
 }
 
 BEGIN_EVENT_TABLE(FieldThumbnailBrowser, wxScrolledWindow)
 EVT_PAINT(FieldThumbnailBrowser::OnPaint)
+EVT_IDLE(FieldThumbnailBrowser::OnIdle)
 EVT_CHAR(FieldThumbnailBrowser::HandleKey)
 EVT_LEFT_DOWN(FieldThumbnailBrowser::HandleMouseDown)
 EVT_SIZE(FieldThumbnailBrowser::HandleSizeEvent)
@@ -146,6 +173,7 @@ FieldThumbnailBrowser::FieldThumbnailBrowser(
     , mLayoutHorizontal{ true }
     , mConfig(config)
     , mPerfRegistry(CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), this, "FieldThumbnailBrowser::OnPaint")
+    , mThumbnailPerfRegistry(CalChart::PerformanceRegistry::GetGlobalPerformanceRegistry(), &mThumbnails, "FieldThumbnailBrowser::DrawThumbnail")
 {
     SetBackgroundStyle(wxBG_STYLE_PAINT);
     // now update the current screen
@@ -179,6 +207,16 @@ auto FieldThumbnailBrowser::WhichCell(wxPoint const& p) const -> int
     return (mLayoutHorizontal) ? p.x / size_of_one.x : p.y / size_of_one.y;
 }
 
+// the size of the field drawn in each cell
+auto FieldThumbnailBrowser::SizeOfOneBox() const -> wxSize
+{
+    auto mode_size = GetShowFullSize(mHandle);
+    auto current_size = GetSize() - wxSize(kXLeftPadding + kXRightPadding + mXScrollPadding, mYNameSize + kYNamePadding + kYUpperPadding + kYBottomPadding + mYScrollPadding);
+    return mLayoutHorizontal
+        ? wxSize(mode_size.x * (current_size.y / static_cast<double>(mode_size.y)), current_size.y)
+        : wxSize(current_size.x, mode_size.y * (current_size.x / static_cast<double>(mode_size.x)));
+}
+
 // Define the repainting behaviour
 // we draw things as a series of mini-fields, with number than the field.
 // the current field is outlined in yellow
@@ -192,6 +230,9 @@ void FieldThumbnailBrowser::OnPaint([[maybe_unused]] wxPaintEvent& event)
     if (!std::get<0>(mHandle)) {
         return;
     }
+    if (mThumbnailsStale) {
+        UpdateThumbnails();
+    }
 
     wxBufferedPaintDC dc(this);
     PrepareDC(dc);
@@ -199,32 +240,99 @@ void FieldThumbnailBrowser::OnPaint([[maybe_unused]] wxPaintEvent& event)
     dc.Clear();
 
     // let's draw the boxes
-    // Convert mode_size to DIP coordinates to match GetSize() coordinate system
-    auto mode_size = GetShowFullSize(mHandle);
-    auto current_size = GetSize() - wxSize(kXLeftPadding + kXRightPadding + mXScrollPadding, mYNameSize + kYNamePadding + kYUpperPadding + kYBottomPadding + mYScrollPadding);
-    auto box_size = mLayoutHorizontal
-        ? wxSize(mode_size.x * (current_size.y / static_cast<double>(mode_size.y)), current_size.y)
-        : wxSize(current_size.x, mode_size.y * (current_size.x / static_cast<double>(mode_size.x)));
-
+    auto box_size = SizeOfOneBox();
     auto thumbnail_offset = mLayoutHorizontal
         ? wxSize(box_size.x + kXLeftPadding + kXRightPadding, 0)
         : wxSize(0, box_size.y + kYUpperPadding + mYNameSize + kYNamePadding);
 
     auto field_offset = CalChart::Coord(0, mYNameSize + kYNamePadding);
 
-    wxCalChart::Draw::DrawCommandList(dc, LayoutSheetThumbnails(GetCurrentSheetNum(mHandle), GetSheetsName(mHandle), mConfig, mYNameSize, toCoordDIP(thumbnail_offset), toCoordDIP(box_size), field_offset));
+    wxCalChart::Draw::DrawCommandList(dc, LayoutSheetThumbnails(GetSheetsName(mHandle), mConfig, mYNameSize, toCoordDIP(thumbnail_offset), toCoordDIP(box_size), field_offset));
 
-    auto userScale = CalcUserScale(tDIP(box_size), CalChart::Coord{ mode_size.x, mode_size.y });
-    dc.SetUserScale(userScale, userScale);
+    // only the sheets that can be seen are drawn
+    auto client_size = GetClientSize();
+    auto first = std::max(WhichCell(CalcUnscrolledPosition({ 0, 0 })), 0);
+    auto last = std::min(WhichCell(CalcUnscrolledPosition({ client_size.x, client_size.y })) + 1, static_cast<int>(mThumbnails.size()));
+    for (auto which = first; which < last; ++which) {
+        dc.DrawBitmap(GetThumbnail(static_cast<size_t>(which), box_size), which * thumbnail_offset.x + kXLeftPadding, which * thumbnail_offset.y + kYUpperPadding + mYNameSize + kYNamePadding);
+    }
+
+    wxCalChart::Draw::DrawCommandList(dc, LayoutSheetHighlight(GetCurrentSheetNum(mHandle), mConfig, toCoordDIP(thumbnail_offset), toCoordDIP(box_size), field_offset));
+}
+
+// draws the thumbnails that can't be seen yet, one at a time so the app stays responsive.
+void FieldThumbnailBrowser::OnIdle(wxIdleEvent& event)
+{
+    event.Skip();
+    if (!std::get<0>(mHandle) || mThumbnailsStale) {
+        return;
+    }
+    auto box_size = SizeOfOneBox();
+    if (box_size != mThumbnailSize) {
+        return;
+    }
+    auto missing = std::ranges::find_if(mThumbnails, [](auto&& thumbnail) { return !thumbnail.bitmap.IsOk(); });
+    if (missing == mThumbnails.end()) {
+        return;
+    }
+    std::ignore = GetThumbnail(static_cast<size_t>(std::distance(mThumbnails.begin(), missing)), box_size);
+    event.RequestMore();
+}
+
+void FieldThumbnailBrowser::UpdateThumbnails()
+{
+    mThumbnailsStale = false;
+    // the field and the marchers' color are in every thumbnail.
+    auto field = GenerateThumbnailFieldDrawCommands(mHandle);
+    auto marcherBrush = mConfig.Get_CalChartBrushAndPen(CalChart::Colors::POINT_ANIM_FRONT);
+    if (field != mThumbnailField || marcherBrush != mThumbnailMarcherBrush) {
+        mThumbnailField = std::move(field);
+        mThumbnailMarcherBrush = marcherBrush;
+        mThumbnails.clear();
+    }
 
-    auto origin = dc.GetDeviceOrigin();
-    // we manipulate the scale and origin to create repeating copies of the field
-    for (auto [which, sheet] : CalChart::Ranges::enumerate_view(GenerateFieldWithMarchersDrawCommands(mHandle))) {
-        auto newOrigin = wxSize(which * thumbnail_offset.x, which * thumbnail_offset.y);
-        auto newOriginful = (wxSize{ origin.x + newOrigin.x + kXLeftPadding, origin.y + newOrigin.y + kYUpperPadding + mYNameSize + kYNamePadding });
-        dc.SetDeviceOrigin(newOriginful.x, newOriginful.y);
-        wxCalChart::Draw::DrawCommandList(dc, sheet);
+    // found by identity, so inserting, removing or moving sheets keeps the thumbnails that are already drawn.
+    auto previous = std::map<void const*, Thumbnail const*>{};
+    for (auto&& thumbnail : mThumbnails) {
+        previous.emplace(thumbnail.sheet.ContentsIdentity(), &thumbnail);
     }
+    mThumbnails = CalChart::Ranges::ToVector<Thumbnail>(CopySheets(mHandle) | std::views::transform([this, &previous](auto&& sheet) {
+        if (auto found = previous.find(sheet.ContentsIdentity()); found != previous.end()) {
+            return *found->second;
+        }
+        auto marchers = GenerateThumbnailMarchersDrawCommands(mHandle, sheet);
+        return Thumbnail{ sheet, std::move(marchers) };
+    }));
+}
+
+auto FieldThumbnailBrowser::GetThumbnail(size_t which, wxSize boxSize) -> wxBitmap const&
+{
+    // the field color is baked into every thumbnail, so a change in the preferences means drawing them all again.
+    auto fieldBrush = mConfig.Get_CalChartBrushAndPen(CalChart::Colors::FIELD);
+    if (boxSize != mThumbnailSize || fieldBrush != mThumbnailFieldBrush) {
+        mThumbnailSize = boxSize;
+        mThumbnailFieldBrush = fieldBrush;
+        for (auto&& thumbnail : mThumbnails) {
+            thumbnail.bitmap = wxBitmap{};
+        }
+    }
+    auto& thumbnail = mThumbnails.at(which);
+    if (thumbnail.bitmap.IsOk()) {
+        return thumbnail.bitmap;
+    }
+    auto measure = mThumbnailPerfRegistry.doMeasure();
+    thumbnail.bitmap.CreateWithDIPSize(ToDIP(wxSize{ std::max(boxSize.x, 1), std::max(boxSize.y, 1) }), GetDPIScaleFactor());
+    wxMemoryDC dc(thumbnail.bitmap);
+    dc.SetBackgroundMode(wxTRANSPARENT);
+    // the box the thumbnail sits in, as it would be drawn under it.
+    wxCalChart::Draw::DrawCommandList(dc, CalChart::Draw::withBrushAndPen(fieldBrush, CalChart::Draw::Rectangle({ 0, 0 }, toCoordDIP(boxSize))));
+
+    auto mode_size = GetShowFullSize(mHandle);
+    auto userScale = CalcUserScale(tDIP(boxSize), CalChart::Coord{ mode_size.x, mode_size.y });
+    dc.SetUserScale(userScale, userScale);
+    wxCalChart::Draw::DrawCommandList(dc, mThumbnailField);
+    wxCalChart::Draw::DrawCommandList(dc, thumbnail.marchers);
+    return thumbnail.bitmap;
 }
 
 void FieldThumbnailBrowser::OnUpdate()
@@ -232,6 +340,7 @@ void FieldThumbnailBrowser::OnUpdate()
     if (!std::get<0>(mHandle)) {
         return;
     }
+    mThumbnailsStale = true;
 
     auto size_of_one = SizeOfOneCell(mLayoutHorizontal);
     auto numSheets = GetNumSheets(mHandle);
@@ -274,6 +383,7 @@ void FieldThumbnailBrowser::OnUpdate()
 void FieldThumbnailBrowser::SetHandlers(Handlers handlers)
 {
     mHandle = handlers;
+    mThumbnailsStale = true;
 }
 
 void FieldThumbnailBrowser::HandleKey(wxKeyEvent& event)
@@ -23,6 +23,9 @@
 #include "CalChartCoord.h"
 #include "CalChartDrawCommand.h"
 #include "CalChartPerformanceRegistry.h"
+#include "CalChartSheet.h"
+#include <vector>
+#include <wx/bitmap.h>
 #include <wx/docview.h>
 
 class CalChartView;
@@ -49,19 +52,34 @@ public:
     using HandleGetNumSheets = std::function<size_t()>;
     using HandleGetCurrentSheetNum = std::function<size_t()>;
     using HandleGetSheetsName = std::function<std::vector<std::string>()>;
-    using HandleGenerateFieldWithMarchersDrawCommands = std::function<std::vector<std::vector<CalChart::Draw::DrawCommand>>()>;
+    using HandleCopySheets = std::function<std::vector<CalChart::Sheet>()>;
+    using HandleGenerateThumbnailFieldDrawCommands = std::function<std::vector<CalChart::Draw::DrawCommand>()>;
+    using HandleGenerateThumbnailMarchersDrawCommands = std::function<std::vector<CalChart::Draw::DrawCommand>(CalChart::Sheet const&)>;
     using HandleGoToSheet = std::function<void(size_t)>;
-    using Handlers = std::tuple<HandleGetShowFullSize, HandleGetNumSheets, HandleGetCurrentSheetNum, HandleGetSheetsName, HandleGenerateFieldWithMarchersDrawCommands, HandleGoToSheet>;
+    using Handlers = std::tuple<HandleGetShowFullSize, HandleGetNumSheets, HandleGetCurrentSheetNum, HandleGetSheetsName, HandleCopySheets, HandleGenerateThumbnailFieldDrawCommands, HandleGenerateThumbnailMarchersDrawCommands, HandleGoToSheet>;
     void SetHandlers(Handlers handlers);
 
 private:
     void OnPaint(wxPaintEvent& event);
+    void OnIdle(wxIdleEvent& event);
     void HandleKey(wxKeyEvent& event);
     void HandleMouseDown(wxMouseEvent& event);
     void HandleSizeEvent(wxSizeEvent& event);
 
     auto SizeOfOneCell(bool horizontal) const -> wxSize;
     auto WhichCell(wxPoint const& p) const -> int;
+    auto SizeOfOneBox() const -> wxSize;
+
+    // Each sheet's thumbnail is drawn into a bitmap once, and only drawn again when that sheet's ContentsIdentity
+    // changes, or the field, size or colors of all of them change.  The copy of the sheet keeps its identity from
+    // being reused.  Visible ones are drawn when painted, the rest while the app is idle.
+    struct Thumbnail {
+        CalChart::Sheet sheet;
+        std::vector<CalChart::Draw::DrawCommand> marchers;
+        wxBitmap bitmap;
+    };
+    void UpdateThumbnails();
+    auto GetThumbnail(size_t which, wxSize boxSize) -> wxBitmap const&;
 
     CalChartView* mView{};
     Handlers mHandle;
@@ -77,5 +95,14 @@ private:
 
     bool mLayoutHorizontal{ false };
     CalChart::Configuration const& mConfig;
+
+    bool mThumbnailsStale{ true };
+    std::vector<Thumbnail> mThumbnails;
+    std::vector<CalChart::Draw::DrawCommand> mThumbnailField;
+    CalChart::BrushAndPen mThumbnailMarcherBrush;
+    wxSize mThumbnailSize;
+    CalChart::BrushAndPen mThumbnailFieldBrush;
+
     CalChart::ScopedPerformanceRegistry mPerfRegistry;
+    CalChart::ScopedPerformanceRegistry mThumbnailPerfRegistry;
 };
@@ -22,6 +22,7 @@
 
 #include "PerformanceDialog.hpp"
 #include "CalChartPerformanceRegistry.h"
+#include "CalChartUndoHistory.h"
 #include "basic_ui.h"
 #include <algorithm>
 #include <iomanip>
@@ -37,17 +38,23 @@ auto FormatDouble(double value, int precision = 2) -> std::string
     oss << std::fixed << std::setprecision(precision) << value;
     return oss.str();
 }
+
+auto FormatMegabytes(size_t bytes) -> std::string
+{
+    return FormatDouble(static_cast<double>(bytes) / (1024.0 * 1024.0)) + " MB";
+}
 }
 
 BEGIN_EVENT_TABLE(PerformanceDialog, wxDialog)
 EVT_CLOSE(PerformanceDialog::OnClose)
 END_EVENT_TABLE()
 
-PerformanceDialog::PerformanceDialog(wxWindow* parent, CalChart::PerformanceRegistry& registry)
+PerformanceDialog::PerformanceDialog(wxWindow* parent, CalChart::PerformanceRegistry& registry, std::shared_ptr<CalChart::UndoHistory const> undoHistory)
     : super(parent, wxID_ANY, "Draw Performance Metrics",
           wxDefaultPosition, wxSize(800, 600),
           wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
     , mRegistry(registry)
+    , mUndoHistory(std::move(undoHistory))
 {
     CreateControls();
     RefreshData();
@@ -59,6 +66,8 @@ void PerformanceDialog::CreateControls()
         wxSizerFlags{}.Border(wxALL, 10).Expand(),
         wxUI::Text("")
             .withProxy(mSummaryText),
+        wxUI::Text("")
+            .withProxy(mUndoHistoryText),
         wxUI::Factory<wxListCtrl>{
             wxSizerFlags{ 1 }.Border(wxALL, 10).Expand(),
             [](wxWindow* window) -> wxListCtrl* {
@@ -127,6 +136,11 @@ void PerformanceDialog::RefreshData()
 
     mSummaryText->SetLabel(summaryText);
 
+    if (mUndoHistory) {
+        auto undoUsage = mUndoHistory->GetUsage();
+        mUndoHistoryText->SetLabel("Undo History: " + std::to_string(undoUsage.payloads) + " payloads  |  In Memory: " + FormatMegabytes(undoUsage.bytesInMemory) + " of " + FormatMegabytes(mUndoHistory->GetMemoryLimit()) + "  |  On Disk: " + FormatMegabytes(undoUsage.bytesOnDisk) + "  |  Shared: " + FormatMegabytes(undoUsage.bytesShared));
+    }
+
     // Populate list
     long itemIndex = 0;
     for (auto&& [ptr, stats] : allStats) {
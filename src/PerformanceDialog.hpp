@@ -21,11 +21,13 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <memory>
 #include <wx/wx.h>
 #include <wxUI/wxUI.hpp>
 
 namespace CalChart {
 class PerformanceRegistry;
+class UndoHistory;
 }
 
 class wxListCtrl;
@@ -35,7 +37,8 @@ class PerformanceDialog : public wxDialog {
     using super = wxDialog;
 
 public:
-    PerformanceDialog(wxWindow* parent, CalChart::PerformanceRegistry& registry);
+    // undoHistory is the document's, and may be null.
+    PerformanceDialog(wxWindow* parent, CalChart::PerformanceRegistry& registry, std::shared_ptr<CalChart::UndoHistory const> undoHistory);
     ~PerformanceDialog() override = default;
 
 private:
@@ -45,12 +48,15 @@ private:
     void OnClose(wxCloseEvent& event);
 
     CalChart::PerformanceRegistry& mRegistry;
+    std::shared_ptr<CalChart::UndoHistory const> mUndoHistory;
 #if 1
     wxUI::Factory<wxListCtrl>::Proxy mListCtrl;
     wxUI::Text::Proxy mSummaryText;
+    wxUI::Text::Proxy mUndoHistoryText;
 #else
     wxListCtrl* mListCtrl{};
     wxStaticText* mSummaryText{};
+    wxStaticText* mUndoHistoryText{};
 #endif
 
     DECLARE_EVENT_TABLE()
@@ -37,6 +37,7 @@ void GeneralSetup::CreateControls()
         wxUI::VSizer{
             "General Settings",
             VLabelWidget("Autosave Interval", wxUI::TextCtrl{}.withSize({ 100, -1 }).withProxy(mAutoSave_Interval)),
+            VLabelWidget("Undo History Memory Limit (MB)", wxUI::TextCtrl{}.withSize({ 100, -1 }).withProxy(mUndoHistoryMemoryLimit)),
             VLabelWidget("Ignored update version", wxUI::TextCtrl{}.withSize({ 300, -1 }).withProxy(mIgnoredUpdateVersion)),
             wxUI::CheckBox{ "Beep on animation collisions " }.withProxy(mBeep_On_Collisions),
             wxUI::CheckBox{ "Show Sheet Slider" }.withProxy(mSheetSlider),
@@ -53,6 +54,7 @@ void GeneralSetup::CreateControls()
 void GeneralSetup::InitFromConfig()
 {
     *mAutoSave_Interval = std::to_string(mConfig.Get_AutosaveInterval());
+    *mUndoHistoryMemoryLimit = std::to_string(mConfig.Get_UndoHistoryMemoryLimit());
     *mIgnoredUpdateVersion = mConfig.Get_IgnoredUpdateVersion();
     *mBeep_On_Collisions = mConfig.Get_BeepOnCollisions();
     *mSheetSlider = mConfig.Get_AnimationFrameSheetSlider();
@@ -70,6 +72,7 @@ bool GeneralSetup::TransferDataFromWindow()
 {
     // read out the values from the window
     mConfig.Set_AutosaveInterval(std::stol(*mAutoSave_Interval));
+    mConfig.Set_UndoHistoryMemoryLimit(std::stol(*mUndoHistoryMemoryLimit));
     mConfig.Set_IgnoredUpdateVersion(*mIgnoredUpdateVersion);
     mConfig.Set_BeepOnCollisions(*mBeep_On_Collisions);
     mConfig.Set_AnimationFrameSheetSlider(*mSheetSlider);
@@ -82,6 +85,7 @@ bool GeneralSetup::TransferDataFromWindow()
 bool GeneralSetup::ClearValuesToDefault()
 {
     mConfig.Clear_AutosaveInterval();
+    mConfig.Clear_UndoHistoryMemoryLimit();
     mConfig.Clear_IgnoredUpdateVersion();
     mConfig.Clear_BeepOnCollisions();
     mConfig.Clear_AnimationFrameSheetSlider();
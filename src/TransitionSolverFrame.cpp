@@ -16,6 +16,7 @@
 #include "TransitionSolverProgressFrame.h"
 #include "TransitionSolverView.h"
 #include "basic_ui.h"
+#include <limits>
 
 #include <wx/help.h>
 #include <wx/html/helpctrl.h>
@@ -123,11 +124,24 @@ void TransitionSolverFrame::CreateControls()
             wxUI::Text{ "Select an algorithm: " },
             wxUI::Choice{ { "E7 Algorithm: Chiu, Zamora, Malani",
                               "E7 Algorithm: Namini Asl, Ramirez, Zhang",
-                              "Ey Algorithm: Sover, Eliceiri, Hershkovitz" } }
+                              "Ey Algorithm: Sover, Eliceiri, Hershkovitz",
+                              "Portfolio: Run All Algorithms, Keep the Best" } }
                 .bind([this](wxCommandEvent& event) {
                     ChooseAlgorithm((CalChart::TransitionSolverParams::AlgorithmIdentifier)event.GetSelection());
                 })
                 .withProxy(mAlgorithmChoiceControl),
+            wxUI::Text{ " Seed: " },
+            wxUI::SpinCtrl{ std::pair{ 0, std::numeric_limits<int>::max() }, static_cast<int>(mSolverParams.seed) }
+                .bind([this] {
+                    mSolverParams.seed = static_cast<unsigned>(*mSeedControl);
+                })
+                .withProxy(mSeedControl),
+            wxUI::Text{ " Runs: " },
+            wxUI::SpinCtrl{ std::pair{ 1, 64 }, static_cast<int>(mSolverParams.multiStartRuns) }
+                .bind([this] {
+                    mSolverParams.multiStartRuns = static_cast<unsigned>(*mMultiStartRunsControl);
+                })
+                .withProxy(mMultiStartRunsControl),
         },
         wxUI::HLine(),
         wxUI::VSizer{
@@ -406,6 +420,8 @@ void TransitionSolverFrame::SyncControlsWithCurrentState()
     auto numPointsInSelection = mDoc->GetSelectionList().size();
 
     mAlgorithmChoiceControl->SetSelection((int)mSolverParams.algorithm);
+    *mSeedControl = static_cast<int>(mSolverParams.seed);
+    *mMultiStartRunsControl = static_cast<int>(mSolverParams.multiStartRuns);
 
     SyncInstructionOptionsControlWithCurrentState();
     SyncGroupControlsWithCurrentState();
@@ -79,6 +79,8 @@ private:
     TransitionSolverView* mView;
 
     wxUI::Choice::Proxy mAlgorithmChoiceControl;
+    wxUI::SpinCtrl::Proxy mSeedControl;
+    wxUI::SpinCtrl::Proxy mMultiStartRunsControl;
     wxUI::Button::Proxy mCloseButton;
     wxUI::Button::Proxy mApplyButton;
     wxUI::ListBox::Proxy mAvailableCommandsControl;
@@ -98,7 +98,13 @@ auto CreateFieldThumbnailBrowserHandlers(CalChartView* view) -> FieldThumbnailBr
             return view->GetSheetsName();
         },
         [view]() {
-            return view->GenerateFieldWithMarchersDrawCommands();
+            return view->CopySheets();
+        },
+        [view]() {
+            return view->GenerateThumbnailFieldDrawCommands();
+        },
+        [view](CalChart::Sheet const& sheet) {
+            return view->GenerateThumbnailMarchersDrawCommands(sheet);
         },
         [view](size_t sheet_num) {
             view->GoToSheet(sheet_num);
@@ -0,0 +1,127 @@
+#pragma once
+//
+//  calchart_cmd_batch.hpp
+//  calchart_cmd
+//
+//  Check many shows at once, a show per worker, writing one JSON record per show.
+//
+
+#include "CalChartAnimation.h"
+#include "CalChartAnimationErrors.h"
+#include "CalChartUtils.h"
+#include "calchart_cmd_parse.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <system_error>
+#include <thread>
+
+namespace {
+
+// Opens, animates and checks a show, reading its sheets and compiling it on numberThreads threads.  Anything
+// that goes wrong is reported in the record instead of stopping the batch.
+auto BatchProcessShow(std::string const& showPath, unsigned numberThreads) -> nlohmann::json
+{
+    auto result = nlohmann::json{ { "show", showPath } };
+    try {
+        auto start = std::chrono::steady_clock::now();
+        // every sheet gets animated anyway, so decode them all up front, where load_ms counts it.
+        auto show = OpenShow(showPath, CalChart::SheetLoading::Eager, numberThreads);
+        auto loaded = std::chrono::steady_clock::now();
+        auto animation = CalChart::Animation{ *show, numberThreads };
+        auto animated = std::chrono::steady_clock::now();
+
+        auto errors = nlohmann::json::array();
+        auto const animationErrors = animation.GetErrors();
+        for (auto&& [sheet, sheetErrors] : CalChart::Ranges::enumerate_view(animationErrors)) {
+            for (auto&& [error, marchers] : sheetErrors) {
+                errors.push_back({ { "sheet", sheet }, { "error", CalChart::Animate::ErrorToString(error) }, { "marchers", marchers } });
+            }
+        }
+        auto collisions = nlohmann::json::array();
+        for (auto&& [sheet, marchers] : animation.GetCollisions()) {
+            collisions.push_back({ { "sheet", sheet }, { "marchers", marchers } });
+        }
+        result["status"] = "ok";
+        result["bytes"] = std::filesystem::file_size(showPath);
+        result["sheets"] = show->GetNumSheets();
+        result["beats"] = animation.GetTotalNumberBeats();
+        result["errors"] = errors;
+        result["collisions"] = collisions;
+        result["load_ms"] = std::chrono::duration<double, std::milli>(loaded - start).count();
+        result["animate_ms"] = std::chrono::duration<double, std::milli>(animated - loaded).count();
+    } catch (std::exception const& e) {
+        result["status"] = "failed";
+        result["message"] = e.what();
+    } catch (...) {
+        // a worker that let this through would never finish the show's record, and the batch would wait on it.
+        result["status"] = "failed";
+        result["message"] = "unknown error";
+    }
+    return result;
+}
+
+// Workers take the next show that nobody has started on.  Records are written in the order the shows
+// were given, each as soon as it and everything before it is done, followed by a summary of the batch.
+// Directories that can't be read get a failed record of their own, first.
+auto Batch(std::vector<std::string> const& paths, unsigned numberWorkers, unsigned numberThreads, std::ostream& os)
+{
+    auto unreadable = std::vector<std::pair<std::filesystem::path, std::error_code>>{};
+    auto const shows = CalChart::Ranges::ToVector<std::string>(CalChart::ShowFilesInPaths(paths, unreadable) | std::views::transform([](auto&& path) { return path.string(); }));
+    if (numberWorkers == 0) {
+        numberWorkers = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    numberWorkers = static_cast<unsigned>(std::clamp<size_t>(shows.size(), 1, numberWorkers));
+
+    auto start = std::chrono::steady_clock::now();
+    auto promises = std::vector<std::promise<nlohmann::json>>(shows.size());
+    auto results = CalChart::Ranges::ToVector<std::future<nlohmann::json>>(promises | std::views::transform([](auto&& promise) {
+        return promise.get_future();
+    }));
+    auto nextShow = std::atomic<size_t>{};
+    auto workers = std::vector<std::future<void>>{};
+    for (auto worker = 0U; worker < numberWorkers; ++worker) {
+        workers.push_back(std::async(std::launch::async, [&shows, &promises, &nextShow, numberThreads] {
+            for (auto which = nextShow++; which < shows.size(); which = nextShow++) {
+                promises.at(which).set_value(BatchProcessShow(shows.at(which), numberThreads));
+            }
+        }));
+    }
+
+    auto failed = unreadable.size();
+    for (auto&& [path, error] : unreadable) {
+        os << nlohmann::json{ { "show", path.string() }, { "status", "failed" }, { "message", error.message() } }.dump() << "\n"
+           << std::flush;
+    }
+    auto totalBytes = uintmax_t{};
+    for (auto&& result : results) {
+        auto record = result.get();
+        if (record["status"] == "ok") {
+            totalBytes += record["bytes"].get<uintmax_t>();
+        } else {
+            ++failed;
+        }
+        os << record.dump() << "\n"
+           << std::flush;
+    }
+    for (auto&& worker : workers) {
+        worker.get();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    auto summary = nlohmann::json{
+        { "shows", shows.size() + unreadable.size() },
+        { "failed", failed },
+        { "workers", numberWorkers },
+        { "seconds", seconds },
+        { "shows_per_second", static_cast<double>(shows.size()) / std::max(seconds, 1e-9) },
+        { "MB_per_second", static_cast<double>(totalBytes) / 1e6 / std::max(seconds, 1e-9) },
+    };
+    os << nlohmann::json{ { "summary", summary } }.dump() << "\n";
+}
+
+}
@@ -15,13 +15,15 @@
 
 namespace {
 
-auto OpenShow(std::string_view showPath) -> std::unique_ptr<CalChart::Show const>
+// sheets are decoded as the show is read, unless asked to decode them only when they are used.
+// the sheets are read on numberThreads threads, 0 for all cores.
+auto OpenShow(std::string_view showPath, CalChart::SheetLoading loading = CalChart::SheetLoading::Eager, unsigned numberThreads = 0) -> std::unique_ptr<CalChart::Show const>
 {
     auto input = std::ifstream(std::string(showPath));
     if (!input.is_open()) {
         throw std::runtime_error(std::format("could not open file {}", showPath));
     }
-    return CalChart::Show::Create(CalChart::ShowMode::GetDefaultShowMode(), input);
+    return CalChart::Show::Create(CalChart::ShowMode::GetDefaultShowMode(), input, nullptr, loading, numberThreads);
 };
 
 auto DumpAnimationErrors(CalChart::Animation const& animation, std::ostream& os)
@@ -43,9 +45,9 @@ auto DumpAnimationErrors(CalChart::Animation const& animation, std::ostream& os)
     }
 }
 
-auto AnimateShow(CalChart::Show const& show, std::ostream& os)
+auto AnimateShow(CalChart::Show const& show, unsigned numberThreads, std::ostream& os)
 {
-    auto animation = CalChart::Animation{ show };
+    auto animation = CalChart::Animation{ show, numberThreads };
     DumpAnimationErrors(animation, os);
 }
 
@@ -89,9 +91,9 @@ auto DumpFileCheck(std::ostream& os)
     os << "ContinuityCountDifferentThanSymbol ? 0\n";
 }
 
-auto PrintShow(CalChart::Show const& show, std::ostream& os)
+auto PrintShow(CalChart::Show const& show, unsigned numberThreads, std::ostream& os)
 {
-    auto animation = CalChart::Animation{ show };
+    auto animation = CalChart::Animation{ show, numberThreads };
     DumpAnimationErrors(animation, os);
     auto currentInfo = animation.GetCurrentInfo(0);
     os << currentInfo.first << "\n";
@@ -112,9 +114,9 @@ auto PrintShow(CalChart::Show const& show, std::ostream& os)
     }
 }
 
-auto DumpJSON(CalChart::Show const& show, std::ostream& os)
+auto DumpJSON(CalChart::Show const& show, unsigned numberThreads, std::ostream& os)
 {
-    auto animation = CalChart::Animation{ show };
+    auto animation = CalChart::Animation{ show, numberThreads };
     auto json = show.toOnlineViewerJSON(animation);
     os << std::setw(4) << json << "\n";
 }
@@ -145,15 +147,17 @@ namespace CalChartCmd {
 
 constexpr auto Parse = [](auto args, auto& os) {
     auto list_of_files = args["<shows>"].asStringList();
+    auto numberThreads = static_cast<unsigned>(args["--threads"].asLong());
+    auto loading = args["--lazy"].asBool() ? CalChart::SheetLoading::Lazy : CalChart::SheetLoading::Eager;
 
     for (auto&& file : list_of_files) {
-        auto show = OpenShow(file);
+        auto show = OpenShow(file, loading);
 
         if (args["--print_show"].asBool()) {
-            PrintShow(*show, os);
+            PrintShow(*show, numberThreads, os);
         }
         if (args["--animate_show"].asBool()) {
-            AnimateShow(*show, os);
+            AnimateShow(*show, numberThreads, os);
         }
         if (args["--dump_continuity"].asBool()) {
             DumpContinuity(*show, os);
@@ -162,7 +166,7 @@ constexpr auto Parse = [](auto args, auto& os) {
             DumpFileCheck(os);
         }
         if (args["--json"].asBool()) {
-            DumpJSON(*show, os);
+            DumpJSON(*show, numberThreads, os);
         }
         if (args["--dump_print_continuity"].asBool()) {
             DumpPrintContinuity(*show, os);
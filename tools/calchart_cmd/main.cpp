@@ -8,6 +8,7 @@
 
 #include "CalChartMeasure.h"
 #include "CalChartPrintShowToPS.hpp"
+#include "calchart_cmd_batch.hpp"
 #include "calchart_cmd_parse.hpp"
 #include "calchart_cmd_parse_continuity_text.hpp"
 #include "ccvers.h"
@@ -23,6 +24,7 @@ constexpr auto USAGE =
 
 Usage:
     calchart_cmd parse [options] <shows>...
+    calchart_cmd batch [--workers=<n> --threads=<n>] <shows>...
     calchart_cmd print_to_postscript [--landscape --cont --contsheet --overview] <show> <ps_file>
     calchart_cmd parse_continuity_text <text>
     calchart_cmd (-h | --help)
@@ -36,6 +38,9 @@ Options:
     --animate_show          Parse option to print the animation.
     --json                  Parse option to dump the JSON for the viewer.
     --dump_beats            Parse option to dump downbeat times.
+    --lazy                  Parse option to decode each sheet only when it is used.
+    --threads=<n>           Parse and batch option for the number of threads used to compile the animation, and in batch to read each show's sheets, 0 for all cores [default: 1].
+    --workers=<n>           Batch option for the number of shows checked at once, 0 for all cores [default: 0].
     --profile               Print profiling data.
     -h, --help              Show this screen.
     --version               Show version.
@@ -97,6 +102,9 @@ auto main(int argc, char* argv[]) -> int
     if (args["parse"].asBool()) {
         CalChartCmd::Parse(args, std::cout);
     }
+    if (args["batch"].asBool()) {
+        Batch(args["<shows>"].asStringList(), static_cast<unsigned>(args["--workers"].asLong()), static_cast<unsigned>(args["--threads"].asLong()), std::cout);
+    }
     if (args["print_to_postscript"].asBool()) {
         PrintToPS(args["<show>"].asString(), args["--landscape"].asBool(), args["--cont"].asBool(), args["--contsheet"].asBool(), args["--overview"].asBool(), args["<ps_file>"].asString());
     }